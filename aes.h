@@ -0,0 +1,52 @@
+#ifndef AES_H
+#define AES_H
+
+#include <stdint.h>
+#include <string.h>
+
+/*! \brief AES block cipher context (AES-128 / AES-256)
+
+	K  -- развернутый ключ, Nr+1 раундовых ключей (формат зависит от реализации)
+	iv -- вектор инициализации для режима CBC
+	nr -- число раундов: 10 (AES-128) или 14 (AES-256)
+
+	Контекст не изменяется функциями шифрования, поэтому один
+	развернутый ключ можно использовать из нескольких потоков.
+ */
+typedef struct _AES_Ctx AES_Ctx;
+struct _AES_Ctx {
+	uint8_t K[14+1][16] __attribute__((aligned(16)));
+	uint8_t iv[16] __attribute__((aligned(16)));
+	int nr;
+};
+
+static inline void AES_set_iv(AES_Ctx *ctx, const uint8_t *iv, int iv_len)
+{
+	memcpy(ctx->iv, iv, 16);
+}
+
+/*! \brief AES implementation (backend)
+
+	probe         -- 1 если реализация доступна на этом процессоре
+	key_expansion -- ekb: длина ключа {128, 256} | 10000h - ключи для расшифровки
+	cbc_encrypt/cbc_decrypt -- length кратна 16, допускается dst == src;
+	                 возвращают 0 или -1 при ошибке
+ */
+typedef struct _AES_Backend AES_Backend;
+struct _AES_Backend {
+	const char *name;
+	int  (*probe)(void);
+	void (*key_expansion)(AES_Ctx *ctx, const uint8_t *key, int klen, int ekb);
+	int  (*cbc_encrypt)(const AES_Ctx *ctx, uint8_t *dst, const uint8_t *src, int length);
+	int  (*cbc_decrypt)(const AES_Ctx *ctx, uint8_t *dst, const uint8_t *src, int length);
+};
+
+#ifdef HAVE_AES_NI
+extern const AES_Backend AES_backend_ni;    // aes_ni.c:   x86 AES-NI
+#endif
+#ifdef HAVE_AES_ARM
+extern const AES_Backend AES_backend_arm;   // aes_arm.c:  ARMv8 Crypto Extensions
+#endif
+extern const AES_Backend AES_backend_soft;  // aes_soft.c: portable C
+
+#endif // AES_H
@@ -0,0 +1,222 @@
+/*! \brief Portable AES-128/AES-256 (FIPS 197), reference implementation
+
+	Используется на процессорах без аппаратной поддержки AES и как
+	эталон при самотестировании остальных реализаций.
+
+	\see https://nvlpubs.nist.gov/nistpubs/fips/nist.fips.197.pdf
+ */
+#include "aes.h"
+
+static const uint8_t SBox[256] =
+{
+	0x63, 0x7C, 0x77, 0x7B, 0xF2, 0x6B, 0x6F, 0xC5, 0x30, 0x01, 0x67, 0x2B, 0xFE, 0xD7, 0xAB, 0x76,
+	0xCA, 0x82, 0xC9, 0x7D, 0xFA, 0x59, 0x47, 0xF0, 0xAD, 0xD4, 0xA2, 0xAF, 0x9C, 0xA4, 0x72, 0xC0,
+	0xB7, 0xFD, 0x93, 0x26, 0x36, 0x3F, 0xF7, 0xCC, 0x34, 0xA5, 0xE5, 0xF1, 0x71, 0xD8, 0x31, 0x15,
+	0x04, 0xC7, 0x23, 0xC3, 0x18, 0x96, 0x05, 0x9A, 0x07, 0x12, 0x80, 0xE2, 0xEB, 0x27, 0xB2, 0x75,
+	0x09, 0x83, 0x2C, 0x1A, 0x1B, 0x6E, 0x5A, 0xA0, 0x52, 0x3B, 0xD6, 0xB3, 0x29, 0xE3, 0x2F, 0x84,
+	0x53, 0xD1, 0x00, 0xED, 0x20, 0xFC, 0xB1, 0x5B, 0x6A, 0xCB, 0xBE, 0x39, 0x4A, 0x4C, 0x58, 0xCF,
+	0xD0, 0xEF, 0xAA, 0xFB, 0x43, 0x4D, 0x33, 0x85, 0x45, 0xF9, 0x02, 0x7F, 0x50, 0x3C, 0x9F, 0xA8,
+	0x51, 0xA3, 0x40, 0x8F, 0x92, 0x9D, 0x38, 0xF5, 0xBC, 0xB6, 0xDA, 0x21, 0x10, 0xFF, 0xF3, 0xD2,
+	0xCD, 0x0C, 0x13, 0xEC, 0x5F, 0x97, 0x44, 0x17, 0xC4, 0xA7, 0x7E, 0x3D, 0x64, 0x5D, 0x19, 0x73,
+	0x60, 0x81, 0x4F, 0xDC, 0x22, 0x2A, 0x90, 0x88, 0x46, 0xEE, 0xB8, 0x14, 0xDE, 0x5E, 0x0B, 0xDB,
+	0xE0, 0x32, 0x3A, 0x0A, 0x49, 0x06, 0x24, 0x5C, 0xC2, 0xD3, 0xAC, 0x62, 0x91, 0x95, 0xE4, 0x79,
+	0xE7, 0xC8, 0x37, 0x6D, 0x8D, 0xD5, 0x4E, 0xA9, 0x6C, 0x56, 0xF4, 0xEA, 0x65, 0x7A, 0xAE, 0x08,
+	0xBA, 0x78, 0x25, 0x2E, 0x1C, 0xA6, 0xB4, 0xC6, 0xE8, 0xDD, 0x74, 0x1F, 0x4B, 0xBD, 0x8B, 0x8A,
+	0x70, 0x3E, 0xB5, 0x66, 0x48, 0x03, 0xF6, 0x0E, 0x61, 0x35, 0x57, 0xB9, 0x86, 0xC1, 0x1D, 0x9E,
+	0xE1, 0xF8, 0x98, 0x11, 0x69, 0xD9, 0x8E, 0x94, 0x9B, 0x1E, 0x87, 0xE9, 0xCE, 0x55, 0x28, 0xDF,
+	0x8C, 0xA1, 0x89, 0x0D, 0xBF, 0xE6, 0x42, 0x68, 0x41, 0x99, 0x2D, 0x0F, 0xB0, 0x54, 0xBB, 0x16,
+};
+
+static const uint8_t InvSBox[256] =
+{
+	0x52, 0x09, 0x6A, 0xD5, 0x30, 0x36, 0xA5, 0x38, 0xBF, 0x40, 0xA3, 0x9E, 0x81, 0xF3, 0xD7, 0xFB,
+	0x7C, 0xE3, 0x39, 0x82, 0x9B, 0x2F, 0xFF, 0x87, 0x34, 0x8E, 0x43, 0x44, 0xC4, 0xDE, 0xE9, 0xCB,
+	0x54, 0x7B, 0x94, 0x32, 0xA6, 0xC2, 0x23, 0x3D, 0xEE, 0x4C, 0x95, 0x0B, 0x42, 0xFA, 0xC3, 0x4E,
+	0x08, 0x2E, 0xA1, 0x66, 0x28, 0xD9, 0x24, 0xB2, 0x76, 0x5B, 0xA2, 0x49, 0x6D, 0x8B, 0xD1, 0x25,
+	0x72, 0xF8, 0xF6, 0x64, 0x86, 0x68, 0x98, 0x16, 0xD4, 0xA4, 0x5C, 0xCC, 0x5D, 0x65, 0xB6, 0x92,
+	0x6C, 0x70, 0x48, 0x50, 0xFD, 0xED, 0xB9, 0xDA, 0x5E, 0x15, 0x46, 0x57, 0xA7, 0x8D, 0x9D, 0x84,
+	0x90, 0xD8, 0xAB, 0x00, 0x8C, 0xBC, 0xD3, 0x0A, 0xF7, 0xE4, 0x58, 0x05, 0xB8, 0xB3, 0x45, 0x06,
+	0xD0, 0x2C, 0x1E, 0x8F, 0xCA, 0x3F, 0x0F, 0x02, 0xC1, 0xAF, 0xBD, 0x03, 0x01, 0x13, 0x8A, 0x6B,
+	0x3A, 0x91, 0x11, 0x41, 0x4F, 0x67, 0xDC, 0xEA, 0x97, 0xF2, 0xCF, 0xCE, 0xF0, 0xB4, 0xE6, 0x73,
+	0x96, 0xAC, 0x74, 0x22, 0xE7, 0xAD, 0x35, 0x85, 0xE2, 0xF9, 0x37, 0xE8, 0x1C, 0x75, 0xDF, 0x6E,
+	0x47, 0xF1, 0x1A, 0x71, 0x1D, 0x29, 0xC5, 0x89, 0x6F, 0xB7, 0x62, 0x0E, 0xAA, 0x18, 0xBE, 0x1B,
+	0xFC, 0x56, 0x3E, 0x4B, 0xC6, 0xD2, 0x79, 0x20, 0x9A, 0xDB, 0xC0, 0xFE, 0x78, 0xCD, 0x5A, 0xF4,
+	0x1F, 0xDD, 0xA8, 0x33, 0x88, 0x07, 0xC7, 0x31, 0xB1, 0x12, 0x10, 0x59, 0x27, 0x80, 0xEC, 0x5F,
+	0x60, 0x51, 0x7F, 0xA9, 0x19, 0xB5, 0x4A, 0x0D, 0x2D, 0xE5, 0x7A, 0x9F, 0x93, 0xC9, 0x9C, 0xEF,
+	0xA0, 0xE0, 0x3B, 0x4D, 0xAE, 0x2A, 0xF5, 0xB0, 0xC8, 0xEB, 0xBB, 0x3C, 0x83, 0x53, 0x99, 0x61,
+	0x17, 0x2B, 0x04, 0x7E, 0xBA, 0x77, 0xD6, 0x26, 0xE1, 0x69, 0x14, 0x63, 0x55, 0x21, 0x0C, 0x7D,
+};
+
+static inline uint8_t xtime(uint8_t x)
+{
+	return (uint8_t)((x << 1) ^ ((x >> 7) * 0x1B));
+}
+
+static inline uint8_t gmul(uint8_t a, uint8_t b)
+{
+	uint8_t p = 0;
+	while (b)
+	{
+		if (b & 1) p ^= a;
+		a = xtime(a);
+		b >>= 1;
+	}
+	return p;
+}
+
+// Состояние хранится по столбцам: s[4*c + r]
+static inline void AddRoundKey(uint8_t s[16], const uint8_t *k)
+{
+	for (int i = 0; i < 16; i++)
+		s[i] ^= k[i];
+}
+
+static inline void SubShiftRows(uint8_t s[16])
+{
+	uint8_t t[16];
+	for (int c = 0; c < 4; c++)
+		for (int r = 0; r < 4; r++)
+			t[4*c + r] = SBox[s[4*((c + r) & 3) + r]];
+	memcpy(s, t, 16);
+}
+
+static inline void InvSubShiftRows(uint8_t s[16])
+{
+	uint8_t t[16];
+	for (int c = 0; c < 4; c++)
+		for (int r = 0; r < 4; r++)
+			t[4*((c + r) & 3) + r] = InvSBox[s[4*c + r]];
+	memcpy(s, t, 16);
+}
+
+static inline void MixColumns(uint8_t s[16])
+{
+	for (int c = 0; c < 4; c++)
+	{
+		uint8_t *a = s + 4*c;
+		uint8_t a0 = a[0], a1 = a[1], a2 = a[2], a3 = a[3];
+		uint8_t t = a0 ^ a1 ^ a2 ^ a3;
+		a[0] ^= t ^ xtime(a0 ^ a1);
+		a[1] ^= t ^ xtime(a1 ^ a2);
+		a[2] ^= t ^ xtime(a2 ^ a3);
+		a[3] ^= t ^ xtime(a3 ^ a0);
+	}
+}
+
+static inline void InvMixColumns(uint8_t s[16])
+{
+	for (int c = 0; c < 4; c++)
+	{
+		uint8_t *a = s + 4*c;
+		uint8_t a0 = a[0], a1 = a[1], a2 = a[2], a3 = a[3];
+		a[0] = gmul(a0, 14) ^ gmul(a1, 11) ^ gmul(a2, 13) ^ gmul(a3,  9);
+		a[1] = gmul(a0,  9) ^ gmul(a1, 14) ^ gmul(a2, 11) ^ gmul(a3, 13);
+		a[2] = gmul(a0, 13) ^ gmul(a1,  9) ^ gmul(a2, 14) ^ gmul(a3, 11);
+		a[3] = gmul(a0, 11) ^ gmul(a1, 13) ^ gmul(a2,  9) ^ gmul(a3, 14);
+	}
+}
+
+static void aes_encrypt_block(const AES_Ctx *ctx, uint8_t s[16])
+{
+	const int nr = ctx->nr;
+	AddRoundKey(s, ctx->K[0]);
+	for (int r = 1; r < nr; r++)
+	{
+		SubShiftRows(s);
+		MixColumns(s);
+		AddRoundKey(s, ctx->K[r]);
+	}
+	SubShiftRows(s);
+	AddRoundKey(s, ctx->K[nr]);
+}
+
+static void aes_decrypt_block(const AES_Ctx *ctx, uint8_t s[16])
+{
+	const int nr = ctx->nr;
+	AddRoundKey(s, ctx->K[nr]);
+	for (int r = nr - 1; r > 0; r--)
+	{
+		InvSubShiftRows(s);
+		AddRoundKey(s, ctx->K[r]);
+		InvMixColumns(s);
+	}
+	InvSubShiftRows(s);
+	AddRoundKey(s, ctx->K[0]);
+}
+
+static int AES_soft_CBC_encrypt(const AES_Ctx *ctx, uint8_t *dst, const uint8_t *src, int length)
+{
+	uint8_t v[16];
+	memcpy(v, ctx->iv, 16);
+	for (int i = 0; i < (length >> 4); i++)
+	{
+		for (int j = 0; j < 16; j++)
+			v[j] ^= src[16*i + j];
+		aes_encrypt_block(ctx, v);
+		memcpy(dst + 16*i, v, 16);
+	}
+	return 0;
+}
+
+static int AES_soft_CBC_decrypt(const AES_Ctx *ctx, uint8_t *dst, const uint8_t *src, int length)
+{
+	uint8_t prev[16], cur[16], d[16];
+	memcpy(prev, ctx->iv, 16);
+	for (int i = 0; i < (length >> 4); i++)
+	{
+		memcpy(cur, src + 16*i, 16);
+		memcpy(d, cur, 16);
+		aes_decrypt_block(ctx, d);
+		for (int j = 0; j < 16; j++)
+			dst[16*i + j] = d[j] ^ prev[j];
+		memcpy(prev, cur, 16);
+	}
+	return 0;
+}
+
+/*! Разгибание ключа, раундовые ключи хранятся в прямом порядке
+	и для зашифрования, и для расшифрования (флаг 10000h не используется)
+ */
+static void AES_soft_KeyExpansion(AES_Ctx *ctx, const uint8_t *key, int klen, int ekb)
+{
+	uint8_t *w = &ctx->K[0][0];
+	const int Nk = (ekb & 0xFFFF) / 32;
+	const int Nr = 6 + Nk;
+	uint8_t rcon = 1;
+
+	memcpy(w, key, 4*Nk);
+	for (int i = Nk; i < 4*(Nr + 1); i++)
+	{
+		uint8_t t[4] = { w[4*i-4], w[4*i-3], w[4*i-2], w[4*i-1] };
+		if (i % Nk == 0)
+		{
+			uint8_t t0 = t[0];
+			t[0] = SBox[t[1]] ^ rcon;
+			t[1] = SBox[t[2]];
+			t[2] = SBox[t[3]];
+			t[3] = SBox[t0];
+			rcon = xtime(rcon);
+		}
+		else if (Nk == 8 && i % Nk == 4)
+		{
+			for (int j = 0; j < 4; j++)
+				t[j] = SBox[t[j]];
+		}
+		for (int j = 0; j < 4; j++)
+			w[4*i + j] = w[4*(i - Nk) + j] ^ t[j];
+	}
+	ctx->nr = Nr;
+}
+
+static int AES_soft_probe(void)
+{
+	return 1;
+}
+
+const AES_Backend AES_backend_soft = {
+	.name = "portable",
+	.probe = AES_soft_probe,
+	.key_expansion = AES_soft_KeyExpansion,
+	.cbc_encrypt = AES_soft_CBC_encrypt,
+	.cbc_decrypt = AES_soft_CBC_decrypt,
+};
@@ -0,0 +1,437 @@
+#include "batch.h"
+#include "eeprom_defs.h"
+#include "eeprom_archive.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+// ═══════════════════════════════════════════════════════════════
+// Thread pool
+// ═══════════════════════════════════════════════════════════════
+
+int batch_default_jobs(void)
+{
+	long n = sysconf(_SC_NPROCESSORS_ONLN);
+	return n > 0 ? (int)n : 1;
+}
+
+typedef struct
+{
+	size_t count;
+	size_t next;                   // следующий свободный индекс (атомарно)
+	BatchWorkFn work;
+	void *ctx;
+} BatchQueue;
+
+typedef struct
+{
+	BatchQueue *queue;
+	int worker;
+} BatchWorker;
+
+static void *batch_worker(void *arg)
+{
+	BatchWorker *self = (BatchWorker*)arg;
+	BatchQueue *queue = self->queue;
+
+	for (;;)
+	{
+		size_t index = __atomic_fetch_add(&queue->next, 1, __ATOMIC_RELAXED);
+		if (index >= queue->count)
+		{
+			break;
+		}
+		queue->work(index, self->worker, queue->ctx);
+	}
+
+	return NULL;
+}
+
+int batch_parallel_for(size_t count, int jobs, BatchWorkFn work, void *ctx)
+{
+	BatchQueue queue = { count, 0, work, ctx };
+
+	if ((size_t)jobs > count)
+	{
+		jobs = (int)count;
+	}
+
+	if (jobs <= 1)
+	{
+		BatchWorker self = { &queue, 0 };
+		batch_worker(&self);
+		return 0;
+	}
+
+	// Вызывающий поток тоже работает (worker 0): jobs - 1 дополнительных
+	pthread_t *threads = malloc(sizeof(pthread_t) * (jobs - 1));
+	BatchWorker *workers = malloc(sizeof(BatchWorker) * jobs);
+	if (!threads || !workers)
+	{
+		free(threads);
+		free(workers);
+		return -1;
+	}
+
+	for (int i = 0; i < jobs; i++)
+	{
+		workers[i].queue = &queue;
+		workers[i].worker = i;
+	}
+
+	int started = 0;
+	while (started < jobs - 1 &&
+		   pthread_create(&threads[started], NULL, batch_worker, &workers[started + 1]) == 0)
+	{
+		started++;
+	}
+
+	batch_worker(&workers[0]);
+
+	for (int i = 0; i < started; i++)
+	{
+		pthread_join(threads[i], NULL);
+	}
+	free(threads);
+	free(workers);
+
+	return 0;
+}
+
+// ═══════════════════════════════════════════════════════════════
+// Ordered / unordered output
+// ═══════════════════════════════════════════════════════════════
+
+typedef struct
+{
+	char *text;
+	size_t length;
+	int ready;
+} BatchPending;
+
+struct _BatchOutput
+{
+	int fd;
+	int ordered;
+	int failed;                    // write() вернул ошибку
+	char *buffer;
+	size_t length;
+	size_t count;
+	size_t next;                   // ordered: первый еще не выведенный индекс
+	BatchPending *pending;
+	pthread_mutex_t lock;
+};
+
+BatchOutput *batch_output_create(int fd, size_t count, int ordered)
+{
+	BatchOutput *output = calloc(1, sizeof(BatchOutput));
+	if (!output)
+	{
+		return NULL;
+	}
+
+	output->fd = fd;
+	output->ordered = ordered;
+	output->count = count;
+	output->buffer = malloc(BATCH_OUTPUT_FLUSH);
+
+	if (ordered && count)
+	{
+		output->pending = calloc(count, sizeof(BatchPending));
+	}
+
+	if (!output->buffer || (ordered && count && !output->pending))
+	{
+		free(output->buffer);
+		free(output->pending);
+		free(output);
+		return NULL;
+	}
+
+	pthread_mutex_init(&output->lock, NULL);
+	return output;
+}
+
+static void batch_output_write(BatchOutput *output, const char *text, size_t length)
+{
+	while (length && !output->failed)
+	{
+		ssize_t n = write(output->fd, text, length);
+		if (n < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			output->failed = 1;
+			break;
+		}
+		text += n;
+		length -= n;
+	}
+}
+
+static void batch_output_append(BatchOutput *output, const char *text, size_t length)
+{
+	if (output->length + length > BATCH_OUTPUT_FLUSH)
+	{
+		batch_output_write(output, output->buffer, output->length);
+		output->length = 0;
+	}
+
+	if (length > BATCH_OUTPUT_FLUSH)
+	{
+		batch_output_write(output, text, length);
+		return;
+	}
+
+	memcpy(output->buffer + output->length, text, length);
+	output->length += length;
+}
+
+void batch_output_commit(BatchOutput *output, size_t index, const char *text, size_t length)
+{
+	pthread_mutex_lock(&output->lock);
+
+	if (!output->ordered || index == output->next)
+	{
+		batch_output_append(output, text, length);
+
+		if (output->ordered)
+		{
+			// Выводим накопившиеся результаты, дождавшиеся своей очереди
+			output->next++;
+			while (output->next < output->count && output->pending[output->next].ready)
+			{
+				BatchPending *p = &output->pending[output->next];
+				batch_output_append(output, p->text, p->length);
+				free(p->text);
+				p->text = NULL;
+				output->next++;
+			}
+		}
+	}
+	else
+	{
+		BatchPending *p = &output->pending[index];
+		p->text = malloc(length ? length : 1);
+		if (p->text)
+		{
+			memcpy(p->text, text, length);
+			p->length = length;
+		}
+		p->ready = 1;
+	}
+
+	pthread_mutex_unlock(&output->lock);
+}
+
+int batch_output_destroy(BatchOutput *output)
+{
+	if (!output)
+	{
+		return 0;
+	}
+
+	if (output->pending)
+	{
+		for (size_t i = 0; i < output->count; i++)
+		{
+			free(output->pending[i].text);
+		}
+		free(output->pending);
+	}
+
+	batch_output_write(output, output->buffer, output->length);
+	int result = output->failed ? -1 : 0;
+
+	pthread_mutex_destroy(&output->lock);
+	free(output->buffer);
+	free(output);
+	return result;
+}
+
+// ═══════════════════════════════════════════════════════════════
+// Directory walk
+// ═══════════════════════════════════════════════════════════════
+
+int batch_add_path(BatchPathList *list, const char *path)
+{
+	if (list->count == list->capacity)
+	{
+		size_t capacity = list->capacity ? list->capacity * 2 : 256;
+		char **paths = realloc(list->paths, capacity * sizeof(char*));
+		if (!paths)
+		{
+			return -1;
+		}
+		list->paths = paths;
+		list->capacity = capacity;
+	}
+
+	list->paths[list->count] = strdup(path);
+	if (!list->paths[list->count])
+	{
+		return -1;
+	}
+	list->count++;
+	return 0;
+}
+
+static int batch_compare_names(const void *a, const void *b)
+{
+	return strcmp(*(char *const*)a, *(char *const*)b);
+}
+
+// Каталоги, уже пройденные обходом: ссылки на каталог выше по дереву
+// иначе зацикливают его, на соседний - дублируют дампы
+typedef struct
+{
+	struct
+	{
+		dev_t dev;
+		ino_t ino;
+	} *dirs;
+	size_t count;
+	size_t capacity;
+} BatchVisited;
+
+// 1 - уже пройден, 0 - отмечен сейчас, -1 - нет памяти
+static int batch_visit(BatchVisited *visited, const struct stat *st)
+{
+	for (size_t i = 0; i < visited->count; i++)
+	{
+		if (visited->dirs[i].dev == st->st_dev && visited->dirs[i].ino == st->st_ino)
+		{
+			return 1;
+		}
+	}
+
+	if (visited->count == visited->capacity)
+	{
+		size_t capacity = visited->capacity ? visited->capacity * 2 : 16;
+		void *dirs = realloc(visited->dirs, capacity * sizeof(*visited->dirs));
+		if (!dirs)
+		{
+			return -1;
+		}
+		visited->dirs = dirs;
+		visited->capacity = capacity;
+	}
+	visited->dirs[visited->count].dev = st->st_dev;
+	visited->dirs[visited->count].ino = st->st_ino;
+	visited->count++;
+	return 0;
+}
+
+// Файл в каталоге, который может быть дампом (1..EEPROM_SIZE байт) или архивом
+static int batch_is_dump(const char *path, const struct stat *st)
+{
+	return S_ISREG(st->st_mode) &&
+		((st->st_size > 0 && st->st_size <= EEPROM_SIZE) || eeprom_archive_is_archive_path(path));
+}
+
+static int batch_walk_dir(BatchPathList *list, const char *dir_path, const struct stat *dir_st,
+						  BatchVisited *visited)
+{
+	int seen = batch_visit(visited, dir_st);
+	if (seen != 0)
+	{
+		return seen > 0 ? 0 : -1;
+	}
+
+	DIR *dir = opendir(dir_path);
+	if (!dir)
+	{
+		return -1;
+	}
+
+	// Имена сначала собираем и сортируем: порядок readdir зависит от ФС
+	BatchPathList names = { 0 };
+	struct dirent *entry;
+	while ((entry = readdir(dir)) != NULL)
+	{
+		if (entry->d_name[0] == '.')
+		{
+			continue;
+		}
+		if (batch_add_path(&names, entry->d_name) != 0)
+		{
+			closedir(dir);
+			batch_free_paths(&names);
+			return -1;
+		}
+	}
+	closedir(dir);
+
+	qsort(names.paths, names.count, sizeof(char*), batch_compare_names);
+
+	int result = 0;
+	size_t dir_len = strlen(dir_path);
+	int need_slash = dir_len > 0 && dir_path[dir_len - 1] != '/';
+
+	for (size_t i = 0; i < names.count && result == 0; i++)
+	{
+		size_t path_len = dir_len + need_slash + strlen(names.paths[i]) + 1;
+		char *path = malloc(path_len);
+		if (!path)
+		{
+			result = -1;
+			break;
+		}
+		snprintf(path, path_len, "%s%s%s", dir_path, need_slash ? "/" : "", names.paths[i]);
+
+		struct stat st;
+		if (stat(path, &st) == 0)
+		{
+			if (S_ISDIR(st.st_mode))
+			{
+				result = batch_walk_dir(list, path, &st, visited);
+			}
+			else if (batch_is_dump(path, &st))
+			{
+				result = batch_add_path(list, path);
+			}
+		}
+		free(path);
+	}
+
+	batch_free_paths(&names);
+	return result;
+}
+
+int batch_collect_paths(BatchPathList *list, const char *path)
+{
+	struct stat st;
+	if (stat(path, &st) != 0)
+	{
+		return -1;
+	}
+
+	if (S_ISDIR(st.st_mode))
+	{
+		BatchVisited visited = { 0 };
+		int result = batch_walk_dir(list, path, &st, &visited);
+		free(visited.dirs);
+		return result;
+	}
+
+	return batch_add_path(list, path);
+}
+
+void batch_free_paths(BatchPathList *list)
+{
+	for (size_t i = 0; i < list->count; i++)
+	{
+		free(list->paths[i]);
+	}
+	free(list->paths);
+	list->paths = NULL;
+	list->count = 0;
+	list->capacity = 0;
+}
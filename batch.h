@@ -0,0 +1,72 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stddef.h>
+
+// ═══════════════════════════════════════════════════════════════
+// Parallel processing of many independent items
+// ═══════════════════════════════════════════════════════════════
+
+// Number of online CPUs (at least 1)
+int batch_default_jobs(void);
+
+/**
+ * Run work(index, worker, ctx) for every index in [0, count) on jobs threads
+ * Items are handed out one by one, so slow files do not stall a thread's
+ * whole share. worker is in [0, jobs) and identifies the calling thread,
+ * e.g. for per-thread scratch buffers. jobs <= 1 runs in the calling
+ * thread. Returns when all items are done; 0 or -1 if threads could not
+ * be started.
+ */
+typedef void (*BatchWorkFn)(size_t index, int worker, void *ctx);
+int batch_parallel_for(size_t count, int jobs, BatchWorkFn work, void *ctx);
+
+// ═══════════════════════════════════════════════════════════════
+// Output of per-item results
+// ═══════════════════════════════════════════════════════════════
+
+/**
+ * Collects per-item text from worker threads
+ * ordered   -- item i is written after items 0..i-1; results that arrive
+ *              early are copied and held until their turn
+ * unordered -- appended as soon as they are committed
+ * Text is gathered in one large buffer and handed to fd with a single
+ * write() per BATCH_OUTPUT_FLUSH bytes (and at destroy).
+ * Every index in [0, count) must be committed exactly once (empty text is fine).
+ */
+#define BATCH_OUTPUT_FLUSH (1 << 20)
+
+typedef struct _BatchOutput BatchOutput;
+
+BatchOutput *batch_output_create(int fd, size_t count, int ordered);
+void batch_output_commit(BatchOutput *output, size_t index, const char *text, size_t length);
+// Flushes the rest; returns 0 or -1 if any write() failed
+int batch_output_destroy(BatchOutput *output);
+
+// ═══════════════════════════════════════════════════════════════
+// Input paths
+// ═══════════════════════════════════════════════════════════════
+
+typedef struct
+{
+	char **paths;
+	size_t count;
+	size_t capacity;
+} BatchPathList;
+
+/**
+ * Append path; directories are walked recursively (entries sorted by
+ * name, hidden entries skipped, each directory once even if linked
+ * again) and only files that can be dumps are added: 1..EEPROM_SIZE
+ * bytes or an archive. A path given directly is added whatever it is,
+ * so a bad file named on the command line is still reported.
+ * Returns 0 or -1 if path cannot be accessed (errno is set).
+ */
+int batch_collect_paths(BatchPathList *list, const char *path);
+/*
+ * Append path as is, without checking it.
+ */
+int batch_add_path(BatchPathList *list, const char *path);
+void batch_free_paths(BatchPathList *list);
+
+#endif // BATCH_H
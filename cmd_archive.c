@@ -0,0 +1,373 @@
+#include "commands.h"
+#include "batch.h"
+#include "inputs.h"
+#include "eeprom_defs.h"
+#include "eeprom_ops.h"
+#include "eeprom_file.h"
+#include "eeprom_archive.h"
+#include "export.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+// ═══════════════════════════════════════════════════════════════
+// pack: дампы -> архив
+// ═══════════════════════════════════════════════════════════════
+
+typedef struct
+{
+	const InputSet *inputs;
+	const CommandOptions *options;
+	EEPROMArchiveWriter *writer;
+	size_t errors;
+} PackJob;
+
+static const char *base_name(const char *path)
+{
+	const char *slash = strrchr(path, '/');
+	return slash ? slash + 1 : path;
+}
+
+static void pack_one(size_t index, int worker, void *arg)
+{
+	PackJob *job = (PackJob*)arg;
+	const InputItem *item = &job->inputs->items[index];
+
+	uint8_t raw[EEPROM_SIZE];
+	size_t length;
+
+	int ret = inputs_read(job->inputs, index, raw, &length);
+	if (ret != EEPROM_SUCCESS)
+	{
+		char source[1024];
+		inputs_source(job->inputs, index, source, sizeof(source));
+		fprintf(stderr, "Warning: Skipping %s: %s\n", source,
+				ret == EEPROM_ERROR_IO ? strerror(errno) : eeprom_strerror(ret));
+		__atomic_fetch_add(&job->errors, 1, __ATOMIC_RELAXED);
+		return;
+	}
+
+	// Серийный номер для индекса; в архив идет исходный (зашифрованный) дамп.
+	// Расшифровывается только регион с номером, без параметров и sweep
+	EEPROMView view;
+	char serial[EEPROM_ARCHIVE_SERIAL + 1] = "";
+
+	if (command_view_init(&view, raw, job->options) == EEPROM_SUCCESS)
+	{
+		eeprom_view_serial(&view, serial, sizeof(serial));
+	}
+
+	const char *name = item->archive == INPUT_FILE
+					   ? base_name(job->inputs->paths.paths[item->index])
+					   : eeprom_archive_name(&job->inputs->archives[item->archive], item->index);
+
+	eeprom_archive_writer_set(job->writer, index, raw, length, serial, name);
+}
+
+static void print_histogram(const EEPROMArchiveHeader *header)
+{
+	for (int v = 0; v < EEPROM_ARCHIVE_VERSIONS; v++)
+	{
+		if (header->version_histogram[v])
+		{
+			if (v == 0)
+			{
+				fprintf(stderr, "  unknown: %llu\n", (unsigned long long)header->version_histogram[v]);
+			}
+			else
+			{
+				fprintf(stderr, "  v%-6d: %llu\n", v, (unsigned long long)header->version_histogram[v]);
+			}
+		}
+	}
+}
+
+static int parse_jobs(const char *value, int *jobs)
+{
+	*jobs = atoi(value);
+	if (*jobs < 1)
+	{
+		fprintf(stderr, "Error: --jobs must be at least 1\n");
+		return -1;
+	}
+	return 0;
+}
+
+int cmd_pack(int argc, char *argv[], const CommandOptions *options)
+{
+	int jobs = batch_default_jobs();
+	const char *output = NULL;
+	InputSet inputs = { 0 };
+	int status = 0;
+
+	for (int i = 0; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc)
+		{
+			if (parse_jobs(argv[++i], &jobs) != 0)
+			{
+				inputs_free(&inputs);
+				return 1;
+			}
+		}
+		else if (!output)
+		{
+			output = argv[i];
+		}
+		else if (inputs_add(&inputs, argv[i]) != 0)
+		{
+			fprintf(stderr, "Error: Cannot read %s: %s\n", argv[i], strerror(errno));
+			status = 1;
+		}
+	}
+
+	if (!output || inputs.count == 0)
+	{
+		if (status == 0)
+		{
+			fprintf(stderr, "Usage: eeprom_tool [options] pack [--jobs N] <archive%s> <files|dirs|archives...>\n",
+					EEPROM_ARCHIVE_EXTENSION);
+		}
+		inputs_free(&inputs);
+		return 1;
+	}
+
+	PackJob job = { 0 };
+	job.inputs = &inputs;
+	job.options = options;
+	job.writer = eeprom_archive_writer_create(output, inputs.count);
+	if (!job.writer)
+	{
+		fprintf(stderr, "Error: Cannot create %s: %s\n", output, strerror(errno));
+		inputs_free(&inputs);
+		return 1;
+	}
+
+	if (batch_parallel_for(inputs.count, jobs, pack_one, &job) != 0)
+	{
+		fprintf(stderr, "Error: Cannot start worker threads\n");
+		eeprom_archive_writer_abort(job.writer);
+		inputs_free(&inputs);
+		return 1;
+	}
+
+	// Архивы-источники должны оставаться отображенными до finish
+	long count = eeprom_archive_writer_finish(job.writer);
+	inputs_free(&inputs);
+
+	if (count < 0)
+	{
+		fprintf(stderr, "Error: Cannot write %s: %s\n", output, strerror(errno));
+		return 1;
+	}
+
+	EEPROMArchive archive;
+	if (eeprom_archive_open(&archive, output) == EEPROM_SUCCESS)
+	{
+		fprintf(stderr, "Packed %ld records into %s (%zu skipped)\n", count, output, job.errors);
+		print_histogram(archive.header);
+		eeprom_archive_close(&archive);
+	}
+
+	return job.errors ? 1 : status;
+}
+
+// ═══════════════════════════════════════════════════════════════
+// unpack: архив -> дампы
+// ═══════════════════════════════════════════════════════════════
+
+typedef struct
+{
+	const EEPROMArchive *archive;
+	const char *directory;
+	size_t errors;
+} UnpackJob;
+
+static void unpack_one(size_t index, int worker, void *arg)
+{
+	UnpackJob *job = (UnpackJob*)arg;
+	const char *name = base_name(eeprom_archive_name(job->archive, index));
+	char path[4096];
+
+	// Имя из архива без каталогов; безымянные записи нумеруются
+	if (name[0] && strcmp(name, ".") != 0 && strcmp(name, "..") != 0)
+	{
+		snprintf(path, sizeof(path), "%s/%s", job->directory, name);
+	}
+	else
+	{
+		snprintf(path, sizeof(path), "%s/record_%zu.bin", job->directory, index);
+	}
+
+	if (eeprom_write_file(path, eeprom_archive_record(job->archive, index),
+						  eeprom_archive_length(job->archive, index)) != EEPROM_SUCCESS)
+	{
+		fprintf(stderr, "Error: Cannot write %s: %s\n", path, strerror(errno));
+		__atomic_fetch_add(&job->errors, 1, __ATOMIC_RELAXED);
+	}
+}
+
+int cmd_unpack(int argc, char *argv[], const CommandOptions *options)
+{
+	int jobs = batch_default_jobs();
+	const char *archive_path = NULL;
+	const char *directory = NULL;
+
+	for (int i = 0; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc)
+		{
+			if (parse_jobs(argv[++i], &jobs) != 0)
+			{
+				return 1;
+			}
+		}
+		else if (!archive_path)
+		{
+			archive_path = argv[i];
+		}
+		else if (!directory)
+		{
+			directory = argv[i];
+		}
+	}
+
+	if (!archive_path || !directory)
+	{
+		fprintf(stderr, "Usage: eeprom_tool [options] unpack [--jobs N] <archive%s> <directory>\n",
+				EEPROM_ARCHIVE_EXTENSION);
+		return 1;
+	}
+
+	EEPROMArchive archive;
+	int ret = eeprom_archive_open(&archive, archive_path);
+	if (ret != EEPROM_SUCCESS)
+	{
+		fprintf(stderr, "Error: Cannot open archive %s: %s\n", archive_path,
+				ret == EEPROM_ERROR_IO ? strerror(errno) : "not an EEPROM archive or corrupted");
+		return 1;
+	}
+
+	if (mkdir(directory, 0755) != 0 && errno != EEXIST)
+	{
+		fprintf(stderr, "Error: Cannot create %s: %s\n", directory, strerror(errno));
+		eeprom_archive_close(&archive);
+		return 1;
+	}
+
+	UnpackJob job = { &archive, directory, 0 };
+	batch_parallel_for(eeprom_archive_count(&archive), jobs, unpack_one, &job);
+
+	fprintf(stderr, "Unpacked %zu records to %s (%zu errors)\n",
+			eeprom_archive_count(&archive) - job.errors, directory, job.errors);
+
+	eeprom_archive_close(&archive);
+	return job.errors ? 1 : 0;
+}
+
+// ═══════════════════════════════════════════════════════════════
+// lookup: поиск по серийному номеру
+// ═══════════════════════════════════════════════════════════════
+
+int cmd_lookup(int argc, char *argv[], const CommandOptions *options)
+{
+	ExportFormat format = EXPORT_FORMAT_TEXT;
+	const char *archive_path = NULL;
+	int first_serial = -1;
+
+	for (int i = 0; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--format") == 0 && i + 1 < argc)
+		{
+			if (export_parse_format(argv[++i], &format) != 0)
+			{
+				fprintf(stderr, "Error: Unknown format '%s' (text, ndjson, csv)\n", argv[i]);
+				return 1;
+			}
+		}
+		else if (!archive_path)
+		{
+			archive_path = argv[i];
+		}
+		else
+		{
+			first_serial = i;
+			break;
+		}
+	}
+
+	if (!archive_path || first_serial < 0)
+	{
+		fprintf(stderr, "Usage: eeprom_tool [options] lookup [--format F] <archive%s> <serial...>\n",
+				EEPROM_ARCHIVE_EXTENSION);
+		return 1;
+	}
+
+	struct timespec start, end;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	EEPROMArchive archive;
+	int ret = eeprom_archive_open(&archive, archive_path);
+	if (ret != EEPROM_SUCCESS)
+	{
+		fprintf(stderr, "Error: Cannot open archive %s: %s\n", archive_path,
+				ret == EEPROM_ERROR_IO ? strerror(errno) : "not an EEPROM archive or corrupted");
+		return 1;
+	}
+
+	ExportBuffer buffer;
+	export_buffer_init(&buffer, 16384);
+	export_header(&buffer, format);
+
+	int status = 0;
+	size_t found = 0;
+
+	for (int i = first_serial; i < argc; i++)
+	{
+		size_t first;
+		size_t n = eeprom_archive_lookup(&archive, argv[i], &first);
+		if (n == 0)
+		{
+			fprintf(stderr, "Serial %s not found\n", argv[i]);
+			status = 1;
+			continue;
+		}
+
+		for (size_t k = 0; k < n; k++)
+		{
+			uint32_t r = archive.index[first + k].record;
+			uint8_t data[EEPROM_SIZE];
+			char source[1024];
+			EEPROMDecodeResult result;
+			EEPROMRecord record;
+
+			memcpy(data, eeprom_archive_record(&archive, r), EEPROM_SIZE);
+			snprintf(source, sizeof(source), "%s:%s", archive_path, eeprom_archive_name(&archive, r));
+
+			ret = command_decode_buffer(data, options, &result, &record);
+			if (ret == EEPROM_SUCCESS)
+			{
+				export_record(&buffer, format, source, &result, &record);
+			}
+			else
+			{
+				export_error(&buffer, format, source, eeprom_strerror(ret));
+			}
+			found++;
+		}
+	}
+
+	export_flush(&buffer, STDOUT_FILENO);
+	export_buffer_free(&buffer);
+
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	double ms = (end.tv_sec - start.tv_sec) * 1e3 + (end.tv_nsec - start.tv_nsec) / 1e6;
+	fprintf(stderr, "%zu records found among %zu (%.3f ms)\n", found, eeprom_archive_count(&archive), ms);
+
+	eeprom_archive_close(&archive);
+	return status;
+}
@@ -0,0 +1,378 @@
+#include "commands.h"
+#include "batch.h"
+#include "inputs.h"
+#include "eeprom_defs.h"
+#include "eeprom_ops.h"
+#include "eeprom_file.h"
+#include "export.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+
+// ═══════════════════════════════════════════════════════════════
+// decode: пакетное декодирование дампов
+// ═══════════════════════════════════════════════════════════════
+
+typedef struct
+{
+	const InputSet *inputs;
+	const CommandOptions *options;
+	ExportFormat format;
+	BatchOutput *output;
+	ExportBuffer *scratch;         // по одному буферу на рабочий поток
+
+	// Счетчики обновляются атомарно из рабочих потоков
+	size_t errors;
+	size_t crc_failures;
+	size_t test_failures;
+} DecodeJob;
+
+// --discover-keys: ключ подбирается по CRC всех регионов, иначе берется из заголовка
+static const EEPROMKeyInfo *command_key(const uint8_t *data, EEPROMVersion version,
+										const CommandOptions *options, EEPROMKeyInfo *key)
+{
+	if (options->discover_keys &&
+		eeprom_discover_key(data, EEPROM_SIZE, version, key) != EEPROM_ERROR_VERSION)
+	{
+		return key;
+	}
+	return NULL;
+}
+
+void command_report_repair(const char *path, const EEPROMDecodeResult *result)
+{
+	if (result->header_repaired)
+	{
+		fprintf(stderr, "Warning: %s: header key byte 0x%02X rewritten to 0x%02X for the discovered key\n",
+				path, result->header_stored, (result->key.algorithm << 4) | result->key.key_index);
+	}
+}
+
+void command_cache_open(CommandOptions *options, size_t count)
+{
+	options->cache = NULL;
+	if (options->cache_path)
+	{
+		options->cache = eeprom_cache_open(options->cache_path, count);
+		if (!options->cache)
+		{
+			fprintf(stderr, "Warning: Cannot open cache %s: %s\n", options->cache_path, strerror(errno));
+		}
+	}
+}
+
+void command_cache_close(CommandOptions *options)
+{
+	if (options->cache)
+	{
+		size_t hits, misses;
+		eeprom_cache_stats(options->cache, &hits, &misses);
+		fprintf(stderr, "Cache %s: %zu hits, %zu decoded\n", options->cache_path, hits, misses);
+		eeprom_cache_close(options->cache);
+		options->cache = NULL;
+	}
+}
+
+int command_decode_result(uint8_t *data, const CommandOptions *options,
+						  EEPROMDecodeResult *result)
+{
+	uint64_t cache_key = 0;
+	if (options->cache)
+	{
+		cache_key = eeprom_cache_key(data, options->discover_keys ? EEPROM_CACHE_DISCOVER_KEYS : 0);
+		if (eeprom_cache_get(options->cache, cache_key, data, result))
+		{
+			return EEPROM_SUCCESS;
+		}
+	}
+
+	EEPROMVersion version = eeprom_detect_version(data);
+
+	EEPROMKeyInfo key;
+	const EEPROMKeyInfo *use_key = command_key(data, version, options, &key);
+
+	int ret = eeprom_decode_ex(data, EEPROM_SIZE, version, use_key, result);
+	if (ret == EEPROM_SUCCESS && options->cache)
+	{
+		eeprom_cache_put(options->cache, cache_key, data, result);
+	}
+	return ret;
+}
+
+void command_decode_results(uint8_t *const data[], size_t count, const CommandOptions *options,
+							EEPROMDecodeResult results[], int status[])
+{
+	uint8_t *pending[COMMAND_DECODE_CHUNK] = { 0 };
+	EEPROMDecodeResult pending_results[COMMAND_DECODE_CHUNK];
+	int pending_status[COMMAND_DECODE_CHUNK];
+	uint64_t keys[COMMAND_DECODE_CHUNK];
+	size_t members[COMMAND_DECODE_CHUNK];
+	size_t n = 0;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		if (options->discover_keys)
+		{
+			status[i] = command_decode_result(data[i], options, &results[i]);
+			continue;
+		}
+		if (options->cache)
+		{
+			keys[n] = eeprom_cache_key(data[i], 0);
+			if (eeprom_cache_get(options->cache, keys[n], data[i], &results[i]))
+			{
+				status[i] = EEPROM_SUCCESS;
+				continue;
+			}
+		}
+		pending[n] = data[i];
+		members[n++] = i;
+	}
+
+	eeprom_decode_many(pending, n, pending_results, pending_status);
+
+	for (size_t m = 0; m < n; m++)
+	{
+		size_t i = members[m];
+		results[i] = pending_results[m];
+		status[i] = pending_status[m];
+		if (status[i] == EEPROM_SUCCESS && options->cache)
+		{
+			eeprom_cache_put(options->cache, keys[m], data[i], &results[i]);
+		}
+	}
+}
+
+int command_decode_buffer(uint8_t *data, const CommandOptions *options,
+						  EEPROMDecodeResult *result, EEPROMRecord *record)
+{
+	int ret = command_decode_result(data, options, result);
+	if (ret != EEPROM_SUCCESS)
+	{
+		return ret;
+	}
+
+	return eeprom_record_parse(record, data, result->version);
+}
+
+int command_view_init(EEPROMView *view, const uint8_t *raw, const CommandOptions *options)
+{
+	EEPROMVersion version = eeprom_detect_version(raw);
+
+	EEPROMKeyInfo key;
+	const EEPROMKeyInfo *use_key = command_key(raw, version, options, &key);
+
+	return eeprom_view_init(view, raw, EEPROM_SIZE, version, use_key);
+}
+
+// Работа - COMMAND_DECODE_CHUNK дампов подряд: платы с общим ключом
+// расшифровываются вместе
+static void decode_chunk(size_t chunk, int worker, void *arg)
+{
+	DecodeJob *job = (DecodeJob*)arg;
+	ExportBuffer *buffer = &job->scratch[worker];
+
+	size_t first = chunk * COMMAND_DECODE_CHUNK;
+	size_t count = job->inputs->count - first;
+	if (count > COMMAND_DECODE_CHUNK)
+	{
+		count = COMMAND_DECODE_CHUNK;
+	}
+
+	uint8_t data[COMMAND_DECODE_CHUNK][EEPROM_SIZE];
+	uint8_t *readable[COMMAND_DECODE_CHUNK] = { 0 };
+	EEPROMDecodeResult results[COMMAND_DECODE_CHUNK];
+	int status[COMMAND_DECODE_CHUNK];
+	int decoded[COMMAND_DECODE_CHUNK];
+	int errnos[COMMAND_DECODE_CHUNK];
+	size_t n = 0;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		status[i] = inputs_read(job->inputs, first + i, data[i], NULL);
+		errnos[i] = errno;
+		if (status[i] == EEPROM_SUCCESS)
+		{
+			readable[n++] = data[i];
+		}
+	}
+
+	command_decode_results(readable, n, job->options, results, decoded);
+
+	for (size_t i = 0, m = 0; i < count; i++)
+	{
+		char path[1024];
+		EEPROMDecodeResult *result = &results[m];
+		EEPROMRecord record;
+		int ret = status[i];
+
+		export_buffer_reset(buffer);
+		inputs_source(job->inputs, first + i, path, sizeof(path));
+
+		if (ret == EEPROM_SUCCESS)
+		{
+			ret = decoded[m++];
+			if (ret == EEPROM_SUCCESS)
+			{
+				ret = eeprom_record_parse(&record, data[i], result->version);
+			}
+		}
+		if (ret != EEPROM_SUCCESS)
+		{
+			__atomic_fetch_add(&job->errors, 1, __ATOMIC_RELAXED);
+			export_error(buffer, job->format, path,
+						 ret == EEPROM_ERROR_IO ? strerror(errnos[i]) : eeprom_strerror(ret));
+		}
+		else
+		{
+			command_report_repair(path, result);
+			if (result->crc_fail_mask)
+			{
+				__atomic_fetch_add(&job->crc_failures, 1, __ATOMIC_RELAXED);
+			}
+			if (result->test_fail_mask)
+			{
+				__atomic_fetch_add(&job->test_failures, 1, __ATOMIC_RELAXED);
+			}
+			export_record(buffer, job->format, path, result, &record);
+		}
+
+		batch_output_commit(job->output, first + i, buffer->data, buffer->length);
+	}
+}
+
+static void decode_usage(void)
+{
+	fprintf(stderr, "Usage: eeprom_tool [options] decode [--jobs N] [--unordered] [--format F] <files|dirs|archives...>\n");
+	fprintf(stderr, "  --jobs N      Worker threads (default: number of CPUs)\n");
+	fprintf(stderr, "  --unordered   Print results as they complete instead of in input order\n");
+	fprintf(stderr, "  --format F    text (default): path <TAB> version <TAB> serial <TAB> crc=ok|fail:regions <TAB> test=ok|fail:regions\n");
+	fprintf(stderr, "                ndjson: one JSON object per file with all fields\n");
+	fprintf(stderr, "                csv:    header + one row per file, columns shared by all versions\n");
+}
+
+int cmd_decode(int argc, char *argv[], const CommandOptions *options)
+{
+	int jobs = batch_default_jobs();
+	int ordered = 1;
+	ExportFormat format = EXPORT_FORMAT_TEXT;
+	InputSet inputs = { 0 };
+	int status = 0;
+
+	for (int i = 0; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc)
+		{
+			jobs = atoi(argv[++i]);
+			if (jobs < 1)
+			{
+				fprintf(stderr, "Error: --jobs must be at least 1\n");
+				inputs_free(&inputs);
+				return 1;
+			}
+		}
+		else if (strcmp(argv[i], "--format") == 0 && i + 1 < argc)
+		{
+			if (export_parse_format(argv[++i], &format) != 0)
+			{
+				fprintf(stderr, "Error: Unknown format '%s' (text, ndjson, csv)\n", argv[i]);
+				inputs_free(&inputs);
+				return 1;
+			}
+		}
+		else if (strcmp(argv[i], "--unordered") == 0)
+		{
+			ordered = 0;
+		}
+		else if (strcmp(argv[i], "--help") == 0)
+		{
+			decode_usage();
+			inputs_free(&inputs);
+			return 0;
+		}
+		else if (inputs_add(&inputs, argv[i]) != 0)
+		{
+			fprintf(stderr, "Error: Cannot read %s: %s\n", argv[i], strerror(errno));
+			status = 1;
+		}
+	}
+
+	if (inputs.count == 0)
+	{
+		if (status == 0)
+		{
+			decode_usage();
+		}
+		inputs_free(&inputs);
+		return 1;
+	}
+
+	CommandOptions local = *options;
+	command_cache_open(&local, inputs.count);
+
+	DecodeJob job = { 0 };
+	job.inputs = &inputs;
+	job.options = &local;
+	job.format = format;
+	job.output = batch_output_create(STDOUT_FILENO, inputs.count, ordered);
+	job.scratch = calloc(jobs, sizeof(ExportBuffer));
+	if (!job.output || !job.scratch)
+	{
+		fprintf(stderr, "Error: Out of memory\n");
+		batch_output_destroy(job.output);
+		free(job.scratch);
+		command_cache_close(&local);
+		inputs_free(&inputs);
+		return 1;
+	}
+
+	for (int i = 0; i < jobs; i++)
+	{
+		export_buffer_init(&job.scratch[i], 16384);
+	}
+
+	ExportBuffer header;
+	export_buffer_init(&header, 16384);
+	export_header(&header, format);
+	export_flush(&header, STDOUT_FILENO);
+	export_buffer_free(&header);
+
+	struct timespec start, end;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	size_t chunks = (inputs.count + COMMAND_DECODE_CHUNK - 1) / COMMAND_DECODE_CHUNK;
+	if (batch_parallel_for(chunks, jobs, decode_chunk, &job) != 0)
+	{
+		fprintf(stderr, "Error: Cannot start worker threads\n");
+		status = 1;
+	}
+
+	if (batch_output_destroy(job.output) != 0)
+	{
+		fprintf(stderr, "Error: Cannot write output: %s\n", strerror(errno));
+		status = 1;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	for (int i = 0; i < jobs; i++)
+	{
+		export_buffer_free(&job.scratch[i]);
+	}
+	free(job.scratch);
+
+	double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+	fprintf(stderr, "Decoded %zu files: %zu errors, %zu CRC failures, %zu test failures (%.3f s, %d jobs)\n",
+			inputs.count, job.errors, job.crc_failures, job.test_failures, seconds, jobs);
+	command_cache_close(&local);
+
+	if (job.errors)
+	{
+		status = 1;
+	}
+
+	inputs_free(&inputs);
+	return status;
+}
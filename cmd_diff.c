@@ -0,0 +1,550 @@
+#include "commands.h"
+#include "batch.h"
+#include "inputs.h"
+#include "eeprom_defs.h"
+#include "eeprom_ops.h"
+#include "eeprom_archive.h"
+#include "eeprom_cache.h"
+#include "export.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+
+// ═══════════════════════════════════════════════════════════════
+// diff: поля двух дампов или двух снимков парка по серийным номерам
+//
+// 1. Ключи сторон: серийный номер и XXH64 исходного образа. Номер из
+//    индекса архива или ленивой расшифровкой региона 1, параллельно.
+// 2. Сортировка по номеру (архив уже отсортирован) и один проход
+//    слиянием: совпавшие хеши - плата не менялась, без расшифровки.
+// 3. Полное декодирование и сравнение только измененных пар, параллельно.
+// ═══════════════════════════════════════════════════════════════
+
+typedef struct
+{
+	char serial[EEPROM_ARCHIVE_SERIAL];
+	uint64_t hash;                 // XXH64 исходного (зашифрованного) образа
+	uint32_t item;
+	int32_t status;                // EEPROM_SUCCESS или ошибка чтения/расшифровки
+} DiffKey;
+
+typedef enum
+{
+	DIFF_CHANGED,
+	DIFF_ADDED,
+	DIFF_REMOVED,
+	DIFF_ERROR_OLD,
+	DIFF_ERROR_NEW
+} DiffKind;
+
+typedef struct
+{
+	uint32_t old_key;
+	uint32_t new_key;
+	uint32_t kind;                 // DiffKind
+} DiffEvent;
+
+typedef struct
+{
+	const CommandOptions *options;
+	ExportFormat format;
+	InputSet sides[2];             // 0 - old, 1 - new
+	DiffKey *keys[2];
+	int key_side;                  // сторона, для которой считаются ключи
+	DiffEvent *events;
+	size_t event_count;
+	BatchOutput *output;
+	ExportBuffer *scratch;         // по одному буферу на рабочий поток
+
+	// Счетчики обновляются атомарно из рабочих потоков
+	size_t changed;
+	size_t unchanged;
+	size_t errors;
+} DiffJob;
+
+// ═══════════════════════════════════════════════════════════════
+// Ключи
+// ═══════════════════════════════════════════════════════════════
+
+static void key_one(size_t index, int worker, void *arg)
+{
+	DiffJob *job = (DiffJob*)arg;
+	const InputSet *inputs = &job->sides[job->key_side];
+	DiffKey *key = &job->keys[job->key_side][index];
+	(void)worker;
+
+	uint8_t raw[EEPROM_SIZE];
+	key->item = (uint32_t)index;
+	key->status = inputs_read(inputs, index, raw, NULL);
+	if (key->status != EEPROM_SUCCESS)
+	{
+		return;
+	}
+	key->hash = eeprom_hash64(raw, EEPROM_SIZE, 0);
+
+	// Номер уже взят из индекса архива
+	if (key->serial[0])
+	{
+		return;
+	}
+
+	EEPROMView view;
+	char serial[EEPROM_ARCHIVE_SERIAL + 1];
+	key->status = command_view_init(&view, raw, job->options);
+	if (key->status == EEPROM_SUCCESS)
+	{
+		key->status = eeprom_view_serial(&view, serial, sizeof(serial));
+	}
+	if (key->status == EEPROM_SUCCESS)
+	{
+		memcpy(key->serial, serial, strnlen(serial, sizeof(key->serial)));
+	}
+}
+
+static int key_compare(const void *a, const void *b)
+{
+	const DiffKey *x = (const DiffKey*)a;
+	const DiffKey *y = (const DiffKey*)b;
+
+	int c = memcmp(x->serial, y->serial, sizeof(x->serial));
+	if (c)
+	{
+		return c;
+	}
+	return x->item < y->item ? -1 : x->item > y->item;
+}
+
+// Серийные номера записей архивов - из их индексов, без расшифровки
+static void keys_from_archives(const InputSet *inputs, DiffKey *keys)
+{
+	for (size_t a = 0; a < inputs->archive_count; a++)
+	{
+		// Записи архива идут в items подряд
+		size_t base = 0;
+		while (base < inputs->count && inputs->items[base].archive != a)
+		{
+			base++;
+		}
+
+		const EEPROMArchive *archive = &inputs->archives[a];
+		for (size_t i = 0; i < eeprom_archive_count(archive); i++)
+		{
+			const EEPROMArchiveIndexEntry *entry = &archive->index[i];
+			memcpy(keys[base + entry->record].serial, entry->serial, EEPROM_ARCHIVE_SERIAL);
+		}
+	}
+}
+
+static int build_keys(DiffJob *job, int side, int jobs)
+{
+	const InputSet *inputs = &job->sides[side];
+	DiffKey *keys = calloc(inputs->count ? inputs->count : 1, sizeof(DiffKey));
+	if (!keys)
+	{
+		return -1;
+	}
+	job->keys[side] = keys;
+
+	keys_from_archives(inputs, keys);
+	job->key_side = side;
+	if (batch_parallel_for(inputs->count, jobs, key_one, job) != 0)
+	{
+		return -1;
+	}
+
+	// Один архив уже отсортирован по номеру
+	int sorted = 1;
+	for (size_t i = 1; i < inputs->count && sorted; i++)
+	{
+		sorted = key_compare(&keys[i - 1], &keys[i]) <= 0;
+	}
+	if (!sorted)
+	{
+		qsort(keys, inputs->count, sizeof(DiffKey), key_compare);
+	}
+	return 0;
+}
+
+// ═══════════════════════════════════════════════════════════════
+// Слияние
+// ═══════════════════════════════════════════════════════════════
+
+static int add_event(DiffJob *job, size_t *capacity, uint32_t old_key, uint32_t new_key, DiffKind kind)
+{
+	if (job->event_count == *capacity)
+	{
+		size_t grown = *capacity ? *capacity * 2 : 1024;
+		DiffEvent *events = realloc(job->events, grown * sizeof(DiffEvent));
+		if (!events)
+		{
+			return -1;
+		}
+		job->events = events;
+		*capacity = grown;
+	}
+
+	DiffEvent *event = &job->events[job->event_count++];
+	event->old_key = old_key;
+	event->new_key = new_key;
+	event->kind = kind;
+	return 0;
+}
+
+static int serial_usable(const DiffKey *key)
+{
+	return key->status == EEPROM_SUCCESS && key->serial[0];
+}
+
+/*! \brief one pass over both sorted key lists
+
+	Дампы без номера - ошибки в начале вывода. Несколько дампов одной
+	платы с каждой стороны сопоставляются по порядку входа.
+ */
+static int merge_keys(DiffJob *job)
+{
+	size_t capacity = 0;
+	size_t counts[2] = { job->sides[0].count, job->sides[1].count };
+	size_t pos[2] = { 0, 0 };
+
+	for (int side = 0; side < 2; side++)
+	{
+		for (size_t i = 0; i < counts[side]; i++)
+		{
+			if (!serial_usable(&job->keys[side][i]) &&
+				add_event(job, &capacity, side ? UINT32_MAX : (uint32_t)i, side ? (uint32_t)i : UINT32_MAX,
+						  side ? DIFF_ERROR_NEW : DIFF_ERROR_OLD) != 0)
+			{
+				return -1;
+			}
+		}
+		// Пустой номер сортируется первым
+		while (pos[side] < counts[side] && !serial_usable(&job->keys[side][pos[side]]))
+		{
+			pos[side]++;
+		}
+	}
+
+	while (pos[0] < counts[0] || pos[1] < counts[1])
+	{
+		const DiffKey *old_key = pos[0] < counts[0] ? &job->keys[0][pos[0]] : NULL;
+		const DiffKey *new_key = pos[1] < counts[1] ? &job->keys[1][pos[1]] : NULL;
+		int c = !old_key ? 1 : !new_key ? -1 : memcmp(old_key->serial, new_key->serial, EEPROM_ARCHIVE_SERIAL);
+		int ret = 0;
+
+		if (c < 0)
+		{
+			ret = add_event(job, &capacity, (uint32_t)pos[0]++, UINT32_MAX, DIFF_REMOVED);
+		}
+		else if (c > 0)
+		{
+			ret = add_event(job, &capacity, UINT32_MAX, (uint32_t)pos[1]++, DIFF_ADDED);
+		}
+		else if (old_key->hash == new_key->hash)
+		{
+			job->unchanged++;
+			pos[0]++;
+			pos[1]++;
+		}
+		else
+		{
+			ret = add_event(job, &capacity, (uint32_t)pos[0]++, (uint32_t)pos[1]++, DIFF_CHANGED);
+		}
+
+		if (ret != 0)
+		{
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+// ═══════════════════════════════════════════════════════════════
+// Сравнение измененных пар
+// ═══════════════════════════════════════════════════════════════
+
+static int diff_decode(DiffJob *job, int side, uint32_t key, uint8_t *data,
+					   EEPROMDecodeResult *result, EEPROMRecord *record, char *source, size_t size)
+{
+	uint32_t item = job->keys[side][key].item;
+	inputs_source(&job->sides[side], item, source, size);
+
+	int ret = inputs_read(&job->sides[side], item, data, NULL);
+	if (ret == EEPROM_SUCCESS)
+	{
+		ret = command_decode_buffer(data, job->options, result, record);
+	}
+	return ret;
+}
+
+static void diff_one(size_t index, int worker, void *arg)
+{
+	DiffJob *job = (DiffJob*)arg;
+	const DiffEvent *event = &job->events[index];
+	ExportBuffer *buffer = &job->scratch[worker];
+	char source[2][1024];
+
+	export_buffer_reset(buffer);
+
+	switch (event->kind)
+	{
+		case DIFF_ERROR_OLD:
+		case DIFF_ERROR_NEW:
+		{
+			int side = event->kind == DIFF_ERROR_NEW;
+			const DiffKey *key = &job->keys[side][side ? event->new_key : event->old_key];
+			inputs_source(&job->sides[side], key->item, source[0], sizeof(source[0]));
+			__atomic_fetch_add(&job->errors, 1, __ATOMIC_RELAXED);
+			export_error(buffer, job->format, source[0],
+						 key->status == EEPROM_SUCCESS ? "no serial number" : eeprom_strerror(key->status));
+			break;
+		}
+
+		case DIFF_ADDED:
+		case DIFF_REMOVED:
+		{
+			int side = event->kind == DIFF_ADDED;
+			const DiffKey *key = &job->keys[side][side ? event->new_key : event->old_key];
+			char serial[EEPROM_ARCHIVE_SERIAL + 1];
+			memcpy(serial, key->serial, EEPROM_ARCHIVE_SERIAL);
+			serial[EEPROM_ARCHIVE_SERIAL] = '\0';
+			inputs_source(&job->sides[side], key->item, source[0], sizeof(source[0]));
+			export_diff_missing(buffer, job->format, serial, side, source[0]);
+			break;
+		}
+
+		default:
+		{
+			uint8_t data[2][EEPROM_SIZE];
+			EEPROMDecodeResult result[2];
+			EEPROMRecord record[2];
+			uint32_t keys[2] = { event->old_key, event->new_key };
+			int ret = EEPROM_SUCCESS;
+			int side;
+
+			for (side = 0; side < 2 && ret == EEPROM_SUCCESS; side++)
+			{
+				ret = diff_decode(job, side, keys[side], data[side], &result[side], &record[side],
+								  source[side], sizeof(source[side]));
+			}
+			if (ret != EEPROM_SUCCESS)
+			{
+				__atomic_fetch_add(&job->errors, 1, __ATOMIC_RELAXED);
+				export_error(buffer, job->format, source[side - 1],
+							 ret == EEPROM_ERROR_IO ? strerror(errno) : eeprom_strerror(ret));
+				break;
+			}
+
+			// Для пары файлов номера могут не совпадать: берется новый
+			char serial[EEPROM_ARCHIVE_SERIAL + 1];
+			eeprom_record_serial(&record[1], serial, sizeof(serial));
+			if (!serial[0])
+			{
+				eeprom_record_serial(&record[0], serial, sizeof(serial));
+			}
+
+			ExportDiffSide sides[2];
+			for (side = 0; side < 2; side++)
+			{
+				sides[side].source = source[side];
+				sides[side].result = &result[side];
+				sides[side].record = &record[side];
+			}
+
+			// Образы различаются, а поля нет (резервные байты): плата не менялась
+			if (export_diff(buffer, job->format, serial, &sides[0], &sides[1]))
+			{
+				__atomic_fetch_add(&job->changed, 1, __ATOMIC_RELAXED);
+			}
+			else
+			{
+				__atomic_fetch_add(&job->unchanged, 1, __ATOMIC_RELAXED);
+			}
+			break;
+		}
+	}
+
+	batch_output_commit(job->output, index, buffer->data, buffer->length);
+}
+
+// ═══════════════════════════════════════════════════════════════
+// Команда
+// ═══════════════════════════════════════════════════════════════
+
+static void diff_usage(void)
+{
+	fprintf(stderr, "Usage: eeprom_tool [options] diff [--jobs N] [--format F] <old> <new>\n");
+	fprintf(stderr, "  old/new       Two dumps, or two snapshots (directories or archives) joined by serial\n");
+	fprintf(stderr, "  --jobs N      Worker threads (default: number of CPUs)\n");
+	fprintf(stderr, "  --format F    text (default): serial <TAB> field <TAB> old <TAB> new, one line per change;\n");
+	fprintf(stderr, "                  sweep: serial <TAB> asic_frequencies[i] <TAB> old <TAB> new <TAB> delta MHz;\n");
+	fprintf(stderr, "                  boards on one side only: serial <TAB> -|+ <TAB> source\n");
+	fprintf(stderr, "                ndjson: one JSON object per changed, added or removed board\n");
+	fprintf(stderr, "Exit status: 0 - no differences, 1 - differences, 2 - errors\n");
+}
+
+static void diff_free(DiffJob *job)
+{
+	for (int side = 0; side < 2; side++)
+	{
+		free(job->keys[side]);
+		inputs_free(&job->sides[side]);
+	}
+	free(job->events);
+}
+
+int cmd_diff(int argc, char *argv[], const CommandOptions *options)
+{
+	int jobs = batch_default_jobs();
+	DiffJob job = { 0 };
+	const char *paths[2] = { NULL, NULL };
+	int path_count = 0;
+
+	job.format = EXPORT_FORMAT_TEXT;
+
+	for (int i = 0; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc)
+		{
+			jobs = atoi(argv[++i]);
+			if (jobs < 1)
+			{
+				fprintf(stderr, "Error: --jobs must be at least 1\n");
+				return 2;
+			}
+		}
+		else if (strcmp(argv[i], "--format") == 0 && i + 1 < argc)
+		{
+			if (export_parse_format(argv[++i], &job.format) != 0 || job.format == EXPORT_FORMAT_CSV)
+			{
+				fprintf(stderr, "Error: Unknown format '%s' (text, ndjson)\n", argv[i]);
+				return 2;
+			}
+		}
+		else if (strcmp(argv[i], "--help") == 0)
+		{
+			diff_usage();
+			return 0;
+		}
+		else if (path_count < 2)
+		{
+			paths[path_count++] = argv[i];
+		}
+		else
+		{
+			diff_usage();
+			return 2;
+		}
+	}
+
+	if (path_count != 2)
+	{
+		diff_usage();
+		return 2;
+	}
+
+	for (int side = 0; side < 2; side++)
+	{
+		if (inputs_add(&job.sides[side], paths[side]) != 0)
+		{
+			fprintf(stderr, "Error: Cannot read %s: %s\n", paths[side], strerror(errno));
+			diff_free(&job);
+			return 2;
+		}
+	}
+
+	CommandOptions local = *options;
+	command_cache_open(&local, job.sides[0].count + job.sides[1].count);
+	job.options = &local;
+
+	struct timespec start, end;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	int status = 0;
+	if (job.sides[0].count == 1 && job.sides[1].count == 1)
+	{
+		// Два дампа сравниваются всегда, даже с разными номерами
+		size_t capacity = 0;
+		job.keys[0] = calloc(1, sizeof(DiffKey));
+		job.keys[1] = calloc(1, sizeof(DiffKey));
+		if (!job.keys[0] || !job.keys[1] || add_event(&job, &capacity, 0, 0, DIFF_CHANGED) != 0)
+		{
+			status = -1;
+		}
+	}
+	else if (build_keys(&job, 0, jobs) != 0 || build_keys(&job, 1, jobs) != 0 || merge_keys(&job) != 0)
+	{
+		status = -1;
+	}
+
+	if (status == 0)
+	{
+		job.output = batch_output_create(STDOUT_FILENO, job.event_count, 1);
+		job.scratch = calloc(jobs, sizeof(ExportBuffer));
+		if (!job.output || !job.scratch)
+		{
+			batch_output_destroy(job.output);
+			free(job.scratch);
+			job.scratch = NULL;
+			status = -1;
+		}
+	}
+	if (status != 0)
+	{
+		fprintf(stderr, "Error: Out of memory\n");
+		command_cache_close(&local);
+		diff_free(&job);
+		return 2;
+	}
+
+	for (int i = 0; i < jobs; i++)
+	{
+		export_buffer_init(&job.scratch[i], 16384);
+	}
+
+	if (batch_parallel_for(job.event_count, jobs, diff_one, &job) != 0)
+	{
+		fprintf(stderr, "Error: Cannot start worker threads\n");
+		status = 2;
+	}
+	if (batch_output_destroy(job.output) != 0)
+	{
+		fprintf(stderr, "Error: Cannot write output: %s\n", strerror(errno));
+		status = 2;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	for (int i = 0; i < jobs; i++)
+	{
+		export_buffer_free(&job.scratch[i]);
+	}
+	free(job.scratch);
+
+	size_t added = 0, removed = 0;
+	for (size_t i = 0; i < job.event_count; i++)
+	{
+		added += job.events[i].kind == DIFF_ADDED;
+		removed += job.events[i].kind == DIFF_REMOVED;
+	}
+
+	double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+	fprintf(stderr, "Compared %zu old and %zu new dumps: %zu changed, %zu unchanged, %zu added, %zu removed, %zu errors (%.3f s, %d jobs)\n",
+			job.sides[0].count, job.sides[1].count, job.changed, job.unchanged,
+			added, removed, job.errors, seconds, jobs);
+	command_cache_close(&local);
+
+	if (status == 0 && job.errors)
+	{
+		status = 2;
+	}
+	else if (status == 0 && (job.changed || added || removed))
+	{
+		status = 1;
+	}
+
+	diff_free(&job);
+	return status;
+}
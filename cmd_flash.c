@@ -0,0 +1,162 @@
+#include "commands.h"
+#include "eeprom_defs.h"
+#include "eeprom_ops.h"
+#include "eeprom_file.h"
+#include "i2c_eeprom.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+// ═══════════════════════════════════════════════════════════════
+// flash: запись дампа обратно в EEPROM платы
+// ═══════════════════════════════════════════════════════════════
+
+#define FLASH_ADDR_DEFAULT 0x50
+
+static int report_failure(int ret, const char *bus, int addr, const char *dump)
+{
+	if (ret == -2)
+	{
+		fprintf(stderr, "Error: %s@0x%02X: read-back differs from %s (write protected?)\n", bus, addr, dump);
+		return 1;
+	}
+	if (ret < 0)
+	{
+		fprintf(stderr, "Error: %s@0x%02X: write failed: %s\n", bus, addr, strerror(errno));
+		return 1;
+	}
+	return 0;
+}
+
+int cmd_flash(int argc, char *argv[], const CommandOptions *options)
+{
+	const char *dump = NULL;
+	const char *bus = NULL;
+	int addr = FLASH_ADDR_DEFAULT;
+	int force = 0;
+	int full = 0;
+
+	for (int i = 0; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--addr") == 0 && i + 1 < argc)
+		{
+			char *end;
+			addr = (int)strtol(argv[++i], &end, 0);
+			if (*end != '\0' || addr < 0x03 || addr > 0x77)
+			{
+				fprintf(stderr, "Error: Invalid I2C address '%s'\n", argv[i]);
+				return 1;
+			}
+		}
+		else if (strcmp(argv[i], "--force") == 0)
+		{
+			force = 1;
+		}
+		else if (strcmp(argv[i], "--full") == 0)
+		{
+			full = 1;
+		}
+		else if (argv[i][0] != '-' && !dump)
+		{
+			dump = argv[i];
+		}
+		else if (argv[i][0] != '-' && !bus)
+		{
+			bus = argv[i];
+		}
+		else
+		{
+			bus = NULL;
+			break;
+		}
+	}
+
+	if (!dump || !bus)
+	{
+		fprintf(stderr, "Usage: eeprom_tool [options] flash [--addr 0x5N] [--full] [--force] <dump.bin> </dev/i2c-N>\n");
+		return 1;
+	}
+
+	uint8_t data[EEPROM_SIZE];
+	size_t size = 0;
+	int ret = eeprom_read_file(dump, data, &size);
+	if (ret != EEPROM_SUCCESS)
+	{
+		fprintf(stderr, "Error: Cannot read %s: %s\n", dump,
+				ret == EEPROM_ERROR_IO ? strerror(errno) : eeprom_strerror(ret));
+		return 1;
+	}
+	if (size != EEPROM_SIZE)
+	{
+		fprintf(stderr, "Error: %s is %zu bytes, expected %d\n", dump, size, EEPROM_SIZE);
+		return 1;
+	}
+
+	// Дамп, который не декодируется, скорее всего испорчен - не пишем без --force
+	if (!force)
+	{
+		uint8_t copy[EEPROM_SIZE];
+		EEPROMDecodeResult result;
+		EEPROMRecord record;
+		memcpy(copy, data, EEPROM_SIZE);
+		ret = command_decode_buffer(copy, options, &result, &record);
+		if (ret != EEPROM_SUCCESS || result.crc_fail_mask)
+		{
+			fprintf(stderr, "Error: %s does not decode cleanly (%s), use --force to write it anyway\n", dump,
+					ret != EEPROM_SUCCESS ? eeprom_strerror(ret) : "CRC mismatch");
+			return 1;
+		}
+	}
+
+	int fd = iic_open(bus, NULL);
+	if (fd < 0)
+	{
+		return 1;
+	}
+
+	if (full)
+	{
+		struct timespec start, end;
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		int written = iic_eeprom_store(fd, (uint8_t)addr, 0, data, EEPROM_SIZE);
+		clock_gettime(CLOCK_MONOTONIC, &end);
+		iic_close(fd);
+
+		double ms = (end.tv_sec - start.tv_sec) * 1e3 + (end.tv_nsec - start.tv_nsec) / 1e6;
+		if (report_failure(written, bus, addr, dump))
+		{
+			return 1;
+		}
+		fprintf(stderr, "Wrote and verified %d bytes to %s@0x%02X (%.1f ms)\n", written, bus, addr, ms);
+		return 0;
+	}
+
+	// По умолчанию - только изменившиеся страницы
+	IICWriteStats stats;
+	int pages = iic_eeprom_update(fd, (uint8_t)addr, data, &stats);
+	iic_close(fd);
+
+	if (report_failure(pages, bus, addr, dump))
+	{
+		return 1;
+	}
+
+	unsigned int total = stats.pages_written + stats.pages_skipped;
+	double ms = (stats.read_us + stats.write_us + stats.verify_us) / 1e3;
+	if (stats.pages_written == 0)
+	{
+		fprintf(stderr, "%s@0x%02X already matches %s, nothing written (%.1f ms)\n", bus, addr, dump, ms);
+		return 0;
+	}
+
+	// Оценка полной перезаписи по измеренному времени на страницу
+	double page_ms = stats.write_us / 1e3 / stats.pages_written;
+	fprintf(stderr, "Programmed %u of %u pages of %s@0x%02X, %u unchanged (%.1f ms: read %.1f, write %.1f, verify %.1f)\n",
+			stats.pages_written, total, bus, addr, stats.pages_skipped, ms,
+			stats.read_us / 1e3, stats.write_us / 1e3, stats.verify_us / 1e3);
+	fprintf(stderr, "Full rewrite would take about %.1f ms of write cycles, saved %.1f ms\n",
+			page_ms * total, page_ms * stats.pages_skipped);
+	return 0;
+}
@@ -0,0 +1,583 @@
+#include "commands.h"
+#include "batch.h"
+#include "inputs.h"
+#include "eeprom_defs.h"
+#include "eeprom_ops.h"
+#include "eeprom_file.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fnmatch.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+// ═══════════════════════════════════════════════════════════════
+// patch: пакетная правка полей
+//
+// Присваивания field=value проверяются по FieldMetadata (read_only,
+// min/max) один раз для каждой версии до начала работы. Фильтр по
+// имени платы и серийному номеру читает только регион 1 через
+// EEPROMView; подходящие дампы расшифровываются целиком, правятся,
+// получают новые CRC, шифруются тем же ключом и записываются через
+// временный файл и rename. Строка на подходящий файл:
+//   path <TAB> serial <TAB> patched|unchanged
+// ═══════════════════════════════════════════════════════════════
+
+#define PATCH_LINE 1200
+
+static const EEPROMVersion patch_versions[] = {
+	EEPROM_VERSION_V1, EEPROM_VERSION_V4, EEPROM_VERSION_V5, EEPROM_VERSION_V6, EEPROM_VERSION_V17,
+};
+#define PATCH_VERSION_COUNT (sizeof(patch_versions) / sizeof(patch_versions[0]))
+
+// Присваивания, разобранные для одной версии
+typedef struct
+{
+	EEPROMFieldValue *values;
+	size_t count;
+	const char *missing;           // поле, которого в версии нет; правка невозможна
+} PatchPlan;
+
+typedef struct
+{
+	const InputSet *inputs;
+	const CommandOptions *options;
+	BatchOutput *output;
+	PatchPlan plans[PATCH_VERSION_COUNT];
+
+	char **boards;                 // --board: шаблоны fnmatch, любой из
+	size_t board_count;
+	char **serials;                // --serial
+	size_t serial_count;
+	const char *output_dir;        // --output; NULL = --in-place
+	int dry_run;
+	int force;                     // править и дампы с ошибкой CRC
+
+	// Счетчики обновляются атомарно из рабочих потоков
+	size_t matched;
+	size_t patched;
+	size_t unchanged;
+	size_t errors;
+} PatchJob;
+
+static const char *base_name(const char *path)
+{
+	const char *slash = strrchr(path, '/');
+	return slash ? slash + 1 : path;
+}
+
+static const PatchPlan *patch_plan(const PatchJob *job, EEPROMVersion version)
+{
+	for (size_t v = 0; v < PATCH_VERSION_COUNT; v++)
+	{
+		if (patch_versions[v] == version)
+		{
+			return &job->plans[v];
+		}
+	}
+	return NULL;
+}
+
+static int patch_match(char **patterns, size_t count, const char *text)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		if (fnmatch(patterns[i], text, 0) == 0)
+		{
+			return 1;
+		}
+	}
+	return 0;
+}
+
+// Имя выходного файла: имя дампа или записи архива без каталогов
+static void patch_output_path(const PatchJob *job, size_t index, char *path, size_t size)
+{
+	const InputItem *item = &job->inputs->items[index];
+	const char *name;
+
+	if (item->archive == INPUT_FILE)
+	{
+		name = job->inputs->paths.paths[item->index];
+		if (!job->output_dir)
+		{
+			snprintf(path, size, "%s", name);
+			return;
+		}
+	}
+	else
+	{
+		name = eeprom_archive_name(&job->inputs->archives[item->archive], item->index);
+	}
+
+	name = base_name(name);
+	if (name[0] && strcmp(name, ".") != 0 && strcmp(name, "..") != 0)
+	{
+		snprintf(path, size, "%s/%s", job->output_dir, name);
+	}
+	else
+	{
+		snprintf(path, size, "%s/record_%zu.bin", job->output_dir, index);
+	}
+}
+
+static int key_equal(const EEPROMKeyInfo *a, const EEPROMKeyInfo *b)
+{
+	return a->algorithm == b->algorithm && a->key_index == b->key_index &&
+		   a->key_table == b->key_table && a->v1_key == b->v1_key;
+}
+
+static int patch_field_text(EEPROMView *view, FieldId id, char *buffer, size_t size)
+{
+	const FieldMetadata *field = eeprom_field_by_id(view->result.version, id);
+	const uint8_t *bytes = field ? eeprom_view_field(view, field) : NULL;
+	if (!bytes)
+	{
+		return -1;
+	}
+
+	size_t length = strnlen((const char*)bytes, field->size);
+	if (length >= size)
+	{
+		length = size - 1;
+	}
+	memcpy(buffer, bytes, length);
+	buffer[length] = '\0';
+	return 0;
+}
+
+// Возвращает строку результата; NULL - дамп не прошел фильтр
+static const char *patch_apply(PatchJob *job, size_t index, EEPROMView *view,
+							   char *serial, size_t serial_size, char *error, size_t error_size)
+{
+	uint8_t raw[EEPROM_SIZE];
+	size_t length = 0;
+
+	int ret = inputs_read(job->inputs, index, raw, &length);
+	if (ret == EEPROM_SUCCESS)
+	{
+		ret = command_view_init(view, raw, job->options);
+	}
+	if (ret == EEPROM_SUCCESS)
+	{
+		ret = eeprom_view_serial(view, serial, serial_size);
+	}
+	if (ret != EEPROM_SUCCESS)
+	{
+		snprintf(error, error_size, "%s", ret == EEPROM_ERROR_IO ? strerror(errno) : eeprom_strerror(ret));
+		return "error";
+	}
+
+	// Фильтры: расшифрован только регион с серийным номером и именем платы
+	if (job->serial_count && !patch_match(job->serials, job->serial_count, serial))
+	{
+		return NULL;
+	}
+	if (job->board_count)
+	{
+		char board[64];
+		if (patch_field_text(view, FIELD_ID_BOARD_NAME, board, sizeof(board)) != 0 ||
+			!patch_match(job->boards, job->board_count, board))
+		{
+			return NULL;
+		}
+	}
+	__atomic_fetch_add(&job->matched, 1, __ATOMIC_RELAXED);
+
+	EEPROMVersion version = view->result.version;
+	const PatchPlan *plan = patch_plan(job, version);
+	if (!plan || plan->missing)
+	{
+		snprintf(error, error_size, "v%d has no field for %s", version, plan ? plan->missing : "?");
+		return "error";
+	}
+
+	// eeprom_encode() шифрует ключом по умолчанию; подобранный --discover-keys
+	// ключ при перешифровании был бы потерян
+	EEPROMKeyInfo default_key;
+	if (eeprom_default_key(raw, version, &default_key) != EEPROM_SUCCESS ||
+		!key_equal(&default_key, &view->result.key))
+	{
+		snprintf(error, error_size, "not encrypted with the default key, cannot re-encode");
+		return "error";
+	}
+
+	eeprom_view_decode_all(view);
+	if (view->result.crc_fail_mask && !job->force)
+	{
+		snprintf(error, error_size, "CRC mismatch (mask %X), use --force to patch anyway",
+				 view->result.crc_fail_mask);
+		return "error";
+	}
+
+	EEPROMRecord record;
+	eeprom_record_parse(&record, view->data, version);
+
+	int changed = 0;
+	for (size_t i = 0; i < plan->count; i++)
+	{
+		changed |= eeprom_field_store(&record, &plan->values[i]);
+	}
+	changed |= view->result.crc_fail_mask != 0;
+
+	uint8_t data[EEPROM_SIZE];
+	if (changed)
+	{
+		memcpy(data, view->data, EEPROM_SIZE);
+		eeprom_record_serialize(&record, data);
+		ret = eeprom_encode(data, EEPROM_SIZE, version);
+		if (ret != EEPROM_SUCCESS)
+		{
+			snprintf(error, error_size, "cannot encode: %s", eeprom_strerror(ret));
+			return "error";
+		}
+	}
+	else
+	{
+		memcpy(data, raw, EEPROM_SIZE);
+	}
+
+	// Без изменений на месте ничего не переписывается; в --output попадают
+	// все подходящие платы
+	if (!job->dry_run && (changed || job->output_dir))
+	{
+		size_t used = eeprom_get_used_size(version);
+		char path[4096];
+		patch_output_path(job, index, path, sizeof(path));
+		if (eeprom_write_file_atomic(path, data, length > used ? length : used) != EEPROM_SUCCESS)
+		{
+			snprintf(error, error_size, "cannot write: %s", strerror(errno));
+			return "error";
+		}
+	}
+
+	__atomic_fetch_add(changed ? &job->patched : &job->unchanged, 1, __ATOMIC_RELAXED);
+	return changed ? "patched" : "unchanged";
+}
+
+static void patch_one(size_t index, int worker, void *arg)
+{
+	PatchJob *job = (PatchJob*)arg;
+	(void)worker;
+
+	EEPROMView view;
+	char serial[64] = "";
+	char error[512] = "";
+	char line[PATCH_LINE];
+	int length = 0;
+
+	const char *status = patch_apply(job, index, &view, serial, sizeof(serial), error, sizeof(error));
+	if (status)
+	{
+		char path[1024];
+		inputs_source(job->inputs, index, path, sizeof(path));
+		if (error[0])
+		{
+			__atomic_fetch_add(&job->errors, 1, __ATOMIC_RELAXED);
+			length = snprintf(line, sizeof(line), "%s\terror\t%s\n", path, error);
+		}
+		else
+		{
+			length = snprintf(line, sizeof(line), "%s\t%s\t%s\n", path, serial, status);
+		}
+	}
+
+	if (length >= (int)sizeof(line))
+	{
+		length = sizeof(line) - 1;
+		line[length - 1] = '\n';
+	}
+	batch_output_commit(job->output, index, line, length > 0 ? (size_t)length : 0);
+}
+
+// Присваивание разбирается для каждой версии, где есть такое поле;
+// поле, неизвестное всем версиям, или недопустимое значение - ошибка
+static int patch_add_assignment(PatchJob *job, const char *assignment)
+{
+	const char *equals = strchr(assignment, '=');
+	char name[128];
+	snprintf(name, sizeof(name), "%.*s", (int)(equals - assignment), assignment);
+	const char *text = equals + 1;
+	int known = 0;
+
+	for (size_t v = 0; v < PATCH_VERSION_COUNT; v++)
+	{
+		PatchPlan *plan = &job->plans[v];
+		const FieldMetadata *field = eeprom_field_find(patch_versions[v], name);
+		if (!field)
+		{
+			if (!plan->missing)
+			{
+				plan->missing = assignment;
+			}
+			continue;
+		}
+		known = 1;
+
+		int ret = eeprom_field_parse(field, text, &plan->values[plan->count]);
+		if (ret == EEPROM_ERROR_RANGE && field->type != FIELD_TYPE_STRING)
+		{
+			fprintf(stderr, "Error: %s: '%s' is not a value of %s in v%d (%d..%d)\n",
+					assignment, text, field->name, patch_versions[v],
+					field->min_value, field->max_value);
+			return -1;
+		}
+		if (ret == EEPROM_ERROR_RANGE)
+		{
+			fprintf(stderr, "Error: %s: %s in v%d holds at most %zu characters\n",
+					assignment, field->name, patch_versions[v], field->size - 1);
+			return -1;
+		}
+		if (ret != EEPROM_SUCCESS)
+		{
+			fprintf(stderr, "Error: %s: %s in v%d cannot be edited\n",
+					assignment, field->name, patch_versions[v]);
+			return -1;
+		}
+		plan->count++;
+	}
+
+	if (!known)
+	{
+		fprintf(stderr, "Error: %s: unknown field '%s'\n", assignment, name);
+		return -1;
+	}
+	return 0;
+}
+
+// field=value, если это не существующий путь
+static int patch_is_assignment(const char *arg)
+{
+	const char *equals = strchr(arg, '=');
+	return equals && equals != arg && arg[0] != '-' && access(arg, F_OK) != 0;
+}
+
+static int compare_strings(const void *a, const void *b)
+{
+	return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+// Два входа с одним именем в --output перезаписали бы друг друга
+static int patch_check_outputs(const PatchJob *job)
+{
+	size_t count = job->inputs->count;
+	char **paths = calloc(count ? count : 1, sizeof(char*));
+	if (!paths)
+	{
+		fprintf(stderr, "Error: Out of memory\n");
+		return -1;
+	}
+
+	int status = 0;
+	for (size_t i = 0; i < count && status == 0; i++)
+	{
+		char path[4096];
+		patch_output_path(job, i, path, sizeof(path));
+		paths[i] = strdup(path);
+		if (!paths[i])
+		{
+			fprintf(stderr, "Error: Out of memory\n");
+			status = -1;
+		}
+	}
+
+	if (status == 0)
+	{
+		qsort(paths, count, sizeof(char*), compare_strings);
+		for (size_t i = 1; i < count; i++)
+		{
+			if (strcmp(paths[i - 1], paths[i]) == 0)
+			{
+				fprintf(stderr, "Error: Several inputs would be written to %s\n", paths[i]);
+				status = -1;
+				break;
+			}
+		}
+	}
+
+	for (size_t i = 0; i < count; i++)
+	{
+		free(paths[i]);
+	}
+	free(paths);
+	return status;
+}
+
+static void patch_usage(void)
+{
+	fprintf(stderr, "Usage: eeprom_tool [options] patch [--jobs N] [--unordered] [--board NAME] [--serial SN]\n");
+	fprintf(stderr, "                   (--output DIR | --in-place | --dry-run) [--force] field=value... <files|dirs|archives...>\n");
+	fprintf(stderr, "  --jobs N      Worker threads (default: number of CPUs)\n");
+	fprintf(stderr, "  --unordered   Print results as they complete instead of in input order\n");
+	fprintf(stderr, "  --board NAME  Patch only boards with this board name (shell pattern, repeatable)\n");
+	fprintf(stderr, "  --serial SN   Patch only boards with this serial number (shell pattern, repeatable)\n");
+	fprintf(stderr, "  --output DIR  Write every matching dump to DIR under its file name\n");
+	fprintf(stderr, "  --in-place    Replace the changed dump files\n");
+	fprintf(stderr, "  --dry-run     Report what would change, write nothing\n");
+	fprintf(stderr, "  --force       Also patch dumps with a CRC mismatch (the CRCs are recomputed)\n");
+	fprintf(stderr, "Fields are named as in the decoded output, e.g. frequency=525 psu_voltage=13.60\n");
+	fprintf(stderr, "(or psu_voltage=1360); values are checked against the field limits.\n");
+	fprintf(stderr, "Output: path <TAB> serial <TAB> patched|unchanged for every matching dump.\n");
+	fprintf(stderr, "Exit status is 1 if any matching dump could not be patched.\n");
+}
+
+int cmd_patch(int argc, char *argv[], const CommandOptions *options)
+{
+	int jobs = batch_default_jobs();
+	int ordered = 1;
+	int in_place = 0;
+	InputSet inputs = { 0 };
+	PatchJob job = { 0 };
+	int status = 0;
+
+	// Массивы с запасом на все аргументы
+	job.boards = calloc(argc + 1, sizeof(char*));
+	job.serials = calloc(argc + 1, sizeof(char*));
+	for (size_t v = 0; v < PATCH_VERSION_COUNT; v++)
+	{
+		job.plans[v].values = calloc(argc + 1, sizeof(EEPROMFieldValue));
+		if (!job.plans[v].values)
+		{
+			status = 1;
+		}
+	}
+	if (!job.boards || !job.serials || status)
+	{
+		fprintf(stderr, "Error: Out of memory\n");
+		status = 1;
+		goto done;
+	}
+
+	size_t assignments = 0;
+	for (int i = 0; i < argc && status == 0; i++)
+	{
+		if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc)
+		{
+			jobs = atoi(argv[++i]);
+			if (jobs < 1)
+			{
+				fprintf(stderr, "Error: --jobs must be at least 1\n");
+				status = 1;
+			}
+		}
+		else if (strcmp(argv[i], "--unordered") == 0)
+		{
+			ordered = 0;
+		}
+		else if (strcmp(argv[i], "--board") == 0 && i + 1 < argc)
+		{
+			job.boards[job.board_count++] = argv[++i];
+		}
+		else if (strcmp(argv[i], "--serial") == 0 && i + 1 < argc)
+		{
+			job.serials[job.serial_count++] = argv[++i];
+		}
+		else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc)
+		{
+			job.output_dir = argv[++i];
+		}
+		else if (strcmp(argv[i], "--in-place") == 0)
+		{
+			in_place = 1;
+		}
+		else if (strcmp(argv[i], "--dry-run") == 0)
+		{
+			job.dry_run = 1;
+		}
+		else if (strcmp(argv[i], "--force") == 0)
+		{
+			job.force = 1;
+		}
+		else if (strcmp(argv[i], "--help") == 0)
+		{
+			patch_usage();
+			goto done;
+		}
+		else if (patch_is_assignment(argv[i]))
+		{
+			if (patch_add_assignment(&job, argv[i]) != 0)
+			{
+				status = 1;
+			}
+			assignments++;
+		}
+		else if (inputs_add(&inputs, argv[i]) != 0)
+		{
+			fprintf(stderr, "Error: Cannot read %s: %s\n", argv[i], strerror(errno));
+			status = 1;
+		}
+	}
+
+	if (status == 0 && (inputs.count == 0 || assignments == 0 ||
+						(!job.output_dir + !in_place + !job.dry_run) != 2))
+	{
+		patch_usage();
+		status = 1;
+	}
+	if (status == 0 && in_place && inputs.archive_count)
+	{
+		fprintf(stderr, "Error: Archive records cannot be patched in place, use --output DIR\n");
+		status = 1;
+	}
+	job.inputs = &inputs;
+	job.options = options;
+	if (status == 0 && job.output_dir && patch_check_outputs(&job) != 0)
+	{
+		status = 1;
+	}
+	if (status == 0 && job.output_dir && mkdir(job.output_dir, 0755) != 0 && errno != EEXIST)
+	{
+		fprintf(stderr, "Error: Cannot create %s: %s\n", job.output_dir, strerror(errno));
+		status = 1;
+	}
+	if (status)
+	{
+		goto done;
+	}
+
+	job.output = batch_output_create(STDOUT_FILENO, inputs.count, ordered);
+	if (!job.output)
+	{
+		fprintf(stderr, "Error: Out of memory\n");
+		status = 1;
+		goto done;
+	}
+
+	struct timespec start, end;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	if (batch_parallel_for(inputs.count, jobs, patch_one, &job) != 0)
+	{
+		fprintf(stderr, "Error: Cannot start worker threads\n");
+		status = 1;
+	}
+
+	if (batch_output_destroy(job.output) != 0)
+	{
+		fprintf(stderr, "Error: Cannot write output: %s\n", strerror(errno));
+		status = 1;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+	fprintf(stderr, "%s %zu of %zu files: %zu matched, %zu unchanged, %zu errors (%.3f s, %.0f files/s, %d jobs)\n",
+			job.dry_run ? "Would patch" : "Patched", job.patched, inputs.count, job.matched,
+			job.unchanged, job.errors, seconds, seconds > 0 ? inputs.count / seconds : 0.0, jobs);
+
+	if (job.errors)
+	{
+		status = 1;
+	}
+
+done:
+	for (size_t v = 0; v < PATCH_VERSION_COUNT; v++)
+	{
+		free(job.plans[v].values);
+	}
+	free(job.boards);
+	free(job.serials);
+	inputs_free(&inputs);
+	return status;
+}
@@ -0,0 +1,246 @@
+#include "commands.h"
+#include "batch.h"
+#include "eeprom_defs.h"
+#include "eeprom_ops.h"
+#include "eeprom_file.h"
+#include "export.h"
+#include "i2c_eeprom.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+// ═══════════════════════════════════════════════════════════════
+// scan: все шины /dev/i2c-*, адреса 0x50-0x53
+// ═══════════════════════════════════════════════════════════════
+
+#define SCAN_ADDR_FIRST 0x50
+#define SCAN_ADDR_COUNT 4          // до четырех цепочек на шину
+
+typedef struct
+{
+	int present;
+	uint8_t data[EEPROM_SIZE];
+} ScanSlot;
+
+typedef struct
+{
+	char path[512];
+	int open_failed;
+	ScanSlot slots[SCAN_ADDR_COUNT];
+} ScanBus;
+
+// Сортировка по номеру шины, а не по строке (i2c-10 после i2c-9)
+static int compare_bus_numbers(const void *a, const void *b)
+{
+	long x = strtol(*(char *const*)a + strlen("/dev/i2c-"), NULL, 10);
+	long y = strtol(*(char *const*)b + strlen("/dev/i2c-"), NULL, 10);
+	return x < y ? -1 : x > y;
+}
+
+static int list_buses(BatchPathList *buses)
+{
+	DIR *dir = opendir("/dev");
+	if (!dir)
+	{
+		return -1;
+	}
+
+	struct dirent *entry;
+	while ((entry = readdir(dir)) != NULL)
+	{
+		if (strncmp(entry->d_name, "i2c-", 4) == 0)
+		{
+			char path[300];
+			snprintf(path, sizeof(path), "/dev/%s", entry->d_name);
+			batch_collect_paths(buses, path);
+		}
+	}
+	closedir(dir);
+
+	// Шины, где EEPROM заняты драйвером at24, могут не иметь узла /dev/i2c-N
+	for (int number = iic_nvmem_next_bus(-1); number >= 0; number = iic_nvmem_next_bus(number))
+	{
+		char path[32];
+		snprintf(path, sizeof(path), "/dev/i2c-%d", number);
+		int listed = 0;
+		for (size_t i = 0; i < buses->count && !listed; i++)
+		{
+			listed = strcmp(buses->paths[i], path) == 0;
+		}
+		if (!listed)
+		{
+			batch_add_path(buses, path);
+		}
+	}
+
+	qsort(buses->paths, buses->count, sizeof(char*), compare_bus_numbers);
+	return 0;
+}
+
+static void scan_bus(size_t index, int worker, void *arg)
+{
+	ScanBus *bus = &((ScanBus*)arg)[index];
+
+	int fd = iic_open(bus->path, NULL);
+	if (fd < 0)
+	{
+		bus->open_failed = 1;
+		return;
+	}
+
+	for (int a = 0; a < SCAN_ADDR_COUNT; a++)
+	{
+		ScanSlot *slot = &bus->slots[a];
+		memset(slot->data, 0xFF, EEPROM_SIZE);
+		slot->present = iic_eeprom_load(fd, SCAN_ADDR_FIRST + a, 0, slot->data, EEPROM_SIZE) >= 0;
+	}
+
+	iic_close(fd);
+}
+
+int cmd_scan(int argc, char *argv[], const CommandOptions *options)
+{
+	ExportFormat format = EXPORT_FORMAT_TEXT;
+	const char *save_dir = NULL;
+	BatchPathList buses = { 0 };
+
+	for (int i = 0; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--format") == 0 && i + 1 < argc)
+		{
+			if (export_parse_format(argv[++i], &format) != 0)
+			{
+				fprintf(stderr, "Error: Unknown format '%s' (text, ndjson, csv)\n", argv[i]);
+				batch_free_paths(&buses);
+				return 1;
+			}
+		}
+		else if (strcmp(argv[i], "--save") == 0 && i + 1 < argc)
+		{
+			save_dir = argv[++i];
+		}
+		else if (argv[i][0] != '-')
+		{
+			// Явно заданные шины вместо всех /dev/i2c-*; проверяет iic_open:
+			// sim:... не файл, у шины только с at24 нет узла /dev/i2c-N
+			if (batch_add_path(&buses, argv[i]) != 0)
+			{
+				batch_free_paths(&buses);
+				return 1;
+			}
+		}
+		else
+		{
+			fprintf(stderr, "Usage: eeprom_tool [options] scan [--format F] [--save DIR] [/dev/i2c-N...]\n");
+			batch_free_paths(&buses);
+			return 1;
+		}
+	}
+
+	if (buses.count == 0 && list_buses(&buses) != 0)
+	{
+		fprintf(stderr, "Error: Cannot list /dev: %s\n", strerror(errno));
+		return 1;
+	}
+
+	if (buses.count == 0)
+	{
+		fprintf(stderr, "No I2C buses found\n");
+		return 1;
+	}
+
+	if (save_dir && mkdir(save_dir, 0755) != 0 && errno != EEXIST)
+	{
+		fprintf(stderr, "Error: Cannot create %s: %s\n", save_dir, strerror(errno));
+		batch_free_paths(&buses);
+		return 1;
+	}
+
+	ScanBus *scan = calloc(buses.count, sizeof(ScanBus));
+	if (!scan)
+	{
+		batch_free_paths(&buses);
+		return 1;
+	}
+	for (size_t b = 0; b < buses.count; b++)
+	{
+		snprintf(scan[b].path, sizeof(scan[b].path), "%s", buses.paths[b]);
+	}
+
+	struct timespec start, end;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	// Шины независимы: по потоку на шину, адреса одной шины - последовательно
+	batch_parallel_for(buses.count, (int)buses.count, scan_bus, scan);
+
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	ExportBuffer buffer;
+	export_buffer_init(&buffer, 65536);
+	export_header(&buffer, format);
+
+	size_t boards = 0, failures = 0;
+	for (size_t b = 0; b < buses.count; b++)
+	{
+		if (scan[b].open_failed)
+		{
+			fprintf(stderr, "Warning: Cannot open %s\n", scan[b].path);
+			continue;
+		}
+
+		for (int a = 0; a < SCAN_ADDR_COUNT; a++)
+		{
+			ScanSlot *slot = &scan[b].slots[a];
+			if (!slot->present)
+			{
+				continue;
+			}
+			boards++;
+
+			char source[600];
+			snprintf(source, sizeof(source), "%s@0x%02X", scan[b].path, SCAN_ADDR_FIRST + a);
+
+			if (save_dir)
+			{
+				char path[4096];
+				snprintf(path, sizeof(path), "%s/%s_0x%02X.bin", save_dir,
+						 strrchr(scan[b].path, '/') ? strrchr(scan[b].path, '/') + 1 : scan[b].path,
+						 SCAN_ADDR_FIRST + a);
+				if (eeprom_write_file(path, slot->data, EEPROM_SIZE) != EEPROM_SUCCESS)
+				{
+					fprintf(stderr, "Warning: Cannot write %s: %s\n", path, strerror(errno));
+				}
+			}
+
+			EEPROMDecodeResult result;
+			EEPROMRecord record;
+			int ret = command_decode_buffer(slot->data, options, &result, &record);
+			if (ret == EEPROM_SUCCESS)
+			{
+				export_record(&buffer, format, source, &result, &record);
+				failures += result.crc_fail_mask != 0;
+			}
+			else
+			{
+				export_error(&buffer, format, source, eeprom_strerror(ret));
+				failures++;
+			}
+		}
+	}
+
+	export_flush(&buffer, STDOUT_FILENO);
+	export_buffer_free(&buffer);
+
+	double ms = (end.tv_sec - start.tv_sec) * 1e3 + (end.tv_nsec - start.tv_nsec) / 1e6;
+	fprintf(stderr, "Scanned %zu buses: %zu boards, %zu not decoded cleanly (%.1f ms)\n",
+			buses.count, boards, failures, ms);
+
+	free(scan);
+	batch_free_paths(&buses);
+	return failures ? 1 : 0;
+}
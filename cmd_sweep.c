@@ -0,0 +1,334 @@
+#include "commands.h"
+#include "batch.h"
+#include "inputs.h"
+#include "eeprom_defs.h"
+#include "eeprom_ops.h"
+#include "eeprom_sweep.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+
+// ═══════════════════════════════════════════════════════════════
+// sweep: частоты sweep по платам и по позициям ASIC во всем парке
+//
+// Расшифровывается только регион sweep (и регион с серийным номером
+// для --boards). По умолчанию строка на позицию ASIC:
+//   asic <TAB> boards <TAB> mean MHz <TAB> c0,c1,...,c15
+// где cN - число плат с уровнем N на этой позиции. --boards:
+//   path <TAB> serial <TAB> min <TAB> max <TAB> mean <TAB> stddev
+// ═══════════════════════════════════════════════════════════════
+
+#define SWEEP_LINE 1200
+
+typedef struct
+{
+	const InputSet *inputs;
+	const CommandOptions *options;
+	BatchOutput *output;           // только --boards
+	EEPROMSweepHistogram *histograms;  // по одной на рабочий поток
+
+	// Счетчики обновляются атомарно из рабочих потоков
+	size_t boards;
+	size_t no_sweep;
+	size_t errors;
+} SweepJob;
+
+// Регион sweep есть только у v1, v5 и v6 (как в eeprom_sweep_stats())
+static int sweep_present(EEPROMVersion version)
+{
+	return version == EEPROM_VERSION_V1 || version == EEPROM_VERSION_V5 ||
+		   version == EEPROM_VERSION_V6;
+}
+
+static int sweep_read(EEPROMView *view, uint8_t packed[EEPROM_SWEEP_BYTES],
+					  uint16_t *base, uint8_t *step)
+{
+	EEPROMVersion version = view->result.version;
+	const FieldMetadata *levels_field = eeprom_field_by_id(version, FIELD_ID_ASIC_FREQUENCIES);
+	const FieldMetadata *base_field = eeprom_field_by_id(version, FIELD_ID_SWEEP_FREQ_BASE);
+	const FieldMetadata *step_field = eeprom_field_by_id(version, FIELD_ID_SWEEP_FREQ_STEP);
+	if (!levels_field || !base_field || !step_field || levels_field->size != EEPROM_SWEEP_BYTES)
+	{
+		return EEPROM_ERROR_VERSION;
+	}
+
+	const uint8_t *levels = eeprom_view_field(view, levels_field);
+	const uint8_t *base_bytes = eeprom_view_field(view, base_field);
+	const uint8_t *step_bytes = eeprom_view_field(view, step_field);
+	if (!levels || !base_bytes || !step_bytes)
+	{
+		return EEPROM_ERROR_UNKNOWN;
+	}
+	if (view->result.crc_fail_mask)
+	{
+		return EEPROM_ERROR_CRC;
+	}
+
+	memcpy(packed, levels, EEPROM_SWEEP_BYTES);
+	memcpy(base, base_bytes, sizeof(*base));
+	*step = *step_bytes;
+	return EEPROM_SUCCESS;
+}
+
+static void sweep_one(size_t index, int worker, void *arg)
+{
+	SweepJob *job = (SweepJob*)arg;
+
+	uint8_t raw[EEPROM_SIZE];
+	uint8_t packed[EEPROM_SWEEP_BYTES];
+	uint16_t freqs[EEPROM_SWEEP_ASICS];
+	uint16_t base = 0;
+	uint8_t step = 0;
+	EEPROMView view;
+	EEPROMSweepStats stats;
+	char serial[64] = "";
+	char line[SWEEP_LINE];
+	int length = 0;
+
+	int ret = inputs_read(job->inputs, index, raw, NULL);
+	if (ret == EEPROM_SUCCESS)
+	{
+		ret = command_view_init(&view, raw, job->options);
+	}
+	if (ret == EEPROM_SUCCESS && !sweep_present(view.result.version))
+	{
+		__atomic_fetch_add(&job->no_sweep, 1, __ATOMIC_RELAXED);
+		if (job->output)
+		{
+			batch_output_commit(job->output, index, NULL, 0);
+		}
+		return;
+	}
+	if (ret == EEPROM_SUCCESS)
+	{
+		ret = sweep_read(&view, packed, &base, &step);
+	}
+	if (ret == EEPROM_SUCCESS && job->output)
+	{
+		ret = eeprom_view_serial(&view, serial, sizeof(serial));
+	}
+
+	char path[1024];
+	if (ret != EEPROM_SUCCESS)
+	{
+		__atomic_fetch_add(&job->errors, 1, __ATOMIC_RELAXED);
+		inputs_source(job->inputs, index, path, sizeof(path));
+		const char *reason = ret == EEPROM_ERROR_IO ? strerror(errno) : eeprom_strerror(ret);
+		if (job->output)
+		{
+			length = snprintf(line, sizeof(line), "%s\terror\t%s\n", path, reason);
+		}
+		else
+		{
+			fprintf(stderr, "Warning: %s: %s\n", path, reason);
+		}
+	}
+	else
+	{
+		__atomic_fetch_add(&job->boards, 1, __ATOMIC_RELAXED);
+		eeprom_sweep_unpack(packed, base, step, freqs, job->output ? &stats : NULL);
+		eeprom_sweep_histogram_add(&job->histograms[worker], packed, freqs);
+
+		if (job->output)
+		{
+			inputs_source(job->inputs, index, path, sizeof(path));
+			length = snprintf(line, sizeof(line), "%s\t%s\t%u\t%u\t%.1f\t%.1f\n", path, serial,
+							  stats.min, stats.max, stats.mean, stats.stddev);
+		}
+	}
+
+	if (length >= (int)sizeof(line))
+	{
+		length = sizeof(line) - 1;
+		line[length - 1] = '\n';
+	}
+	if (job->output)
+	{
+		batch_output_commit(job->output, index, line, length > 0 ? (size_t)length : 0);
+	}
+}
+
+static const EEPROMSweepHistogram *sort_histogram;
+
+static int compare_positions(const void *a, const void *b)
+{
+	uint64_t sum_a = sort_histogram->freq_sum[*(const int*)a];
+	uint64_t sum_b = sort_histogram->freq_sum[*(const int*)b];
+	if (sum_a != sum_b)
+	{
+		return sum_a < sum_b ? -1 : 1;
+	}
+	return *(const int*)a - *(const int*)b;
+}
+
+// Позиции по порядку или weakest самых низкочастотных по возрастанию
+static void sweep_print_positions(const EEPROMSweepHistogram *histogram, int weakest)
+{
+	int positions[EEPROM_SWEEP_ASICS];
+	int count = EEPROM_SWEEP_ASICS;
+	for (int i = 0; i < EEPROM_SWEEP_ASICS; i++)
+	{
+		positions[i] = i;
+	}
+	if (weakest > 0)
+	{
+		sort_histogram = histogram;
+		qsort(positions, EEPROM_SWEEP_ASICS, sizeof(int), compare_positions);
+		count = weakest < count ? weakest : count;
+	}
+
+	for (int p = 0; p < count; p++)
+	{
+		int asic = positions[p];
+		printf("%d\t%llu\t%.1f\t", asic, (unsigned long long)histogram->boards,
+			   histogram->boards ? (double)histogram->freq_sum[asic] / histogram->boards : 0.0);
+		for (int level = 0; level < EEPROM_SWEEP_LEVELS; level++)
+		{
+			printf(level ? ",%u" : "%u", histogram->levels[asic][level]);
+		}
+		printf("\n");
+	}
+}
+
+static void sweep_usage(void)
+{
+	fprintf(stderr, "Usage: eeprom_tool [options] sweep [--jobs N] [--boards [--unordered]] [--weakest N] <files|dirs|archives...>\n");
+	fprintf(stderr, "  --jobs N      Worker threads (default: number of CPUs)\n");
+	fprintf(stderr, "  --boards      One line per board: path, serial, min, max, mean, stddev (MHz)\n");
+	fprintf(stderr, "  --unordered   With --boards, print results as they complete\n");
+	fprintf(stderr, "  --weakest N   Only the N ASIC positions with the lowest mean frequency\n");
+	fprintf(stderr, "Default output, one line per ASIC position over all boards:\n");
+	fprintf(stderr, "  asic <TAB> boards <TAB> mean MHz <TAB> boards at level 0,1,...,15\n");
+	fprintf(stderr, "Dumps without sweep data (v4, v17) are skipped.\n");
+}
+
+int cmd_sweep(int argc, char *argv[], const CommandOptions *options)
+{
+	int jobs = batch_default_jobs();
+	int ordered = 1;
+	int per_board = 0;
+	int weakest = 0;
+	InputSet inputs = { 0 };
+	int status = 0;
+
+	for (int i = 0; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc)
+		{
+			jobs = atoi(argv[++i]);
+			if (jobs < 1)
+			{
+				fprintf(stderr, "Error: --jobs must be at least 1\n");
+				inputs_free(&inputs);
+				return 1;
+			}
+		}
+		else if (strcmp(argv[i], "--unordered") == 0)
+		{
+			ordered = 0;
+		}
+		else if (strcmp(argv[i], "--boards") == 0)
+		{
+			per_board = 1;
+		}
+		else if (strcmp(argv[i], "--weakest") == 0 && i + 1 < argc)
+		{
+			weakest = atoi(argv[++i]);
+			if (weakest < 1)
+			{
+				fprintf(stderr, "Error: --weakest must be at least 1\n");
+				inputs_free(&inputs);
+				return 1;
+			}
+		}
+		else if (strcmp(argv[i], "--help") == 0)
+		{
+			sweep_usage();
+			inputs_free(&inputs);
+			return 0;
+		}
+		else if (inputs_add(&inputs, argv[i]) != 0)
+		{
+			fprintf(stderr, "Error: Cannot read %s: %s\n", argv[i], strerror(errno));
+			status = 1;
+		}
+	}
+
+	if (inputs.count == 0)
+	{
+		if (status == 0)
+		{
+			sweep_usage();
+		}
+		inputs_free(&inputs);
+		return 1;
+	}
+
+	SweepJob job = { 0 };
+	job.inputs = &inputs;
+	job.options = options;
+	job.histograms = calloc(jobs, sizeof(EEPROMSweepHistogram));
+	if (per_board)
+	{
+		job.output = batch_output_create(STDOUT_FILENO, inputs.count, ordered);
+	}
+	if (!job.histograms || (per_board && !job.output))
+	{
+		fprintf(stderr, "Error: Out of memory\n");
+		if (job.output)
+		{
+			batch_output_destroy(job.output);
+		}
+		free(job.histograms);
+		inputs_free(&inputs);
+		return 1;
+	}
+
+	struct timespec start, end;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	if (batch_parallel_for(inputs.count, jobs, sweep_one, &job) != 0)
+	{
+		fprintf(stderr, "Error: Cannot start worker threads\n");
+		status = 1;
+	}
+
+	if (job.output && batch_output_destroy(job.output) != 0)
+	{
+		fprintf(stderr, "Error: Cannot write output: %s\n", strerror(errno));
+		status = 1;
+	}
+
+	for (int i = 1; i < jobs; i++)
+	{
+		eeprom_sweep_histogram_merge(&job.histograms[0], &job.histograms[i]);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	if (!per_board)
+	{
+		sweep_print_positions(&job.histograms[0], weakest);
+		if (fflush(stdout) != 0)
+		{
+			fprintf(stderr, "Error: Cannot write output: %s\n", strerror(errno));
+			status = 1;
+		}
+	}
+
+	double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+	fprintf(stderr, "Sweep of %zu files: %zu boards, %zu without sweep data, %zu errors (%.3f s, %.0f files/s, %d jobs, %s)\n",
+			inputs.count, job.boards, job.no_sweep, job.errors,
+			seconds, seconds > 0 ? inputs.count / seconds : 0.0, jobs, eeprom_sweep_kernel());
+
+	if (job.errors)
+	{
+		status = 1;
+	}
+
+	free(job.histograms);
+	inputs_free(&inputs);
+	return status;
+}
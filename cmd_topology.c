@@ -0,0 +1,359 @@
+#include "commands.h"
+#include "inputs.h"
+#include "eeprom_defs.h"
+#include "eeprom_ops.h"
+#include "eeprom_topology.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#define TOPOLOGY_CACHE_FILE "topology" EEPROM_TOPOLOGY_EXTENSION
+
+// ═══════════════════════════════════════════════════════════════
+// topology: модель платы по board_name из EEPROM
+//
+// Конфиги topol_*.conf из --topology DIR разбираются один раз в индекс,
+// который потом только отображается в память; без --topology берется
+// уже собранный индекс. Строка на запрос (имя платы или дамп):
+//   query <TAB> board_name <TAB> machine <TAB> asic <TAB> chains
+//         <TAB> asics per chain <TAB> layout <TAB> config
+// Без аргументов - все известные имена платы.
+// ═══════════════════════════════════════════════════════════════
+
+static void topology_print_diag(EEPROMDiagLevel level, const char *message, void *user)
+{
+	(void)user;
+	fprintf(stderr, "%s%s\n", level == EEPROM_DIAG_ERROR ? "Error: " : "Warning: ", message);
+}
+
+// --topology-cache или $XDG_CACHE_HOME/eeprom_tool/topology.eet; NULL - только в памяти.
+// create: создать недостающие каталоги (индекс будет записан)
+static const char *topology_cache_path(const CommandOptions *options, int create, char *buffer, size_t size)
+{
+	if (options->topology_cache)
+	{
+		return options->topology_cache;
+	}
+
+	const char *xdg = getenv("XDG_CACHE_HOME");
+	const char *home = getenv("HOME");
+	int length;
+	if (xdg && xdg[0])
+	{
+		length = snprintf(buffer, size, "%s", xdg);
+		if (create && length > 0 && length < (int)size)
+		{
+			mkdir(buffer, 0755);
+		}
+	}
+	else if (home && home[0])
+	{
+		length = snprintf(buffer, size, "%s/.cache", home);
+		if (create && length > 0 && length < (int)size)
+		{
+			mkdir(buffer, 0755);
+		}
+	}
+	else
+	{
+		return NULL;
+	}
+
+	if (length > 0 && length < (int)size)
+	{
+		length += snprintf(buffer + length, size - length, "/eeprom_tool");
+	}
+	if (length <= 0 || length >= (int)size || (create && mkdir(buffer, 0755) != 0 && errno != EEXIST))
+	{
+		return NULL;
+	}
+	length += snprintf(buffer + length, size - length, "/%s", TOPOLOGY_CACHE_FILE);
+	return length < (int)size ? buffer : NULL;
+}
+
+int command_topology_open(const CommandOptions *options, EEPROMTopology *topology, int verbose)
+{
+	char buffer[4096];
+	const char *dir = options->topology_dir;
+	const char *cache = topology_cache_path(options, dir != NULL, buffer, sizeof(buffer));
+
+	int ret = eeprom_topology_open(topology, dir, cache, verbose ? topology_print_diag : NULL, NULL);
+	if (ret != EEPROM_SUCCESS && verbose)
+	{
+		if (dir)
+		{
+			fprintf(stderr, "Error: Cannot read topology configs in %s: %s\n", dir, strerror(errno));
+		}
+		else if (errno == ENOENT)
+		{
+			fprintf(stderr, "Error: No topology index%s%s, compile one with --topology DIR\n",
+					cache ? " at " : "", cache ? cache : "");
+		}
+		else
+		{
+			fprintf(stderr, "Error: Cannot read topology index %s: %s\n", cache, strerror(errno));
+		}
+	}
+	return ret;
+}
+
+static void topology_print_board(const char *query, const char *name, const EEPROMTopologyBoard *board)
+{
+	if (!board)
+	{
+		printf("%s\t%s\tunknown\n", query, name);
+		return;
+	}
+	printf("%s\t%s\t%s\t%s\t%u\t%u\t%ux%u\t%s", query, name, board->machine, board->asic_id,
+		   board->chain_num, board->chain_asic_num, board->grid_rows, board->grid_columns, board->source);
+	if (board->source_entry)
+	{
+		printf("[%u]", board->source_entry);
+	}
+	printf("\n");
+}
+
+// --details: все, что есть в записи
+static void topology_print_details(const EEPROMTopologyBoard *board)
+{
+	printf("  hardware: hw %s, sw %s, %s, power %s @0x%02X, %u fans\n", board->hw_version,
+		   board->sw_version, board->processor, board->power, board->power_i2c_addr, board->fan_count);
+	printf("  asic: %s 0x%04X, %u cores, %u small cores, %u domains, address interval %u\n",
+		   board->asic_id, board->asic_addr, board->asic_core_num, board->asic_small_core_num,
+		   board->asic_domain_num, board->asic_addr_interval);
+	printf("  chain: %u chains, %ux%u, %u ASICs in %u domains of %u\n", board->chain_num,
+		   board->chain_row, board->chain_column, board->chain_asic_num,
+		   board->chain_domain_num, board->domain_asic_num);
+	printf("  pic: %s @0x%02X, eeprom: %s @0x%02X\n", board->pic[0] ? board->pic : "-",
+		   board->pic_i2c_addr, board->eeprom[0] ? board->eeprom : "-", board->eeprom_i2c_addr);
+	for (int a = 0; a < board->alias_count; a++)
+	{
+		printf("  alias: %s\n", board->aliases[a]);
+	}
+	for (int s = 0; s < board->sensor_count; s++)
+	{
+		const EEPROMTopologySensor *sensor = &board->sensors[s];
+		printf("  sensor: %s %u %s @0x%02X %s/%s", eeprom_topology_sensor_group(sensor->group),
+			   sensor->index, sensor->type, sensor->i2c_addr, sensor->x, sensor->y);
+		if (sensor->asic >= 0)
+		{
+			printf(" asic %d", sensor->asic);
+		}
+		printf("\n");
+	}
+	for (int p = 0; p < board->param_count; p++)
+	{
+		printf("  %s: %d\n", board->params[p].key, board->params[p].value);
+	}
+	for (int row = 0; row < board->grid_rows; row++)
+	{
+		printf("  |");
+		for (int column = 0; column < board->grid_columns; column++)
+		{
+			uint8_t asic = board->grid[row * board->grid_columns + column];
+			printf(asic ? " %3u" : "   .", asic);
+		}
+		printf("\n");
+	}
+}
+
+static int topology_board_name(const InputSet *inputs, size_t item, const CommandOptions *options,
+							   char *name, size_t size)
+{
+	uint8_t raw[EEPROM_SIZE];
+	EEPROMView view;
+
+	int ret = inputs_read(inputs, item, raw, NULL);
+	if (ret == EEPROM_SUCCESS)
+	{
+		ret = command_view_init(&view, raw, options);
+	}
+	if (ret != EEPROM_SUCCESS)
+	{
+		return ret;
+	}
+
+	const FieldMetadata *field = eeprom_field_by_id(view.result.version, FIELD_ID_BOARD_NAME);
+	const uint8_t *bytes = field ? eeprom_view_field(&view, field) : NULL;
+	if (!bytes)
+	{
+		return EEPROM_ERROR_VERSION;
+	}
+	if (view.result.crc_fail_mask)
+	{
+		return EEPROM_ERROR_CRC;
+	}
+
+	size_t length = strnlen((const char*)bytes, field->size);
+	if (length >= size)
+	{
+		length = size - 1;
+	}
+	memcpy(name, bytes, length);
+	name[length] = '\0';
+	return EEPROM_SUCCESS;
+}
+
+static void topology_usage(void)
+{
+	fprintf(stderr, "Usage: eeprom_tool [options] topology [--rebuild] [--details] [board names|files|dirs|archives...]\n");
+	fprintf(stderr, "  --rebuild     Parse the configs again even if the compiled index is current\n");
+	fprintf(stderr, "  --details     Sensors, strategy values and ASIC layout of each board\n");
+	fprintf(stderr, "Configs: topol_*.conf in --topology DIR, compiled into --topology-cache FILE\n");
+	fprintf(stderr, "(default $XDG_CACHE_HOME/eeprom_tool/topology.eet); without --topology the\n");
+	fprintf(stderr, "index compiled last is used as is.\n");
+	fprintf(stderr, "Output, one line per board name or dump:\n");
+	fprintf(stderr, "  query <TAB> board_name <TAB> machine <TAB> asic <TAB> chains <TAB> asics <TAB> layout <TAB> config\n");
+}
+
+int cmd_topology(int argc, char *argv[], const CommandOptions *options)
+{
+	int rebuild = 0;
+	int details = 0;
+	int status = 0;
+	int queries = 0;
+
+	for (int i = 0; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--rebuild") == 0)
+		{
+			rebuild = 1;
+		}
+		else if (strcmp(argv[i], "--details") == 0)
+		{
+			details = 1;
+		}
+		else if (strcmp(argv[i], "--help") == 0)
+		{
+			topology_usage();
+			return 0;
+		}
+		else if (argv[i][0] == '-')
+		{
+			fprintf(stderr, "Error: Unknown option: %s\n", argv[i]);
+			topology_usage();
+			return 1;
+		}
+	}
+
+	if (rebuild && !options->topology_dir)
+	{
+		fprintf(stderr, "Error: --rebuild needs --topology DIR\n");
+		return 1;
+	}
+
+	char buffer[4096];
+	const char *cache = topology_cache_path(options, options->topology_dir != NULL, buffer, sizeof(buffer));
+	if (rebuild && cache && unlink(cache) != 0 && errno != ENOENT)
+	{
+		fprintf(stderr, "Warning: Cannot remove %s: %s\n", cache, strerror(errno));
+	}
+
+	struct timespec start, opened, end;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	EEPROMTopology topology;
+	if (command_topology_open(options, &topology, 1) != EEPROM_SUCCESS)
+	{
+		return 1;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &opened);
+
+	size_t lookups = 0;
+	for (int i = 0; i < argc; i++)
+	{
+		if (argv[i][0] == '-')
+		{
+			continue;
+		}
+		queries++;
+
+		// Существующий путь - дампы, иначе имя платы
+		struct stat st;
+		if (stat(argv[i], &st) != 0)
+		{
+			const EEPROMTopologyBoard *board = eeprom_topology_find(&topology, argv[i]);
+			lookups++;
+			topology_print_board(argv[i], argv[i], board);
+			if (board && details)
+			{
+				topology_print_details(board);
+			}
+			status |= board ? 0 : 1;
+			continue;
+		}
+
+		InputSet inputs = { 0 };
+		if (inputs_add(&inputs, argv[i]) != 0)
+		{
+			fprintf(stderr, "Error: Cannot read %s: %s\n", argv[i], strerror(errno));
+			status = 1;
+			inputs_free(&inputs);
+			continue;
+		}
+		for (size_t item = 0; item < inputs.count; item++)
+		{
+			char path[1024];
+			char name[64];
+			inputs_source(&inputs, item, path, sizeof(path));
+
+			int ret = topology_board_name(&inputs, item, options, name, sizeof(name));
+			if (ret != EEPROM_SUCCESS)
+			{
+				printf("%s\terror\t%s\n", path, ret == EEPROM_ERROR_IO ? strerror(errno) : eeprom_strerror(ret));
+				status = 1;
+				continue;
+			}
+
+			const EEPROMTopologyBoard *board = eeprom_topology_find(&topology, name);
+			lookups++;
+			topology_print_board(path, name, board);
+			if (board && details)
+			{
+				topology_print_details(board);
+			}
+			status |= board ? 0 : 1;
+		}
+		inputs_free(&inputs);
+	}
+
+	// Без запросов - все имена индекса
+	if (queries == 0)
+	{
+		for (size_t n = 0; n < topology.header->name_count; n++)
+		{
+			const EEPROMTopologyBoard *board = &topology.boards[topology.names[n].board];
+			topology_print_board(topology.names[n].name, topology.names[n].name, board);
+			if (details)
+			{
+				topology_print_details(board);
+			}
+		}
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	if (fflush(stdout) != 0)
+	{
+		fprintf(stderr, "Error: Cannot write output: %s\n", strerror(errno));
+		status = 1;
+	}
+
+	double open_ms = (opened.tv_sec - start.tv_sec) * 1e3 + (opened.tv_nsec - start.tv_nsec) / 1e6;
+	fprintf(stderr, "Topology: %llu boards, %llu names from %llu configs (%llu skipped), %s %s in %.3f ms",
+			(unsigned long long)topology.header->board_count, (unsigned long long)topology.header->name_count,
+			(unsigned long long)topology.header->config_count, (unsigned long long)topology.header->skipped_count,
+			topology.compiled ? "compiled" : "mapped", cache ? cache : "(memory only)", open_ms);
+	if (lookups)
+	{
+		double lookup_ms = (end.tv_sec - opened.tv_sec) * 1e3 + (end.tv_nsec - opened.tv_nsec) / 1e6;
+		fprintf(stderr, ", %zu queries in %.3f ms", lookups, lookup_ms);
+	}
+	fprintf(stderr, "\n");
+
+	eeprom_topology_close(&topology);
+	return status;
+}
@@ -0,0 +1,266 @@
+#include "commands.h"
+#include "batch.h"
+#include "inputs.h"
+#include "eeprom_defs.h"
+#include "eeprom_ops.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+
+// ═══════════════════════════════════════════════════════════════
+// verify: только расшифровка, CRC и результаты тестов регионов
+//
+// Поля не разбираются и не форматируются. Строка на файл:
+//   path <TAB> vN <TAB> XX
+// XX - битовая карта в hex: биты 0-2 - CRC не совпал в регионе 1-3,
+// биты 4-6 - тест региона 1-3 не пройден; 00 - плата в порядке.
+// Нечитаемые дампы: path <TAB> error <TAB> причина.
+// ═══════════════════════════════════════════════════════════════
+
+#define VERIFY_LINE 1200
+
+typedef struct
+{
+	const InputSet *inputs;
+	const CommandOptions *options;
+	BatchOutput *output;
+	int failed_only;               // --failed: строки только для плат с ошибками
+
+	// Счетчики обновляются атомарно из рабочих потоков
+	size_t ok;
+	size_t errors;
+	size_t crc_failures;
+	size_t test_failures;
+	size_t region_crc[EEPROM_MAX_REGIONS];
+	size_t region_test[EEPROM_MAX_REGIONS];
+} VerifyJob;
+
+// Строка и счетчики одного дампа; errno - причина, если ret == EEPROM_ERROR_IO
+static void verify_report(VerifyJob *job, size_t index, int ret, const EEPROMDecodeResult *result)
+{
+	char line[VERIFY_LINE];
+	int length = 0;
+
+	if (ret != EEPROM_SUCCESS)
+	{
+		__atomic_fetch_add(&job->errors, 1, __ATOMIC_RELAXED);
+
+		char path[1024];
+		inputs_source(job->inputs, index, path, sizeof(path));
+		length = snprintf(line, sizeof(line), "%s\terror\t%s\n", path,
+						  ret == EEPROM_ERROR_IO ? strerror(errno) : eeprom_strerror(ret));
+	}
+	else
+	{
+		unsigned bitmap = result->crc_fail_mask | (result->test_fail_mask << 4);
+
+		if (!bitmap)
+		{
+			__atomic_fetch_add(&job->ok, 1, __ATOMIC_RELAXED);
+		}
+		if (result->crc_fail_mask)
+		{
+			__atomic_fetch_add(&job->crc_failures, 1, __ATOMIC_RELAXED);
+		}
+		if (result->test_fail_mask)
+		{
+			__atomic_fetch_add(&job->test_failures, 1, __ATOMIC_RELAXED);
+		}
+		for (size_t r = 0; r < result->region_count; r++)
+		{
+			if (result->crc_fail_mask & (1u << r))
+			{
+				__atomic_fetch_add(&job->region_crc[r], 1, __ATOMIC_RELAXED);
+			}
+			if (result->test_fail_mask & (1u << r))
+			{
+				__atomic_fetch_add(&job->region_test[r], 1, __ATOMIC_RELAXED);
+			}
+		}
+
+		char path[1024];
+		inputs_source(job->inputs, index, path, sizeof(path));
+		command_report_repair(path, result);
+
+		if (bitmap || !job->failed_only)
+		{
+			length = snprintf(line, sizeof(line), "%s\tv%d\t%02X\n", path, result->version, bitmap);
+		}
+	}
+
+	if (length >= (int)sizeof(line))
+	{
+		length = sizeof(line) - 1;
+		line[length - 1] = '\n';
+	}
+	batch_output_commit(job->output, index, line, length > 0 ? (size_t)length : 0);
+}
+
+// Работа - COMMAND_DECODE_CHUNK дампов подряд: платы с общим ключом
+// расшифровываются вместе
+static void verify_chunk(size_t chunk, int worker, void *arg)
+{
+	VerifyJob *job = (VerifyJob*)arg;
+	(void)worker;
+
+	size_t first = chunk * COMMAND_DECODE_CHUNK;
+	size_t count = job->inputs->count - first;
+	if (count > COMMAND_DECODE_CHUNK)
+	{
+		count = COMMAND_DECODE_CHUNK;
+	}
+
+	uint8_t data[COMMAND_DECODE_CHUNK][EEPROM_SIZE];
+	uint8_t *readable[COMMAND_DECODE_CHUNK] = { 0 };
+	EEPROMDecodeResult results[COMMAND_DECODE_CHUNK];
+	int status[COMMAND_DECODE_CHUNK];
+	int decoded[COMMAND_DECODE_CHUNK];
+	int errnos[COMMAND_DECODE_CHUNK];
+	size_t n = 0;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		status[i] = inputs_read(job->inputs, first + i, data[i], NULL);
+		errnos[i] = errno;
+		if (status[i] == EEPROM_SUCCESS)
+		{
+			readable[n++] = data[i];
+		}
+	}
+
+	command_decode_results(readable, n, job->options, results, decoded);
+
+	for (size_t i = 0, m = 0; i < count; i++)
+	{
+		if (status[i] != EEPROM_SUCCESS)
+		{
+			errno = errnos[i];
+			verify_report(job, first + i, status[i], NULL);
+			continue;
+		}
+		verify_report(job, first + i, decoded[m], &results[m]);
+		m++;
+	}
+}
+
+static void verify_usage(void)
+{
+	fprintf(stderr, "Usage: eeprom_tool [options] verify [--jobs N] [--unordered] [--failed] <files|dirs|archives...>\n");
+	fprintf(stderr, "  --jobs N      Worker threads (default: number of CPUs)\n");
+	fprintf(stderr, "  --unordered   Print results as they complete instead of in input order\n");
+	fprintf(stderr, "  --failed      Print only dumps with a CRC or test failure or that cannot be decoded\n");
+	fprintf(stderr, "Output: path <TAB> version <TAB> XX, XX = hex bitmap:\n");
+	fprintf(stderr, "  bits 0-2 CRC mismatch in region 1-3, bits 4-6 test of region 1-3 not passed\n");
+	fprintf(stderr, "Exit status is 1 if any dump failed a check or could not be decoded.\n");
+}
+
+int cmd_verify(int argc, char *argv[], const CommandOptions *options)
+{
+	int jobs = batch_default_jobs();
+	int ordered = 1;
+	int failed_only = 0;
+	InputSet inputs = { 0 };
+	int status = 0;
+
+	for (int i = 0; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc)
+		{
+			jobs = atoi(argv[++i]);
+			if (jobs < 1)
+			{
+				fprintf(stderr, "Error: --jobs must be at least 1\n");
+				inputs_free(&inputs);
+				return 1;
+			}
+		}
+		else if (strcmp(argv[i], "--unordered") == 0)
+		{
+			ordered = 0;
+		}
+		else if (strcmp(argv[i], "--failed") == 0)
+		{
+			failed_only = 1;
+		}
+		else if (strcmp(argv[i], "--help") == 0)
+		{
+			verify_usage();
+			inputs_free(&inputs);
+			return 0;
+		}
+		else if (inputs_add(&inputs, argv[i]) != 0)
+		{
+			fprintf(stderr, "Error: Cannot read %s: %s\n", argv[i], strerror(errno));
+			status = 1;
+		}
+	}
+
+	if (inputs.count == 0)
+	{
+		if (status == 0)
+		{
+			verify_usage();
+		}
+		inputs_free(&inputs);
+		return 1;
+	}
+
+	CommandOptions local = *options;
+	command_cache_open(&local, inputs.count);
+
+	VerifyJob job = { 0 };
+	job.inputs = &inputs;
+	job.options = &local;
+	job.failed_only = failed_only;
+	job.output = batch_output_create(STDOUT_FILENO, inputs.count, ordered);
+	if (!job.output)
+	{
+		fprintf(stderr, "Error: Out of memory\n");
+		command_cache_close(&local);
+		inputs_free(&inputs);
+		return 1;
+	}
+
+	struct timespec start, end;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	size_t chunks = (inputs.count + COMMAND_DECODE_CHUNK - 1) / COMMAND_DECODE_CHUNK;
+	if (batch_parallel_for(chunks, jobs, verify_chunk, &job) != 0)
+	{
+		fprintf(stderr, "Error: Cannot start worker threads\n");
+		status = 1;
+	}
+
+	if (batch_output_destroy(job.output) != 0)
+	{
+		fprintf(stderr, "Error: Cannot write output: %s\n", strerror(errno));
+		status = 1;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+	fprintf(stderr, "Verified %zu files: %zu ok, %zu CRC failures, %zu test failures, %zu errors (%.3f s, %.0f files/s, %d jobs)\n",
+			inputs.count, job.ok, job.crc_failures, job.test_failures, job.errors,
+			seconds, seconds > 0 ? inputs.count / seconds : 0.0, jobs);
+	for (int r = 0; r < EEPROM_MAX_REGIONS; r++)
+	{
+		if (job.region_crc[r] || job.region_test[r])
+		{
+			fprintf(stderr, "  region %d: %zu CRC mismatches, %zu tests not passed\n",
+					r + 1, job.region_crc[r], job.region_test[r]);
+		}
+	}
+
+	command_cache_close(&local);
+
+	if (job.errors || job.crc_failures || job.test_failures)
+	{
+		status = 1;
+	}
+
+	inputs_free(&inputs);
+	return status;
+}
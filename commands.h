@@ -0,0 +1,93 @@
+#ifndef COMMANDS_H
+#define COMMANDS_H
+
+// ═══════════════════════════════════════════════════════════════
+// Non-interactive commands: eeprom_tool [options] <command> [args]
+// ═══════════════════════════════════════════════════════════════
+
+#include <stdint.h>
+#include "eeprom_ops.h"
+#include "eeprom_cache.h"
+#include "eeprom_topology.h"
+
+// Global options given before the command
+typedef struct
+{
+	int discover_keys;             // --discover-keys
+	const char *cache_path;        // --cache FILE
+	EEPROMCache *cache;            // opened by commands that decode many dumps
+	const char *topology_dir;      // --topology DIR
+	const char *topology_cache;    // --topology-cache FILE
+} CommandOptions;
+
+// Opens options->cache_path sized for count new dumps. Without --cache,
+// or if the file cannot be opened (warning), options->cache stays NULL.
+void command_cache_open(CommandOptions *options, size_t count);
+// Prints the hit count and closes the cache
+void command_cache_close(CommandOptions *options);
+
+// Decodes a raw dump in place (key discovery if requested), through the
+// cache if one is open: a known image is copied, not decrypted
+int command_decode_result(uint8_t *data, const CommandOptions *options,
+						  EEPROMDecodeResult *result);
+
+// command_decode_result() for count <= COMMAND_DECODE_CHUNK dumps: the
+// ones not in the cache and without key discovery go through
+// eeprom_decode_many(), which decrypts same-key XXTEA boards together
+#define COMMAND_DECODE_CHUNK 32
+void command_decode_results(uint8_t *const data[], size_t count, const CommandOptions *options,
+							EEPROMDecodeResult results[], int status[]);
+
+// Warning on stderr if key discovery rewrote the header key byte of the dump
+void command_report_repair(const char *path, const EEPROMDecodeResult *result);
+
+// command_decode_result() and parse
+int command_decode_buffer(uint8_t *data, const CommandOptions *options,
+						  EEPROMDecodeResult *result, EEPROMRecord *record);
+
+// Same key selection, but decodes regions only as their fields are read
+int command_view_init(EEPROMView *view, const uint8_t *raw, const CommandOptions *options);
+
+// Maps the compiled index of the topol_*.conf configs in options->topology_dir,
+// compiling it into options->topology_cache (default
+// $XDG_CACHE_HOME/eeprom_tool/topology.eet) if the configs changed.
+// verbose: config errors as warnings on stderr.
+int command_topology_open(const CommandOptions *options, EEPROMTopology *topology, int verbose);
+
+// decode [--jobs N] [--unordered] [--format F] <files|dirs|archives...>
+int cmd_decode(int argc, char *argv[], const CommandOptions *options);
+
+// verify [--jobs N] [--unordered] [--failed] <files|dirs|archives...>
+int cmd_verify(int argc, char *argv[], const CommandOptions *options);
+
+// diff [--jobs N] [--format F] <old> <new>
+int cmd_diff(int argc, char *argv[], const CommandOptions *options);
+
+// sweep [--jobs N] [--boards [--unordered]] [--weakest N] <files|dirs|archives...>
+int cmd_sweep(int argc, char *argv[], const CommandOptions *options);
+
+// patch [--jobs N] [--board NAME] [--serial SN] (--output DIR | --in-place | --dry-run)
+//       [--force] field=value... <files|dirs|archives...>
+int cmd_patch(int argc, char *argv[], const CommandOptions *options);
+
+// topology [--rebuild] [--details] [board names|files|dirs|archives...]
+int cmd_topology(int argc, char *argv[], const CommandOptions *options);
+
+// pack [--jobs N] <archive.eea> <files|dirs|archives...>
+int cmd_pack(int argc, char *argv[], const CommandOptions *options);
+
+// unpack [--jobs N] <archive.eea> <directory>
+int cmd_unpack(int argc, char *argv[], const CommandOptions *options);
+
+// lookup [--format F] <archive.eea> <serial...>
+int cmd_lookup(int argc, char *argv[], const CommandOptions *options);
+
+#ifdef HAVE_I2C_SUPPORT
+// scan [--format F] [--save DIR] [/dev/i2c-N...]
+int cmd_scan(int argc, char *argv[], const CommandOptions *options);
+
+// flash [--addr 0x5N] [--full] [--force] <dump.bin> </dev/i2c-N>
+int cmd_flash(int argc, char *argv[], const CommandOptions *options);
+#endif
+
+#endif // COMMANDS_H
@@ -1,6 +1,9 @@
 #include "crypto.h"
 #include "eeprom_defs.h"
 #include <string.h>
+#include "aes.h"
+#include <stdio.h>
+#include <pthread.h>
 #include <openssl/evp.h>
 #include <openssl/aes.h>
 
@@ -109,6 +112,105 @@ void decode_data(uint8_t *data, size_t length, uint8_t algorithm_version,
 	}
 }
 
+// ═══════════════════════════════════════════════════════════════
+// Multi-buffer XXTEA: одна плата на SIMD-линию
+// ═══════════════════════════════════════════════════════════════
+// Внутри блока XXTEA последовательный, но платы независимы: слово p
+// всех плат группы хранится в одном векторе, раунды идут по линиям.
+
+#define XXTEA_LANES     8
+#define XXTEA_MAX_WORDS (EEPROM_SIZE / 4)
+
+typedef uint32_t xxtea_lanes_t __attribute__((vector_size(4 * XXTEA_LANES)));
+
+// AVX2 на x86 выбирается при загрузке (ifunc), иначе SSE2/NEON
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(__clang__)
+#define XXTEA_TARGET_CLONES __attribute__((target_clones("avx2", "default")))
+#else
+#define XXTEA_TARGET_CLONES
+#endif
+
+// Макрос, а не функция: вектор 256 бит нельзя вернуть по значению без AVX
+#define MX_LANES(sum, y, z, k) \
+	(((z >> 5 ^ y << 2) + (y >> 3 ^ z << 4)) ^ ((sum ^ y) + (k ^ z)))
+
+XXTEA_TARGET_CLONES
+static void XXTEA_decode_lanes(xxtea_lanes_t *v, int n, const uint32_t *k)
+{
+	xxtea_lanes_t y, z;
+	uint32_t sum;
+	unsigned p, rounds, e;
+
+	rounds = 6 + 52/n;
+	sum = rounds*DELTA;
+	y = v[0];
+	do {
+		e = (sum >> 2) & 3;
+		for (p=n-1; p>0; p--) {
+			z = v[p-1];
+			y = v[p] -= MX_LANES(sum, y, z, k[(p & 3) ^ e]);
+		}
+		z = v[n-1];
+		y = v[0] -= MX_LANES(sum, y, z, k[(p & 3) ^ e]);
+		sum -= DELTA;
+	} while (--rounds);
+}
+
+void decode_data_many(uint8_t *const data[], size_t count, size_t length,
+					  uint8_t algorithm_version, uint8_t key_index,
+					  EEPROMVersion eeprom_version)
+{
+	const int n = (int)(length / 4);
+
+	if (algorithm_version != CRYPTO_ALGORITHM_XXTEA || n < 2 || n > XXTEA_MAX_WORDS)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			decode_data(data[i], length, algorithm_version, key_index, eeprom_version);
+		}
+		return;
+	}
+
+	const uint8_t (*key_large)[16] = (eeprom_version == EEPROM_VERSION_V17)
+									 ? KEY_LARGE_V17
+									 : KEY_LARGE;
+	uint32_t k[4];
+	memcpy(k, key_large[key_index], sizeof(k));
+
+	xxtea_lanes_t v[XXTEA_MAX_WORDS];
+
+	for (size_t base = 0; base < count; base += XXTEA_LANES)
+	{
+		size_t lanes = count - base;
+		if (lanes > XXTEA_LANES) lanes = XXTEA_LANES;
+
+		// Транспонирование: слово p платы l -> v[p][l]
+		memset(v, 0, n * sizeof(v[0]));
+		for (size_t l = 0; l < lanes; l++)
+		{
+			const uint8_t *src = data[base + l];
+			for (int p = 0; p < n; p++)
+			{
+				uint32_t w;
+				memcpy(&w, src + 4*p, 4);
+				v[p][l] = w;
+			}
+		}
+
+		XXTEA_decode_lanes(v, n, k);
+
+		for (size_t l = 0; l < lanes; l++)
+		{
+			uint8_t *dst = data[base + l];
+			for (int p = 0; p < n; p++)
+			{
+				uint32_t w = v[p][l];
+				memcpy(dst + 4*p, &w, 4);
+			}
+		}
+	}
+}
+
 static const uint8_t CRC5_Lookup[256]=
 {// CRC-5/BITMAIN = x5 + x2 + 1 POLY=0x5
 0x00, 0x28, 0x50, 0x78, 0xA0, 0x88, 0xF0, 0xD8,
@@ -169,10 +271,314 @@ uint8_t calculate_crc(const uint8_t *ptr, size_t bits)
 // ═══════════════════════════════════════════════════════════════
 // Polynomial: 0x8C (reflected)
 // Initial value: 0x00
+// Slice-by-8: восемь байт за шаг по восьми таблицам
+static const uint8_t CRC8_Lookup[8][256]=
+{// CRC-8/MAXIM (Dallas 1-Wire) reflected POLY=0x8C, T[k][b] = CRC of b followed by k zero bytes
+{
+0x00, 0x5E, 0xBC, 0xE2, 0x61, 0x3F, 0xDD, 0x83,
+0xC2, 0x9C, 0x7E, 0x20, 0xA3, 0xFD, 0x1F, 0x41,
+0x9D, 0xC3, 0x21, 0x7F, 0xFC, 0xA2, 0x40, 0x1E,
+0x5F, 0x01, 0xE3, 0xBD, 0x3E, 0x60, 0x82, 0xDC,
+0x23, 0x7D, 0x9F, 0xC1, 0x42, 0x1C, 0xFE, 0xA0,
+0xE1, 0xBF, 0x5D, 0x03, 0x80, 0xDE, 0x3C, 0x62,
+0xBE, 0xE0, 0x02, 0x5C, 0xDF, 0x81, 0x63, 0x3D,
+0x7C, 0x22, 0xC0, 0x9E, 0x1D, 0x43, 0xA1, 0xFF,
+0x46, 0x18, 0xFA, 0xA4, 0x27, 0x79, 0x9B, 0xC5,
+0x84, 0xDA, 0x38, 0x66, 0xE5, 0xBB, 0x59, 0x07,
+0xDB, 0x85, 0x67, 0x39, 0xBA, 0xE4, 0x06, 0x58,
+0x19, 0x47, 0xA5, 0xFB, 0x78, 0x26, 0xC4, 0x9A,
+0x65, 0x3B, 0xD9, 0x87, 0x04, 0x5A, 0xB8, 0xE6,
+0xA7, 0xF9, 0x1B, 0x45, 0xC6, 0x98, 0x7A, 0x24,
+0xF8, 0xA6, 0x44, 0x1A, 0x99, 0xC7, 0x25, 0x7B,
+0x3A, 0x64, 0x86, 0xD8, 0x5B, 0x05, 0xE7, 0xB9,
+0x8C, 0xD2, 0x30, 0x6E, 0xED, 0xB3, 0x51, 0x0F,
+0x4E, 0x10, 0xF2, 0xAC, 0x2F, 0x71, 0x93, 0xCD,
+0x11, 0x4F, 0xAD, 0xF3, 0x70, 0x2E, 0xCC, 0x92,
+0xD3, 0x8D, 0x6F, 0x31, 0xB2, 0xEC, 0x0E, 0x50,
+0xAF, 0xF1, 0x13, 0x4D, 0xCE, 0x90, 0x72, 0x2C,
+0x6D, 0x33, 0xD1, 0x8F, 0x0C, 0x52, 0xB0, 0xEE,
+0x32, 0x6C, 0x8E, 0xD0, 0x53, 0x0D, 0xEF, 0xB1,
+0xF0, 0xAE, 0x4C, 0x12, 0x91, 0xCF, 0x2D, 0x73,
+0xCA, 0x94, 0x76, 0x28, 0xAB, 0xF5, 0x17, 0x49,
+0x08, 0x56, 0xB4, 0xEA, 0x69, 0x37, 0xD5, 0x8B,
+0x57, 0x09, 0xEB, 0xB5, 0x36, 0x68, 0x8A, 0xD4,
+0x95, 0xCB, 0x29, 0x77, 0xF4, 0xAA, 0x48, 0x16,
+0xE9, 0xB7, 0x55, 0x0B, 0x88, 0xD6, 0x34, 0x6A,
+0x2B, 0x75, 0x97, 0xC9, 0x4A, 0x14, 0xF6, 0xA8,
+0x74, 0x2A, 0xC8, 0x96, 0x15, 0x4B, 0xA9, 0xF7,
+0xB6, 0xE8, 0x0A, 0x54, 0xD7, 0x89, 0x6B, 0x35,
+},
+{
+0x00, 0xC4, 0x91, 0x55, 0x3B, 0xFF, 0xAA, 0x6E,
+0x76, 0xB2, 0xE7, 0x23, 0x4D, 0x89, 0xDC, 0x18,
+0xEC, 0x28, 0x7D, 0xB9, 0xD7, 0x13, 0x46, 0x82,
+0x9A, 0x5E, 0x0B, 0xCF, 0xA1, 0x65, 0x30, 0xF4,
+0xC1, 0x05, 0x50, 0x94, 0xFA, 0x3E, 0x6B, 0xAF,
+0xB7, 0x73, 0x26, 0xE2, 0x8C, 0x48, 0x1D, 0xD9,
+0x2D, 0xE9, 0xBC, 0x78, 0x16, 0xD2, 0x87, 0x43,
+0x5B, 0x9F, 0xCA, 0x0E, 0x60, 0xA4, 0xF1, 0x35,
+0x9B, 0x5F, 0x0A, 0xCE, 0xA0, 0x64, 0x31, 0xF5,
+0xED, 0x29, 0x7C, 0xB8, 0xD6, 0x12, 0x47, 0x83,
+0x77, 0xB3, 0xE6, 0x22, 0x4C, 0x88, 0xDD, 0x19,
+0x01, 0xC5, 0x90, 0x54, 0x3A, 0xFE, 0xAB, 0x6F,
+0x5A, 0x9E, 0xCB, 0x0F, 0x61, 0xA5, 0xF0, 0x34,
+0x2C, 0xE8, 0xBD, 0x79, 0x17, 0xD3, 0x86, 0x42,
+0xB6, 0x72, 0x27, 0xE3, 0x8D, 0x49, 0x1C, 0xD8,
+0xC0, 0x04, 0x51, 0x95, 0xFB, 0x3F, 0x6A, 0xAE,
+0x2F, 0xEB, 0xBE, 0x7A, 0x14, 0xD0, 0x85, 0x41,
+0x59, 0x9D, 0xC8, 0x0C, 0x62, 0xA6, 0xF3, 0x37,
+0xC3, 0x07, 0x52, 0x96, 0xF8, 0x3C, 0x69, 0xAD,
+0xB5, 0x71, 0x24, 0xE0, 0x8E, 0x4A, 0x1F, 0xDB,
+0xEE, 0x2A, 0x7F, 0xBB, 0xD5, 0x11, 0x44, 0x80,
+0x98, 0x5C, 0x09, 0xCD, 0xA3, 0x67, 0x32, 0xF6,
+0x02, 0xC6, 0x93, 0x57, 0x39, 0xFD, 0xA8, 0x6C,
+0x74, 0xB0, 0xE5, 0x21, 0x4F, 0x8B, 0xDE, 0x1A,
+0xB4, 0x70, 0x25, 0xE1, 0x8F, 0x4B, 0x1E, 0xDA,
+0xC2, 0x06, 0x53, 0x97, 0xF9, 0x3D, 0x68, 0xAC,
+0x58, 0x9C, 0xC9, 0x0D, 0x63, 0xA7, 0xF2, 0x36,
+0x2E, 0xEA, 0xBF, 0x7B, 0x15, 0xD1, 0x84, 0x40,
+0x75, 0xB1, 0xE4, 0x20, 0x4E, 0x8A, 0xDF, 0x1B,
+0x03, 0xC7, 0x92, 0x56, 0x38, 0xFC, 0xA9, 0x6D,
+0x99, 0x5D, 0x08, 0xCC, 0xA2, 0x66, 0x33, 0xF7,
+0xEF, 0x2B, 0x7E, 0xBA, 0xD4, 0x10, 0x45, 0x81,
+},
+{
+0x00, 0xAB, 0x4F, 0xE4, 0x9E, 0x35, 0xD1, 0x7A,
+0x25, 0x8E, 0x6A, 0xC1, 0xBB, 0x10, 0xF4, 0x5F,
+0x4A, 0xE1, 0x05, 0xAE, 0xD4, 0x7F, 0x9B, 0x30,
+0x6F, 0xC4, 0x20, 0x8B, 0xF1, 0x5A, 0xBE, 0x15,
+0x94, 0x3F, 0xDB, 0x70, 0x0A, 0xA1, 0x45, 0xEE,
+0xB1, 0x1A, 0xFE, 0x55, 0x2F, 0x84, 0x60, 0xCB,
+0xDE, 0x75, 0x91, 0x3A, 0x40, 0xEB, 0x0F, 0xA4,
+0xFB, 0x50, 0xB4, 0x1F, 0x65, 0xCE, 0x2A, 0x81,
+0x31, 0x9A, 0x7E, 0xD5, 0xAF, 0x04, 0xE0, 0x4B,
+0x14, 0xBF, 0x5B, 0xF0, 0x8A, 0x21, 0xC5, 0x6E,
+0x7B, 0xD0, 0x34, 0x9F, 0xE5, 0x4E, 0xAA, 0x01,
+0x5E, 0xF5, 0x11, 0xBA, 0xC0, 0x6B, 0x8F, 0x24,
+0xA5, 0x0E, 0xEA, 0x41, 0x3B, 0x90, 0x74, 0xDF,
+0x80, 0x2B, 0xCF, 0x64, 0x1E, 0xB5, 0x51, 0xFA,
+0xEF, 0x44, 0xA0, 0x0B, 0x71, 0xDA, 0x3E, 0x95,
+0xCA, 0x61, 0x85, 0x2E, 0x54, 0xFF, 0x1B, 0xB0,
+0x62, 0xC9, 0x2D, 0x86, 0xFC, 0x57, 0xB3, 0x18,
+0x47, 0xEC, 0x08, 0xA3, 0xD9, 0x72, 0x96, 0x3D,
+0x28, 0x83, 0x67, 0xCC, 0xB6, 0x1D, 0xF9, 0x52,
+0x0D, 0xA6, 0x42, 0xE9, 0x93, 0x38, 0xDC, 0x77,
+0xF6, 0x5D, 0xB9, 0x12, 0x68, 0xC3, 0x27, 0x8C,
+0xD3, 0x78, 0x9C, 0x37, 0x4D, 0xE6, 0x02, 0xA9,
+0xBC, 0x17, 0xF3, 0x58, 0x22, 0x89, 0x6D, 0xC6,
+0x99, 0x32, 0xD6, 0x7D, 0x07, 0xAC, 0x48, 0xE3,
+0x53, 0xF8, 0x1C, 0xB7, 0xCD, 0x66, 0x82, 0x29,
+0x76, 0xDD, 0x39, 0x92, 0xE8, 0x43, 0xA7, 0x0C,
+0x19, 0xB2, 0x56, 0xFD, 0x87, 0x2C, 0xC8, 0x63,
+0x3C, 0x97, 0x73, 0xD8, 0xA2, 0x09, 0xED, 0x46,
+0xC7, 0x6C, 0x88, 0x23, 0x59, 0xF2, 0x16, 0xBD,
+0xE2, 0x49, 0xAD, 0x06, 0x7C, 0xD7, 0x33, 0x98,
+0x8D, 0x26, 0xC2, 0x69, 0x13, 0xB8, 0x5C, 0xF7,
+0xA8, 0x03, 0xE7, 0x4C, 0x36, 0x9D, 0x79, 0xD2,
+},
+{
+0x00, 0x8F, 0x07, 0x88, 0x0E, 0x81, 0x09, 0x86,
+0x1C, 0x93, 0x1B, 0x94, 0x12, 0x9D, 0x15, 0x9A,
+0x38, 0xB7, 0x3F, 0xB0, 0x36, 0xB9, 0x31, 0xBE,
+0x24, 0xAB, 0x23, 0xAC, 0x2A, 0xA5, 0x2D, 0xA2,
+0x70, 0xFF, 0x77, 0xF8, 0x7E, 0xF1, 0x79, 0xF6,
+0x6C, 0xE3, 0x6B, 0xE4, 0x62, 0xED, 0x65, 0xEA,
+0x48, 0xC7, 0x4F, 0xC0, 0x46, 0xC9, 0x41, 0xCE,
+0x54, 0xDB, 0x53, 0xDC, 0x5A, 0xD5, 0x5D, 0xD2,
+0xE0, 0x6F, 0xE7, 0x68, 0xEE, 0x61, 0xE9, 0x66,
+0xFC, 0x73, 0xFB, 0x74, 0xF2, 0x7D, 0xF5, 0x7A,
+0xD8, 0x57, 0xDF, 0x50, 0xD6, 0x59, 0xD1, 0x5E,
+0xC4, 0x4B, 0xC3, 0x4C, 0xCA, 0x45, 0xCD, 0x42,
+0x90, 0x1F, 0x97, 0x18, 0x9E, 0x11, 0x99, 0x16,
+0x8C, 0x03, 0x8B, 0x04, 0x82, 0x0D, 0x85, 0x0A,
+0xA8, 0x27, 0xAF, 0x20, 0xA6, 0x29, 0xA1, 0x2E,
+0xB4, 0x3B, 0xB3, 0x3C, 0xBA, 0x35, 0xBD, 0x32,
+0xD9, 0x56, 0xDE, 0x51, 0xD7, 0x58, 0xD0, 0x5F,
+0xC5, 0x4A, 0xC2, 0x4D, 0xCB, 0x44, 0xCC, 0x43,
+0xE1, 0x6E, 0xE6, 0x69, 0xEF, 0x60, 0xE8, 0x67,
+0xFD, 0x72, 0xFA, 0x75, 0xF3, 0x7C, 0xF4, 0x7B,
+0xA9, 0x26, 0xAE, 0x21, 0xA7, 0x28, 0xA0, 0x2F,
+0xB5, 0x3A, 0xB2, 0x3D, 0xBB, 0x34, 0xBC, 0x33,
+0x91, 0x1E, 0x96, 0x19, 0x9F, 0x10, 0x98, 0x17,
+0x8D, 0x02, 0x8A, 0x05, 0x83, 0x0C, 0x84, 0x0B,
+0x39, 0xB6, 0x3E, 0xB1, 0x37, 0xB8, 0x30, 0xBF,
+0x25, 0xAA, 0x22, 0xAD, 0x2B, 0xA4, 0x2C, 0xA3,
+0x01, 0x8E, 0x06, 0x89, 0x0F, 0x80, 0x08, 0x87,
+0x1D, 0x92, 0x1A, 0x95, 0x13, 0x9C, 0x14, 0x9B,
+0x49, 0xC6, 0x4E, 0xC1, 0x47, 0xC8, 0x40, 0xCF,
+0x55, 0xDA, 0x52, 0xDD, 0x5B, 0xD4, 0x5C, 0xD3,
+0x71, 0xFE, 0x76, 0xF9, 0x7F, 0xF0, 0x78, 0xF7,
+0x6D, 0xE2, 0x6A, 0xE5, 0x63, 0xEC, 0x64, 0xEB,
+},
+{
+0x00, 0xCD, 0x83, 0x4E, 0x1F, 0xD2, 0x9C, 0x51,
+0x3E, 0xF3, 0xBD, 0x70, 0x21, 0xEC, 0xA2, 0x6F,
+0x7C, 0xB1, 0xFF, 0x32, 0x63, 0xAE, 0xE0, 0x2D,
+0x42, 0x8F, 0xC1, 0x0C, 0x5D, 0x90, 0xDE, 0x13,
+0xF8, 0x35, 0x7B, 0xB6, 0xE7, 0x2A, 0x64, 0xA9,
+0xC6, 0x0B, 0x45, 0x88, 0xD9, 0x14, 0x5A, 0x97,
+0x84, 0x49, 0x07, 0xCA, 0x9B, 0x56, 0x18, 0xD5,
+0xBA, 0x77, 0x39, 0xF4, 0xA5, 0x68, 0x26, 0xEB,
+0xE9, 0x24, 0x6A, 0xA7, 0xF6, 0x3B, 0x75, 0xB8,
+0xD7, 0x1A, 0x54, 0x99, 0xC8, 0x05, 0x4B, 0x86,
+0x95, 0x58, 0x16, 0xDB, 0x8A, 0x47, 0x09, 0xC4,
+0xAB, 0x66, 0x28, 0xE5, 0xB4, 0x79, 0x37, 0xFA,
+0x11, 0xDC, 0x92, 0x5F, 0x0E, 0xC3, 0x8D, 0x40,
+0x2F, 0xE2, 0xAC, 0x61, 0x30, 0xFD, 0xB3, 0x7E,
+0x6D, 0xA0, 0xEE, 0x23, 0x72, 0xBF, 0xF1, 0x3C,
+0x53, 0x9E, 0xD0, 0x1D, 0x4C, 0x81, 0xCF, 0x02,
+0xCB, 0x06, 0x48, 0x85, 0xD4, 0x19, 0x57, 0x9A,
+0xF5, 0x38, 0x76, 0xBB, 0xEA, 0x27, 0x69, 0xA4,
+0xB7, 0x7A, 0x34, 0xF9, 0xA8, 0x65, 0x2B, 0xE6,
+0x89, 0x44, 0x0A, 0xC7, 0x96, 0x5B, 0x15, 0xD8,
+0x33, 0xFE, 0xB0, 0x7D, 0x2C, 0xE1, 0xAF, 0x62,
+0x0D, 0xC0, 0x8E, 0x43, 0x12, 0xDF, 0x91, 0x5C,
+0x4F, 0x82, 0xCC, 0x01, 0x50, 0x9D, 0xD3, 0x1E,
+0x71, 0xBC, 0xF2, 0x3F, 0x6E, 0xA3, 0xED, 0x20,
+0x22, 0xEF, 0xA1, 0x6C, 0x3D, 0xF0, 0xBE, 0x73,
+0x1C, 0xD1, 0x9F, 0x52, 0x03, 0xCE, 0x80, 0x4D,
+0x5E, 0x93, 0xDD, 0x10, 0x41, 0x8C, 0xC2, 0x0F,
+0x60, 0xAD, 0xE3, 0x2E, 0x7F, 0xB2, 0xFC, 0x31,
+0xDA, 0x17, 0x59, 0x94, 0xC5, 0x08, 0x46, 0x8B,
+0xE4, 0x29, 0x67, 0xAA, 0xFB, 0x36, 0x78, 0xB5,
+0xA6, 0x6B, 0x25, 0xE8, 0xB9, 0x74, 0x3A, 0xF7,
+0x98, 0x55, 0x1B, 0xD6, 0x87, 0x4A, 0x04, 0xC9,
+},
+{
+0x00, 0x37, 0x6E, 0x59, 0xDC, 0xEB, 0xB2, 0x85,
+0xA1, 0x96, 0xCF, 0xF8, 0x7D, 0x4A, 0x13, 0x24,
+0x5B, 0x6C, 0x35, 0x02, 0x87, 0xB0, 0xE9, 0xDE,
+0xFA, 0xCD, 0x94, 0xA3, 0x26, 0x11, 0x48, 0x7F,
+0xB6, 0x81, 0xD8, 0xEF, 0x6A, 0x5D, 0x04, 0x33,
+0x17, 0x20, 0x79, 0x4E, 0xCB, 0xFC, 0xA5, 0x92,
+0xED, 0xDA, 0x83, 0xB4, 0x31, 0x06, 0x5F, 0x68,
+0x4C, 0x7B, 0x22, 0x15, 0x90, 0xA7, 0xFE, 0xC9,
+0x75, 0x42, 0x1B, 0x2C, 0xA9, 0x9E, 0xC7, 0xF0,
+0xD4, 0xE3, 0xBA, 0x8D, 0x08, 0x3F, 0x66, 0x51,
+0x2E, 0x19, 0x40, 0x77, 0xF2, 0xC5, 0x9C, 0xAB,
+0x8F, 0xB8, 0xE1, 0xD6, 0x53, 0x64, 0x3D, 0x0A,
+0xC3, 0xF4, 0xAD, 0x9A, 0x1F, 0x28, 0x71, 0x46,
+0x62, 0x55, 0x0C, 0x3B, 0xBE, 0x89, 0xD0, 0xE7,
+0x98, 0xAF, 0xF6, 0xC1, 0x44, 0x73, 0x2A, 0x1D,
+0x39, 0x0E, 0x57, 0x60, 0xE5, 0xD2, 0x8B, 0xBC,
+0xEA, 0xDD, 0x84, 0xB3, 0x36, 0x01, 0x58, 0x6F,
+0x4B, 0x7C, 0x25, 0x12, 0x97, 0xA0, 0xF9, 0xCE,
+0xB1, 0x86, 0xDF, 0xE8, 0x6D, 0x5A, 0x03, 0x34,
+0x10, 0x27, 0x7E, 0x49, 0xCC, 0xFB, 0xA2, 0x95,
+0x5C, 0x6B, 0x32, 0x05, 0x80, 0xB7, 0xEE, 0xD9,
+0xFD, 0xCA, 0x93, 0xA4, 0x21, 0x16, 0x4F, 0x78,
+0x07, 0x30, 0x69, 0x5E, 0xDB, 0xEC, 0xB5, 0x82,
+0xA6, 0x91, 0xC8, 0xFF, 0x7A, 0x4D, 0x14, 0x23,
+0x9F, 0xA8, 0xF1, 0xC6, 0x43, 0x74, 0x2D, 0x1A,
+0x3E, 0x09, 0x50, 0x67, 0xE2, 0xD5, 0x8C, 0xBB,
+0xC4, 0xF3, 0xAA, 0x9D, 0x18, 0x2F, 0x76, 0x41,
+0x65, 0x52, 0x0B, 0x3C, 0xB9, 0x8E, 0xD7, 0xE0,
+0x29, 0x1E, 0x47, 0x70, 0xF5, 0xC2, 0x9B, 0xAC,
+0x88, 0xBF, 0xE6, 0xD1, 0x54, 0x63, 0x3A, 0x0D,
+0x72, 0x45, 0x1C, 0x2B, 0xAE, 0x99, 0xC0, 0xF7,
+0xD3, 0xE4, 0xBD, 0x8A, 0x0F, 0x38, 0x61, 0x56,
+},
+{
+0x00, 0x3D, 0x7A, 0x47, 0xF4, 0xC9, 0x8E, 0xB3,
+0xF1, 0xCC, 0x8B, 0xB6, 0x05, 0x38, 0x7F, 0x42,
+0xFB, 0xC6, 0x81, 0xBC, 0x0F, 0x32, 0x75, 0x48,
+0x0A, 0x37, 0x70, 0x4D, 0xFE, 0xC3, 0x84, 0xB9,
+0xEF, 0xD2, 0x95, 0xA8, 0x1B, 0x26, 0x61, 0x5C,
+0x1E, 0x23, 0x64, 0x59, 0xEA, 0xD7, 0x90, 0xAD,
+0x14, 0x29, 0x6E, 0x53, 0xE0, 0xDD, 0x9A, 0xA7,
+0xE5, 0xD8, 0x9F, 0xA2, 0x11, 0x2C, 0x6B, 0x56,
+0xC7, 0xFA, 0xBD, 0x80, 0x33, 0x0E, 0x49, 0x74,
+0x36, 0x0B, 0x4C, 0x71, 0xC2, 0xFF, 0xB8, 0x85,
+0x3C, 0x01, 0x46, 0x7B, 0xC8, 0xF5, 0xB2, 0x8F,
+0xCD, 0xF0, 0xB7, 0x8A, 0x39, 0x04, 0x43, 0x7E,
+0x28, 0x15, 0x52, 0x6F, 0xDC, 0xE1, 0xA6, 0x9B,
+0xD9, 0xE4, 0xA3, 0x9E, 0x2D, 0x10, 0x57, 0x6A,
+0xD3, 0xEE, 0xA9, 0x94, 0x27, 0x1A, 0x5D, 0x60,
+0x22, 0x1F, 0x58, 0x65, 0xD6, 0xEB, 0xAC, 0x91,
+0x97, 0xAA, 0xED, 0xD0, 0x63, 0x5E, 0x19, 0x24,
+0x66, 0x5B, 0x1C, 0x21, 0x92, 0xAF, 0xE8, 0xD5,
+0x6C, 0x51, 0x16, 0x2B, 0x98, 0xA5, 0xE2, 0xDF,
+0x9D, 0xA0, 0xE7, 0xDA, 0x69, 0x54, 0x13, 0x2E,
+0x78, 0x45, 0x02, 0x3F, 0x8C, 0xB1, 0xF6, 0xCB,
+0x89, 0xB4, 0xF3, 0xCE, 0x7D, 0x40, 0x07, 0x3A,
+0x83, 0xBE, 0xF9, 0xC4, 0x77, 0x4A, 0x0D, 0x30,
+0x72, 0x4F, 0x08, 0x35, 0x86, 0xBB, 0xFC, 0xC1,
+0x50, 0x6D, 0x2A, 0x17, 0xA4, 0x99, 0xDE, 0xE3,
+0xA1, 0x9C, 0xDB, 0xE6, 0x55, 0x68, 0x2F, 0x12,
+0xAB, 0x96, 0xD1, 0xEC, 0x5F, 0x62, 0x25, 0x18,
+0x5A, 0x67, 0x20, 0x1D, 0xAE, 0x93, 0xD4, 0xE9,
+0xBF, 0x82, 0xC5, 0xF8, 0x4B, 0x76, 0x31, 0x0C,
+0x4E, 0x73, 0x34, 0x09, 0xBA, 0x87, 0xC0, 0xFD,
+0x44, 0x79, 0x3E, 0x03, 0xB0, 0x8D, 0xCA, 0xF7,
+0xB5, 0x88, 0xCF, 0xF2, 0x41, 0x7C, 0x3B, 0x06,
+},
+{
+0x00, 0x43, 0x86, 0xC5, 0x15, 0x56, 0x93, 0xD0,
+0x2A, 0x69, 0xAC, 0xEF, 0x3F, 0x7C, 0xB9, 0xFA,
+0x54, 0x17, 0xD2, 0x91, 0x41, 0x02, 0xC7, 0x84,
+0x7E, 0x3D, 0xF8, 0xBB, 0x6B, 0x28, 0xED, 0xAE,
+0xA8, 0xEB, 0x2E, 0x6D, 0xBD, 0xFE, 0x3B, 0x78,
+0x82, 0xC1, 0x04, 0x47, 0x97, 0xD4, 0x11, 0x52,
+0xFC, 0xBF, 0x7A, 0x39, 0xE9, 0xAA, 0x6F, 0x2C,
+0xD6, 0x95, 0x50, 0x13, 0xC3, 0x80, 0x45, 0x06,
+0x49, 0x0A, 0xCF, 0x8C, 0x5C, 0x1F, 0xDA, 0x99,
+0x63, 0x20, 0xE5, 0xA6, 0x76, 0x35, 0xF0, 0xB3,
+0x1D, 0x5E, 0x9B, 0xD8, 0x08, 0x4B, 0x8E, 0xCD,
+0x37, 0x74, 0xB1, 0xF2, 0x22, 0x61, 0xA4, 0xE7,
+0xE1, 0xA2, 0x67, 0x24, 0xF4, 0xB7, 0x72, 0x31,
+0xCB, 0x88, 0x4D, 0x0E, 0xDE, 0x9D, 0x58, 0x1B,
+0xB5, 0xF6, 0x33, 0x70, 0xA0, 0xE3, 0x26, 0x65,
+0x9F, 0xDC, 0x19, 0x5A, 0x8A, 0xC9, 0x0C, 0x4F,
+0x92, 0xD1, 0x14, 0x57, 0x87, 0xC4, 0x01, 0x42,
+0xB8, 0xFB, 0x3E, 0x7D, 0xAD, 0xEE, 0x2B, 0x68,
+0xC6, 0x85, 0x40, 0x03, 0xD3, 0x90, 0x55, 0x16,
+0xEC, 0xAF, 0x6A, 0x29, 0xF9, 0xBA, 0x7F, 0x3C,
+0x3A, 0x79, 0xBC, 0xFF, 0x2F, 0x6C, 0xA9, 0xEA,
+0x10, 0x53, 0x96, 0xD5, 0x05, 0x46, 0x83, 0xC0,
+0x6E, 0x2D, 0xE8, 0xAB, 0x7B, 0x38, 0xFD, 0xBE,
+0x44, 0x07, 0xC2, 0x81, 0x51, 0x12, 0xD7, 0x94,
+0xDB, 0x98, 0x5D, 0x1E, 0xCE, 0x8D, 0x48, 0x0B,
+0xF1, 0xB2, 0x77, 0x34, 0xE4, 0xA7, 0x62, 0x21,
+0x8F, 0xCC, 0x09, 0x4A, 0x9A, 0xD9, 0x1C, 0x5F,
+0xA5, 0xE6, 0x23, 0x60, 0xB0, 0xF3, 0x36, 0x75,
+0x73, 0x30, 0xF5, 0xB6, 0x66, 0x25, 0xE0, 0xA3,
+0x59, 0x1A, 0xDF, 0x9C, 0x4C, 0x0F, 0xCA, 0x89,
+0x27, 0x64, 0xA1, 0xE2, 0x32, 0x71, 0xB4, 0xF7,
+0x0D, 0x4E, 0x8B, 0xC8, 0x18, 0x5B, 0x9E, 0xDD,
+},
+};
+
 uint8_t calculate_crc8_v1(const uint8_t *data, size_t length)
 {
 	uint8_t crc = 0;
 
+	for (; length >= 8; data += 8, length -= 8)
+	{
+		uint64_t x;
+		memcpy(&x, data, 8);
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+		x = __builtin_bswap64(x);
+#endif
+		x ^= crc;
+		crc = CRC8_Lookup[7][(x      ) & 0xFF] ^ CRC8_Lookup[6][(x >>  8) & 0xFF]
+			^ CRC8_Lookup[5][(x >> 16) & 0xFF] ^ CRC8_Lookup[4][(x >> 24) & 0xFF]
+			^ CRC8_Lookup[3][(x >> 32) & 0xFF] ^ CRC8_Lookup[2][(x >> 40) & 0xFF]
+			^ CRC8_Lookup[1][(x >> 48) & 0xFF] ^ CRC8_Lookup[0][(x >> 56)       ];
+	}
+
+	while (length--)
+	{
+		crc = CRC8_Lookup[0][crc ^ *data++];
+	}
+
+	return crc;
+}
+
+// Побитовый эталон для самотестирования
+static uint8_t crc8_v1_bitwise(const uint8_t *data, size_t length)
+{
+	uint8_t crc = 0;
+
 	for (size_t i = 0; i < length; i++)
 	{
 		crc ^= data[i];
@@ -265,95 +671,456 @@ static void derive_aes_key_v1(uint32_t encryption_key, uint8_t aes_key[32], uint
 	}
 }
 
-int decode_data_v1(uint8_t *data, size_t length, uint32_t encryption_key)
+// ═══════════════════════════════════════════════════════════════
+// AES backend registry
+// ═══════════════════════════════════════════════════════════════
+
+// OpenSSL EVP: в контексте хранится сам ключ, развертывание выполняет OpenSSL
+static void AES_openssl_KeyExpansion(AES_Ctx *ctx, const uint8_t *key, int klen, int ekb)
+{
+	memset(ctx->K, 0, sizeof(ctx->K));
+	memcpy(ctx->K, key, klen);
+	ctx->nr = (klen == 32) ? 14 : 10;
+}
+
+static int AES_openssl_CBC_crypt(const AES_Ctx *ctx, uint8_t *dst, const uint8_t *src,
+								 int length, int encrypt)
+{
+	const EVP_CIPHER *cipher = (ctx->nr == 14) ? EVP_aes_256_cbc() : EVP_aes_128_cbc();
+
+	EVP_CIPHER_CTX *evp = EVP_CIPHER_CTX_new();
+	if (!evp) return -1;
+
+	int ok = EVP_CipherInit_ex(evp, cipher, NULL, &ctx->K[0][0], ctx->iv, encrypt) == 1;
+	EVP_CIPHER_CTX_set_padding(evp, 0);
+
+	int len = 0;
+	int final_len = 0;
+	ok = ok && EVP_CipherUpdate(evp, dst, &len, src, length) == 1;
+	ok = ok && EVP_CipherFinal_ex(evp, dst + len, &final_len) == 1;
+
+	EVP_CIPHER_CTX_free(evp);
+	return ok ? 0 : -1;
+}
+
+static int AES_openssl_CBC_encrypt(const AES_Ctx *ctx, uint8_t *dst, const uint8_t *src, int length)
+{
+	return AES_openssl_CBC_crypt(ctx, dst, src, length, 1);
+}
+
+static int AES_openssl_CBC_decrypt(const AES_Ctx *ctx, uint8_t *dst, const uint8_t *src, int length)
+{
+	return AES_openssl_CBC_crypt(ctx, dst, src, length, 0);
+}
+
+static int AES_openssl_probe(void)
+{
+	return 1;
+}
+
+static const AES_Backend AES_backend_openssl = {
+	.name = "openssl",
+	.probe = AES_openssl_probe,
+	.key_expansion = AES_openssl_KeyExpansion,
+	.cbc_encrypt = AES_openssl_CBC_encrypt,
+	.cbc_decrypt = AES_openssl_CBC_decrypt,
+};
+
+// В порядке предпочтения: первая доступная реализация выбирается автоматически
+static const AES_Backend *const crypto_backends[] =
+{
+#ifdef HAVE_AES_NI
+	&AES_backend_ni,
+#endif
+#ifdef HAVE_AES_ARM
+	&AES_backend_arm,
+#endif
+	&AES_backend_openssl,
+	&AES_backend_soft,
+};
+
+#define CRYPTO_BACKEND_COUNT (sizeof(crypto_backends) / sizeof(crypto_backends[0]))
+
+static const AES_Backend *crypto_backend;
+
+// ═══════════════════════════════════════════════════════════════
+// Развернутые ключи для v1
+// ═══════════════════════════════════════════════════════════════
+
+typedef struct
+{
+	const AES_Backend *backend;
+	uint32_t encryption_key;
+	uint8_t xor_key;
+	AES_Ctx enc;
+	AES_Ctx dec;
+} V1KeySchedule;
+
+static V1KeySchedule v1_production_schedule;
+static pthread_once_t crypto_backend_once = PTHREAD_ONCE_INIT;
+
+static void v1_key_schedule_init(V1KeySchedule *ks, const AES_Backend *backend,
+								 uint32_t encryption_key)
 {
 	uint8_t aes_key[32];
 	uint8_t aes_iv[16];
+	uint8_t crypto_table_1[32];
 
 	derive_aes_key_v1(encryption_key, aes_key, aes_iv);
+	xor_with_key_dword(crypto_table_1, KEY_PHRASE_1_V1, 32, encryption_key);
 
-	EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
-	if (!ctx) return -1;
+	ks->backend = backend;
+	ks->encryption_key = encryption_key;
+	ks->xor_key = crypto_table_1[1];
 
-	if (EVP_DecryptInit_ex(ctx, EVP_aes_256_cbc(), NULL, aes_key, aes_iv) != 1)
+	backend->key_expansion(&ks->enc, aes_key, 32, 256);
+	AES_set_iv(&ks->enc, aes_iv, 16);
+	backend->key_expansion(&ks->dec, aes_key, 32, 256 | (1u << 16));
+	AES_set_iv(&ks->dec, aes_iv, 16);
+}
+
+static void crypto_backend_use(const AES_Backend *backend)
+{
+	crypto_backend = backend;
+	// Ключ производства разворачивается один раз при выборе реализации
+	v1_key_schedule_init(&v1_production_schedule, backend, EEPROM_V1_KEY_PRODUCTION);
+}
+
+static void crypto_backend_autoselect(void)
+{
+	for (size_t i = 0; i < CRYPTO_BACKEND_COUNT; i++)
 	{
-		EVP_CIPHER_CTX_free(ctx);
-		return -1;
+		if (crypto_backends[i]->probe())
+		{
+			crypto_backend_use(crypto_backends[i]);
+			return;
+		}
+	}
+}
+
+static const AES_Backend* crypto_backend_find(const char *name)
+{
+	for (size_t i = 0; i < CRYPTO_BACKEND_COUNT; i++)
+	{
+		if (strcmp(crypto_backends[i]->name, name) == 0)
+		{
+			return crypto_backends[i];
+		}
 	}
+	return NULL;
+}
 
-	EVP_CIPHER_CTX_set_padding(ctx, 0);
+int crypto_set_backend(const char *name)
+{
+	pthread_once(&crypto_backend_once, crypto_backend_autoselect);
 
-	int len;
-	if (EVP_DecryptUpdate(ctx, data, &len, data, length) != 1)
+	if (name == NULL || strcmp(name, "auto") == 0)
 	{
-		EVP_CIPHER_CTX_free(ctx);
-		return -1;
+		crypto_backend_autoselect();
+		return 0;
 	}
 
-	int final_len;
-	if (EVP_DecryptFinal_ex(ctx, data + len, &final_len) != 1)
+	const AES_Backend *backend = crypto_backend_find(name);
+	if (!backend || !backend->probe())
 	{
-		EVP_CIPHER_CTX_free(ctx);
 		return -1;
 	}
 
-	EVP_CIPHER_CTX_free(ctx);
+	crypto_backend_use(backend);
+	return 0;
+}
 
-	uint8_t crypto_table_1[32];
-	xor_with_key_dword(crypto_table_1, KEY_PHRASE_1_V1, 32, encryption_key);
-	uint8_t xor_key = crypto_table_1[1];
+const char* crypto_backend_name(void)
+{
+	pthread_once(&crypto_backend_once, crypto_backend_autoselect);
+	return crypto_backend->name;
+}
+
+const char* crypto_backend_get(size_t index, int *available)
+{
+	if (index >= CRYPTO_BACKEND_COUNT)
+	{
+		return NULL;
+	}
+	if (available)
+	{
+		*available = crypto_backends[index]->probe();
+	}
+	return crypto_backends[index]->name;
+}
+
+// Non-production keys are expanded into the caller-provided storage.
+static const V1KeySchedule* v1_key_schedule_get(uint32_t encryption_key, V1KeySchedule *storage)
+{
+	pthread_once(&crypto_backend_once, crypto_backend_autoselect);
+
+	if (encryption_key == EEPROM_V1_KEY_PRODUCTION)
+	{
+		return &v1_production_schedule;
+	}
+
+	v1_key_schedule_init(storage, crypto_backend, encryption_key);
+	return storage;
+}
+
+static int v1_decode_with(const V1KeySchedule *ks, uint8_t *data, size_t length)
+{
+	if (length % 16) return -1;
+
+	if (ks->backend->cbc_decrypt(&ks->dec, data, data, length) != 0)
+	{
+		return -1;
+	}
 
 	for (size_t i = 0; i < length; i++)
 	{
-		data[i] ^= xor_key;
+		data[i] ^= ks->xor_key;
 	}
 
 	return 0;
 }
 
+static int v1_encode_with(const V1KeySchedule *ks, uint8_t *data, size_t length)
+{
+	if (length % 16) return -1;
+
+	for (size_t i = 0; i < length; i++)
+	{
+		data[i] ^= ks->xor_key;
+	}
+
+	return ks->backend->cbc_encrypt(&ks->enc, data, data, length);
+}
+
+int decode_data_v1(uint8_t *data, size_t length, uint32_t encryption_key)
+{
+	V1KeySchedule storage;
+	return v1_decode_with(v1_key_schedule_get(encryption_key, &storage), data, length);
+}
+
 int encode_data_v1(uint8_t *data, size_t length, uint32_t encryption_key)
 {
-	uint8_t aes_key[32];
-	uint8_t aes_iv[16];
+	V1KeySchedule storage;
+	return v1_encode_with(v1_key_schedule_get(encryption_key, &storage), data, length);
+}
 
-	derive_aes_key_v1(encryption_key, aes_key, aes_iv);
+// ═══════════════════════════════════════════════════════════════
+// Self-test: все реализации на одних и тех же векторах
+// ═══════════════════════════════════════════════════════════════
 
-	// XOR pre-processing
-	uint8_t crypto_table_1[32];
-	xor_with_key_dword(crypto_table_1, KEY_PHRASE_1_V1, 32, encryption_key);
-	uint8_t xor_key = crypto_table_1[1];
+// NIST SP 800-38A, F.2.1 - F.2.6
+static const uint8_t SELFTEST_IV[16] =
+{
+	0x00,0x01,0x02,0x03, 0x04,0x05,0x06,0x07, 0x08,0x09,0x0A,0x0B, 0x0C,0x0D,0x0E,0x0F
+};
 
-	for (size_t i = 0; i < length; i++)
+static const uint8_t SELFTEST_PLAINTEXT[64] =
+{
+	0x6B,0xC1,0xBE,0xE2, 0x2E,0x40,0x9F,0x96, 0xE9,0x3D,0x7E,0x11, 0x73,0x93,0x17,0x2A,
+	0xAE,0x2D,0x8A,0x57, 0x1E,0x03,0xAC,0x9C, 0x9E,0xB7,0x6F,0xAC, 0x45,0xAF,0x8E,0x51,
+	0x30,0xC8,0x1C,0x46, 0xA3,0x5C,0xE4,0x11, 0xE5,0xFB,0xC1,0x19, 0x1A,0x0A,0x52,0xEF,
+	0xF6,0x9F,0x24,0x45, 0xDF,0x4F,0x9B,0x17, 0xAD,0x2B,0x41,0x7B, 0xE6,0x6C,0x37,0x10,
+};
+
+static const uint8_t SELFTEST_KEY128[16] =
+{
+	0x2B,0x7E,0x15,0x16, 0x28,0xAE,0xD2,0xA6, 0xAB,0xF7,0x15,0x88, 0x09,0xCF,0x4F,0x3C
+};
+
+static const uint8_t SELFTEST_CIPHERTEXT128[64] =
+{
+	0x76,0x49,0xAB,0xAC, 0x81,0x19,0xB2,0x46, 0xCE,0xE9,0x8E,0x9B, 0x12,0xE9,0x19,0x7D,
+	0x50,0x86,0xCB,0x9B, 0x50,0x72,0x19,0xEE, 0x95,0xDB,0x11,0x3A, 0x91,0x76,0x78,0xB2,
+	0x73,0xBE,0xD6,0xB8, 0xE3,0xC1,0x74,0x3B, 0x71,0x16,0xE6,0x9E, 0x22,0x22,0x95,0x16,
+	0x3F,0xF1,0xCA,0xA1, 0x68,0x1F,0xAC,0x09, 0x12,0x0E,0xCA,0x30, 0x75,0x86,0xE1,0xA7,
+};
+
+static const uint8_t SELFTEST_KEY256[32] =
+{
+	0x60,0x3D,0xEB,0x10, 0x15,0xCA,0x71,0xBE, 0x2B,0x73,0xAE,0xF0, 0x85,0x7D,0x77,0x81,
+	0x1F,0x35,0x2C,0x07, 0x3B,0x61,0x08,0xD7, 0x2D,0x98,0x10,0xA3, 0x09,0x14,0xDF,0xF4,
+};
+
+static const uint8_t SELFTEST_CIPHERTEXT256[64] =
+{
+	0xF5,0x8C,0x4C,0x04, 0xD6,0xE5,0xF1,0xBA, 0x77,0x9E,0xAB,0xFB, 0x5F,0x7B,0xFB,0xD6,
+	0x9C,0xFC,0x4E,0x96, 0x7E,0xDB,0x80,0x8D, 0x67,0x9F,0x77,0x7B, 0xC6,0x70,0x2C,0x7D,
+	0x39,0xF2,0x33,0x69, 0xA9,0xD9,0xBA,0xCF, 0xA5,0x30,0xE2,0x63, 0x04,0x23,0x14,0x61,
+	0xB2,0xEB,0x05,0xE2, 0xC3,0x9B,0xE9,0xFC, 0xDA,0x6C,0x19,0x07, 0x8C,0x6A,0x9D,0x1B,
+};
+
+typedef struct
+{
+	CryptoSelftestHandler handler;
+	void *user;
+} SelftestSink;
+
+static int selftest_report(const SelftestSink *sink, const char *backend, const char *test, int ok)
+{
+	if (sink->handler)
 	{
-		data[i] ^= xor_key;
+		sink->handler(backend, test, ok ? CRYPTO_SELFTEST_OK : CRYPTO_SELFTEST_FAIL, sink->user);
 	}
+	return ok ? 0 : 1;
+}
+
+static int selftest_cbc(const AES_Backend *backend, const SelftestSink *sink, const char *name,
+						const uint8_t *key, int klen, const uint8_t *ciphertext)
+{
+	AES_Ctx ctx;
+	uint8_t result[64];
+	char test[32];
+	int failures = 0;
+
+	backend->key_expansion(&ctx, key, klen, klen * 8);
+	AES_set_iv(&ctx, SELFTEST_IV, 16);
+	int ok = backend->cbc_encrypt(&ctx, result, SELFTEST_PLAINTEXT, 64) == 0
+			 && memcmp(result, ciphertext, 64) == 0;
+	snprintf(test, sizeof(test), "%s encrypt", name);
+	failures += selftest_report(sink, backend->name, test, ok);
 
-	EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
-	if (!ctx) return -1;
+	backend->key_expansion(&ctx, key, klen, (klen * 8) | (1u << 16));
+	AES_set_iv(&ctx, SELFTEST_IV, 16);
+	memcpy(result, ciphertext, 64);
+	ok = backend->cbc_decrypt(&ctx, result, result, 64) == 0
+		 && memcmp(result, SELFTEST_PLAINTEXT, 64) == 0;
+	snprintf(test, sizeof(test), "%s decrypt (in place)", name);
+	failures += selftest_report(sink, backend->name, test, ok);
+
+	return failures;
+}
+
+// v1 SWEEP-блок: результат каждой реализации сравнивается с портативной
+static int selftest_v1(const AES_Backend *backend, const SelftestSink *sink)
+{
+	static const uint32_t keys[2] = { EEPROM_V1_KEY_PRODUCTION, EEPROM_V1_KEY_FIXTURE };
+	int failures = 0;
 
-	if (EVP_EncryptInit_ex(ctx, EVP_aes_256_cbc(), NULL, aes_key, aes_iv) != 1)
+	for (size_t k = 0; k < 2; k++)
 	{
-		EVP_CIPHER_CTX_free(ctx);
-		return -1;
+		uint8_t plain[EEPROM_V1_SWEEP_SIZE];
+		uint8_t expected[EEPROM_V1_SWEEP_SIZE];
+		uint8_t result[EEPROM_V1_SWEEP_SIZE];
+		V1KeySchedule reference, ks;
+
+		for (size_t i = 0; i < sizeof(plain); i++)
+		{
+			plain[i] = (uint8_t)(i * 7 + 3);
+		}
+
+		v1_key_schedule_init(&reference, &AES_backend_soft, keys[k]);
+		v1_key_schedule_init(&ks, backend, keys[k]);
+
+		memcpy(expected, plain, sizeof(plain));
+		v1_encode_with(&reference, expected, sizeof(expected));
+
+		memcpy(result, plain, sizeof(plain));
+		int ok = v1_encode_with(&ks, result, sizeof(result)) == 0
+				 && memcmp(result, expected, sizeof(result)) == 0;
+		ok = ok && v1_decode_with(&ks, result, sizeof(result)) == 0
+				&& memcmp(result, plain, sizeof(result)) == 0;
+
+		failures += selftest_report(sink, backend->name,
+									k == 0 ? "EEPROM v1 production key" : "EEPROM v1 fixture key", ok);
 	}
 
-	EVP_CIPHER_CTX_set_padding(ctx, 0);
+	return failures;
+}
 
-	int len;
-	if (EVP_EncryptUpdate(ctx, data, &len, data, length) != 1)
+// decode_data_many() против последовательного decode_data()
+static int selftest_xxtea_many(const SelftestSink *sink)
+{
+	static const size_t lengths[] =
 	{
-		EVP_CIPHER_CTX_free(ctx);
-		return -1;
+		EEPROM_V4_REGION1_SIZE, EEPROM_V4_REGION2_SIZE,
+		EEPROM_V5_REGION3_SIZE, EEPROM_V17_DATA_SIZE
+	};
+	enum { BOARDS = 2 * XXTEA_LANES + 3 };
+	static uint8_t reference[BOARDS][EEPROM_SIZE];
+	static uint8_t lanes[BOARDS][EEPROM_SIZE];
+	uint8_t *ptrs[BOARDS];
+	uint32_t seed = 0x12345678;
+	int ok = 1;
+
+	for (size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++)
+	{
+		for (uint8_t key_index = 0; key_index < 4; key_index++)
+		{
+			EEPROMVersion version = (l == 3) ? EEPROM_VERSION_V17 : EEPROM_VERSION_V5;
+
+			for (size_t b = 0; b < BOARDS; b++)
+			{
+				for (size_t i = 0; i < lengths[l]; i++)
+				{
+					seed = seed * 1103515245u + 12345u;
+					reference[b][i] = lanes[b][i] = (uint8_t)(seed >> 16);
+				}
+				decode_data(reference[b], lengths[l], CRYPTO_ALGORITHM_XXTEA, key_index, version);
+				ptrs[b] = lanes[b];
+			}
+
+			decode_data_many(ptrs, BOARDS, lengths[l], CRYPTO_ALGORITHM_XXTEA, key_index, version);
+
+			for (size_t b = 0; b < BOARDS; b++)
+			{
+				ok = ok && memcmp(reference[b], lanes[b], lengths[l]) == 0;
+			}
+		}
 	}
 
-	int final_len;
-	if (EVP_EncryptFinal_ex(ctx, data + len, &final_len) != 1)
+	return selftest_report(sink, "xxtea", "decode_data_many", ok);
+}
+
+// Табличный CRC-8 против побитового на случайных буферах всех длин
+static int selftest_crc8(const SelftestSink *sink)
+{
+	uint8_t buffer[EEPROM_SIZE + 8];
+	uint32_t seed = 0x9E3779B9;
+	int ok = 1;
+
+	for (int round = 0; round < 64; round++)
 	{
-		EVP_CIPHER_CTX_free(ctx);
-		return -1;
+		for (size_t i = 0; i < sizeof(buffer); i++)
+		{
+			seed = seed * 1103515245u + 12345u;
+			buffer[i] = (uint8_t)(seed >> 16);
+		}
+		for (size_t offset = 0; offset < 8; offset++)
+		{
+			for (size_t length = 0; length <= EEPROM_SIZE; length++)
+			{
+				ok = ok && calculate_crc8_v1(buffer + offset, length)
+						   == crc8_v1_bitwise(buffer + offset, length);
+			}
+		}
 	}
 
-	EVP_CIPHER_CTX_free(ctx);
+	return selftest_report(sink, "crc8", "slice-by-8 vs bitwise", ok);
+}
 
-	return 0;
+int crypto_selftest(CryptoSelftestHandler handler, void *user)
+{
+	const SelftestSink sink = { handler, user };
+	int failures = selftest_xxtea_many(&sink);
+	failures += selftest_crc8(&sink);
+
+	for (size_t i = 0; i < CRYPTO_BACKEND_COUNT; i++)
+	{
+		const AES_Backend *backend = crypto_backends[i];
+
+		if (!backend->probe())
+		{
+			if (handler)
+			{
+				handler(backend->name, NULL, CRYPTO_SELFTEST_SKIP, user);
+			}
+			continue;
+		}
+
+		failures += selftest_cbc(backend, &sink, "AES-128-CBC", SELFTEST_KEY128, 16, SELFTEST_CIPHERTEXT128);
+		failures += selftest_cbc(backend, &sink, "AES-256-CBC", SELFTEST_KEY256, 32, SELFTEST_CIPHERTEXT256);
+		failures += selftest_v1(backend, &sink);
+	}
+
+	return failures;
 }
@@ -10,9 +10,15 @@ void encode_data(uint8_t *data, size_t length, uint8_t algorithm_version,
 void decode_data(uint8_t *data, size_t length, uint8_t algorithm_version,
 				 uint8_t key_index, EEPROMVersion eeprom_version);
 
+// Decodes the same-length region of count boards at once: each board
+// occupies one SIMD lane, so throughput scales with vector width.
+void decode_data_many(uint8_t *const data[], size_t count, size_t length,
+					  uint8_t algorithm_version, uint8_t key_index,
+					  EEPROMVersion eeprom_version);
+
 uint8_t calculate_crc(const uint8_t *data, size_t length);
 
-// CRC-8 for EEPROM v1
+// CRC-8 for EEPROM v1 (table-driven, slice-by-8)
 uint8_t calculate_crc8_v1(const uint8_t *data, size_t length);
 
 // ═══════════════════════════════════════════════════════════════
@@ -23,4 +29,33 @@ uint8_t calculate_crc8_v1(const uint8_t *data, size_t length);
 int encode_data_v1(uint8_t *data, size_t length, uint32_t encryption_key);
 int decode_data_v1(uint8_t *data, size_t length, uint32_t encryption_key);
 
+// ═══════════════════════════════════════════════════════════════
+// AES backend selection (OpenSSL / AES-NI / ARMv8-CE / portable)
+// ═══════════════════════════════════════════════════════════════
+
+// Selects the backend by name, or the fastest available one for NULL/"auto".
+// Call before decoding starts; returns -1 for unknown or unsupported backends.
+int crypto_set_backend(const char *name);
+const char* crypto_backend_name(void);
+
+// Enumerates compiled-in backends; returns NULL past the end
+const char* crypto_backend_get(size_t index, int *available);
+
+typedef enum
+{
+	CRYPTO_SELFTEST_OK,
+	CRYPTO_SELFTEST_FAIL,
+	CRYPTO_SELFTEST_SKIP           // backend not supported by the CPU; test is NULL
+} CryptoSelftestResult;
+
+// Called once per check (backend "xxtea" and "crc8" for the non-AES ones)
+typedef void (*CryptoSelftestHandler)(const char *backend, const char *test,
+									  CryptoSelftestResult result, void *user);
+
+// Checks every available backend against NIST SP 800-38A vectors and
+// against each other on EEPROM v1 blocks; also checks decode_data_many()
+// against decode_data() and the table CRC-8 against the bitwise one.
+// handler (may be NULL) receives each result. Returns the number of failures.
+int crypto_selftest(CryptoSelftestHandler handler, void *user);
+
 #endif // CRYPTO_H
@@ -0,0 +1,447 @@
+#include "eeprom_archive.h"
+#include "eeprom_ops.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define ALIGN8(x) (((x) + 7) & ~(uint64_t)7)
+
+// ═══════════════════════════════════════════════════════════════
+// Reading
+// ═══════════════════════════════════════════════════════════════
+
+int eeprom_archive_is_archive_path(const char *path)
+{
+	size_t len = strlen(path);
+	size_t ext = strlen(EEPROM_ARCHIVE_EXTENSION);
+	return len > ext && strcmp(path + len - ext, EEPROM_ARCHIVE_EXTENSION) == 0;
+}
+
+// Секция [offset, offset + count * item) целиком внутри файла
+static int archive_section_ok(uint64_t file_size, uint64_t offset, uint64_t count, uint64_t item)
+{
+	if (offset > file_size || (offset & 7) != 0)
+	{
+		return 0;
+	}
+	return count <= (file_size - offset) / item;
+}
+
+int eeprom_archive_open(EEPROMArchive *archive, const char *path)
+{
+	memset(archive, 0, sizeof(*archive));
+
+	int fd = open(path, O_RDONLY);
+	if (fd < 0)
+	{
+		return EEPROM_ERROR_IO;
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) != 0)
+	{
+		close(fd);
+		return EEPROM_ERROR_IO;
+	}
+
+	if ((uint64_t)st.st_size < sizeof(EEPROMArchiveHeader))
+	{
+		close(fd);
+		return EEPROM_ERROR_VERSION;
+	}
+
+	void *base = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (base == MAP_FAILED)
+	{
+		return EEPROM_ERROR_IO;
+	}
+
+	const EEPROMArchiveHeader *header = (const EEPROMArchiveHeader*)base;
+	uint64_t size = st.st_size;
+	uint64_t count = header->record_count;
+
+	if (memcmp(header->magic, EEPROM_ARCHIVE_MAGIC, sizeof(header->magic)) != 0 ||
+		header->format_version != 1 ||
+		header->record_size != EEPROM_SIZE ||
+		count > UINT32_MAX ||
+		!archive_section_ok(size, header->records_offset, count, EEPROM_SIZE) ||
+		!archive_section_ok(size, header->lengths_offset, count, sizeof(uint16_t)) ||
+		!archive_section_ok(size, header->index_offset, count, sizeof(EEPROMArchiveIndexEntry)) ||
+		!archive_section_ok(size, header->names_offset, count, sizeof(uint32_t)) ||
+		!archive_section_ok(size, ALIGN8(header->names_offset + count * sizeof(uint32_t)),
+							header->names_size, 1))
+	{
+		munmap(base, st.st_size);
+		return EEPROM_ERROR_VERSION;
+	}
+
+	archive->base = base;
+	archive->size = st.st_size;
+	archive->header = header;
+	archive->records = archive->base + header->records_offset;
+	archive->lengths = (const uint16_t*)(archive->base + header->lengths_offset);
+	archive->index = (const EEPROMArchiveIndexEntry*)(archive->base + header->index_offset);
+	archive->name_offsets = (const uint32_t*)(archive->base + header->names_offset);
+	archive->names = (const char*)archive->base +
+					 ALIGN8(header->names_offset + count * sizeof(uint32_t));
+
+	// Блок имен заканчивается нулем: любая строка с допустимым смещением завершена
+	if (header->names_size == 0 || archive->names[header->names_size - 1] != '\0')
+	{
+		if (count)
+		{
+			eeprom_archive_close(archive);
+			return EEPROM_ERROR_VERSION;
+		}
+	}
+
+	// Номера записей индекса и длины используются как индексы без проверок:
+	// поврежденный архив отклоняется здесь, а не падает в lookup/diff/unpack
+	for (uint64_t i = 0; i < count; i++)
+	{
+		if (archive->index[i].record >= count ||
+			archive->lengths[i] == 0 || archive->lengths[i] > EEPROM_SIZE)
+		{
+			eeprom_archive_close(archive);
+			return EEPROM_ERROR_VERSION;
+		}
+	}
+
+	return EEPROM_SUCCESS;
+}
+
+void eeprom_archive_close(EEPROMArchive *archive)
+{
+	if (archive->base)
+	{
+		munmap((void*)archive->base, archive->size);
+	}
+	memset(archive, 0, sizeof(*archive));
+}
+
+const char *eeprom_archive_name(const EEPROMArchive *archive, size_t record)
+{
+	uint32_t offset = archive->name_offsets[record];
+	return offset < archive->header->names_size ? archive->names + offset : "";
+}
+
+size_t eeprom_archive_lookup(const EEPROMArchive *archive, const char *serial, size_t *first)
+{
+	char key[EEPROM_ARCHIVE_SERIAL] = { 0 };
+	size_t len = strlen(serial);
+
+	*first = 0;
+	if (len > sizeof(key))
+	{
+		return 0;
+	}
+	memcpy(key, serial, len);
+
+	// lower_bound
+	size_t lo = 0, hi = eeprom_archive_count(archive);
+	while (lo < hi)
+	{
+		size_t mid = lo + (hi - lo) / 2;
+		if (memcmp(archive->index[mid].serial, key, sizeof(key)) < 0)
+		{
+			lo = mid + 1;
+		}
+		else
+		{
+			hi = mid;
+		}
+	}
+
+	*first = lo;
+
+	size_t end = lo;
+	while (end < eeprom_archive_count(archive) &&
+		   memcmp(archive->index[end].serial, key, sizeof(key)) == 0)
+	{
+		end++;
+	}
+
+	return end - lo;
+}
+
+// ═══════════════════════════════════════════════════════════════
+// Writing
+// ═══════════════════════════════════════════════════════════════
+
+struct _EEPROMArchiveWriter
+{
+	char *path;                    // итоговое имя
+	char *tmp_path;                // пишем сюда, rename в finish
+	int fd;
+	size_t capacity;
+	uint8_t *map;                  // header + capacity записей
+	size_t map_size;
+	uint16_t *lengths;             // 0 = слот не заполнен
+	char (*serials)[EEPROM_ARCHIVE_SERIAL];
+	char **names;
+};
+
+static void archive_writer_free(EEPROMArchiveWriter *writer)
+{
+	if (writer->map)
+	{
+		munmap(writer->map, writer->map_size);
+	}
+	if (writer->fd >= 0)
+	{
+		close(writer->fd);
+	}
+	if (writer->names)
+	{
+		for (size_t i = 0; i < writer->capacity; i++)
+		{
+			free(writer->names[i]);
+		}
+	}
+	free(writer->names);
+	free(writer->serials);
+	free(writer->lengths);
+	free(writer->tmp_path);
+	free(writer->path);
+	free(writer);
+}
+
+EEPROMArchiveWriter *eeprom_archive_writer_create(const char *path, size_t capacity)
+{
+	if (capacity > UINT32_MAX)
+	{
+		errno = EFBIG;
+		return NULL;
+	}
+
+	EEPROMArchiveWriter *writer = calloc(1, sizeof(EEPROMArchiveWriter));
+	if (!writer)
+	{
+		return NULL;
+	}
+
+	writer->fd = -1;
+	writer->capacity = capacity;
+	writer->path = strdup(path);
+	writer->tmp_path = malloc(strlen(path) + 8);
+	writer->lengths = calloc(capacity ? capacity : 1, sizeof(uint16_t));
+	writer->serials = calloc(capacity ? capacity : 1, EEPROM_ARCHIVE_SERIAL);
+	writer->names = calloc(capacity ? capacity : 1, sizeof(char*));
+
+	if (!writer->path || !writer->tmp_path || !writer->lengths || !writer->serials || !writer->names)
+	{
+		archive_writer_free(writer);
+		errno = ENOMEM;
+		return NULL;
+	}
+	sprintf(writer->tmp_path, "%s.XXXXXX", path);
+
+	// Уникальное имя: два pack в один архив не обрезают временный файл друг друга
+	writer->fd = mkstemp(writer->tmp_path);
+	if (writer->fd < 0)
+	{
+		archive_writer_free(writer);
+		return NULL;
+	}
+	if (fchmod(writer->fd, 0644) != 0)
+	{
+		int saved = errno;
+		eeprom_archive_writer_abort(writer);
+		errno = saved;
+		return NULL;
+	}
+
+	writer->map_size = ALIGN8(sizeof(EEPROMArchiveHeader)) + capacity * EEPROM_SIZE;
+	if (ftruncate(writer->fd, writer->map_size) != 0)
+	{
+		eeprom_archive_writer_abort(writer);
+		return NULL;
+	}
+
+	writer->map = mmap(NULL, writer->map_size, PROT_READ | PROT_WRITE, MAP_SHARED, writer->fd, 0);
+	if (writer->map == MAP_FAILED)
+	{
+		writer->map = NULL;
+		eeprom_archive_writer_abort(writer);
+		return NULL;
+	}
+
+	return writer;
+}
+
+void eeprom_archive_writer_set(EEPROMArchiveWriter *writer, size_t slot,
+							   const uint8_t *data, size_t length,
+							   const char *serial, const char *name)
+{
+	uint8_t *record = writer->map + ALIGN8(sizeof(EEPROMArchiveHeader)) + slot * EEPROM_SIZE;
+	memcpy(record, data, EEPROM_SIZE);
+
+	if (serial)
+	{
+		strncpy(writer->serials[slot], serial, EEPROM_ARCHIVE_SERIAL);
+	}
+	writer->names[slot] = strdup(name ? name : "");
+	writer->lengths[slot] = (uint16_t)length;
+}
+
+void eeprom_archive_writer_abort(EEPROMArchiveWriter *writer)
+{
+	if (!writer)
+	{
+		return;
+	}
+	unlink(writer->tmp_path);
+	archive_writer_free(writer);
+}
+
+static int archive_compare_index(const void *a, const void *b)
+{
+	const EEPROMArchiveIndexEntry *x = (const EEPROMArchiveIndexEntry*)a;
+	const EEPROMArchiveIndexEntry *y = (const EEPROMArchiveIndexEntry*)b;
+
+	int c = memcmp(x->serial, y->serial, sizeof(x->serial));
+	if (c)
+	{
+		return c;
+	}
+	return x->record < y->record ? -1 : x->record > y->record;
+}
+
+static int archive_pwrite(int fd, const void *data, size_t size, uint64_t offset)
+{
+	const uint8_t *p = (const uint8_t*)data;
+
+	while (size)
+	{
+		ssize_t n = pwrite(fd, p, size, offset);
+		if (n < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			return -1;
+		}
+		p += n;
+		size -= n;
+		offset += n;
+	}
+	return 0;
+}
+
+long eeprom_archive_writer_finish(EEPROMArchiveWriter *writer)
+{
+	uint8_t *records = writer->map + ALIGN8(sizeof(EEPROMArchiveHeader));
+	EEPROMArchiveHeader header;
+	memset(&header, 0, sizeof(header));
+
+	// Уплотнение: пропущенные слоты (ошибки чтения) выбрасываются
+	size_t count = 0;
+	uint64_t names_size = 0;
+	for (size_t i = 0; i < writer->capacity; i++)
+	{
+		if (!writer->lengths[i])
+		{
+			free(writer->names[i]);
+			writer->names[i] = NULL;
+			continue;
+		}
+
+		if (i != count)
+		{
+			memcpy(records + count * EEPROM_SIZE, records + i * EEPROM_SIZE, EEPROM_SIZE);
+			writer->lengths[count] = writer->lengths[i];
+			memcpy(writer->serials[count], writer->serials[i], EEPROM_ARCHIVE_SERIAL);
+			writer->names[count] = writer->names[i];
+			writer->names[i] = NULL;
+		}
+
+		int version = eeprom_detect_version(records + count * EEPROM_SIZE);
+		header.version_histogram[version > 0 && version < EEPROM_ARCHIVE_VERSIONS ? version : 0]++;
+
+		names_size += strlen(writer->names[count]) + 1;
+		count++;
+	}
+
+	memcpy(header.magic, EEPROM_ARCHIVE_MAGIC, sizeof(header.magic));
+	header.format_version = 1;
+	header.record_size = EEPROM_SIZE;
+	header.record_count = count;
+	header.records_offset = ALIGN8(sizeof(EEPROMArchiveHeader));
+	header.lengths_offset = header.records_offset + (uint64_t)count * EEPROM_SIZE;
+	header.index_offset = ALIGN8(header.lengths_offset + count * sizeof(uint16_t));
+	header.names_offset = header.index_offset + count * sizeof(EEPROMArchiveIndexEntry);
+	header.names_size = names_size;
+
+	uint64_t blob_offset = ALIGN8(header.names_offset + count * sizeof(uint32_t));
+	uint64_t total_size = blob_offset + names_size;
+
+	EEPROMArchiveIndexEntry *index = malloc((count ? count : 1) * sizeof(EEPROMArchiveIndexEntry));
+	uint32_t *name_offsets = malloc((count ? count : 1) * sizeof(uint32_t));
+	char *blob = malloc(names_size ? names_size : 1);
+	int result = -1;
+
+	if (index && name_offsets && blob && names_size <= UINT32_MAX)
+	{
+		uint64_t pos = 0;
+		for (size_t i = 0; i < count; i++)
+		{
+			memcpy(index[i].serial, writer->serials[i], EEPROM_ARCHIVE_SERIAL);
+			index[i].record = (uint32_t)i;
+
+			size_t len = strlen(writer->names[i]) + 1;
+			memcpy(blob + pos, writer->names[i], len);
+			name_offsets[i] = (uint32_t)pos;
+			pos += len;
+		}
+
+		qsort(index, count, sizeof(EEPROMArchiveIndexEntry), archive_compare_index);
+
+		// Записи уже в файле через mmap; заголовок туда же, хвостовые секции - pwrite
+		memcpy(writer->map, &header, sizeof(header));
+		munmap(writer->map, writer->map_size);
+		writer->map = NULL;
+
+		static const uint8_t zero[8] = { 0 };
+		uint64_t lengths_end = header.lengths_offset + count * sizeof(uint16_t);
+		uint64_t offsets_end = header.names_offset + count * sizeof(uint32_t);
+
+		if (ftruncate(writer->fd, total_size) == 0 &&
+			archive_pwrite(writer->fd, writer->lengths, count * sizeof(uint16_t), header.lengths_offset) == 0 &&
+			archive_pwrite(writer->fd, zero, header.index_offset - lengths_end, lengths_end) == 0 &&
+			archive_pwrite(writer->fd, index, count * sizeof(EEPROMArchiveIndexEntry), header.index_offset) == 0 &&
+			archive_pwrite(writer->fd, name_offsets, count * sizeof(uint32_t), header.names_offset) == 0 &&
+			archive_pwrite(writer->fd, zero, blob_offset - offsets_end, offsets_end) == 0 &&
+			archive_pwrite(writer->fd, blob, names_size, blob_offset) == 0 &&
+			fsync(writer->fd) == 0 &&
+			rename(writer->tmp_path, writer->path) == 0)
+		{
+			result = 0;
+		}
+	}
+	else
+	{
+		errno = ENOMEM;
+	}
+
+	free(index);
+	free(name_offsets);
+	free(blob);
+
+	if (result != 0)
+	{
+		int saved = errno;
+		eeprom_archive_writer_abort(writer);
+		errno = saved;
+		return -1;
+	}
+
+	archive_writer_free(writer);
+	return (long)count;
+}
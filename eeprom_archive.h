@@ -0,0 +1,126 @@
+#ifndef EEPROM_ARCHIVE_H
+#define EEPROM_ARCHIVE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "eeprom_defs.h"
+
+// ═══════════════════════════════════════════════════════════════
+// Packed EEPROM archive (*.eea)
+// ═══════════════════════════════════════════════════════════════
+//
+// Many raw (still encrypted) dumps in one file, read through mmap:
+//
+//   EEPROMArchiveHeader
+//   records  [record_count][EEPROM_SIZE]   raw dumps, short files padded with 0xFF
+//   lengths  [record_count] uint16_t       original file sizes
+//   index    [record_count] EEPROMArchiveIndexEntry, sorted by serial
+//   names    [record_count] uint32_t       offsets into the name blob
+//   name blob                              NUL-terminated source file names
+//
+// Integers are in the byte order of the host that wrote the file, every
+// section starts 8-byte aligned. On a host with the other byte order
+// format_version does not read as 1 and the archive is rejected.
+
+#define EEPROM_ARCHIVE_MAGIC      "EEPRARC1"
+#define EEPROM_ARCHIVE_EXTENSION  ".eea"
+#define EEPROM_ARCHIVE_VERSIONS   32   // histogram slots, indexed by EEPROMVersion (0 = unknown)
+#define EEPROM_ARCHIVE_SERIAL     20   // board_sn / serial_number, NUL-padded
+
+typedef struct
+{
+	char magic[8];                 // EEPROM_ARCHIVE_MAGIC
+	uint32_t format_version;       // 1
+	uint32_t record_size;          // EEPROM_SIZE
+	uint64_t record_count;
+	uint64_t records_offset;
+	uint64_t lengths_offset;
+	uint64_t index_offset;
+	uint64_t names_offset;
+	uint64_t names_size;           // size of the name blob
+	uint64_t version_histogram[EEPROM_ARCHIVE_VERSIONS];
+} EEPROMArchiveHeader;
+
+typedef struct
+{
+	char serial[EEPROM_ARCHIVE_SERIAL];
+	uint32_t record;
+} EEPROMArchiveIndexEntry;
+
+// ═══════════════════════════════════════════════════════════════
+// Reading
+// ═══════════════════════════════════════════════════════════════
+
+typedef struct
+{
+	const uint8_t *base;           // read-only mapping of the whole file
+	size_t size;
+	const EEPROMArchiveHeader *header;
+	const uint8_t *records;
+	const uint16_t *lengths;
+	const EEPROMArchiveIndexEntry *index;
+	const uint32_t *name_offsets;
+	const char *names;
+} EEPROMArchive;
+
+// Maps and validates the sections, index records and lengths; EEPROM_SUCCESS,
+// EEPROM_ERROR_IO (errno) or EEPROM_ERROR_VERSION (not an archive or corrupted)
+int eeprom_archive_open(EEPROMArchive *archive, const char *path);
+void eeprom_archive_close(EEPROMArchive *archive);
+
+// Name ends with EEPROM_ARCHIVE_EXTENSION
+int eeprom_archive_is_archive_path(const char *path);
+
+static inline size_t eeprom_archive_count(const EEPROMArchive *archive)
+{
+	return archive->header->record_count;
+}
+
+// Raw record, EEPROM_SIZE bytes inside the mapping (no copy)
+static inline const uint8_t *eeprom_archive_record(const EEPROMArchive *archive, size_t record)
+{
+	return archive->records + record * EEPROM_SIZE;
+}
+
+static inline size_t eeprom_archive_length(const EEPROMArchive *archive, size_t record)
+{
+	return archive->lengths[record];
+}
+
+// Source file name the record was packed from
+const char *eeprom_archive_name(const EEPROMArchive *archive, size_t record);
+
+/**
+ * Binary search of the serial index
+ * @return number of records with this serial; their index entries are
+ *         archive->index[*first] .. archive->index[*first + n - 1]
+ */
+size_t eeprom_archive_lookup(const EEPROMArchive *archive, const char *serial, size_t *first);
+
+// ═══════════════════════════════════════════════════════════════
+// Writing
+// ═══════════════════════════════════════════════════════════════
+
+/*! \brief Archive under construction
+
+	Records are written straight into a mapping of the output file, so
+	eeprom_archive_writer_set() may be called from several threads for
+	different slots. Slots that are never set are dropped on finish.
+ */
+typedef struct _EEPROMArchiveWriter EEPROMArchiveWriter;
+
+EEPROMArchiveWriter *eeprom_archive_writer_create(const char *path, size_t capacity);
+
+// data: EEPROM_SIZE bytes, length: original size (1..EEPROM_SIZE), serial may be NULL
+void eeprom_archive_writer_set(EEPROMArchiveWriter *writer, size_t slot,
+							   const uint8_t *data, size_t length,
+							   const char *serial, const char *name);
+
+// Compacts, sorts the index, writes the tail sections and the header; frees the writer.
+// Returns the number of records or -1 (errno is set).
+long eeprom_archive_writer_finish(EEPROMArchiveWriter *writer);
+
+// Discards the writer and removes the output file
+void eeprom_archive_writer_abort(EEPROMArchiveWriter *writer);
+
+#endif // EEPROM_ARCHIVE_H
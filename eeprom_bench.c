@@ -0,0 +1,471 @@
+#include "crypto.h"
+#include "eeprom_defs.h"
+#include "eeprom_file.h"
+#include "eeprom_ops.h"
+#include "eeprom_structure.h"
+#include "batch.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// ═══════════════════════════════════════════════════════════════
+// eeprom_bench: микробенчмарки кодека, результат в JSON
+//
+// eeprom_bench [--filter TEXT] [--time MS] [--repeat N] [dumps|dirs...]
+// По умолчанию дампы из examples/; v6 и v17 без образцов собираются
+// из расшифрованных v5 и пустого образа через eeprom_encode.
+// ═══════════════════════════════════════════════════════════════
+
+#ifndef EEPROM_BENCH_EXAMPLES
+#define EEPROM_BENCH_EXAMPLES "examples"
+#endif
+
+#define BENCH_VERSIONS 5
+
+typedef struct
+{
+	EEPROMVersion version;
+	int present;
+	int synthetic;                 // собран из другой версии, образца нет
+	uint8_t encoded[EEPROM_SIZE];
+	uint8_t decoded[EEPROM_SIZE];
+} BenchImage;
+
+typedef struct
+{
+	const char *name;
+	BenchImage *image;             // версия, с которой работает случай
+} BenchCase;
+
+typedef void (*BenchFn)(const BenchCase *bench, size_t iterations);
+
+static volatile uint8_t bench_sink;
+static BenchImage images[BENCH_VERSIONS] = {
+	{ .version = EEPROM_VERSION_V1 },
+	{ .version = EEPROM_VERSION_V4 },
+	{ .version = EEPROM_VERSION_V5 },
+	{ .version = EEPROM_VERSION_V6 },
+	{ .version = EEPROM_VERSION_V17 },
+};
+
+static BenchImage *image_for(EEPROMVersion version)
+{
+	for (int i = 0; i < BENCH_VERSIONS; i++)
+	{
+		if (images[i].version == version)
+		{
+			return &images[i];
+		}
+	}
+	return NULL;
+}
+
+static double now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// ═══════════════════════════════════════════════════════════════
+// Измеряемые операции: одна итерация = одна плата
+// ═══════════════════════════════════════════════════════════════
+
+static void bench_decode(const BenchCase *bench, size_t iterations)
+{
+	uint8_t data[EEPROM_SIZE];
+	for (size_t i = 0; i < iterations; i++)
+	{
+		memcpy(data, bench->image->encoded, EEPROM_SIZE);
+		eeprom_decode(data, EEPROM_SIZE, bench->image->version);
+		bench_sink ^= data[i & (EEPROM_SIZE - 1)];
+	}
+}
+
+// eeprom_decode_many() пачками по BENCH_MANY плат одного образа, как в
+// пакетных командах: XXTEA-регионы одного ключа по SIMD-линии на плату
+#define BENCH_MANY 32
+
+static void bench_decode_many(const BenchCase *bench, size_t iterations)
+{
+	static uint8_t data[BENCH_MANY][EEPROM_SIZE];
+	uint8_t *boards[BENCH_MANY];
+	EEPROMDecodeResult results[BENCH_MANY];
+	int status[BENCH_MANY];
+
+	for (size_t done = 0; done < iterations; )
+	{
+		size_t count = iterations - done < BENCH_MANY ? iterations - done : BENCH_MANY;
+		for (size_t b = 0; b < count; b++)
+		{
+			memcpy(data[b], bench->image->encoded, EEPROM_SIZE);
+			boards[b] = data[b];
+		}
+		eeprom_decode_many(boards, count, results, status);
+		bench_sink ^= data[0][done & (EEPROM_SIZE - 1)];
+		done += count;
+	}
+}
+
+// Только серийный номер через ленивое представление: один регион вместо всех
+static void bench_serial(const BenchCase *bench, size_t iterations)
+{
+	EEPROMView view;
+	char serial[32];
+	for (size_t i = 0; i < iterations; i++)
+	{
+		eeprom_view_init(&view, bench->image->encoded, EEPROM_SIZE, bench->image->version, NULL);
+		eeprom_view_serial(&view, serial, sizeof(serial));
+		bench_sink ^= (uint8_t)serial[i & 7];
+	}
+}
+
+static void bench_encode(const BenchCase *bench, size_t iterations)
+{
+	uint8_t data[EEPROM_SIZE];
+	for (size_t i = 0; i < iterations; i++)
+	{
+		memcpy(data, bench->image->decoded, EEPROM_SIZE);
+		eeprom_encode(data, EEPROM_SIZE, bench->image->version);
+		bench_sink ^= data[i & (EEPROM_SIZE - 1)];
+	}
+}
+
+// CRC всех регионов платы, как при проверке после расшифровки
+static void bench_crc(const BenchCase *bench, size_t iterations)
+{
+	const EEPROMLayout *layout = eeprom_get_layout(bench->image->version);
+	const uint8_t *data = bench->image->decoded;
+	uint8_t crc = 0;
+	for (size_t i = 0; i < iterations; i++)
+	{
+		for (size_t r = 0; r < layout->region_count; r++)
+		{
+			const RegionMeta *region = &layout->regions[r];
+			crc ^= bench->image->version == EEPROM_VERSION_V1
+				? calculate_crc8_v1(data + region->crc_start, region->crc_bits / 8)
+				: calculate_crc(data + region->crc_start, region->crc_bits);
+		}
+	}
+	bench_sink ^= crc;
+}
+
+// AES-256-CBC трех регионов v1 выбранной реализацией
+static void bench_aes(const BenchCase *bench, size_t iterations)
+{
+	const EEPROMLayout *layout = eeprom_get_layout(EEPROM_VERSION_V1);
+	uint8_t data[EEPROM_SIZE];
+	for (size_t i = 0; i < iterations; i++)
+	{
+		memcpy(data, bench->image->encoded, EEPROM_SIZE);
+		for (size_t r = 0; r < layout->region_count; r++)
+		{
+			const RegionMeta *region = &layout->regions[r];
+			decode_data_v1(data + region->data_start, region->data_size, EEPROM_V1_KEY_PRODUCTION);
+		}
+		bench_sink ^= data[i & (EEPROM_SIZE - 1)];
+	}
+}
+
+static void bench_parse(const BenchCase *bench, size_t iterations)
+{
+	EEPROMRecord record;
+	for (size_t i = 0; i < iterations; i++)
+	{
+		eeprom_record_parse(&record, bench->image->decoded, bench->image->version);
+		bench_sink ^= ((const uint8_t*)&record)[i & 63];
+	}
+}
+
+// Поиск по ключу через сгенерированный хэш: итерация - все поля версии
+static void bench_field_find(const BenchCase *bench, size_t iterations)
+{
+	size_t count;
+	const FieldMetadata *fields = eeprom_get_fields(bench->image->version, &count);
+	char keys[64][40];
+	for (size_t f = 0; f < count && f < 64; f++)
+	{
+		eeprom_field_key(fields[f].name, keys[f], sizeof(keys[f]));
+	}
+	for (size_t i = 0; i < iterations; i++)
+	{
+		for (size_t f = 0; f < count && f < 64; f++)
+		{
+			bench_sink ^= (uint8_t)eeprom_field_find(bench->image->version, keys[f])->offset;
+		}
+	}
+}
+
+static void bench_serialize(const BenchCase *bench, size_t iterations)
+{
+	EEPROMRecord record;
+	uint8_t data[EEPROM_SIZE];
+	eeprom_record_parse(&record, bench->image->decoded, bench->image->version);
+	for (size_t i = 0; i < iterations; i++)
+	{
+		switch (record.version)
+		{
+			case EEPROM_VERSION_V1:
+				eeprom_v1_serialize(&record.v1, data);
+				break;
+			case EEPROM_VERSION_V17:
+				eeprom_v17_serialize(&record.v17, data);
+				break;
+			default:
+				eeprom_to_bytes(&record.v4, data);
+				break;
+		}
+		bench_sink ^= data[i & 63];
+	}
+}
+
+// Распаковка sweep со сводкой собранным ядром (sse2/neon/scalar)
+static void bench_sweep(const BenchCase *bench, size_t iterations)
+{
+	const FieldMetadata *levels = eeprom_field_by_id(bench->image->version, FIELD_ID_ASIC_FREQUENCIES);
+	const uint8_t *packed = bench->image->decoded + levels->offset;
+	uint16_t freqs[EEPROM_SWEEP_ASICS];
+	EEPROMSweepStats stats;
+	for (size_t i = 0; i < iterations; i++)
+	{
+		eeprom_sweep_unpack(packed, 575, (uint8_t)(i | 1), freqs, &stats);
+		bench_sink ^= (uint8_t)(freqs[i & (EEPROM_SWEEP_ASICS - 1)] ^ stats.max);
+	}
+}
+
+// ═══════════════════════════════════════════════════════════════
+// Входные образы
+// ═══════════════════════════════════════════════════════════════
+
+static void add_image(const uint8_t *raw)
+{
+	EEPROMVersion version = eeprom_detect_version(raw);
+	BenchImage *image = image_for(version);
+	if (!image || image->present)
+	{
+		return;
+	}
+
+	memcpy(image->encoded, raw, EEPROM_SIZE);
+	memcpy(image->decoded, raw, EEPROM_SIZE);
+	EEPROMDecodeResult result;
+	if (eeprom_decode_ex(image->decoded, EEPROM_SIZE, version, NULL, &result) == EEPROM_SUCCESS &&
+		result.crc_fail_mask == 0)
+	{
+		image->present = 1;
+	}
+}
+
+// Версия без образца: расшифрованный образ с другим байтом версии, зашифрованный заново
+static void synthesize_image(EEPROMVersion version, const BenchImage *from)
+{
+	BenchImage *image = image_for(version);
+	if (image->present)
+	{
+		return;
+	}
+
+	if (from && from->present)
+	{
+		memcpy(image->decoded, from->decoded, EEPROM_SIZE);
+	}
+	else
+	{
+		memset(image->decoded, 0, EEPROM_SIZE);
+	}
+	image->decoded[0] = version == EEPROM_VERSION_V17 ? 0x11 : (uint8_t)version;
+
+	memcpy(image->encoded, image->decoded, EEPROM_SIZE);
+	if (eeprom_encode(image->encoded, EEPROM_SIZE, version) != EEPROM_SUCCESS)
+	{
+		return;
+	}
+	// CRC пересчитаны при шифровании: эталон для encode - повторная расшифровка
+	memcpy(image->decoded, image->encoded, EEPROM_SIZE);
+	image->present = eeprom_decode(image->decoded, EEPROM_SIZE, version) == EEPROM_SUCCESS;
+	image->synthetic = 1;
+}
+
+static int load_images(char **paths, int count)
+{
+	BatchPathList list = { 0 };
+	for (int i = 0; i < count; i++)
+	{
+		if (batch_collect_paths(&list, paths[i]) != 0)
+		{
+			fprintf(stderr, "Error: Cannot access %s\n", paths[i]);
+			batch_free_paths(&list);
+			return -1;
+		}
+	}
+
+	for (size_t i = 0; i < list.count; i++)
+	{
+		uint8_t raw[EEPROM_SIZE];
+		if (eeprom_read_file(list.paths[i], raw, NULL) == EEPROM_SUCCESS)
+		{
+			add_image(raw);
+		}
+	}
+	batch_free_paths(&list);
+
+	synthesize_image(EEPROM_VERSION_V6, image_for(EEPROM_VERSION_V5));
+	synthesize_image(EEPROM_VERSION_V17, NULL);
+	return 0;
+}
+
+// ═══════════════════════════════════════════════════════════════
+// Запуск: итерации подбираются под --time, медиана из --repeat замеров
+// ═══════════════════════════════════════════════════════════════
+
+static int compare_doubles(const void *a, const void *b)
+{
+	double x = *(const double*)a, y = *(const double*)b;
+	return x < y ? -1 : x > y;
+}
+
+static void run_case(const BenchCase *bench, BenchFn fn, double time_ns, int repeat, int *first)
+{
+	size_t iterations = 1;
+	double elapsed;
+	for (;;)
+	{
+		double start = now_ns();
+		fn(bench, iterations);
+		elapsed = now_ns() - start;
+		if (elapsed >= time_ns / 10 || iterations >= ((size_t)1 << 40))
+		{
+			break;
+		}
+		iterations *= elapsed > 0 && time_ns / 10 / elapsed < 100 ? 2 : 16;
+	}
+	// на один замер - доля --time
+	iterations = (size_t)(iterations * (time_ns / repeat) / (elapsed > 0 ? elapsed : 1)) + 1;
+
+	double samples[16];
+	for (int r = 0; r < repeat; r++)
+	{
+		double start = now_ns();
+		fn(bench, iterations);
+		samples[r] = (now_ns() - start) / iterations;
+	}
+	qsort(samples, repeat, sizeof(double), compare_doubles);
+	double ns = samples[repeat / 2];
+
+	printf("%s\n    {\"name\": \"%s\", \"iterations\": %zu, \"ns_per_board\": %.1f, "
+		   "\"ns_min\": %.1f, \"ns_max\": %.1f, \"boards_per_sec\": %.0f}",
+		   *first ? "" : ",", bench->name, iterations, ns, samples[0], samples[repeat - 1], 1e9 / ns);
+	fflush(stdout);
+	*first = 0;
+}
+
+int main(int argc, char *argv[])
+{
+	const char *filter = NULL;
+	double time_ms = 200;
+	int repeat = 5;
+	char *default_paths[] = { (char*)EEPROM_BENCH_EXAMPLES };
+	char **paths = default_paths;
+	int path_count = 1;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+		{
+			filter = argv[++i];
+		}
+		else if (strcmp(argv[i], "--time") == 0 && i + 1 < argc)
+		{
+			time_ms = atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc)
+		{
+			repeat = atoi(argv[++i]);
+			repeat = repeat < 1 ? 1 : repeat > 16 ? 16 : repeat;
+		}
+		else if (argv[i][0] != '-')
+		{
+			paths = argv + i;
+			path_count = argc - i;
+			break;
+		}
+		else
+		{
+			fprintf(stderr, "Usage: %s [--filter TEXT] [--time MS] [--repeat N] [dumps|dirs...]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	if (load_images(paths, path_count) != 0)
+	{
+		return 1;
+	}
+
+	static const char *const version_names[BENCH_VERSIONS] = { "v1", "v4", "v5", "v6", "v17" };
+	static const struct
+	{
+		const char *prefix;
+		BenchFn fn;
+	} kinds[] = {
+		{ "decode", bench_decode },
+		{ "decode_many", bench_decode_many },
+		{ "serial", bench_serial },
+		{ "encode", bench_encode },
+		{ "crc", bench_crc },
+		{ "parse", bench_parse },
+		{ "serialize", bench_serialize },
+		{ "field_find", bench_field_find },
+	};
+
+	crypto_set_backend("auto");
+	printf("{\n  \"crypto_backend\": \"%s\",\n  \"versions\": {", crypto_backend_name());
+	for (int v = 0; v < BENCH_VERSIONS; v++)
+	{
+		printf("%s\"%s\": \"%s\"", v ? ", " : "", version_names[v],
+			   !images[v].present ? "missing" : images[v].synthetic ? "synthetic" : "sample");
+	}
+	printf("},\n  \"results\": [");
+
+	int first = 1;
+	char name[64];
+	for (size_t k = 0; k < sizeof(kinds) / sizeof(kinds[0]); k++)
+	{
+		for (int v = 0; v < BENCH_VERSIONS; v++)
+		{
+			snprintf(name, sizeof(name), "%s/%s", kinds[k].prefix, version_names[v]);
+			if (!images[v].present || (filter && !strstr(name, filter)))
+			{
+				continue;
+			}
+			BenchCase bench = { .name = name, .image = &images[v] };
+			run_case(&bench, kinds[k].fn, time_ms * 1e6, repeat, &first);
+		}
+	}
+
+	// Каждая доступная реализация AES на тех же регионах v1
+	BenchImage *v1 = image_for(EEPROM_VERSION_V1);
+	const char *backend;
+	int available;
+	for (size_t b = 0; v1->present && (backend = crypto_backend_get(b, &available)) != NULL; b++)
+	{
+		snprintf(name, sizeof(name), "aes/%s", backend);
+		if (!available || (filter && !strstr(name, filter)) || crypto_set_backend(backend) != 0)
+		{
+			continue;
+		}
+		BenchCase bench = { .name = name, .image = v1 };
+		run_case(&bench, bench_aes, time_ms * 1e6, repeat, &first);
+	}
+	crypto_set_backend("auto");
+
+	snprintf(name, sizeof(name), "sweep/%s", eeprom_sweep_kernel());
+	if (v1->present && (!filter || strstr(name, filter)))
+	{
+		BenchCase bench = { .name = name, .image = v1 };
+		run_case(&bench, bench_sweep, time_ms * 1e6, repeat, &first);
+	}
+
+	printf("\n  ]\n}\n");
+	return 0;
+}
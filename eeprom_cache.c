@@ -0,0 +1,530 @@
+#include "eeprom_cache.h"
+#include "stats.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define EEPROM_CACHE_MIN_CAPACITY 1024
+#define EEPROM_CACHE_FORMAT       4
+
+// ═══════════════════════════════════════════════════════════════
+// XXH64
+// ═══════════════════════════════════════════════════════════════
+
+#define XXH_PRIME1 0x9E3779B185EBCA87ULL
+#define XXH_PRIME2 0xC2B2AE3D27D4EB4FULL
+#define XXH_PRIME3 0x165667B19E3779F9ULL
+#define XXH_PRIME4 0x85EBCA77C2B2AE63ULL
+#define XXH_PRIME5 0x27D4EB2F165667C5ULL
+
+static inline uint64_t xxh_rotl(uint64_t x, int r)
+{
+	return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t xxh_read64(const uint8_t *p)
+{
+	uint64_t v;
+	memcpy(&v, p, sizeof(v));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	v = __builtin_bswap64(v);
+#endif
+	return v;
+}
+
+static inline uint32_t xxh_read32(const uint8_t *p)
+{
+	uint32_t v;
+	memcpy(&v, p, sizeof(v));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	v = __builtin_bswap32(v);
+#endif
+	return v;
+}
+
+static inline uint64_t xxh_round(uint64_t acc, uint64_t input)
+{
+	acc += input * XXH_PRIME2;
+	acc = xxh_rotl(acc, 31);
+	return acc * XXH_PRIME1;
+}
+
+static inline uint64_t xxh_merge(uint64_t acc, uint64_t value)
+{
+	acc ^= xxh_round(0, value);
+	return acc * XXH_PRIME1 + XXH_PRIME4;
+}
+
+uint64_t eeprom_hash64(const void *data, size_t size, uint64_t seed)
+{
+	const uint8_t *p = (const uint8_t*)data;
+	const uint8_t *end = p + size;
+	uint64_t h;
+
+	if (size >= 32)
+	{
+		uint64_t v1 = seed + XXH_PRIME1 + XXH_PRIME2;
+		uint64_t v2 = seed + XXH_PRIME2;
+		uint64_t v3 = seed;
+		uint64_t v4 = seed - XXH_PRIME1;
+
+		do
+		{
+			v1 = xxh_round(v1, xxh_read64(p));
+			v2 = xxh_round(v2, xxh_read64(p + 8));
+			v3 = xxh_round(v3, xxh_read64(p + 16));
+			v4 = xxh_round(v4, xxh_read64(p + 24));
+			p += 32;
+		}
+		while (p + 32 <= end);
+
+		h = xxh_rotl(v1, 1) + xxh_rotl(v2, 7) + xxh_rotl(v3, 12) + xxh_rotl(v4, 18);
+		h = xxh_merge(h, v1);
+		h = xxh_merge(h, v2);
+		h = xxh_merge(h, v3);
+		h = xxh_merge(h, v4);
+	}
+	else
+	{
+		h = seed + XXH_PRIME5;
+	}
+
+	h += size;
+
+	for (; p + 8 <= end; p += 8)
+	{
+		h ^= xxh_round(0, xxh_read64(p));
+		h = xxh_rotl(h, 27) * XXH_PRIME1 + XXH_PRIME4;
+	}
+	if (p + 4 <= end)
+	{
+		h ^= (uint64_t)xxh_read32(p) * XXH_PRIME1;
+		h = xxh_rotl(h, 23) * XXH_PRIME2 + XXH_PRIME3;
+		p += 4;
+	}
+	for (; p < end; p++)
+	{
+		h ^= *p * XXH_PRIME5;
+		h = xxh_rotl(h, 11) * XXH_PRIME1;
+	}
+
+	h ^= h >> 33;
+	h *= XXH_PRIME2;
+	h ^= h >> 29;
+	h *= XXH_PRIME3;
+	h ^= h >> 32;
+	return h;
+}
+
+// ═══════════════════════════════════════════════════════════════
+// Отпечаток таблиц eeprom_defs.h
+// ═══════════════════════════════════════════════════════════════
+
+static uint64_t fingerprint_string(uint64_t h, const char *text)
+{
+	return text ? eeprom_hash64(text, strlen(text) + 1, h) : eeprom_hash64("", 0, ~h);
+}
+
+static uint64_t fingerprint_value(uint64_t h, uint64_t value)
+{
+	return eeprom_hash64(&value, sizeof(value), h);
+}
+
+uint64_t eeprom_layout_fingerprint(void)
+{
+	static const EEPROMVersion versions[] =
+	{
+		EEPROM_VERSION_V1, EEPROM_VERSION_V4, EEPROM_VERSION_V5,
+		EEPROM_VERSION_V6, EEPROM_VERSION_V17
+	};
+
+	uint64_t h = 0;
+	h = fingerprint_value(h, EEPROM_SIZE);
+	h = fingerprint_value(h, sizeof(EEPROMCacheEntry));
+	h = fingerprint_value(h, sizeof(EEPROMRecord));
+
+	for (size_t v = 0; v < sizeof(versions) / sizeof(versions[0]); v++)
+	{
+		// Поля по одному: в структурах есть выравнивание с мусором
+		const EEPROMLayout *layout = eeprom_get_layout(versions[v]);
+		h = fingerprint_value(h, versions[v]);
+		h = fingerprint_value(h, layout->region_count);
+		h = fingerprint_value(h, layout->algorithm);
+		h = fingerprint_value(h, layout->key_index);
+
+		for (size_t r = 0; r < layout->region_count; r++)
+		{
+			const RegionMeta *region = &layout->regions[r];
+			h = fingerprint_string(h, region->name);
+			h = fingerprint_value(h, region->data_start);
+			h = fingerprint_value(h, region->data_size);
+			h = fingerprint_value(h, region->crc_pos);
+			h = fingerprint_value(h, region->crc_start);
+			h = fingerprint_value(h, region->crc_bits);
+			h = fingerprint_value(h, (uint64_t)(int64_t)region->test_result_pos);
+			h = fingerprint_string(h, region->test_name);
+		}
+
+		size_t count;
+		const FieldMetadata *fields = eeprom_get_fields(versions[v], &count);
+		h = fingerprint_value(h, count);
+		for (size_t f = 0; f < count; f++)
+		{
+			h = fingerprint_string(h, fields[f].name);
+			h = fingerprint_value(h, fields[f].id);
+			h = fingerprint_string(h, fields[f].category);
+			h = fingerprint_value(h, fields[f].type);
+			h = fingerprint_value(h, fields[f].offset);
+			h = fingerprint_value(h, fields[f].size);
+			h = fingerprint_value(h, (uint64_t)(int64_t)fields[f].min_value);
+			h = fingerprint_value(h, (uint64_t)(int64_t)fields[f].max_value);
+			h = fingerprint_string(h, fields[f].unit);
+			h = fingerprint_string(h, fields[f].format);
+			h = fingerprint_value(h, fields[f].read_only);
+		}
+	}
+
+	return h;
+}
+
+// ═══════════════════════════════════════════════════════════════
+// Файл кэша
+// ═══════════════════════════════════════════════════════════════
+
+struct _EEPROMCache
+{
+	uint8_t *map;
+	size_t map_size;
+	EEPROMCacheHeader *header;
+	EEPROMCacheEntry *slots;
+	uint64_t mask;                 // capacity - 1
+	uint64_t generation;           // header->opens of this open
+
+	// Счетчики обновляются атомарно из рабочих потоков
+	size_t hits;
+	size_t misses;
+};
+
+static size_t cache_file_size(uint64_t capacity)
+{
+	return sizeof(EEPROMCacheHeader) + capacity * sizeof(EEPROMCacheEntry);
+}
+
+static int cache_map(EEPROMCache *cache, int fd, size_t size)
+{
+	void *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (map == MAP_FAILED)
+	{
+		return -1;
+	}
+	cache->map = map;
+	cache->map_size = size;
+	cache->header = (EEPROMCacheHeader*)map;
+	cache->slots = (EEPROMCacheEntry*)(cache->map + sizeof(EEPROMCacheHeader));
+	cache->mask = cache->header->capacity - 1;
+	return 0;
+}
+
+static void cache_unmap(EEPROMCache *cache)
+{
+	if (cache->map)
+	{
+		munmap(cache->map, cache->map_size);
+	}
+	cache->map = NULL;
+	cache->header = NULL;
+	cache->slots = NULL;
+}
+
+// Заголовок цел и записан этой же сборкой
+static int cache_valid(const EEPROMCache *cache, uint64_t fingerprint)
+{
+	const EEPROMCacheHeader *header = cache->header;
+	return memcmp(header->magic, EEPROM_CACHE_MAGIC, sizeof(header->magic)) == 0 &&
+		   header->format_version == EEPROM_CACHE_FORMAT &&
+		   header->entry_size == sizeof(EEPROMCacheEntry) &&
+		   header->fingerprint == fingerprint &&
+		   header->capacity >= EEPROM_CACHE_MIN_CAPACITY &&
+		   (header->capacity & (header->capacity - 1)) == 0 &&
+		   cache_file_size(header->capacity) == cache->map_size;
+}
+
+static uint64_t cache_checksum(const EEPROMCacheEntry *entry)
+{
+	uint64_t h = eeprom_hash64(&entry->result, sizeof(entry->result), entry->key);
+	return eeprom_hash64(entry->data, EEPROM_SIZE, h);
+}
+
+// Слот можно отдать: контрольная сумма сошлась и результат согласован с
+// раскладкой своей версии (число регионов - граница циклов у вызывающих)
+static int cache_entry_ok(const EEPROMCacheEntry *entry)
+{
+	const EEPROMDecodeResult *result = &entry->result;
+	if (entry->checksum != cache_checksum(entry))
+	{
+		return 0;
+	}
+
+	const EEPROMLayout *layout = eeprom_get_layout(result->version);
+	return layout && result->region_count == layout->region_count &&
+		   result->region_count <= EEPROM_MAX_REGIONS &&
+		   (result->crc_fail_mask >> result->region_count) == 0 &&
+		   (result->test_fail_mask >> result->region_count) == 0;
+}
+
+// Слот в записи от более раннего открытия файла: писатель упал или был
+// убит посреди записи, иначе слот был бы уже VALID
+static int cache_slot_abandoned(const EEPROMCache *cache, uint64_t state)
+{
+	return state != EEPROM_CACHE_SLOT_EMPTY && state != EEPROM_CACHE_SLOT_VALID &&
+		   (state >> 8) < cache->generation;
+}
+
+static EEPROMCacheEntry *cache_claim(EEPROMCache *cache, uint64_t key)
+{
+	uint64_t writing = EEPROM_CACHE_SLOT_WRITER(cache->generation);
+
+	for (uint64_t i = 0; i < EEPROM_CACHE_PROBES; i++)
+	{
+		EEPROMCacheEntry *entry = &cache->slots[(key + i) & cache->mask];
+		uint64_t state = __atomic_load_n(&entry->state, __ATOMIC_ACQUIRE);
+
+		if (state == EEPROM_CACHE_SLOT_VALID && entry->key == key)
+		{
+			return NULL;           // уже есть
+		}
+		if ((state == EEPROM_CACHE_SLOT_EMPTY || cache_slot_abandoned(cache, state)) &&
+			__atomic_compare_exchange_n(&entry->state, &state, writing,
+										0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+		{
+			return entry;
+		}
+	}
+	return NULL;
+}
+
+static void cache_insert(EEPROMCache *cache, uint64_t key,
+						 const uint8_t *data, const EEPROMDecodeResult *result)
+{
+	EEPROMCacheEntry *entry = cache_claim(cache, key);
+	if (!entry)
+	{
+		return;
+	}
+	entry->key = key;
+	entry->result = *result;
+	memcpy(entry->data, data, EEPROM_SIZE);
+	entry->checksum = cache_checksum(entry);
+	__atomic_store_n(&entry->state, EEPROM_CACHE_SLOT_VALID, __ATOMIC_RELEASE);
+	__atomic_fetch_add(&cache->header->count, 1, __ATOMIC_RELAXED);
+}
+
+/*! \brief new empty file of capacity slots with the entries of old (may be NULL)
+
+	Пишется во временный файл и переименовывается: процесс, у которого
+	открыт старый кэш, дописывает в старый файл и ничего не портит.
+ */
+static int cache_rebuild(EEPROMCache *cache, const char *path, uint64_t capacity,
+						 uint64_t fingerprint, EEPROMCache *old)
+{
+	// Уникальное имя в том же каталоге: два процесса, одновременно
+	// перестраивающие кэш, не обрезают файл, отображенный другим
+	char *tmp_path = malloc(strlen(path) + 8);
+	if (!tmp_path)
+	{
+		errno = ENOMEM;
+		return -1;
+	}
+	sprintf(tmp_path, "%s.XXXXXX", path);
+
+	int fd = mkstemp(tmp_path);
+	if (fd < 0 || fchmod(fd, 0644) != 0)
+	{
+		int saved = errno;
+		if (fd >= 0)
+		{
+			close(fd);
+			unlink(tmp_path);
+		}
+		free(tmp_path);
+		errno = saved;
+		return -1;
+	}
+
+	// Файл разреженный: место на диске занимают только заполненные слоты
+	size_t size = cache_file_size(capacity);
+	int ret = -1;
+	if (ftruncate(fd, size) == 0)
+	{
+		void *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		if (map != MAP_FAILED)
+		{
+			EEPROMCacheHeader *header = (EEPROMCacheHeader*)map;
+			memcpy(header->magic, EEPROM_CACHE_MAGIC, sizeof(header->magic));
+			header->format_version = EEPROM_CACHE_FORMAT;
+			header->entry_size = sizeof(EEPROMCacheEntry);
+			header->fingerprint = fingerprint;
+			header->capacity = capacity;
+			header->count = 0;
+			header->opens = 0;
+
+			munmap(map, size);
+			ret = cache_map(cache, fd, size);
+		}
+	}
+
+	if (ret == 0 && old)
+	{
+		for (uint64_t i = 0; i <= old->mask; i++)
+		{
+			if (old->slots[i].state == EEPROM_CACHE_SLOT_VALID && cache_entry_ok(&old->slots[i]))
+			{
+				cache_insert(cache, old->slots[i].key, old->slots[i].data, &old->slots[i].result);
+			}
+		}
+	}
+
+	if (ret == 0 && rename(tmp_path, path) != 0)
+	{
+		cache_unmap(cache);
+		ret = -1;
+	}
+	if (ret != 0)
+	{
+		int saved = errno;
+		unlink(tmp_path);
+		errno = saved;
+	}
+
+	close(fd);
+	free(tmp_path);
+	return ret;
+}
+
+EEPROMCache *eeprom_cache_open(const char *path, size_t expected)
+{
+	EEPROMCache *cache = calloc(1, sizeof(EEPROMCache));
+	if (!cache)
+	{
+		errno = ENOMEM;
+		return NULL;
+	}
+
+	uint64_t fingerprint = eeprom_layout_fingerprint();
+	EEPROMCache old = { 0 };
+	int have_old = 0;
+
+	int fd = open(path, O_RDWR);
+	if (fd >= 0)
+	{
+		struct stat st;
+		if (fstat(fd, &st) == 0 && (uint64_t)st.st_size >= sizeof(EEPROMCacheHeader) &&
+			cache_map(&old, fd, st.st_size) == 0)
+		{
+			have_old = cache_valid(&old, fingerprint);
+			if (!have_old)
+			{
+				cache_unmap(&old);
+			}
+		}
+		close(fd);
+	}
+	else if (errno != ENOENT)
+	{
+		free(cache);
+		return NULL;
+	}
+
+	// Заполнение не выше половины: короткие цепочки проб
+	uint64_t needed = (have_old ? old.header->count : 0) + expected;
+	if (have_old && needed <= old.header->capacity / 2)
+	{
+		*cache = old;
+		cache->generation = __atomic_add_fetch(&cache->header->opens, 1, __ATOMIC_RELAXED);
+		return cache;
+	}
+
+	uint64_t capacity = EEPROM_CACHE_MIN_CAPACITY;
+	while (capacity < needed * 2)
+	{
+		capacity *= 2;
+	}
+
+	int ret = cache_rebuild(cache, path, capacity, fingerprint, have_old ? &old : NULL);
+	int saved = errno;
+	cache_unmap(&old);
+	if (ret != 0)
+	{
+		free(cache);
+		errno = saved;
+		return NULL;
+	}
+	cache->generation = __atomic_add_fetch(&cache->header->opens, 1, __ATOMIC_RELAXED);
+	return cache;
+}
+
+void eeprom_cache_close(EEPROMCache *cache)
+{
+	if (!cache)
+	{
+		return;
+	}
+	cache_unmap(cache);
+	free(cache);
+}
+
+uint64_t eeprom_cache_key(const uint8_t raw[EEPROM_SIZE], uint32_t flags)
+{
+	return eeprom_hash64(raw, EEPROM_SIZE, flags);
+}
+
+int eeprom_cache_get(EEPROMCache *cache, uint64_t key,
+					 uint8_t data[EEPROM_SIZE], EEPROMDecodeResult *result)
+{
+	for (uint64_t i = 0; i < EEPROM_CACHE_PROBES; i++)
+	{
+		const EEPROMCacheEntry *entry = &cache->slots[(key + i) & cache->mask];
+		uint64_t state = __atomic_load_n(&entry->state, __ATOMIC_ACQUIRE);
+
+		if (state == EEPROM_CACHE_SLOT_EMPTY)
+		{
+			break;
+		}
+		if (state == EEPROM_CACHE_SLOT_VALID && entry->key == key)
+		{
+			if (!cache_entry_ok(entry))
+			{
+				break;
+			}
+			memcpy(data, entry->data, EEPROM_SIZE);
+			*result = entry->result;
+			__atomic_fetch_add(&cache->hits, 1, __ATOMIC_RELAXED);
+			// Плата из кэша считается так же, как расшифрованная
+			STATS_ADD(STATS_CACHE_HITS, 1);
+			STATS_ADD(STATS_BOARDS, 1);
+			STATS_ADD(STATS_CRC_FAILURES, __builtin_popcount(result->crc_fail_mask));
+			STATS_ADD(STATS_TEST_FAILURES, __builtin_popcount(result->test_fail_mask));
+			return 1;
+		}
+	}
+
+	__atomic_fetch_add(&cache->misses, 1, __ATOMIC_RELAXED);
+	return 0;
+}
+
+void eeprom_cache_put(EEPROMCache *cache, uint64_t key,
+					  const uint8_t data[EEPROM_SIZE], const EEPROMDecodeResult *result)
+{
+	cache_insert(cache, key, data, result);
+}
+
+void eeprom_cache_stats(const EEPROMCache *cache, size_t *hits, size_t *misses)
+{
+	*hits = cache->hits;
+	*misses = cache->misses;
+}
@@ -0,0 +1,94 @@
+#ifndef EEPROM_CACHE_H
+#define EEPROM_CACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "eeprom_defs.h"
+#include "eeprom_ops.h"
+
+// ═══════════════════════════════════════════════════════════════
+// Persistent decode cache (*.eec)
+// ═══════════════════════════════════════════════════════════════
+//
+// Decoded images and their CRC/test status keyed by a 64-bit hash of the
+// raw 256 bytes, so unchanged dumps skip decryption on later runs:
+//
+//   EEPROMCacheHeader
+//   slots [capacity] EEPROMCacheEntry    open addressing, linear probing
+//
+// The file is mapped read-write and filled by worker threads in place.
+// Host byte order: the cache is a local file, not an exchange format.
+// The header carries eeprom_layout_fingerprint(); a cache written by a
+// build with different layout or field tables is discarded on open.
+// Each entry carries a checksum of its contents, checked with the
+// decode result on every hit: a damaged slot, or one whose state reached
+// the disk before its data, is a miss. A slot left WRITING by a writer
+// that died is claimed again by any later open of the file.
+
+#define EEPROM_CACHE_MAGIC        "EEPRDC01"
+#define EEPROM_CACHE_EXTENSION    ".eec"
+#define EEPROM_CACHE_PROBES       32   // slots searched before giving up
+
+// Key selection flags mixed into the key: the same raw image decodes
+// differently with and without key discovery
+#define EEPROM_CACHE_DISCOVER_KEYS 0x1
+
+typedef struct
+{
+	char magic[8];                 // EEPROM_CACHE_MAGIC
+	uint32_t format_version;       // 4
+	uint32_t entry_size;           // sizeof(EEPROMCacheEntry)
+	uint64_t fingerprint;          // eeprom_layout_fingerprint() of the writer
+	uint64_t capacity;             // slots, power of two
+	uint64_t count;                // filled slots
+	uint64_t opens;                // eeprom_cache_open() count: generation of writers
+} EEPROMCacheHeader;
+
+typedef struct
+{
+	uint64_t state;                // EEPROM_CACHE_SLOT_*
+	uint64_t key;                  // eeprom_cache_key()
+	uint64_t checksum;             // XXH64 of result and data, seeded with key
+	EEPROMDecodeResult result;
+	uint8_t data[EEPROM_SIZE];     // decoded image
+} EEPROMCacheEntry;
+
+#define EEPROM_CACHE_SLOT_EMPTY   0
+#define EEPROM_CACHE_SLOT_WRITING 1  // claimed by a writer; skipped by readers
+#define EEPROM_CACHE_SLOT_VALID   2
+
+// WRITING state of a slot claimed by the open of this generation (opens)
+#define EEPROM_CACHE_SLOT_WRITER(generation) ((uint64_t)(generation) << 8 | EEPROM_CACHE_SLOT_WRITING)
+
+typedef struct _EEPROMCache EEPROMCache;
+
+/**
+ * Opens or creates the cache with room for expected new entries
+ * A missing, damaged or outdated (fingerprint) file is replaced by an
+ * empty cache; a full one is rebuilt larger, keeping its entries. Both
+ * go through a uniquely named temporary file and rename.
+ * @return NULL on error (errno is set)
+ */
+EEPROMCache *eeprom_cache_open(const char *path, size_t expected);
+void eeprom_cache_close(EEPROMCache *cache);
+
+uint64_t eeprom_cache_key(const uint8_t raw[EEPROM_SIZE], uint32_t flags);
+
+// Thread-safe. Returns 1 and fills data/result on a hit, 0 on a miss.
+int eeprom_cache_get(EEPROMCache *cache, uint64_t key,
+					 uint8_t data[EEPROM_SIZE], EEPROMDecodeResult *result);
+// Thread-safe; silently dropped if the probe window is full
+void eeprom_cache_put(EEPROMCache *cache, uint64_t key,
+					  const uint8_t data[EEPROM_SIZE], const EEPROMDecodeResult *result);
+
+// Lookups of this process
+void eeprom_cache_stats(const EEPROMCache *cache, size_t *hits, size_t *misses);
+
+// XXH64 of data
+uint64_t eeprom_hash64(const void *data, size_t size, uint64_t seed);
+
+// Hash of the region and field tables of every version and of the
+// structures stored in the cache
+uint64_t eeprom_layout_fingerprint(void);
+
+#endif // EEPROM_CACHE_H
@@ -30,6 +30,59 @@ typedef enum
 	FIELD_TYPE_ARRAY_UINT8      // Array of uint8_t
 } FieldType;
 
+// Stable field identity across versions: one ID per field key, the
+// snake_case form of FieldMetadata.name that names export columns
+// ("PSU Voltage" -> psu_voltage). Values are never reused or reordered;
+// new fields are appended before FIELD_ID_COUNT.
+typedef enum
+{
+	FIELD_ID_NONE,
+	FIELD_ID_EEPROM_VERSION,
+	FIELD_ID_ALGORITHM_KEY,
+	FIELD_ID_BOARD_SERIAL,
+	FIELD_ID_BOARD_NAME,
+	FIELD_ID_PCB_VERSION,
+	FIELD_ID_BOM_VERSION,
+	FIELD_ID_CHIP_DIE,
+	FIELD_ID_CHIP_MARKING,
+	FIELD_ID_CHIP_BIN,
+	FIELD_ID_CHIP_TECH,
+	FIELD_ID_FT_VERSION,
+	FIELD_ID_FACTORY_JOB,
+	FIELD_ID_ASIC_SENSOR_TYPE,
+	FIELD_ID_PT1_RESULT,
+	FIELD_ID_PT1_COUNT,
+	FIELD_ID_PSU_VOLTAGE,
+	FIELD_ID_FREQUENCY,
+	FIELD_ID_NONCE_RATE,
+	FIELD_ID_PCB_TEMP_IN,
+	FIELD_ID_PCB_TEMP_OUT,
+	FIELD_ID_TEST_VERSION,
+	FIELD_ID_TEST_STANDARD,
+	FIELD_ID_PT2_RESULT,
+	FIELD_ID_PT2_COUNT,
+	FIELD_ID_SWEEP_HASHRATE,
+	FIELD_ID_SWEEP_FREQ_BASE,
+	FIELD_ID_SWEEP_FREQ_STEP,
+	FIELD_ID_ASIC_FREQUENCIES,
+	FIELD_ID_SWEEP_RESULT,
+	FIELD_ID_DATA_LENGTH,
+	FIELD_ID_SUBFORMAT_VERSION,
+	FIELD_ID_SERIAL_NUMBER,
+	FIELD_ID_FT_PROGRAM_VERSION,
+	FIELD_ID_MINER_TYPE,
+	FIELD_ID_CHIP_TECHNOLOGY,
+	FIELD_ID_TEST_VOLTAGE,
+	FIELD_ID_TEST_FREQUENCY,
+	FIELD_ID_TEST_HASHRATE,
+	FIELD_ID_TEST_PARAMETER,
+	FIELD_ID_TEST_RESULT,
+	FIELD_ID_DONE_TYPE,
+	FIELD_ID_SWEEP_VOLTAGE,
+	FIELD_ID_SWEEP_COUNT,
+	FIELD_ID_COUNT
+} FieldId;
+
 // ═══════════════════════════════════════════════════════════════
 // Size Constants
 // ═══════════════════════════════════════════════════════════════
@@ -114,6 +167,7 @@ typedef struct
 	size_t data_start;             // Start offset in byte array
 	size_t data_size;              // Size of encrypted data
 	size_t crc_pos;                // CRC position in byte array
+	size_t crc_start;              // First byte covered by the CRC
 	size_t crc_bits;               // Number of bits for CRC calculation
 	int test_result_pos;           // Test result position (-1 if none)
 	const char *test_name;         // Test name for warnings (NULL if none)
@@ -131,6 +185,7 @@ typedef struct
 typedef struct
 {
 	const char *name;              // Field name for display
+	FieldId id;                    // Stable identity, see FieldId
 	const char *category;          // Category for grouping
 	FieldType type;                // Field type
 	size_t offset;                 // offsetof() from structure base
@@ -194,6 +249,7 @@ static const RegionMeta v4_v6_regions[] =
 		.data_start = EEPROM_V4_REGION1_START,
 		.data_size = EEPROM_V4_REGION1_SIZE,
 		.crc_pos = EEPROM_V4_REGION1_CRC_POS,
+		.crc_start = 0,  // Region 1 CRC covers the header
 		.crc_bits = EEPROM_V4_REGION1_CRC_BITS,
 		.test_result_pos = 95,  // PT1 result position
 		.test_name = "PT1"
@@ -203,6 +259,7 @@ static const RegionMeta v4_v6_regions[] =
 		.data_start = EEPROM_V4_REGION2_START,
 		.data_size = EEPROM_V4_REGION2_SIZE,
 		.crc_pos = EEPROM_V4_REGION2_CRC_POS,
+		.crc_start = EEPROM_V4_REGION2_START,
 		.crc_bits = EEPROM_V4_REGION2_CRC_BITS,
 		.test_result_pos = 108,  // PT2 result position
 		.test_name = "PT2"
@@ -212,6 +269,7 @@ static const RegionMeta v4_v6_regions[] =
 		.data_start = EEPROM_V5_REGION3_START,
 		.data_size = EEPROM_V5_REGION3_SIZE,
 		.crc_pos = EEPROM_V5_REGION3_CRC_POS,
+		.crc_start = EEPROM_V5_REGION3_START,
 		.crc_bits = EEPROM_V5_REGION3_CRC_BITS,
 		.test_result_pos = 247,  // Sweep result position
 		.test_name = "Sweep"
@@ -226,6 +284,7 @@ static const RegionMeta v17_regions[] =
 		.data_start = EEPROM_V17_HEADER_SIZE,
 		.data_size = EEPROM_V17_DATA_SIZE,
 		.crc_pos = EEPROM_V17_CRC_POS,
+		.crc_start = 0,  // CRC covers the header
 		.crc_bits = EEPROM_V17_CRC_BITS,
 		.test_result_pos = 67,  // Test result position
 		.test_name = "Test"
@@ -240,6 +299,7 @@ static const RegionMeta v1_regions[] =
 		.data_start = EEPROM_V1_PT1_START,
 		.data_size = EEPROM_V1_PT1_SIZE,
 		.crc_pos = EEPROM_V1_PT1_CRC_POS,
+		.crc_start = EEPROM_V1_PT1_START,
 		.crc_bits = EEPROM_V1_PT1_CRC_BYTES * 8,
 		.test_result_pos = 93,  // 16 + 77
 		.test_name = "PT1"
@@ -249,6 +309,7 @@ static const RegionMeta v1_regions[] =
 		.data_start = EEPROM_V1_PT2_START,
 		.data_size = EEPROM_V1_PT2_SIZE,
 		.crc_pos = EEPROM_V1_PT2_CRC_POS,
+		.crc_start = EEPROM_V1_PT2_START,
 		.crc_bits = EEPROM_V1_PT2_CRC_BYTES * 8,
 		.test_result_pos = 107,  // 96 + 11
 		.test_name = "PT2"
@@ -258,8 +319,9 @@ static const RegionMeta v1_regions[] =
 		.data_start = EEPROM_V1_SWEEP_START,
 		.data_size = EEPROM_V1_SWEEP_SIZE,
 		.crc_pos = EEPROM_V1_SWEEP_CRC_POS,
+		.crc_start = EEPROM_V1_SWEEP_START,
 		.crc_bits = EEPROM_V1_SWEEP_CRC_BYTES * 8,
-		.test_result_pos = 253,  // 112 + 141
+		.test_result_pos = 247,  // 112 + 135, sweep_result
 		.test_name = "Sweep"
 	}
 };
@@ -330,6 +392,7 @@ static const FieldMetadata eeprom_v4_v6_fields[] =
 	// Header
 	{
 		.name = "EEPROM Version",
+		.id = FIELD_ID_EEPROM_VERSION,
 		.category = "Header",
 		.type = FIELD_TYPE_UINT8,
 		.offset = offsetof(EEPROMStructure, eeprom_version),
@@ -342,6 +405,7 @@ static const FieldMetadata eeprom_v4_v6_fields[] =
 	},
 	{
 		.name = "Algorithm & Key",
+		.id = FIELD_ID_ALGORITHM_KEY,
 		.category = "Header",
 		.type = FIELD_TYPE_HEX8,
 		.offset = offsetof(EEPROMStructure, algorithm_and_key_version),
@@ -356,6 +420,7 @@ static const FieldMetadata eeprom_v4_v6_fields[] =
 	// Board Information
 	{
 		.name = "Board Serial",
+		.id = FIELD_ID_BOARD_SERIAL,
 		.category = "Board Information",
 		.type = FIELD_TYPE_STRING,
 		.offset = offsetof(EEPROMStructure, board_info.board_sn),
@@ -368,6 +433,7 @@ static const FieldMetadata eeprom_v4_v6_fields[] =
 	},
 	{
 		.name = "Board Name",
+		.id = FIELD_ID_BOARD_NAME,
 		.category = "Board Information",
 		.type = FIELD_TYPE_STRING,
 		.offset = offsetof(EEPROMStructure, board_info.board_name),
@@ -380,6 +446,7 @@ static const FieldMetadata eeprom_v4_v6_fields[] =
 	},
 	{
 		.name = "PCB Version",
+		.id = FIELD_ID_PCB_VERSION,
 		.category = "Board Information",
 		.type = FIELD_TYPE_HEX16,
 		.offset = offsetof(EEPROMStructure, board_info.pcb_version),
@@ -392,6 +459,7 @@ static const FieldMetadata eeprom_v4_v6_fields[] =
 	},
 	{
 		.name = "BOM Version",
+		.id = FIELD_ID_BOM_VERSION,
 		.category = "Board Information",
 		.type = FIELD_TYPE_HEX16,
 		.offset = offsetof(EEPROMStructure, board_info.bom_version),
@@ -404,6 +472,7 @@ static const FieldMetadata eeprom_v4_v6_fields[] =
 	},
 	{
 		.name = "Chip Die",
+		.id = FIELD_ID_CHIP_DIE,
 		.category = "Board Information",
 		.type = FIELD_TYPE_STRING,
 		.offset = offsetof(EEPROMStructure, board_info.chip_die),
@@ -416,6 +485,7 @@ static const FieldMetadata eeprom_v4_v6_fields[] =
 	},
 	{
 		.name = "Chip Marking",
+		.id = FIELD_ID_CHIP_MARKING,
 		.category = "Board Information",
 		.type = FIELD_TYPE_STRING,
 		.offset = offsetof(EEPROMStructure, board_info.chip_marking),
@@ -428,6 +498,7 @@ static const FieldMetadata eeprom_v4_v6_fields[] =
 	},
 	{
 		.name = "Chip Bin",
+		.id = FIELD_ID_CHIP_BIN,
 		.category = "Board Information",
 		.type = FIELD_TYPE_UINT8,
 		.offset = offsetof(EEPROMStructure, board_info.chip_bin),
@@ -440,6 +511,7 @@ static const FieldMetadata eeprom_v4_v6_fields[] =
 	},
 	{
 		.name = "Chip Tech",
+		.id = FIELD_ID_CHIP_TECH,
 		.category = "Board Information",
 		.type = FIELD_TYPE_STRING,
 		.offset = offsetof(EEPROMStructure, board_info.chip_tech),
@@ -452,6 +524,7 @@ static const FieldMetadata eeprom_v4_v6_fields[] =
 	},
 	{
 		.name = "FT Version",
+		.id = FIELD_ID_FT_VERSION,
 		.category = "Board Information",
 		.type = FIELD_TYPE_STRING,
 		.offset = offsetof(EEPROMStructure, board_info.ft_version),
@@ -464,6 +537,7 @@ static const FieldMetadata eeprom_v4_v6_fields[] =
 	},
 	{
 		.name = "Factory Job",
+		.id = FIELD_ID_FACTORY_JOB,
 		.category = "Board Information",
 		.type = FIELD_TYPE_STRING,
 		.offset = offsetof(EEPROMStructure, board_info.factory_job),
@@ -476,6 +550,7 @@ static const FieldMetadata eeprom_v4_v6_fields[] =
 	},
 	{
 		.name = "ASIC Sensor Type",
+		.id = FIELD_ID_ASIC_SENSOR_TYPE,
 		.category = "Board Information",
 		.type = FIELD_TYPE_UINT8,
 		.offset = offsetof(EEPROMStructure, board_info.asic_sensor_type),
@@ -488,6 +563,7 @@ static const FieldMetadata eeprom_v4_v6_fields[] =
 	},
 	{
 		.name = "PT1 Result",
+		.id = FIELD_ID_PT1_RESULT,
 		.category = "Board Information",
 		.type = FIELD_TYPE_UINT8,
 		.offset = offsetof(EEPROMStructure, board_info.pt1_result),
@@ -500,6 +576,7 @@ static const FieldMetadata eeprom_v4_v6_fields[] =
 	},
 	{
 		.name = "PT1 Count",
+		.id = FIELD_ID_PT1_COUNT,
 		.category = "Board Information",
 		.type = FIELD_TYPE_UINT8,
 		.offset = offsetof(EEPROMStructure, board_info.pt1_count),
@@ -514,6 +591,7 @@ static const FieldMetadata eeprom_v4_v6_fields[] =
 	// Test Parameters
 	{
 		.name = "PSU Voltage",
+		.id = FIELD_ID_PSU_VOLTAGE,
 		.category = "Test Parameters",
 		.type = FIELD_TYPE_VOLTAGE,
 		.offset = offsetof(EEPROMStructure, test_params.voltage),
@@ -526,6 +604,7 @@ static const FieldMetadata eeprom_v4_v6_fields[] =
 	},
 	{
 		.name = "Frequency",
+		.id = FIELD_ID_FREQUENCY,
 		.category = "Test Parameters",
 		.type = FIELD_TYPE_UINT16,
 		.offset = offsetof(EEPROMStructure, test_params.frequency),
@@ -538,6 +617,7 @@ static const FieldMetadata eeprom_v4_v6_fields[] =
 	},
 	{
 		.name = "Nonce Rate",
+		.id = FIELD_ID_NONCE_RATE,
 		.category = "Test Parameters",
 		.type = FIELD_TYPE_UINT16,
 		.offset = offsetof(EEPROMStructure, test_params.nonce_rate),
@@ -550,6 +630,7 @@ static const FieldMetadata eeprom_v4_v6_fields[] =
 	},
 	{
 		.name = "PCB Temp In",
+		.id = FIELD_ID_PCB_TEMP_IN,
 		.category = "Test Parameters",
 		.type = FIELD_TYPE_INT8,
 		.offset = offsetof(EEPROMStructure, test_params.pcb_temp_in),
@@ -562,6 +643,7 @@ static const FieldMetadata eeprom_v4_v6_fields[] =
 	},
 	{
 		.name = "PCB Temp Out",
+		.id = FIELD_ID_PCB_TEMP_OUT,
 		.category = "Test Parameters",
 		.type = FIELD_TYPE_INT8,
 		.offset = offsetof(EEPROMStructure, test_params.pcb_temp_out),
@@ -574,6 +656,7 @@ static const FieldMetadata eeprom_v4_v6_fields[] =
 	},
 	{
 		.name = "Test Version",
+		.id = FIELD_ID_TEST_VERSION,
 		.category = "Test Parameters",
 		.type = FIELD_TYPE_UINT8,
 		.offset = offsetof(EEPROMStructure, test_params.test_version),
@@ -586,6 +669,7 @@ static const FieldMetadata eeprom_v4_v6_fields[] =
 	},
 	{
 		.name = "Test Standard",
+		.id = FIELD_ID_TEST_STANDARD,
 		.category = "Test Parameters",
 		.type = FIELD_TYPE_UINT8,
 		.offset = offsetof(EEPROMStructure, test_params.test_standard),
@@ -598,6 +682,7 @@ static const FieldMetadata eeprom_v4_v6_fields[] =
 	},
 	{
 		.name = "PT2 Result",
+		.id = FIELD_ID_PT2_RESULT,
 		.category = "Test Parameters",
 		.type = FIELD_TYPE_UINT8,
 		.offset = offsetof(EEPROMStructure, test_params.pt2_result),
@@ -610,6 +695,7 @@ static const FieldMetadata eeprom_v4_v6_fields[] =
 	},
 	{
 		.name = "PT2 Count",
+		.id = FIELD_ID_PT2_COUNT,
 		.category = "Test Parameters",
 		.type = FIELD_TYPE_UINT8,
 		.offset = offsetof(EEPROMStructure, test_params.pt2_count),
@@ -624,6 +710,7 @@ static const FieldMetadata eeprom_v4_v6_fields[] =
 	// Sweep Data (v5+ only)
 	{
 		.name = "Sweep Hashrate",
+		.id = FIELD_ID_SWEEP_HASHRATE,
 		.category = "Sweep Data",
 		.type = FIELD_TYPE_UINT16,
 		.offset = offsetof(EEPROMStructure, sweep_data.sweep_hashrate),
@@ -636,6 +723,7 @@ static const FieldMetadata eeprom_v4_v6_fields[] =
 	},
 	{
 		.name = "Sweep Freq Base",
+		.id = FIELD_ID_SWEEP_FREQ_BASE,
 		.category = "Sweep Data",
 		.type = FIELD_TYPE_UINT16,
 		.offset = offsetof(EEPROMStructure, sweep_data.sweep_freq_base),
@@ -648,6 +736,7 @@ static const FieldMetadata eeprom_v4_v6_fields[] =
 	},
 	{
 		.name = "Sweep Freq Step",
+		.id = FIELD_ID_SWEEP_FREQ_STEP,
 		.category = "Sweep Data",
 		.type = FIELD_TYPE_UINT8,
 		.offset = offsetof(EEPROMStructure, sweep_data.sweep_freq_step),
@@ -660,6 +749,7 @@ static const FieldMetadata eeprom_v4_v6_fields[] =
 	},
 	{
 		.name = "ASIC Frequencies",
+		.id = FIELD_ID_ASIC_FREQUENCIES,
 		.category = "Sweep Data",
 		.type = FIELD_TYPE_ARRAY_UINT8,
 		.offset = offsetof(EEPROMStructure, sweep_data.sweep_level),
@@ -672,6 +762,7 @@ static const FieldMetadata eeprom_v4_v6_fields[] =
 	},
 	{
 		.name = "Sweep Result",
+		.id = FIELD_ID_SWEEP_RESULT,
 		.category = "Sweep Data",
 		.type = FIELD_TYPE_UINT8,
 		.offset = offsetof(EEPROMStructure, sweep_data.sweep_result),
@@ -692,6 +783,7 @@ static const FieldMetadata eeprom_v17_fields[] =
 	// Header
 	{
 		.name = "Algorithm & Key",
+		.id = FIELD_ID_ALGORITHM_KEY,
 		.category = "Header",
 		.type = FIELD_TYPE_HEX8,
 		.offset = offsetof(EEPROMStructure_v17, algorithm_and_key),
@@ -704,6 +796,7 @@ static const FieldMetadata eeprom_v17_fields[] =
 	},
 	{
 		.name = "Data Length",
+		.id = FIELD_ID_DATA_LENGTH,
 		.category = "Header",
 		.type = FIELD_TYPE_UINT8,
 		.offset = offsetof(EEPROMStructure_v17, data_length),
@@ -718,6 +811,7 @@ static const FieldMetadata eeprom_v17_fields[] =
 	// Identification
 	{
 		.name = "Subformat Version",
+		.id = FIELD_ID_SUBFORMAT_VERSION,
 		.category = "Identification",
 		.type = FIELD_TYPE_UINT8,
 		.offset = offsetof(EEPROMStructure_v17, data.subformat_version),
@@ -730,6 +824,7 @@ static const FieldMetadata eeprom_v17_fields[] =
 	},
 	{
 		.name = "Serial Number",
+		.id = FIELD_ID_SERIAL_NUMBER,
 		.category = "Identification",
 		.type = FIELD_TYPE_STRING,
 		.offset = offsetof(EEPROMStructure_v17, data.serial_number),
@@ -742,6 +837,7 @@ static const FieldMetadata eeprom_v17_fields[] =
 	},
 	{
 		.name = "Chip Die",
+		.id = FIELD_ID_CHIP_DIE,
 		.category = "Identification",
 		.type = FIELD_TYPE_STRING,
 		.offset = offsetof(EEPROMStructure_v17, data.chip_die),
@@ -754,6 +850,7 @@ static const FieldMetadata eeprom_v17_fields[] =
 	},
 	{
 		.name = "Chip Marking",
+		.id = FIELD_ID_CHIP_MARKING,
 		.category = "Identification",
 		.type = FIELD_TYPE_STRING,
 		.offset = offsetof(EEPROMStructure_v17, data.chip_marking),
@@ -766,6 +863,7 @@ static const FieldMetadata eeprom_v17_fields[] =
 	},
 	{
 		.name = "Chip Bin",
+		.id = FIELD_ID_CHIP_BIN,
 		.category = "Identification",
 		.type = FIELD_TYPE_UINT8,
 		.offset = offsetof(EEPROMStructure_v17, data.chip_bin),
@@ -778,6 +876,7 @@ static const FieldMetadata eeprom_v17_fields[] =
 	},
 	{
 		.name = "FT Program Version",
+		.id = FIELD_ID_FT_PROGRAM_VERSION,
 		.category = "Identification",
 		.type = FIELD_TYPE_STRING,
 		.offset = offsetof(EEPROMStructure_v17, data.ft_program_version),
@@ -790,6 +889,7 @@ static const FieldMetadata eeprom_v17_fields[] =
 	},
 	{
 		.name = "Miner Type",
+		.id = FIELD_ID_MINER_TYPE,
 		.category = "Identification",
 		.type = FIELD_TYPE_STRING,
 		.offset = offsetof(EEPROMStructure_v17, data.miner_type),
@@ -804,6 +904,7 @@ static const FieldMetadata eeprom_v17_fields[] =
 	// Hardware Versions
 	{
 		.name = "PCB Version",
+		.id = FIELD_ID_PCB_VERSION,
 		.category = "Hardware",
 		.type = FIELD_TYPE_HEX16,
 		.offset = offsetof(EEPROMStructure_v17, data.pcb_version),
@@ -816,6 +917,7 @@ static const FieldMetadata eeprom_v17_fields[] =
 	},
 	{
 		.name = "BOM Version",
+		.id = FIELD_ID_BOM_VERSION,
 		.category = "Hardware",
 		.type = FIELD_TYPE_HEX16,
 		.offset = offsetof(EEPROMStructure_v17, data.bom_version),
@@ -828,6 +930,7 @@ static const FieldMetadata eeprom_v17_fields[] =
 	},
 	{
 		.name = "Chip Technology",
+		.id = FIELD_ID_CHIP_TECHNOLOGY,
 		.category = "Hardware",
 		.type = FIELD_TYPE_STRING,
 		.offset = offsetof(EEPROMStructure_v17, data.chip_technology),
@@ -840,6 +943,7 @@ static const FieldMetadata eeprom_v17_fields[] =
 	},
 	{
 		.name = "ASIC Sensor Type",
+		.id = FIELD_ID_ASIC_SENSOR_TYPE,
 		.category = "Hardware",
 		.type = FIELD_TYPE_UINT8,
 		.offset = offsetof(EEPROMStructure_v17, data.asic_sensor_type),
@@ -854,6 +958,7 @@ static const FieldMetadata eeprom_v17_fields[] =
 	// Test Parameters
 	{
 		.name = "Test Voltage",
+		.id = FIELD_ID_TEST_VOLTAGE,
 		.category = "Test Parameters",
 		.type = FIELD_TYPE_UINT16,
 		.offset = offsetof(EEPROMStructure_v17, data.test_voltage),
@@ -866,6 +971,7 @@ static const FieldMetadata eeprom_v17_fields[] =
 	},
 	{
 		.name = "Test Frequency",
+		.id = FIELD_ID_TEST_FREQUENCY,
 		.category = "Test Parameters",
 		.type = FIELD_TYPE_UINT16,
 		.offset = offsetof(EEPROMStructure_v17, data.test_frequency),
@@ -878,6 +984,7 @@ static const FieldMetadata eeprom_v17_fields[] =
 	},
 	{
 		.name = "Test Hashrate",
+		.id = FIELD_ID_TEST_HASHRATE,
 		.category = "Test Parameters",
 		.type = FIELD_TYPE_HASHRATE,
 		.offset = offsetof(EEPROMStructure_v17, data.test_hashrate),
@@ -890,6 +997,7 @@ static const FieldMetadata eeprom_v17_fields[] =
 	},
 	{
 		.name = "PCB Temp In",
+		.id = FIELD_ID_PCB_TEMP_IN,
 		.category = "Test Parameters",
 		.type = FIELD_TYPE_INT8,
 		.offset = offsetof(EEPROMStructure_v17, data.pcb_temperature_in),
@@ -902,6 +1010,7 @@ static const FieldMetadata eeprom_v17_fields[] =
 	},
 	{
 		.name = "PCB Temp Out",
+		.id = FIELD_ID_PCB_TEMP_OUT,
 		.category = "Test Parameters",
 		.type = FIELD_TYPE_INT8,
 		.offset = offsetof(EEPROMStructure_v17, data.pcb_temperature_out),
@@ -914,6 +1023,7 @@ static const FieldMetadata eeprom_v17_fields[] =
 	},
 	{
 		.name = "Test Parameter",
+		.id = FIELD_ID_TEST_PARAMETER,
 		.category = "Test Parameters",
 		.type = FIELD_TYPE_UINT8,
 		.offset = offsetof(EEPROMStructure_v17, data.test_parameter),
@@ -926,6 +1036,7 @@ static const FieldMetadata eeprom_v17_fields[] =
 	},
 	{
 		.name = "Test Result",
+		.id = FIELD_ID_TEST_RESULT,
 		.category = "Test Parameters",
 		.type = FIELD_TYPE_UINT8,
 		.offset = offsetof(EEPROMStructure_v17, data.test_result),
@@ -946,6 +1057,7 @@ static const FieldMetadata eeprom_v1_fields[] =
 	// Header
 	{
 		.name = "EEPROM Version",
+		.id = FIELD_ID_EEPROM_VERSION,
 		.category = "Header",
 		.type = FIELD_TYPE_UINT8,
 		.offset = offsetof(EEPROMStructure_v1, eeprom_version),
@@ -958,6 +1070,7 @@ static const FieldMetadata eeprom_v1_fields[] =
 	},
 	{
 		.name = "Board Name",
+		.id = FIELD_ID_BOARD_NAME,
 		.category = "Header",
 		.type = FIELD_TYPE_STRING,
 		.offset = offsetof(EEPROMStructure_v1, board_name),
@@ -972,6 +1085,7 @@ static const FieldMetadata eeprom_v1_fields[] =
 	// PT1: Board Information
 	{
 		.name = "Board Serial",
+		.id = FIELD_ID_BOARD_SERIAL,
 		.category = "Board Information",
 		.type = FIELD_TYPE_STRING,
 		.offset = offsetof(EEPROMStructure_v1, pt1_data.board_serial),
@@ -984,6 +1098,7 @@ static const FieldMetadata eeprom_v1_fields[] =
 	},
 	{
 		.name = "Factory Job",
+		.id = FIELD_ID_FACTORY_JOB,
 		.category = "Board Information",
 		.type = FIELD_TYPE_STRING,
 		.offset = offsetof(EEPROMStructure_v1, pt1_data.factory_job),
@@ -996,6 +1111,7 @@ static const FieldMetadata eeprom_v1_fields[] =
 	},
 	{
 		.name = "Chip Die",
+		.id = FIELD_ID_CHIP_DIE,
 		.category = "Board Information",
 		.type = FIELD_TYPE_STRING,
 		.offset = offsetof(EEPROMStructure_v1, pt1_data.chip_die),
@@ -1008,6 +1124,7 @@ static const FieldMetadata eeprom_v1_fields[] =
 	},
 	{
 		.name = "Chip Marking",
+		.id = FIELD_ID_CHIP_MARKING,
 		.category = "Board Information",
 		.type = FIELD_TYPE_STRING,
 		.offset = offsetof(EEPROMStructure_v1, pt1_data.chip_marking),
@@ -1020,6 +1137,7 @@ static const FieldMetadata eeprom_v1_fields[] =
 	},
 	{
 		.name = "FT Version",
+		.id = FIELD_ID_FT_VERSION,
 		.category = "Board Information",
 		.type = FIELD_TYPE_STRING,
 		.offset = offsetof(EEPROMStructure_v1, pt1_data.ft_version),
@@ -1032,6 +1150,7 @@ static const FieldMetadata eeprom_v1_fields[] =
 	},
 	{
 		.name = "Chip Tech",
+		.id = FIELD_ID_CHIP_TECH,
 		.category = "Board Information",
 		.type = FIELD_TYPE_STRING,
 		.offset = offsetof(EEPROMStructure_v1, pt1_data.chip_tech),
@@ -1044,6 +1163,7 @@ static const FieldMetadata eeprom_v1_fields[] =
 	},
 	{
 		.name = "Chip Bin",
+		.id = FIELD_ID_CHIP_BIN,
 		.category = "Board Information",
 		.type = FIELD_TYPE_UINT8,
 		.offset = offsetof(EEPROMStructure_v1, pt1_data.chip_bin),
@@ -1056,6 +1176,7 @@ static const FieldMetadata eeprom_v1_fields[] =
 	},
 	{
 		.name = "PCB Version",
+		.id = FIELD_ID_PCB_VERSION,
 		.category = "Board Information",
 		.type = FIELD_TYPE_HEX16,
 		.offset = offsetof(EEPROMStructure_v1, pt1_data.pcb_version),
@@ -1068,6 +1189,7 @@ static const FieldMetadata eeprom_v1_fields[] =
 	},
 	{
 		.name = "BOM Version",
+		.id = FIELD_ID_BOM_VERSION,
 		.category = "Board Information",
 		.type = FIELD_TYPE_UINT8,
 		.offset = offsetof(EEPROMStructure_v1, pt1_data.bom_version),
@@ -1080,6 +1202,7 @@ static const FieldMetadata eeprom_v1_fields[] =
 	},
 	{
 		.name = "ASIC Sensor Type",
+		.id = FIELD_ID_ASIC_SENSOR_TYPE,
 		.category = "Board Information",
 		.type = FIELD_TYPE_UINT8,
 		.offset = offsetof(EEPROMStructure_v1, pt1_data.asic_sensor_type),
@@ -1092,6 +1215,7 @@ static const FieldMetadata eeprom_v1_fields[] =
 	},
 	{
 		.name = "PT1 Result",
+		.id = FIELD_ID_PT1_RESULT,
 		.category = "Board Information",
 		.type = FIELD_TYPE_UINT8,
 		.offset = offsetof(EEPROMStructure_v1, pt1_data.pt1_result),
@@ -1104,6 +1228,7 @@ static const FieldMetadata eeprom_v1_fields[] =
 	},
 	{
 		.name = "PT1 Count",
+		.id = FIELD_ID_PT1_COUNT,
 		.category = "Board Information",
 		.type = FIELD_TYPE_UINT8,
 		.offset = offsetof(EEPROMStructure_v1, pt1_data.pt1_count),
@@ -1118,6 +1243,7 @@ static const FieldMetadata eeprom_v1_fields[] =
 	// PT2: Test Parameters
 	{
 		.name = "PSU Voltage",
+		.id = FIELD_ID_PSU_VOLTAGE,
 		.category = "Test Parameters",
 		.type = FIELD_TYPE_VOLTAGE,
 		.offset = offsetof(EEPROMStructure_v1, pt2_data.voltage),
@@ -1130,6 +1256,7 @@ static const FieldMetadata eeprom_v1_fields[] =
 	},
 	{
 		.name = "Frequency",
+		.id = FIELD_ID_FREQUENCY,
 		.category = "Test Parameters",
 		.type = FIELD_TYPE_UINT16,
 		.offset = offsetof(EEPROMStructure_v1, pt2_data.frequency),
@@ -1142,6 +1269,7 @@ static const FieldMetadata eeprom_v1_fields[] =
 	},
 	{
 		.name = "Nonce Rate",
+		.id = FIELD_ID_NONCE_RATE,
 		.category = "Test Parameters",
 		.type = FIELD_TYPE_UINT16,
 		.offset = offsetof(EEPROMStructure_v1, pt2_data.nonce_rate),
@@ -1154,6 +1282,7 @@ static const FieldMetadata eeprom_v1_fields[] =
 	},
 	{
 		.name = "Done Type",
+		.id = FIELD_ID_DONE_TYPE,
 		.category = "Test Parameters",
 		.type = FIELD_TYPE_UINT8,
 		.offset = offsetof(EEPROMStructure_v1, pt2_data.done_type),
@@ -1166,6 +1295,7 @@ static const FieldMetadata eeprom_v1_fields[] =
 	},
 	{
 		.name = "PCB Temp In",
+		.id = FIELD_ID_PCB_TEMP_IN,
 		.category = "Test Parameters",
 		.type = FIELD_TYPE_INT8,
 		.offset = offsetof(EEPROMStructure_v1, pt2_data.temp_in),
@@ -1178,6 +1308,7 @@ static const FieldMetadata eeprom_v1_fields[] =
 	},
 	{
 		.name = "PCB Temp Out",
+		.id = FIELD_ID_PCB_TEMP_OUT,
 		.category = "Test Parameters",
 		.type = FIELD_TYPE_INT8,
 		.offset = offsetof(EEPROMStructure_v1, pt2_data.temp_out),
@@ -1190,6 +1321,7 @@ static const FieldMetadata eeprom_v1_fields[] =
 	},
 	{
 		.name = "PT2 Result",
+		.id = FIELD_ID_PT2_RESULT,
 		.category = "Test Parameters",
 		.type = FIELD_TYPE_UINT8,
 		.offset = offsetof(EEPROMStructure_v1, pt2_data.pt2_result),
@@ -1202,6 +1334,7 @@ static const FieldMetadata eeprom_v1_fields[] =
 	},
 	{
 		.name = "PT2 Count",
+		.id = FIELD_ID_PT2_COUNT,
 		.category = "Test Parameters",
 		.type = FIELD_TYPE_UINT8,
 		.offset = offsetof(EEPROMStructure_v1, pt2_data.pt2_count),
@@ -1216,6 +1349,7 @@ static const FieldMetadata eeprom_v1_fields[] =
 	// SWEEP: Frequency Optimization
 	{
 		.name = "SWEEP Voltage",
+		.id = FIELD_ID_SWEEP_VOLTAGE,
 		.category = "Sweep Data",
 		.type = FIELD_TYPE_VOLTAGE,
 		.offset = offsetof(EEPROMStructure_v1, sweep_data.voltage),
@@ -1228,6 +1362,7 @@ static const FieldMetadata eeprom_v1_fields[] =
 	},
 	{
 		.name = "Sweep Hashrate",
+		.id = FIELD_ID_SWEEP_HASHRATE,
 		.category = "Sweep Data",
 		.type = FIELD_TYPE_HASHRATE,
 		.offset = offsetof(EEPROMStructure_v1, sweep_data.sweep_hashrate),
@@ -1240,6 +1375,7 @@ static const FieldMetadata eeprom_v1_fields[] =
 	},
 	{
 		.name = "Sweep Freq Base",
+		.id = FIELD_ID_SWEEP_FREQ_BASE,
 		.category = "Sweep Data",
 		.type = FIELD_TYPE_UINT16,
 		.offset = offsetof(EEPROMStructure_v1, sweep_data.sweep_freq_base),
@@ -1252,6 +1388,7 @@ static const FieldMetadata eeprom_v1_fields[] =
 	},
 	{
 		.name = "Sweep Freq Step",
+		.id = FIELD_ID_SWEEP_FREQ_STEP,
 		.category = "Sweep Data",
 		.type = FIELD_TYPE_UINT8,
 		.offset = offsetof(EEPROMStructure_v1, sweep_data.sweep_freq_step),
@@ -1264,6 +1401,7 @@ static const FieldMetadata eeprom_v1_fields[] =
 	},
 	{
 		.name = "ASIC Frequencies",
+		.id = FIELD_ID_ASIC_FREQUENCIES,
 		.category = "Sweep Data",
 		.type = FIELD_TYPE_ARRAY_UINT8,
 		.offset = offsetof(EEPROMStructure_v1, sweep_data.sweep_level),
@@ -1276,6 +1414,7 @@ static const FieldMetadata eeprom_v1_fields[] =
 	},
 	{
 		.name = "Sweep Result",
+		.id = FIELD_ID_SWEEP_RESULT,
 		.category = "Sweep Data",
 		.type = FIELD_TYPE_UINT8,
 		.offset = offsetof(EEPROMStructure_v1, sweep_data.sweep_result),
@@ -1288,6 +1427,7 @@ static const FieldMetadata eeprom_v1_fields[] =
 	},
 	{
 		.name = "Sweep Count",
+		.id = FIELD_ID_SWEEP_COUNT,
 		.category = "Sweep Data",
 		.type = FIELD_TYPE_UINT8,
 		.offset = offsetof(EEPROMStructure_v1, sweep_data.sweep_count),
@@ -1328,4 +1468,68 @@ static inline const FieldMetadata* eeprom_get_fields(EEPROMVersion version, size
 	}
 }
 
+// Field key of a name: lowercase letters and digits, any run of other
+// characters becomes one '_' ("Algorithm & Key" -> "algorithm_key").
+// Returns the key length; truncated to size - 1.
+static inline size_t eeprom_field_key(const char *name, char *key, size_t size)
+{
+	size_t n = 0;
+	int pending_sep = 0;
+
+	for (; *name && n + 2 < size; name++)
+	{
+		char c = *name;
+		if (c >= 'A' && c <= 'Z')
+		{
+			c = c - 'A' + 'a';
+		}
+		else if (!((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9')))
+		{
+			pending_sep = n > 0;
+			continue;
+		}
+
+		if (pending_sep)
+		{
+			key[n++] = '_';
+			pending_sep = 0;
+		}
+		key[n++] = c;
+	}
+	key[n] = '\0';
+	return n;
+}
+
+// Field table of a version: 0 = v1, 1 = v4-v6, 2 = v17, -1 = none
+#define EEPROM_FIELD_TABLES 3
+
+static inline int eeprom_field_table(EEPROMVersion version)
+{
+	switch (version)
+	{
+		case EEPROM_VERSION_V1:  return 0;
+		case EEPROM_VERSION_V4:
+		case EEPROM_VERSION_V5:
+		case EEPROM_VERSION_V6:  return 1;
+		case EEPROM_VERSION_V17: return 2;
+		default:                 return -1;
+	}
+}
+
+// Hash of the field index (eeprom_field_index.h): FNV-1a over the table
+// number and the key, seeded, with a final mix for the low bits
+static inline uint32_t eeprom_field_hash(uint32_t seed, int table, const char *key)
+{
+	uint32_t h = 2166136261u ^ (seed * 0x9E3779B9u);
+	h = (h ^ (uint32_t)table) * 16777619u;
+	for (; *key; key++)
+	{
+		h = (h ^ (uint8_t)*key) * 16777619u;
+	}
+	h ^= h >> 15;
+	h *= 0x2C1B3C6Du;
+	h ^= h >> 12;
+	return h;
+}
+
 #endif // EEPROM_DEFS_H
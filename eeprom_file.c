@@ -0,0 +1,117 @@
+#include "eeprom_file.h"
+#include "eeprom_ops.h"
+#include "stats.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+int eeprom_read_file(const char *filename, uint8_t *buffer, size_t *size)
+{
+	STATS_BEGIN(start);
+	FILE *file = fopen(filename, "rb");
+	if (!file)
+	{
+		return EEPROM_ERROR_IO;
+	}
+
+	// Один fread на EEPROM_SIZE + 1 байт: и данные, и проверка размера без fseek/ftell
+	uint8_t raw[EEPROM_SIZE + 1];
+	size_t read_size = fread(raw, 1, sizeof(raw), file);
+	int failed = ferror(file);
+
+	if (!failed && read_size > EEPROM_SIZE && fseek(file, 0, SEEK_END) == 0)
+	{
+		read_size = (size_t)ftell(file);
+	}
+	fclose(file);
+	STATS_END(STATS_FILE_READ, start);
+	STATS_ADD(STATS_BYTES_READ, read_size);
+
+	if (size)
+	{
+		*size = read_size;
+	}
+
+	if (failed)
+	{
+		errno = EIO;
+		return EEPROM_ERROR_IO;
+	}
+
+	if (read_size == 0 || read_size > EEPROM_SIZE)
+	{
+		return EEPROM_ERROR_SIZE;
+	}
+
+	memcpy(buffer, raw, read_size);
+	memset(buffer + read_size, 0xFF, EEPROM_SIZE - read_size);
+	return EEPROM_SUCCESS;
+}
+
+int eeprom_write_file(const char *filename, const uint8_t *buffer, size_t size)
+{
+	FILE *file = fopen(filename, "wb");
+	if (!file)
+	{
+		return EEPROM_ERROR_IO;
+	}
+
+	size_t written_size = fwrite(buffer, 1, size, file);
+	if (fclose(file) != 0 || written_size != size)
+	{
+		return EEPROM_ERROR_IO;
+	}
+
+	return EEPROM_SUCCESS;
+}
+
+int eeprom_write_file_atomic(const char *filename, const uint8_t *buffer, size_t size)
+{
+	// Имя временного файла уникально и между потоками одного процесса
+	static unsigned long sequence;
+	char tmp_path[4096];
+	int length = snprintf(tmp_path, sizeof(tmp_path), "%s.%ld.%lu.tmp", filename, (long)getpid(),
+						  __atomic_fetch_add(&sequence, 1, __ATOMIC_RELAXED));
+	if (length < 0 || length >= (int)sizeof(tmp_path))
+	{
+		errno = ENAMETOOLONG;
+		return EEPROM_ERROR_IO;
+	}
+
+	struct stat st;
+	mode_t mode = stat(filename, &st) == 0 ? (st.st_mode & 07777) : 0666;
+
+	int fd = open(tmp_path, O_WRONLY | O_CREAT | O_EXCL, mode);
+	if (fd < 0)
+	{
+		return EEPROM_ERROR_IO;
+	}
+
+	// open() применяет umask; права существующего файла восстанавливаются явно
+	int failed = write(fd, buffer, size) != (ssize_t)size ||
+				 (mode != 0666 && fchmod(fd, mode) != 0) ||
+				 fsync(fd) != 0;
+	int saved_errno = errno;
+	if (close(fd) != 0 && !failed)
+	{
+		failed = 1;
+		saved_errno = errno;
+	}
+
+	if (!failed && rename(tmp_path, filename) != 0)
+	{
+		failed = 1;
+		saved_errno = errno;
+	}
+
+	if (failed)
+	{
+		unlink(tmp_path);
+		errno = saved_errno ? saved_errno : EIO;
+		return EEPROM_ERROR_IO;
+	}
+	return EEPROM_SUCCESS;
+}
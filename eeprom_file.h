@@ -0,0 +1,34 @@
+#ifndef EEPROM_FILE_H
+#define EEPROM_FILE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ═══════════════════════════════════════════════════════════════
+// EEPROM dump files (raw 1..256 byte images)
+// ═══════════════════════════════════════════════════════════════
+
+/**
+ * Read an EEPROM dump
+ * @param filename - dump path
+ * @param buffer - EEPROM_SIZE bytes; bytes past the end of the file are set to 0xFF
+ * @param size - file size (may be NULL); also set on EEPROM_ERROR_SIZE
+ * @return EEPROM_SUCCESS, EEPROM_ERROR_IO (errno is set) or EEPROM_ERROR_SIZE
+ */
+int eeprom_read_file(const char *filename, uint8_t *buffer, size_t *size);
+
+/**
+ * Write size bytes of an EEPROM image
+ * @return EEPROM_SUCCESS or EEPROM_ERROR_IO (errno is set)
+ */
+int eeprom_write_file(const char *filename, const uint8_t *buffer, size_t size);
+
+/**
+ * Same, but through a temporary file in the same directory, fsync and
+ * rename: readers see either the old or the new image, never a partial
+ * one. An existing file keeps its permissions.
+ * @return EEPROM_SUCCESS or EEPROM_ERROR_IO (errno is set)
+ */
+int eeprom_write_file_atomic(const char *filename, const uint8_t *buffer, size_t size);
+
+#endif // EEPROM_FILE_H
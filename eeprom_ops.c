@@ -1,37 +1,162 @@
 #include "eeprom_ops.h"
 #include "crypto.h"
+#include "stats.h"
+#include "eeprom_field_index.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
 #include <string.h>
+#include <ctype.h>
+#include <errno.h>
+
+// ═══════════════════════════════════════════════════════════════
+// Diagnostics
+// ═══════════════════════════════════════════════════════════════
+
+static EEPROMDiagHandler diag_handler = NULL;
+static void *diag_user = NULL;
+
+void eeprom_set_diag_handler(EEPROMDiagHandler handler, void *user)
+{
+	diag_handler = handler;
+	diag_user = user;
+}
+
+// Без обработчика сообщение даже не форматируется
+__attribute__((format(printf, 2, 3)))
+static void eeprom_diag(EEPROMDiagLevel level, const char *format, ...)
+{
+	if (!diag_handler)
+	{
+		return;
+	}
+
+	char message[256];
+	va_list args;
+	va_start(args, format);
+	vsnprintf(message, sizeof(message), format, args);
+	va_end(args);
+
+	diag_handler(level, message, diag_user);
+}
+
+const char *eeprom_strerror(int code)
+{
+	switch (code)
+	{
+		case EEPROM_SUCCESS:         return "OK";
+		case EEPROM_ERROR_CRC:       return "CRC mismatch";
+		case EEPROM_ERROR_VERSION:   return "unknown EEPROM version";
+		case EEPROM_ERROR_TEST_FAIL: return "test did not pass";
+		case EEPROM_ERROR_IO:        return "I/O error";
+		case EEPROM_ERROR_SIZE:      return "invalid size";
+		case EEPROM_ERROR_READ_ONLY: return "field is read-only";
+		case EEPROM_ERROR_RANGE:     return "value out of range";
+		default:                     return "error";
+	}
+}
 
 // ═══════════════════════════════════════════════════════════════
 // Generic Region Processing
 // ═══════════════════════════════════════════════════════════════
 
-static void process_region_decode(uint8_t *data,
-								   const RegionMeta *region,
-								   uint8_t algorithm,
-								   uint8_t key_index,
-								   EEPROMVersion version)
+// CRC и результат теста уже расшифрованного региона
+static void process_region_check(const uint8_t *data,
+								 const RegionMeta *region,
+								 EEPROMVersion version,
+								 EEPROMRegionStatus *status)
 {
-	decode_data(data + region->data_start,
-			   region->data_size,
-			   algorithm, key_index, version);
+	STATS_BEGIN(crc_start);
+	if (version == EEPROM_VERSION_V1)
+	{
+		status->crc_calculated = calculate_crc8_v1(data + region->crc_start,
+												   region->crc_bits / 8);
+	}
+	else
+	{
+		status->crc_calculated = calculate_crc(data + region->crc_start, region->crc_bits);
+	}
+	STATS_END(STATS_CRC, crc_start);
 
-	uint8_t calculated_crc = calculate_crc(data, region->crc_bits);
-	if (calculated_crc != data[region->crc_pos])
+	status->crc_stored = data[region->crc_pos];
+	status->crc_ok = status->crc_calculated == status->crc_stored;
+	if (!status->crc_ok)
 	{
-		printf("Warning: CRC mismatch in %s. Calculated: 0x%02X, Stored: 0x%02X\n",
-			  region->name, calculated_crc, data[region->crc_pos]);
+		eeprom_diag(EEPROM_DIAG_WARNING, "CRC mismatch in %s. Calculated: 0x%02X, Stored: 0x%02X",
+					region->name, status->crc_calculated, status->crc_stored);
 	}
 
-	if (region->test_result_pos >= 0 && region->test_name)
+	status->has_test = region->test_result_pos >= 0 && region->test_name;
+	status->test_result = status->has_test ? data[region->test_result_pos] : 0;
+	status->test_ok = !status->has_test || status->test_result == 1;
+	if (!status->test_ok)
+	{
+		eeprom_diag(EEPROM_DIAG_WARNING, "%s test did not pass (result = %d)",
+					region->test_name, status->test_result);
+	}
+}
+
+static int process_region_decode(uint8_t *data,
+								  const RegionMeta *region,
+								  const EEPROMKeyInfo *key,
+								  EEPROMVersion version,
+								  EEPROMRegionStatus *status)
+{
+	if (version == EEPROM_VERSION_V1)
 	{
-		if (data[region->test_result_pos] != 1)
+		STATS_BEGIN(start);
+		if (decode_data_v1(data + region->data_start,
+						   region->data_size,
+						   key->v1_key) != 0)
 		{
-			printf("Warning: %s test did not pass (result = %d)\n",
-				  region->test_name, data[region->test_result_pos]);
+			eeprom_diag(EEPROM_DIAG_ERROR, "Failed to decrypt %s block", region->name);
+			return EEPROM_ERROR_UNKNOWN;
 		}
+		STATS_END(STATS_DECRYPT_AES, start);
+	}
+	else
+	{
+		STATS_BEGIN(start);
+		decode_data(data + region->data_start,
+				   region->data_size,
+				   key->algorithm, key->key_index, key->key_table);
+		STATS_END(STATS_DECRYPT_XXTEA, start);
+	}
+
+	process_region_check(data, region, version, status);
+	return EEPROM_SUCCESS;
+}
+
+// Итог региона i в маски result
+static void account_region(EEPROMDecodeResult *result, size_t i)
+{
+	const EEPROMRegionStatus *status = &result->regions[i];
+
+	if (!status->crc_ok)
+	{
+		result->crc_fail_mask |= 1u << i;
+		STATS_ADD(STATS_CRC_FAILURES, 1);
+	}
+	if (!status->test_ok)
+	{
+		result->test_fail_mask |= 1u << i;
+		STATS_ADD(STATS_TEST_FAILURES, 1);
+	}
+}
+
+// Регион i раскладки: расшифровка, CRC и тест, итог в result->regions[i] и маски
+static int decode_region(uint8_t *data, const EEPROMLayout *layout, size_t i,
+						 EEPROMDecodeResult *result)
+{
+	int ret = process_region_decode(data, &layout->regions[i],
+									&result->key, result->version, &result->regions[i]);
+	if (ret != EEPROM_SUCCESS)
+	{
+		return ret;
 	}
+
+	account_region(result, i);
+	return EEPROM_SUCCESS;
 }
 
 static void process_region_encode(uint8_t *data,
@@ -40,115 +165,359 @@ static void process_region_encode(uint8_t *data,
 								   uint8_t key_index,
 								   EEPROMVersion version)
 {
-	data[region->crc_pos] = calculate_crc(data, region->crc_bits);
+	data[region->crc_pos] = calculate_crc(data + region->crc_start, region->crc_bits);
 
 	encode_data(data + region->data_start,
 			   region->data_size,
 			   algorithm, key_index, version);
 }
 
-int eeprom_decode(uint8_t *data, size_t size, EEPROMVersion version)
+// ═══════════════════════════════════════════════════════════════
+// Key Discovery
+// ═══════════════════════════════════════════════════════════════
+
+int eeprom_default_key(const uint8_t *data, EEPROMVersion version, EEPROMKeyInfo *key)
+{
+	const EEPROMLayout *layout = eeprom_get_layout(version);
+	if (!layout)
+	{
+		return EEPROM_ERROR_VERSION;
+	}
+
+	key->algorithm = layout->algorithm;
+	key->key_index = layout->key_index;
+	key->key_table = version;
+	key->v1_key = EEPROM_V1_KEY_PRODUCTION;
+
+	if (version >= EEPROM_VERSION_V4 && version <= EEPROM_VERSION_V6)
+	{
+		key->algorithm = data[1] >> 4;
+		key->key_index = data[1] & 0xF;
+	}
+
+	return EEPROM_SUCCESS;
+}
+
+// Байт алгоритма/ключа в заголовке v4-v6, каким его записал бы key
+static uint8_t key_header_byte(const EEPROMKeyInfo *key)
+{
+	return (uint8_t)((key->algorithm << 4) | key->key_index);
+}
+
+// Заголовок не совпадает с явно заданным ключом: data[1] переписывается,
+// иначе CRC региона 1 (он покрывает data[1]) не сойдется с найденным ключом
+static void key_repair_header(uint8_t *data, EEPROMDecodeResult *result)
+{
+	if (result->version < EEPROM_VERSION_V4 || result->version > EEPROM_VERSION_V6)
+	{
+		return;
+	}
+
+	uint8_t header = key_header_byte(&result->key);
+	if (data[1] != header)
+	{
+		eeprom_diag(EEPROM_DIAG_WARNING, "Header key byte 0x%02X does not match the key, rewritten to 0x%02X",
+					data[1], header);
+		result->header_repaired = 1;
+		result->header_stored = data[1];
+		data[1] = header;
+	}
+}
+
+// Decrypts a copy region by region and rejects the key at the first bad CRC
+static int eeprom_key_validates(const uint8_t *data, EEPROMVersion version,
+								const EEPROMLayout *layout, const EEPROMKeyInfo *key)
+{
+	uint8_t work[EEPROM_SIZE];
+	memcpy(work, data, EEPROM_SIZE);
+
+	// Region 1 CRC covers data[1]: check it as the candidate would have written it
+	if (version >= EEPROM_VERSION_V4 && version <= EEPROM_VERSION_V6)
+	{
+		work[1] = key_header_byte(key);
+	}
+
+	for (size_t i = 0; i < layout->region_count; i++)
+	{
+		const RegionMeta *region = &layout->regions[i];
+
+		if (version == EEPROM_VERSION_V1)
+		{
+			if (decode_data_v1(work + region->data_start, region->data_size, key->v1_key) != 0)
+			{
+				return 0;
+			}
+			if (calculate_crc8_v1(work + region->crc_start, region->crc_bits / 8) != work[region->crc_pos])
+			{
+				return 0;
+			}
+		}
+		else
+		{
+			if (key->key_index > 3)
+			{
+				return 0;
+			}
+			decode_data(work + region->data_start, region->data_size,
+						key->algorithm, key->key_index, key->key_table);
+			if (calculate_crc(work + region->crc_start, region->crc_bits) != work[region->crc_pos])
+			{
+				return 0;
+			}
+		}
+	}
+
+	return 1;
+}
+
+int eeprom_discover_key(const uint8_t *data, size_t size, EEPROMVersion version,
+						EEPROMKeyInfo *key)
 {
 	if (size != EEPROM_SIZE)
 	{
-		printf("Error: Invalid buffer size %zu, expected %d\n", size, EEPROM_SIZE);
 		return EEPROM_ERROR_UNKNOWN;
 	}
 
 	if (version == EEPROM_VERSION_UNKNOWN)
 	{
 		version = eeprom_detect_version(data);
-		if (version == EEPROM_VERSION_UNKNOWN)
-		{
-			printf("Error: Unknown EEPROM version (byte 0 = 0x%02X)\n", data[0]);
-			return EEPROM_ERROR_VERSION;
-		}
 	}
 
-	printf("EEPROM Version: %d (0x%02X)\n", version, data[0]);
+	const EEPROMLayout *layout = eeprom_get_layout(version);
+	if (!layout || eeprom_default_key(data, version, key) != EEPROM_SUCCESS)
+	{
+		return EEPROM_ERROR_VERSION;
+	}
+
+	if (eeprom_key_validates(data, version, layout, key))
+	{
+		return EEPROM_SUCCESS;
+	}
+
+	EEPROMKeyInfo candidate = *key;
 
-	// ═══════════════════════════════════════════════════════════════
-	// EEPROM v1 (AES-256-CBC)
-	// ═══════════════════════════════════════════════════════════════
 	if (version == EEPROM_VERSION_V1)
 	{
-		uint32_t encryption_key = EEPROM_V1_KEY_PRODUCTION;
+		static const uint32_t v1_keys[] = { EEPROM_V1_KEY_PRODUCTION, EEPROM_V1_KEY_FIXTURE };
 
-		if (decode_data_v1(data + EEPROM_V1_PT1_START,
-						   EEPROM_V1_PT1_SIZE,
-						   encryption_key) != 0)
+		for (size_t i = 0; i < sizeof(v1_keys) / sizeof(v1_keys[0]); i++)
 		{
-			printf("Error: Failed to decrypt PT1 block\n");
-			return EEPROM_ERROR_UNKNOWN;
+			candidate.v1_key = v1_keys[i];
+			if (eeprom_key_validates(data, version, layout, &candidate))
+			{
+				*key = candidate;
+				return EEPROM_SUCCESS;
+			}
 		}
+		return EEPROM_ERROR_CRC;
+	}
 
-		uint8_t pt1_crc_calc = calculate_crc8_v1(data + EEPROM_V1_PT1_START,
-												  EEPROM_V1_PT1_CRC_BYTES);
-		if (pt1_crc_calc != data[EEPROM_V1_PT1_CRC_POS])
-		{
-			printf("Warning: PT1 CRC mismatch. Calculated: 0x%02X, Stored: 0x%02X\n",
-				   pt1_crc_calc, data[EEPROM_V1_PT1_CRC_POS]);
-		}
+	// XXTEA: KEY_LARGE и KEY_LARGE_V17; XOR: только KEY_SMALL
+	static const struct
+	{
+		uint8_t algorithm;
+		EEPROMVersion key_table;
+	} tables[] =
+	{
+		{ CRYPTO_ALGORITHM_XXTEA, EEPROM_VERSION_V4 },
+		{ CRYPTO_ALGORITHM_XXTEA, EEPROM_VERSION_V17 },
+		{ CRYPTO_ALGORITHM_XOR,   EEPROM_VERSION_V4 },
+	};
 
-		if (decode_data_v1(data + EEPROM_V1_PT2_START,
-						   EEPROM_V1_PT2_SIZE,
-						   encryption_key) != 0)
+	for (size_t t = 0; t < sizeof(tables) / sizeof(tables[0]); t++)
+	{
+		for (uint8_t key_index = 0; key_index < 4; key_index++)
 		{
-			printf("Error: Failed to decrypt PT2 block\n");
-			return EEPROM_ERROR_UNKNOWN;
-		}
+			candidate.algorithm = tables[t].algorithm;
+			candidate.key_table = tables[t].key_table;
+			candidate.key_index = key_index;
 
-		uint8_t pt2_crc_calc = calculate_crc8_v1(data + EEPROM_V1_PT2_START,
-												  EEPROM_V1_PT2_CRC_BYTES);
-		if (pt2_crc_calc != data[EEPROM_V1_PT2_CRC_POS])
-		{
-			printf("Warning: PT2 CRC mismatch. Calculated: 0x%02X, Stored: 0x%02X\n",
-				   pt2_crc_calc, data[EEPROM_V1_PT2_CRC_POS]);
+			if (eeprom_key_validates(data, version, layout, &candidate))
+			{
+				*key = candidate;
+				return EEPROM_SUCCESS;
+			}
 		}
+	}
 
-		if (decode_data_v1(data + EEPROM_V1_SWEEP_START,
-						   EEPROM_V1_SWEEP_SIZE,
-						   encryption_key) != 0)
+	return EEPROM_ERROR_CRC;
+}
+
+int eeprom_decode(uint8_t *data, size_t size, EEPROMVersion version)
+{
+	return eeprom_decode_ex(data, size, version, NULL, NULL);
+}
+
+int eeprom_decode_with_key(uint8_t *data, size_t size, EEPROMVersion version,
+						   const EEPROMKeyInfo *key)
+{
+	return eeprom_decode_ex(data, size, version, key, NULL);
+}
+
+// Версия, раскладка и ключ до расшифровки: общая часть eeprom_decode_ex и eeprom_decode_many
+static int decode_prepare(const uint8_t *data, EEPROMVersion version, const EEPROMKeyInfo *key,
+						  EEPROMDecodeResult *result, const EEPROMLayout **layout_out)
+{
+	memset(result, 0, sizeof(*result));
+
+	if (version == EEPROM_VERSION_UNKNOWN)
+	{
+		version = eeprom_detect_version(data);
+		if (version == EEPROM_VERSION_UNKNOWN)
 		{
-			printf("Error: Failed to decrypt SWEEP block\n");
-			return EEPROM_ERROR_UNKNOWN;
+			eeprom_diag(EEPROM_DIAG_ERROR, "Unknown EEPROM version (byte 0 = 0x%02X)", data[0]);
+			return EEPROM_ERROR_VERSION;
 		}
+	}
+
+	result->version = version;
+	eeprom_diag(EEPROM_DIAG_INFO, "EEPROM Version: %d (0x%02X)", version, data[0]);
 
-		uint8_t sweep_crc_calc = calculate_crc8_v1(data + EEPROM_V1_SWEEP_START,
-													EEPROM_V1_SWEEP_CRC_BYTES);
-		if (sweep_crc_calc != data[EEPROM_V1_SWEEP_CRC_POS])
+	const EEPROMLayout *layout = eeprom_get_layout(version);
+	if (!layout || layout->region_count > EEPROM_MAX_REGIONS)
+	{
+		eeprom_diag(EEPROM_DIAG_ERROR, "No layout found for EEPROM version %d", version);
+		return EEPROM_ERROR_VERSION;
+	}
+
+	if (key)
+	{
+		result->key = *key;
+	}
+	else
+	{
+		eeprom_default_key(data, version, &result->key);
+	}
+
+	result->region_count = layout->region_count;
+	*layout_out = layout;
+	return EEPROM_SUCCESS;
+}
+
+// ═══════════════════════════════════════════════════════════════
+// v1 (AES-256-CBC + CRC-8) и v4/v5/v6/v17 (XXTEA/XOR + CRC5)
+// ═══════════════════════════════════════════════════════════════
+static int decode_regions(uint8_t *data, const EEPROMLayout *layout, EEPROMDecodeResult *result)
+{
+	for (size_t i = 0; i < layout->region_count; i++)
+	{
+		int ret = decode_region(data, layout, i, result);
+		if (ret != EEPROM_SUCCESS)
 		{
-			printf("Warning: SWEEP CRC mismatch. Calculated: 0x%02X, Stored: 0x%02X\n",
-				   sweep_crc_calc, data[EEPROM_V1_SWEEP_CRC_POS]);
+			return ret;
 		}
+	}
 
-		return EEPROM_SUCCESS;
+	STATS_ADD(STATS_BOARDS, 1);
+	return EEPROM_SUCCESS;
+}
+
+int eeprom_decode_ex(uint8_t *data, size_t size, EEPROMVersion version,
+					 const EEPROMKeyInfo *key, EEPROMDecodeResult *result)
+{
+	EEPROMDecodeResult local;
+	if (!result)
+	{
+		result = &local;
 	}
 
-	// ═══════════════════════════════════════════════════════════════
-	// EEPROM v4/v5/v6/v17 - Generic region processing (XXTEA/XOR)
-	// ═══════════════════════════════════════════════════════════════
+	if (size != EEPROM_SIZE)
+	{
+		memset(result, 0, sizeof(*result));
+		eeprom_diag(EEPROM_DIAG_ERROR, "Invalid buffer size %zu, expected %d", size, EEPROM_SIZE);
+		return EEPROM_ERROR_UNKNOWN;
+	}
 
-	const EEPROMLayout *layout = eeprom_get_layout(version);
-	if (!layout)
+	const EEPROMLayout *layout;
+	int ret = decode_prepare(data, version, key, result, &layout);
+	if (ret != EEPROM_SUCCESS)
 	{
-		printf("Error: No layout found for EEPROM version %d\n", version);
-		return EEPROM_ERROR_VERSION;
+		return ret;
 	}
 
-	uint8_t algorithm = layout->algorithm;
-	uint8_t key_index = layout->key_index;
+	if (key)
+	{
+		key_repair_header(data, result);
+	}
+	return decode_regions(data, layout, result);
+}
 
-	if (version >= EEPROM_VERSION_V4 && version <= EEPROM_VERSION_V6)
+#define DECODE_PENDING 1           // status[]: ждет расшифровки в группе
+#define DECODE_GROUP   64          // плат на один проход decode_data_many()
+
+// Та же версия и тот же ключ: регионы расшифровываются одним вызовом
+static int decode_same_key(const EEPROMDecodeResult *a, const EEPROMDecodeResult *b)
+{
+	return a->version == b->version &&
+		   a->key.algorithm == b->key.algorithm &&
+		   a->key.key_index == b->key.key_index &&
+		   a->key.key_table == b->key.key_table;
+}
+
+int eeprom_decode_many(uint8_t *const data[], size_t count,
+					   EEPROMDecodeResult results[], int status[])
+{
+	const EEPROMLayout *layout;
+
+	// Версия и ключ из заголовка; v1, XOR и ошибочные платы - сразу по одной
+	for (size_t i = 0; i < count; i++)
 	{
-		algorithm = data[1] >> 4;
-		key_index = data[1] & 0xF;
+		status[i] = decode_prepare(data[i], EEPROM_VERSION_UNKNOWN, NULL, &results[i], &layout);
+		if (status[i] != EEPROM_SUCCESS)
+		{
+			continue;
+		}
+		if (results[i].version != EEPROM_VERSION_V1 && results[i].key.algorithm == CRYPTO_ALGORITHM_XXTEA)
+		{
+			status[i] = DECODE_PENDING;
+			continue;
+		}
+		status[i] = decode_regions(data[i], layout, &results[i]);
 	}
 
-	for (size_t i = 0; i < layout->region_count; i++)
+	// XXTEA: группы плат с общим ключом, по SIMD-линии на плату
+	for (size_t first = 0; first < count; first++)
 	{
-		process_region_decode(data, &layout->regions[i],
-							 algorithm, key_index, version);
+		if (status[first] != DECODE_PENDING)
+		{
+			continue;
+		}
+
+		size_t members[DECODE_GROUP];
+		size_t n = 0;
+		for (size_t i = first; i < count && n < DECODE_GROUP; i++)
+		{
+			if (status[i] == DECODE_PENDING && decode_same_key(&results[first], &results[i]))
+			{
+				members[n++] = i;
+				status[i] = EEPROM_SUCCESS;
+			}
+		}
+
+		const EEPROMDecodeResult *head = &results[first];
+		layout = eeprom_get_layout(head->version);
+		for (size_t r = 0; r < layout->region_count; r++)
+		{
+			const RegionMeta *region = &layout->regions[r];
+			uint8_t *blocks[DECODE_GROUP];
+			for (size_t m = 0; m < n; m++)
+			{
+				blocks[m] = data[members[m]] + region->data_start;
+			}
+
+			STATS_BEGIN(start);
+			decode_data_many(blocks, n, region->data_size, head->key.algorithm,
+							 head->key.key_index, head->key.key_table);
+			STATS_END(STATS_DECRYPT_XXTEA, start);
+
+			for (size_t m = 0; m < n; m++)
+			{
+				EEPROMDecodeResult *result = &results[members[m]];
+				process_region_check(data[members[m]], region, result->version, &result->regions[r]);
+				account_region(result, r);
+			}
+		}
+		STATS_ADD(STATS_BOARDS, n);
 	}
 
 	return EEPROM_SUCCESS;
@@ -158,7 +527,7 @@ int eeprom_encode(uint8_t *data, size_t size, EEPROMVersion version)
 {
 	if (size != EEPROM_SIZE)
 	{
-		printf("Error: Invalid buffer size %zu, expected %d\n", size, EEPROM_SIZE);
+		eeprom_diag(EEPROM_DIAG_ERROR, "Invalid buffer size %zu, expected %d", size, EEPROM_SIZE);
 		return EEPROM_ERROR_UNKNOWN;
 	}
 
@@ -167,7 +536,7 @@ int eeprom_encode(uint8_t *data, size_t size, EEPROMVersion version)
 		version = eeprom_detect_version(data);
 		if (version == EEPROM_VERSION_UNKNOWN)
 		{
-			printf("Error: Unknown EEPROM version (byte 0 = 0x%02X)\n", data[0]);
+			eeprom_diag(EEPROM_DIAG_ERROR, "Unknown EEPROM version (byte 0 = 0x%02X)", data[0]);
 			return EEPROM_ERROR_VERSION;
 		}
 	}
@@ -186,7 +555,7 @@ int eeprom_encode(uint8_t *data, size_t size, EEPROMVersion version)
 						   EEPROM_V1_PT1_SIZE,
 						   encryption_key) != 0)
 		{
-			printf("Error: Failed to encrypt PT1 block\n");
+			eeprom_diag(EEPROM_DIAG_ERROR, "Failed to encrypt PT1 block");
 			return EEPROM_ERROR_UNKNOWN;
 		}
 
@@ -197,7 +566,7 @@ int eeprom_encode(uint8_t *data, size_t size, EEPROMVersion version)
 						   EEPROM_V1_PT2_SIZE,
 						   encryption_key) != 0)
 		{
-			printf("Error: Failed to encrypt PT2 block\n");
+			eeprom_diag(EEPROM_DIAG_ERROR, "Failed to encrypt PT2 block");
 			return EEPROM_ERROR_UNKNOWN;
 		}
 
@@ -208,7 +577,7 @@ int eeprom_encode(uint8_t *data, size_t size, EEPROMVersion version)
 						   EEPROM_V1_SWEEP_SIZE,
 						   encryption_key) != 0)
 		{
-			printf("Error: Failed to encrypt SWEEP block\n");
+			eeprom_diag(EEPROM_DIAG_ERROR, "Failed to encrypt SWEEP block");
 			return EEPROM_ERROR_UNKNOWN;
 		}
 
@@ -222,7 +591,7 @@ int eeprom_encode(uint8_t *data, size_t size, EEPROMVersion version)
 	const EEPROMLayout *layout = eeprom_get_layout(version);
 	if (!layout)
 	{
-		printf("Error: No layout found for EEPROM version %d\n", version);
+		eeprom_diag(EEPROM_DIAG_ERROR, "No layout found for EEPROM version %d", version);
 		return EEPROM_ERROR_VERSION;
 	}
 
@@ -244,147 +613,485 @@ int eeprom_encode(uint8_t *data, size_t size, EEPROMVersion version)
 	return EEPROM_SUCCESS;
 }
 
+
 // ═══════════════════════════════════════════════════════════════
-// Interactive Editing Functions
+// Parsed records
 // ═══════════════════════════════════════════════════════════════
 
-#include "ui.h"
+int eeprom_record_parse(EEPROMRecord *record, const uint8_t *data, EEPROMVersion version)
+{
+	STATS_BEGIN(start);
+	record->version = version;
+
+	switch (version)
+	{
+		case EEPROM_VERSION_V1:
+			eeprom_v1_parse(&record->v1, data);
+			break;
+		case EEPROM_VERSION_V4:
+		case EEPROM_VERSION_V5:
+		case EEPROM_VERSION_V6:
+			eeprom_from_bytes(&record->v4, data);
+			break;
+		case EEPROM_VERSION_V17:
+			eeprom_v17_parse(&record->v17, data);
+			break;
+		default:
+			return EEPROM_ERROR_VERSION;
+	}
+
+	STATS_END(STATS_PARSE, start);
+	return EEPROM_SUCCESS;
+}
 
-static int edit_field_interactive(void *base, const FieldMetadata *field)
+// Поля фиксированной длины, не обязательно с завершающим нулем
+static void copy_fixed_string(char *buffer, size_t size, const char *text, size_t length)
 {
-	uint8_t *ptr = (uint8_t*)base + field->offset;
+	length = strnlen(text, length);
+	if (length >= size)
+	{
+		length = size - 1;
+	}
+	memcpy(buffer, text, length);
+	buffer[length] = '\0';
+}
 
-	if (field->read_only)
+void eeprom_record_serial(const EEPROMRecord *record, char *buffer, size_t size)
+{
+	const char *serial = "";
+	size_t length = 0;
+
+	switch (record->version)
 	{
-		ui_print_warning("Field '%s' is read-only", field->name);
-		return EEPROM_SUCCESS;
+		case EEPROM_VERSION_V1:
+			serial = record->v1.pt1_data.board_serial;
+			length = sizeof(record->v1.pt1_data.board_serial);
+			break;
+		case EEPROM_VERSION_V4:
+		case EEPROM_VERSION_V5:
+		case EEPROM_VERSION_V6:
+			serial = record->v4.board_info.board_sn;
+			length = sizeof(record->v4.board_info.board_sn);
+			break;
+		case EEPROM_VERSION_V17:
+			serial = record->v17.data.serial_number;
+			length = sizeof(record->v17.data.serial_number);
+			break;
+		default:
+			break;
 	}
 
-	printf("\n");
-	ui_print_info("Editing: %s", field->name);
-	printf("Current value: ");
-	ui_print_field(base, field);
+	copy_fixed_string(buffer, size, serial, length);
+}
 
-	switch (field->type)
+size_t eeprom_sweep_stats(const EEPROMRecord *record, uint16_t freqs[EEPROM_SWEEP_ASICS],
+						  EEPROMSweepStats *stats)
+{
+	const uint8_t *levels;
+	uint16_t freq_base;
+	uint8_t freq_step;
+
+	switch (record->version)
 	{
-		case FIELD_TYPE_UINT8:
-		case FIELD_TYPE_HEX8:
+		case EEPROM_VERSION_V1:
+			levels = record->v1.sweep_data.sweep_level;
+			freq_base = record->v1.sweep_data.sweep_freq_base;
+			freq_step = record->v1.sweep_data.sweep_freq_step;
+			break;
+		case EEPROM_VERSION_V5:
+		case EEPROM_VERSION_V6:
+			levels = record->v4.sweep_data.sweep_level;
+			freq_base = record->v4.sweep_data.sweep_freq_base;
+			freq_step = record->v4.sweep_data.sweep_freq_step;
+			break;
+		default:
+			return 0;
+	}
+
+	eeprom_sweep_unpack(levels, freq_base, freq_step, freqs, stats);
+	return EEPROM_SWEEP_ASICS;
+}
+
+size_t eeprom_sweep_frequencies(const EEPROMRecord *record, uint16_t freqs[EEPROM_SWEEP_ASICS])
+{
+	return eeprom_sweep_stats(record, freqs, NULL);
+}
+
+int eeprom_record_serialize(const EEPROMRecord *record, uint8_t *data)
+{
+	switch (record->version)
+	{
+		case EEPROM_VERSION_V1:
+			eeprom_v1_serialize(&record->v1, data);
+			break;
+		case EEPROM_VERSION_V4:
+		case EEPROM_VERSION_V5:
+		case EEPROM_VERSION_V6:
+			eeprom_to_bytes(&record->v4, data);
+			break;
+		case EEPROM_VERSION_V17:
+			eeprom_v17_serialize(&record->v17, data);
+			break;
+		default:
+			return EEPROM_ERROR_VERSION;
+	}
+	return EEPROM_SUCCESS;
+}
+
+
+// ═══════════════════════════════════════════════════════════════
+// Field lookup and assignment
+// ═══════════════════════════════════════════════════════════════
+
+// Имя приводится к ключу и ищется в сгенерированном совершенном хэше:
+// два вычисления хэша и одно сравнение строк
+const FieldMetadata *eeprom_field_find(EEPROMVersion version, const char *name)
+{
+	int table = eeprom_field_table(version);
+	if (table < 0)
+	{
+		return NULL;
+	}
+
+	char key[64];
+	eeprom_field_key(name, key, sizeof(key));
+
+	uint32_t bucket = eeprom_field_hash(0, table, key) & (EEPROM_FIELD_INDEX_BUCKETS - 1);
+	uint32_t slot = eeprom_field_hash(eeprom_field_index_displace[bucket], table, key) &
+					(EEPROM_FIELD_INDEX_SLOTS - 1);
+	const EEPROMFieldSlot *entry = &eeprom_field_index_slots[slot];
+
+	if (entry->table != table || strcmp(entry->key, key) != 0)
+	{
+		return NULL;
+	}
+	return &eeprom_get_fields(version, NULL)[entry->field];
+}
+
+const FieldMetadata *eeprom_field_by_id(EEPROMVersion version, FieldId id)
+{
+	int table = eeprom_field_table(version);
+	if (table < 0 || id <= FIELD_ID_NONE || id >= FIELD_ID_COUNT ||
+		eeprom_field_index_by_id[table][id] < 0)
+	{
+		return NULL;
+	}
+	return &eeprom_get_fields(version, NULL)[eeprom_field_index_by_id[table][id]];
+}
+
+const char *eeprom_field_id_key(FieldId id)
+{
+	return id > FIELD_ID_NONE && id < FIELD_ID_COUNT ? eeprom_field_index_keys[id] : NULL;
+}
+
+// Целое: десятичное или 0x..; для VOLTAGE/HASHRATE допускаются два знака
+// после точки (значение хранится в сотых)
+static int field_parse_number(const FieldMetadata *field, const char *text, long long *number)
+{
+	int scaled = field->type == FIELD_TYPE_VOLTAGE || field->type == FIELD_TYPE_HASHRATE;
+	char *end;
+
+	errno = 0;
+	if (text[0] == '0' && (text[1] == 'x' || text[1] == 'X'))
+	{
+		*number = strtoll(text + 2, &end, 16);
+		if (end == text + 2)
 		{
-			uint8_t value;
-			if (ui_input_uint8("New value", &value, field->min_value, field->max_value))
+			return -1;
+		}
+	}
+	else
+	{
+		*number = strtoll(text, &end, 10);
+		if (end == text)
+		{
+			return -1;
+		}
+		if (scaled && *end == '.')
+		{
+			const char *fraction = end + 1;
+			int hundredths = 0;
+			for (int digit = 0; digit < 2; digit++)
 			{
-				*(uint8_t*)ptr = value;
-				ui_print_success("Updated");
+				hundredths *= 10;
+				if (isdigit((unsigned char)*fraction))
+				{
+					hundredths += *fraction++ - '0';
+				}
 			}
-			break;
+			if (*fraction || text[0] == '-')
+			{
+				return -1;
+			}
+			*number = *number * 100 + hundredths;
+			end = (char*)fraction;
 		}
+	}
+
+	return errno == 0 && *end == '\0' ? 0 : -1;
+}
+
+int eeprom_field_parse(const FieldMetadata *field, const char *text, EEPROMFieldValue *value)
+{
+	memset(value, 0, sizeof(*value));
+	value->field = field;
 
+	if (field->read_only)
+	{
+		return EEPROM_ERROR_READ_ONLY;
+	}
+
+	long long number;
+	long long low = field->min_value;
+	long long high = field->max_value;
+
+	switch (field->type)
+	{
+		case FIELD_TYPE_UINT8:
+		case FIELD_TYPE_HEX8:
+			low = low < 0 ? 0 : low;
+			high = high > UINT8_MAX ? UINT8_MAX : high;
+			break;
 		case FIELD_TYPE_UINT16:
 		case FIELD_TYPE_HEX16:
 		case FIELD_TYPE_VOLTAGE:
 		case FIELD_TYPE_HASHRATE:
+			low = low < 0 ? 0 : low;
+			high = high > UINT16_MAX ? UINT16_MAX : high;
+			break;
+		case FIELD_TYPE_INT8:
+			low = low < INT8_MIN ? INT8_MIN : low;
+			high = high > INT8_MAX ? INT8_MAX : high;
+			break;
+		case FIELD_TYPE_STRING:
+			// как при ручном редактировании: последний байт остается нулем
+			if (strlen(text) >= field->size || strlen(text) >= sizeof(value->text))
+			{
+				return EEPROM_ERROR_RANGE;
+			}
+			strcpy(value->text, text);
+			return EEPROM_SUCCESS;
+		default:
+			return EEPROM_ERROR_READ_ONLY;
+	}
+
+	if (field_parse_number(field, text, &number) != 0 || number < low || number > high)
+	{
+		return EEPROM_ERROR_RANGE;
+	}
+
+	value->number = (uint32_t)number;
+	return EEPROM_SUCCESS;
+}
+
+int eeprom_field_store(EEPROMRecord *record, const EEPROMFieldValue *value)
+{
+	const FieldMetadata *field = value->field;
+	uint8_t *ptr = (uint8_t*)&record->v4 + field->offset;
+
+	switch (field->type)
+	{
+		case FIELD_TYPE_UINT8:
+		case FIELD_TYPE_HEX8:
+		case FIELD_TYPE_INT8:
 		{
-			uint16_t value;
-			if (ui_input_uint16("New value", &value, field->min_value, field->max_value))
+			uint8_t stored = (uint8_t)value->number;
+			if (*ptr == stored)
 			{
-				*(uint16_t*)ptr = value;
-				ui_print_success("Updated");
+				return 0;
 			}
-			break;
+			*ptr = stored;
+			return 1;
 		}
 
-		case FIELD_TYPE_INT8:
+		case FIELD_TYPE_UINT16:
+		case FIELD_TYPE_HEX16:
+		case FIELD_TYPE_VOLTAGE:
+		case FIELD_TYPE_HASHRATE:
 		{
-			int8_t value;
-			if (ui_input_int8("New value", &value, field->min_value, field->max_value))
+			uint16_t stored = (uint16_t)value->number;
+			uint16_t current;
+			memcpy(&current, ptr, sizeof(current));
+			if (current == stored)
 			{
-				*(int8_t*)ptr = value;
-				ui_print_success("Updated");
+				return 0;
 			}
-			break;
+			memcpy(ptr, &stored, sizeof(stored));
+			return 1;
 		}
 
 		case FIELD_TYPE_STRING:
 		{
-			char buffer[256];
-			if (ui_input_string("New value", buffer, sizeof(buffer)))
+			char stored[EEPROM_SIZE] = { 0 };
+			memcpy(stored, value->text, strlen(value->text));
+			if (memcmp(ptr, stored, field->size) == 0)
 			{
-				strncpy((char*)ptr, buffer, field->size);
-				((char*)ptr)[field->size - 1] = '\0';
-				ui_print_success("Updated");
+				return 0;
 			}
-			break;
+			memcpy(ptr, stored, field->size);
+			return 1;
 		}
 
 		default:
-			ui_print_error("Editing not supported for this field type");
-			return EEPROM_ERROR_UNKNOWN;
+			return 0;
 	}
-
-	return EEPROM_SUCCESS;
 }
 
-int eeprom_edit_interactive(void *eeprom_struct, EEPROMVersion version)
+
+// ═══════════════════════════════════════════════════════════════
+// Lazy decoded view
+// ═══════════════════════════════════════════════════════════════
+
+int eeprom_view_init(EEPROMView *view, const uint8_t *raw, size_t size,
+					 EEPROMVersion version, const EEPROMKeyInfo *key)
 {
-	size_t field_count;
-	const FieldMetadata *fields = eeprom_get_fields(version, &field_count);
+	memset(&view->result, 0, sizeof(view->result));
+	view->raw = raw;
+	view->layout = NULL;
+	view->decoded_mask = 0;
+
+	if (size != EEPROM_SIZE)
+	{
+		eeprom_diag(EEPROM_DIAG_ERROR, "Invalid buffer size %zu, expected %d", size, EEPROM_SIZE);
+		return EEPROM_ERROR_UNKNOWN;
+	}
+
+	if (version == EEPROM_VERSION_UNKNOWN)
+	{
+		version = eeprom_detect_version(raw);
+		if (version == EEPROM_VERSION_UNKNOWN)
+		{
+			eeprom_diag(EEPROM_DIAG_ERROR, "Unknown EEPROM version (byte 0 = 0x%02X)", raw[0]);
+			return EEPROM_ERROR_VERSION;
+		}
+	}
 
-	if (!fields || field_count == 0)
+	const EEPROMLayout *layout = eeprom_get_layout(version);
+	if (!layout || layout->region_count > EEPROM_MAX_REGIONS)
 	{
-		ui_print_error("No field metadata for EEPROM version %d", version);
+		eeprom_diag(EEPROM_DIAG_ERROR, "No layout found for EEPROM version %d", version);
 		return EEPROM_ERROR_VERSION;
 	}
 
-	while (1)
+	view->layout = layout;
+	view->result.version = version;
+	view->result.region_count = layout->region_count;
+	if (key)
 	{
-		ui_print_eeprom(eeprom_struct, version);
+		view->result.key = *key;
+	}
+	else
+	{
+		eeprom_default_key(raw, version, &view->result.key);
+	}
 
-		printf("\n" TERM_BOLD "Edit Menu:" TERM_RESET "\n");
-		printf("Select field to edit (1-%zu), or 0 to finish:\n", field_count);
+	// Открытые байты (заголовок, резерв) сразу на месте, регионы - по запросу
+	memcpy(view->data, raw, EEPROM_SIZE);
+	if (key)
+	{
+		key_repair_header(view->data, &view->result);
+	}
+	return EEPROM_SUCCESS;
+}
 
-		const char *current_category = NULL;
-		for (size_t i = 0; i < field_count; i++)
-		{
-			if (current_category == NULL || strcmp(current_category, fields[i].category) != 0)
-			{
-				printf("\n" TERM_BOLD TERM_CYAN "  %s:" TERM_RESET "\n", fields[i].category);
-				current_category = fields[i].category;
-			}
-			printf("    [%2zu] %s", i + 1, fields[i].name);
-			if (fields[i].read_only)
-			{
-				printf(TERM_DIM " (read-only)" TERM_RESET);
-			}
-			printf("\n");
-		}
+static int view_decode_region(EEPROMView *view, size_t i)
+{
+	if (view->decoded_mask & (1u << i))
+	{
+		return EEPROM_SUCCESS;
+	}
 
-		printf("\n    [ 0] " TERM_BOLD TERM_GREEN "Finish editing" TERM_RESET "\n");
+	int ret = decode_region(view->data, view->layout, i, &view->result);
+	if (ret != EEPROM_SUCCESS)
+	{
+		// Регион мог остаться наполовину расшифрованным
+		const RegionMeta *region = &view->layout->regions[i];
+		memcpy(view->data + region->data_start, view->raw + region->data_start, region->data_size);
+		return ret;
+	}
+
+	view->decoded_mask |= 1u << i;
+	return EEPROM_SUCCESS;
+}
+
+const uint8_t *eeprom_view_bytes(EEPROMView *view, size_t offset, size_t size)
+{
+	if (!view->layout || offset > EEPROM_SIZE || size > EEPROM_SIZE - offset)
+	{
+		return NULL;
+	}
 
-		printf("\nChoice: ");
-		int choice;
-		if (scanf("%d", &choice) != 1)
+	for (size_t i = 0; i < view->layout->region_count; i++)
+	{
+		const RegionMeta *region = &view->layout->regions[i];
+		if (offset < region->data_start + region->data_size &&
+			region->data_start < offset + size &&
+			view_decode_region(view, i) != EEPROM_SUCCESS)
 		{
-			while (getchar() != '\n');
-			ui_print_error("Invalid input");
-			continue;
+			return NULL;
 		}
-		getchar();
+	}
 
-		if (choice == 0)
-		{
+	return view->data + offset;
+}
+
+const uint8_t *eeprom_view_field(EEPROMView *view, const FieldMetadata *field)
+{
+	return eeprom_view_bytes(view, field->offset, field->size);
+}
+
+int eeprom_view_serial(EEPROMView *view, char *buffer, size_t size)
+{
+	size_t offset;
+	size_t length;
+
+	buffer[0] = '\0';
+	switch (view->result.version)
+	{
+		case EEPROM_VERSION_V1:
+			offset = offsetof(EEPROMStructure_v1, pt1_data.board_serial);
+			length = sizeof(((EEPROMStructure_v1*)0)->pt1_data.board_serial);
 			break;
-		}
+		case EEPROM_VERSION_V4:
+		case EEPROM_VERSION_V5:
+		case EEPROM_VERSION_V6:
+			offset = offsetof(EEPROMStructure, board_info.board_sn);
+			length = sizeof(((EEPROMStructure*)0)->board_info.board_sn);
+			break;
+		case EEPROM_VERSION_V17:
+			offset = offsetof(EEPROMStructure_v17, data.serial_number);
+			length = sizeof(((EEPROMStructure_v17*)0)->data.serial_number);
+			break;
+		default:
+			return EEPROM_ERROR_VERSION;
+	}
+
+	const uint8_t *serial = eeprom_view_bytes(view, offset, length);
+	if (!serial)
+	{
+		return EEPROM_ERROR_UNKNOWN;
+	}
+
+	copy_fixed_string(buffer, size, (const char*)serial, length);
+	return EEPROM_SUCCESS;
+}
+
+int eeprom_view_decode_all(EEPROMView *view)
+{
+	if (!view->layout)
+	{
+		return EEPROM_ERROR_VERSION;
+	}
 
-		if (choice < 1 || choice > (int)field_count)
+	for (size_t i = 0; i < view->layout->region_count; i++)
+	{
+		int ret = view_decode_region(view, i);
+		if (ret != EEPROM_SUCCESS)
 		{
-			ui_print_error("Invalid choice (1-%zu)", field_count);
-			continue;
+			return ret;
 		}
-
-		const FieldMetadata *field = &fields[choice - 1];
-		edit_field_interactive(eeprom_struct, field);
 	}
 
-	ui_print_success("Editing complete");
+	STATS_ADD(STATS_BOARDS, 1);
 	return EEPROM_SUCCESS;
 }
@@ -4,6 +4,7 @@
 #include <stdint.h>
 #include <stddef.h>
 #include "eeprom_defs.h"
+#include "eeprom_sweep.h"
 
 // ═══════════════════════════════════════════════════════════════
 // Return Codes
@@ -13,10 +14,211 @@
 #define EEPROM_ERROR_CRC          -2
 #define EEPROM_ERROR_VERSION      -3
 #define EEPROM_ERROR_TEST_FAIL    -4
+#define EEPROM_ERROR_IO           -5
+#define EEPROM_ERROR_SIZE         -6
+#define EEPROM_ERROR_READ_ONLY    -7
+#define EEPROM_ERROR_RANGE        -8
 
+// Short description of an EEPROM_* return code
+const char *eeprom_strerror(int code);
+
+
+// ═══════════════════════════════════════════════════════════════
+// Encryption key selection
+// ═══════════════════════════════════════════════════════════════
+typedef struct
+{
+	uint8_t algorithm;             // CRYPTO_ALGORITHM_*
+	uint8_t key_index;             // XXTEA/XOR key index (0-3)
+	EEPROMVersion key_table;       // V17: KEY_LARGE_V17, otherwise KEY_LARGE / KEY_SMALL
+	uint32_t v1_key;               // EEPROM_V1_KEY_* (v1 only)
+} EEPROMKeyInfo;
+
+// Key given by the header (data[1] for v4-v6) or the layout defaults
+int eeprom_default_key(const uint8_t *data, EEPROMVersion version, EEPROMKeyInfo *key);
+
+// Tries every algorithm x key_index x key table (both keys for v1) and
+// stops at the first one whose region CRCs all validate. The claimed
+// key is tried first. Returns EEPROM_ERROR_CRC and the default key if
+// nothing validates.
+int eeprom_discover_key(const uint8_t *data, size_t size, EEPROMVersion version,
+						EEPROMKeyInfo *key);
+
+
+// ═══════════════════════════════════════════════════════════════
+// Diagnostics
+// ═══════════════════════════════════════════════════════════════
+typedef enum
+{
+	EEPROM_DIAG_INFO,
+	EEPROM_DIAG_WARNING,
+	EEPROM_DIAG_ERROR
+} EEPROMDiagLevel;
+
+// message is formatted without a trailing newline or "Warning:" prefix
+typedef void (*EEPROMDiagHandler)(EEPROMDiagLevel level, const char *message, void *user);
+
+// Process-wide; NULL (the default) keeps the library silent
+void eeprom_set_diag_handler(EEPROMDiagHandler handler, void *user);
+
+
+// ═══════════════════════════════════════════════════════════════
+// Decode result
+// ═══════════════════════════════════════════════════════════════
+#define EEPROM_MAX_REGIONS 3
+
+typedef struct
+{
+	uint8_t crc_calculated;
+	uint8_t crc_stored;
+	uint8_t crc_ok;
+	uint8_t has_test;              // region carries a test result byte
+	uint8_t test_result;           // 1 = passed
+	uint8_t test_ok;               // test passed or region has no test
+} EEPROMRegionStatus;
+
+typedef struct
+{
+	EEPROMVersion version;         // detected (or given) version
+	EEPROMKeyInfo key;             // key the data was decoded with
+	size_t region_count;           // regions[] entries filled, in layout order
+	EEPROMRegionStatus regions[EEPROM_MAX_REGIONS];
+	uint32_t crc_fail_mask;        // bit i: regions[i] CRC mismatch
+	uint32_t test_fail_mask;       // bit i: regions[i] test did not pass
+	uint8_t header_repaired;       // v4-v6: data[1] rewritten from key
+	uint8_t header_stored;         // data[1] as stored, if header_repaired
+} EEPROMDecodeResult;
+
+// Decodes in place. CRC and test failures do not fail the call, they
+// are reported in result (may be NULL). key NULL = eeprom_default_key().
+// For v4-v6 a key that differs from the header byte data[1] (e.g. from
+// eeprom_discover_key()) rewrites data[1] before the region 1 CRC check,
+// as discovery validates it, and sets header_repaired.
+int eeprom_decode_ex(uint8_t *data, size_t size, EEPROMVersion version,
+					 const EEPROMKeyInfo *key, EEPROMDecodeResult *result);
+
+/**
+ * Decodes count images of EEPROM_SIZE bytes in place, each as
+ * eeprom_decode_ex(data[i], EEPROM_SIZE, EEPROM_VERSION_UNKNOWN, NULL,
+ * &results[i]) would. XXTEA boards of the same version and key are
+ * decrypted together, one SIMD lane per board (decode_data_many()).
+ * @param status - per board: EEPROM_SUCCESS or the error of that board
+ * @return EEPROM_SUCCESS
+ */
+int eeprom_decode_many(uint8_t *const data[], size_t count,
+					   EEPROMDecodeResult results[], int status[]);
 
 int eeprom_decode(uint8_t *data, size_t size, EEPROMVersion version);
+int eeprom_decode_with_key(uint8_t *data, size_t size, EEPROMVersion version,
+						   const EEPROMKeyInfo *key);
 int eeprom_encode(uint8_t *data, size_t size, EEPROMVersion version);
-int eeprom_edit_interactive(void *eeprom_struct, EEPROMVersion version);
+
+
+// ═══════════════════════════════════════════════════════════════
+// Parsed EEPROM of any version
+// ═══════════════════════════════════════════════════════════════
+typedef struct
+{
+	EEPROMVersion version;
+	union
+	{
+		EEPROMStructure v4;        // v4/v5/v6
+		EEPROMStructure_v1 v1;
+		EEPROMStructure_v17 v17;
+	};
+} EEPROMRecord;
+
+// Parses decoded bytes; the union members are the bases for eeprom_get_fields()
+int eeprom_record_parse(EEPROMRecord *record, const uint8_t *data, EEPROMVersion version);
+
+// Board serial number, NUL-terminated
+void eeprom_record_serial(const EEPROMRecord *record, char *buffer, size_t size);
+
+// Per-ASIC sweep frequencies (MHz): two 4-bit levels per byte, high
+// nibble first, frequency = level * step + base. Returns the number of
+// ASICs, 0 if the version has no sweep region (v4, v17).
+size_t eeprom_sweep_frequencies(const EEPROMRecord *record, uint16_t freqs[EEPROM_SWEEP_ASICS]);
+
+// Same, plus min/max/mean/stddev of the board (see eeprom_sweep_unpack())
+size_t eeprom_sweep_stats(const EEPROMRecord *record, uint16_t freqs[EEPROM_SWEEP_ASICS],
+						  EEPROMSweepStats *stats);
+
+// Writes the record over decoded bytes; bytes no field maps are kept
+int eeprom_record_serialize(const EEPROMRecord *record, uint8_t *data);
+
+
+// ═══════════════════════════════════════════════════════════════
+// Field lookup and assignment
+// ═══════════════════════════════════════════════════════════════
+#define EEPROM_FIELD_TEXT 64
+
+typedef struct
+{
+	const FieldMetadata *field;
+	uint32_t number;               // numeric types, already range-checked
+	char text[EEPROM_FIELD_TEXT];  // FIELD_TYPE_STRING
+} EEPROMFieldValue;
+
+// Field of eeprom_get_fields(version) by display name ("PSU Voltage") or
+// field key ("psu_voltage"), case-insensitive; the name is reduced with
+// eeprom_field_key() and looked up in a perfect hash generated at build
+// time from eeprom_defs.h. NULL if the version has no such field.
+const FieldMetadata *eeprom_field_find(EEPROMVersion version, const char *name);
+
+// Field of eeprom_get_fields(version) with this ID, NULL if none; O(1)
+const FieldMetadata *eeprom_field_by_id(EEPROMVersion version, FieldId id);
+
+// Field key of an ID ("psu_voltage"), NULL for FIELD_ID_NONE
+const char *eeprom_field_id_key(FieldId id);
+
+// Parses text for field: integers in decimal or 0x hex, VOLTAGE and
+// HASHRATE also with two decimals ("13.60" = 1360). Returns
+// EEPROM_ERROR_READ_ONLY for read-only and array fields, EEPROM_ERROR_RANGE
+// for malformed text, values outside min/max and strings too long.
+int eeprom_field_parse(const FieldMetadata *field, const char *text, EEPROMFieldValue *value);
+
+// Stores a parsed value; value->field must come from record->version.
+// Returns 1 if the field changed, 0 if it already held the value.
+int eeprom_field_store(EEPROMRecord *record, const EEPROMFieldValue *value);
+
+
+
+// ═══════════════════════════════════════════════════════════════
+// Lazy decoded view
+//
+// Decrypts and CRC-checks a region only when a field inside it is
+// first accessed: a serial-only query touches region 1 (PT1 for v1)
+// and never the sweep block. Bytes outside every region (v4-v6 and
+// v17 header, v1 plaintext header) need no decryption at all.
+// ═══════════════════════════════════════════════════════════════
+typedef struct
+{
+	const uint8_t *raw;            // encrypted image, not modified
+	const EEPROMLayout *layout;
+	uint32_t decoded_mask;         // bit i: regions[i] decrypted into data
+	EEPROMDecodeResult result;     // statuses of the regions decoded so far
+	uint8_t data[EEPROM_SIZE];     // decoded copy; valid for decoded regions and plaintext
+} EEPROMView;
+
+// raw must stay valid while the view is used. Nothing is decrypted yet.
+// key NULL = eeprom_default_key(); a key that differs from the v4-v6
+// header byte repairs data[1] of the copy, as in eeprom_decode_ex().
+int eeprom_view_init(EEPROMView *view, const uint8_t *raw, size_t size,
+					 EEPROMVersion version, const EEPROMKeyInfo *key);
+
+// Decoded bytes [offset, offset + size), decrypting the regions they
+// overlap on first access. Values are as stored: v17 numbers are
+// big-endian, unlike EEPROMRecord. NULL if out of range or decryption fails.
+const uint8_t *eeprom_view_bytes(EEPROMView *view, size_t offset, size_t size);
+
+// Field of eeprom_get_fields(view->result.version); offsets address the image
+const uint8_t *eeprom_view_field(EEPROMView *view, const FieldMetadata *field);
+
+// Board serial number, NUL-terminated; same text as eeprom_record_serial()
+int eeprom_view_serial(EEPROMView *view, char *buffer, size_t size);
+
+// Decodes the remaining regions: view->data and view->result then match
+// what eeprom_decode_ex() gives for the same image
+int eeprom_view_decode_all(EEPROMView *view);
 
 #endif // EEPROM_OPS_H
@@ -0,0 +1,244 @@
+#include "eeprom_sweep.h"
+#include <math.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+// ═══════════════════════════════════════════════════════════════
+// Unpack kernel
+//
+// Статистика считается по уровням, а не по частотам: суммы уровней и их
+// квадратов помещаются в 32 бита, частоты получаются линейным
+// преобразованием без потери точности
+// ═══════════════════════════════════════════════════════════════
+
+typedef struct
+{
+	uint8_t min;
+	uint8_t max;
+	uint32_t sum;
+	uint32_t sum_sq;
+} LevelTotals;
+
+#if defined(__SSE2__)
+
+static void sweep_unpack_kernel(const uint8_t *packed, uint16_t base, uint8_t step,
+								uint16_t *freqs, LevelTotals *totals)
+{
+	const __m128i nibble = _mm_set1_epi8(0x0F);
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i vstep = _mm_set1_epi16(step);
+	const __m128i vbase = _mm_set1_epi16((short)base);
+	__m128i vmin = _mm_set1_epi8(0x0F);
+	__m128i vmax = zero;
+	__m128i vsum = zero;
+	__m128i vsum_sq = zero;
+
+	for (size_t i = 0; i < EEPROM_SWEEP_BYTES; i += 16)
+	{
+		__m128i v = _mm_loadu_si128((const __m128i*)(packed + i));
+		__m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), nibble);
+		__m128i lo = _mm_and_si128(v, nibble);
+
+		vmin = _mm_min_epu8(vmin, _mm_min_epu8(hi, lo));
+		vmax = _mm_max_epu8(vmax, _mm_max_epu8(hi, lo));
+		vsum = _mm_add_epi64(vsum, _mm_add_epi64(_mm_sad_epu8(hi, zero), _mm_sad_epu8(lo, zero)));
+
+		// Чередование старших и младших полубайтов дает уровни по порядку ASIC
+		__m128i levels[2] = { _mm_unpacklo_epi8(hi, lo), _mm_unpackhi_epi8(hi, lo) };
+		for (int half = 0; half < 2; half++)
+		{
+			__m128i w0 = _mm_unpacklo_epi8(levels[half], zero);
+			__m128i w1 = _mm_unpackhi_epi8(levels[half], zero);
+
+			vsum_sq = _mm_add_epi32(vsum_sq, _mm_add_epi32(_mm_madd_epi16(w0, w0), _mm_madd_epi16(w1, w1)));
+
+			uint16_t *out = freqs + 2 * i + 16 * half;
+			_mm_storeu_si128((__m128i*)out, _mm_add_epi16(_mm_mullo_epi16(w0, vstep), vbase));
+			_mm_storeu_si128((__m128i*)(out + 8), _mm_add_epi16(_mm_mullo_epi16(w1, vstep), vbase));
+		}
+	}
+
+	uint8_t bytes[16];
+	_mm_storeu_si128((__m128i*)bytes, vmin);
+	totals->min = 0x0F;
+	for (int k = 0; k < 16; k++)
+	{
+		totals->min = bytes[k] < totals->min ? bytes[k] : totals->min;
+	}
+	_mm_storeu_si128((__m128i*)bytes, vmax);
+	totals->max = 0;
+	for (int k = 0; k < 16; k++)
+	{
+		totals->max = bytes[k] > totals->max ? bytes[k] : totals->max;
+	}
+
+	uint32_t words[4];
+	_mm_storeu_si128((__m128i*)words, vsum);
+	totals->sum = words[0] + words[2];
+	_mm_storeu_si128((__m128i*)words, vsum_sq);
+	totals->sum_sq = words[0] + words[1] + words[2] + words[3];
+}
+
+const char *eeprom_sweep_kernel(void)
+{
+	return "sse2";
+}
+
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+
+static void sweep_unpack_kernel(const uint8_t *packed, uint16_t base, uint8_t step,
+								uint16_t *freqs, LevelTotals *totals)
+{
+	const uint8x16_t nibble = vdupq_n_u8(0x0F);
+	const uint16x8_t vstep = vdupq_n_u16(step);
+	const uint16x8_t vbase = vdupq_n_u16(base);
+	uint8x16_t vmin = nibble;
+	uint8x16_t vmax = vdupq_n_u8(0);
+	uint32x4_t vsum = vdupq_n_u32(0);
+	uint32x4_t vsum_sq = vdupq_n_u32(0);
+
+	for (size_t i = 0; i < EEPROM_SWEEP_BYTES; i += 16)
+	{
+		uint8x16_t v = vld1q_u8(packed + i);
+		uint8x16_t hi = vshrq_n_u8(v, 4);
+		uint8x16_t lo = vandq_u8(v, nibble);
+
+		vmin = vminq_u8(vmin, vminq_u8(hi, lo));
+		vmax = vmaxq_u8(vmax, vmaxq_u8(hi, lo));
+
+		uint8x16x2_t levels = vzipq_u8(hi, lo);
+		for (int half = 0; half < 2; half++)
+		{
+			uint16x8_t w0 = vmovl_u8(vget_low_u8(levels.val[half]));
+			uint16x8_t w1 = vmovl_u8(vget_high_u8(levels.val[half]));
+
+			vsum = vpadalq_u16(vsum, w0);
+			vsum = vpadalq_u16(vsum, w1);
+			vsum_sq = vmlal_u16(vsum_sq, vget_low_u16(w0), vget_low_u16(w0));
+			vsum_sq = vmlal_u16(vsum_sq, vget_high_u16(w0), vget_high_u16(w0));
+			vsum_sq = vmlal_u16(vsum_sq, vget_low_u16(w1), vget_low_u16(w1));
+			vsum_sq = vmlal_u16(vsum_sq, vget_high_u16(w1), vget_high_u16(w1));
+
+			uint16_t *out = freqs + 2 * i + 16 * half;
+			vst1q_u16(out, vmlaq_u16(vbase, w0, vstep));
+			vst1q_u16(out + 8, vmlaq_u16(vbase, w1, vstep));
+		}
+	}
+
+	totals->min = vminvq_u8(vmin);
+	totals->max = vmaxvq_u8(vmax);
+	totals->sum = vaddvq_u32(vsum);
+	totals->sum_sq = vaddvq_u32(vsum_sq);
+}
+
+const char *eeprom_sweep_kernel(void)
+{
+	return "neon";
+}
+
+#else
+
+static void sweep_unpack_kernel(const uint8_t *packed, uint16_t base, uint8_t step,
+								uint16_t *freqs, LevelTotals *totals)
+{
+	totals->min = 0x0F;
+	totals->max = 0;
+	totals->sum = 0;
+	totals->sum_sq = 0;
+
+	for (size_t i = 0; i < EEPROM_SWEEP_BYTES; i++)
+	{
+		uint8_t levels[2] = { packed[i] >> 4, packed[i] & 0x0F };
+		for (int k = 0; k < 2; k++)
+		{
+			freqs[2 * i + k] = levels[k] * step + base;
+			totals->min = levels[k] < totals->min ? levels[k] : totals->min;
+			totals->max = levels[k] > totals->max ? levels[k] : totals->max;
+			totals->sum += levels[k];
+			totals->sum_sq += levels[k] * levels[k];
+		}
+	}
+}
+
+const char *eeprom_sweep_kernel(void)
+{
+	return "scalar";
+}
+
+#endif
+
+void eeprom_sweep_unpack(const uint8_t packed[EEPROM_SWEEP_BYTES], uint16_t base, uint8_t step,
+						 uint16_t freqs[EEPROM_SWEEP_ASICS], EEPROMSweepStats *stats)
+{
+	LevelTotals totals;
+	sweep_unpack_kernel(packed, base, step, freqs, &totals);
+
+	if (stats && (uint32_t)totals.max * step + base > UINT16_MAX)
+	{
+		// Частоты переполнили 16 бит (стертый регион 0xFF): сводка по тому,
+		// что записано в freqs, чтобы они не расходились
+		uint64_t sum = 0, sum_sq = 0;
+		stats->min = UINT16_MAX;
+		stats->max = 0;
+		for (size_t i = 0; i < EEPROM_SWEEP_ASICS; i++)
+		{
+			stats->min = freqs[i] < stats->min ? freqs[i] : stats->min;
+			stats->max = freqs[i] > stats->max ? freqs[i] : stats->max;
+			sum += freqs[i];
+			sum_sq += (uint64_t)freqs[i] * freqs[i];
+		}
+		double mean = (double)sum / EEPROM_SWEEP_ASICS;
+		double variance = (double)sum_sq / EEPROM_SWEEP_ASICS - mean * mean;
+		stats->mean = mean;
+		stats->stddev = variance > 0 ? sqrt(variance) : 0.0;
+	}
+	else if (stats)
+	{
+		double mean = (double)totals.sum / EEPROM_SWEEP_ASICS;
+		double variance = (double)totals.sum_sq / EEPROM_SWEEP_ASICS - mean * mean;
+
+		stats->min = (uint16_t)(totals.min * step + base);
+		stats->max = (uint16_t)(totals.max * step + base);
+		stats->mean = mean * step + base;
+		stats->stddev = variance > 0 ? sqrt(variance) * step : 0.0;
+	}
+}
+
+// ═══════════════════════════════════════════════════════════════
+// Fleet histogram
+// ═══════════════════════════════════════════════════════════════
+
+void eeprom_sweep_histogram_add(EEPROMSweepHistogram *histogram,
+								const uint8_t packed[EEPROM_SWEEP_BYTES],
+								const uint16_t freqs[EEPROM_SWEEP_ASICS])
+{
+	histogram->boards++;
+
+	for (size_t i = 0; i < EEPROM_SWEEP_ASICS; i++)
+	{
+		histogram->freq_sum[i] += freqs[i];
+	}
+	for (size_t i = 0; i < EEPROM_SWEEP_BYTES; i++)
+	{
+		histogram->levels[2 * i][packed[i] >> 4]++;
+		histogram->levels[2 * i + 1][packed[i] & 0x0F]++;
+	}
+}
+
+void eeprom_sweep_histogram_merge(EEPROMSweepHistogram *into, const EEPROMSweepHistogram *from)
+{
+	into->boards += from->boards;
+
+	for (size_t i = 0; i < EEPROM_SWEEP_ASICS; i++)
+	{
+		into->freq_sum[i] += from->freq_sum[i];
+		for (size_t level = 0; level < EEPROM_SWEEP_LEVELS; level++)
+		{
+			into->levels[i][level] += from->levels[i][level];
+		}
+	}
+}
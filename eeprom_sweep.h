@@ -0,0 +1,57 @@
+#ifndef EEPROM_SWEEP_H
+#define EEPROM_SWEEP_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ═══════════════════════════════════════════════════════════════
+// Sweep frequency tables (v1, v5, v6)
+// ═══════════════════════════════════════════════════════════════
+//
+// 128 bytes of 4-bit levels, two ASICs per byte, high nibble first:
+//   level[2i] = packed[i] >> 4, level[2i + 1] = packed[i] & 0x0F
+//   frequency = level * step + base (MHz)
+
+#define EEPROM_SWEEP_ASICS  256
+#define EEPROM_SWEEP_BYTES  (EEPROM_SWEEP_ASICS / 2)
+#define EEPROM_SWEEP_LEVELS 16
+
+// One board, MHz
+typedef struct
+{
+	uint16_t min;
+	uint16_t max;
+	double mean;
+	double stddev;                 // population standard deviation
+} EEPROMSweepStats;
+
+/**
+ * Unpacks the levels into per-ASIC frequencies and summarizes them
+ * SSE2 on x86-64, NEON on AArch64 (multiply-accumulate per 8 ASICs),
+ * scalar elsewhere; all give the same result. Frequencies wrap at 16 bits
+ * like the scalar formula; stats describe the frequencies as written.
+ * @param stats - may be NULL
+ */
+void eeprom_sweep_unpack(const uint8_t packed[EEPROM_SWEEP_BYTES], uint16_t base, uint8_t step,
+						 uint16_t freqs[EEPROM_SWEEP_ASICS], EEPROMSweepStats *stats);
+
+// "sse2", "neon" or "scalar": the kernel eeprom_sweep_unpack() was built with
+const char *eeprom_sweep_kernel(void);
+
+// Per ASIC position over many boards. Not thread-safe: one per worker,
+// merged at the end.
+typedef struct
+{
+	uint64_t boards;
+	uint64_t freq_sum[EEPROM_SWEEP_ASICS];                      // MHz
+	uint32_t levels[EEPROM_SWEEP_ASICS][EEPROM_SWEEP_LEVELS];    // boards per level
+} EEPROMSweepHistogram;
+
+// freqs as unpacked from packed by eeprom_sweep_unpack()
+void eeprom_sweep_histogram_add(EEPROMSweepHistogram *histogram,
+								const uint8_t packed[EEPROM_SWEEP_BYTES],
+								const uint16_t freqs[EEPROM_SWEEP_ASICS]);
+
+void eeprom_sweep_histogram_merge(EEPROMSweepHistogram *into, const EEPROMSweepHistogram *from);
+
+#endif // EEPROM_SWEEP_H
@@ -0,0 +1,1115 @@
+#include "eeprom_topology.h"
+#include "eeprom_cache.h"
+#include "eeprom_file.h"
+#include "json_reader.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define TOPOLOGY_PREFIX     "topol_"
+#define TOPOLOGY_SUFFIX     ".conf"
+#define TOPOLOGY_MAX_CONFIG (1 << 20)  // больше конфиг не бывает
+#define TOPOLOGY_PER_FILE   64         // записей в одном "config"
+#define TOPOLOGY_TPL_MAX    64         // строк и столбцов tpl до проверки размера
+
+// ═══════════════════════════════════════════════════════════════
+// Разбор конфига
+// ═══════════════════════════════════════════════════════════════
+
+typedef enum
+{
+	KEY_TEXT,
+	KEY_NUMBER,
+	KEY_ADDRESS                        // число или строка "0x1368"
+} TopologyKeyKind;
+
+// Скалярное значение записи: путь от корня записи и поле EEPROMTopologyBoard
+typedef struct
+{
+	const char *path;                  // имена через '.', '#' - любой элемент массива
+	TopologyKeyKind kind;
+	size_t offset;
+	size_t size;
+} TopologyKey;
+
+#define TOPOLOGY_TEXT(path, member) \
+	{ path, KEY_TEXT, offsetof(EEPROMTopologyBoard, member), sizeof(((EEPROMTopologyBoard*)0)->member) }
+#define TOPOLOGY_NUMBER(path, member) \
+	{ path, KEY_NUMBER, offsetof(EEPROMTopologyBoard, member), sizeof(((EEPROMTopologyBoard*)0)->member) }
+#define TOPOLOGY_ADDRESS(path, member) \
+	{ path, KEY_ADDRESS, offsetof(EEPROMTopologyBoard, member), sizeof(((EEPROMTopologyBoard*)0)->member) }
+
+static const TopologyKey topology_keys[] =
+{
+	TOPOLOGY_TEXT("machine", machine),
+	TOPOLOGY_TEXT("hw_version", hw_version),
+	TOPOLOGY_TEXT("sw_version", sw_version),
+	TOPOLOGY_TEXT("processor.type", processor),
+	TOPOLOGY_TEXT("power.type", power),
+	TOPOLOGY_NUMBER("power.i2c_addr", power_i2c_addr),
+	TOPOLOGY_TEXT("asic.asic_id", asic_id),
+	TOPOLOGY_ADDRESS("asic.asic_addr", asic_addr),
+	TOPOLOGY_ADDRESS("asic.chip_type", asic_addr),
+	TOPOLOGY_NUMBER("asic.asic_addr_interval", asic_addr_interval),
+	TOPOLOGY_NUMBER("asic.asic_domain_num", asic_domain_num),
+	TOPOLOGY_NUMBER("asic.asic_core_num", asic_core_num),
+	TOPOLOGY_NUMBER("asic.asic_big_core_num", asic_core_num),
+	TOPOLOGY_NUMBER("asic.asic_small_core_num", asic_small_core_num),
+	TOPOLOGY_NUMBER("asic.asic_little_core_num", asic_small_core_num),
+	TOPOLOGY_NUMBER("chain.chain_num", chain_num),
+	TOPOLOGY_NUMBER("chain.chain_row", chain_row),
+	TOPOLOGY_NUMBER("chain.chain_column", chain_column),
+	TOPOLOGY_NUMBER("chain.chain_domain_num", chain_domain_num),
+	TOPOLOGY_NUMBER("chain.chain_asic_num", chain_asic_num),
+	TOPOLOGY_NUMBER("chain.domain_asic_num", domain_asic_num),
+	TOPOLOGY_TEXT("chain.pic.type", pic),
+	TOPOLOGY_NUMBER("chain.pic.i2c_addr", pic_i2c_addr),
+	TOPOLOGY_TEXT("chain.eeprom.type", eeprom),
+	TOPOLOGY_NUMBER("chain.eeprom.i2c_addr", eeprom_i2c_addr),
+};
+
+// Массивы датчиков и их группы
+static const struct
+{
+	const char *path;
+	EEPROMTopologySensorGroup group;
+} topology_sensor_arrays[] =
+{
+	{ "chain.sensor.#", EEPROM_TOPOLOGY_SENSOR_CHAIN },
+	{ "chain.pic.sensor.#", EEPROM_TOPOLOGY_SENSOR_PIC },
+	{ "chain.ctrlboardsensor.#", EEPROM_TOPOLOGY_SENSOR_CTRLBOARD },
+	{ "chain.ctrlboard_sensor.#", EEPROM_TOPOLOGY_SENSOR_CTRLBOARD },
+	{ "chain.switchsensor.#", EEPROM_TOPOLOGY_SENSOR_SWITCH },
+	{ "chain.asic_sensor.#", EEPROM_TOPOLOGY_SENSOR_ASIC },
+};
+
+typedef struct
+{
+	EEPROMTopologyBoard *boards;
+	size_t capacity;
+	size_t count;
+	const char *source;
+
+	EEPROMTopologyBoard *board;        // запись, которая сейчас читается
+	int base;                          // уровень пути, на котором ключи записи
+	int in_config;                     // корень - {"config": [...]}
+
+	EEPROMTopologySensor *sensor;      // текущий объект датчика
+	int sensor_depth;
+
+	// tpl и координаты доменов до проверки размеров
+	uint8_t tpl[TOPOLOGY_TPL_MAX][TOPOLOGY_TPL_MAX];
+	int tpl_rows;
+	int tpl_columns;
+	int from_domains;                  // tpl заполнен из chain.domain
+	int domain_asic;
+	int coordinate[2];
+
+	int status;
+	char *message;
+	size_t message_size;
+} TopologyParser;
+
+static int parser_fail(TopologyParser *parser, int status, const char *format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	vsnprintf(parser->message, parser->message_size, format, args);
+	va_end(args);
+	parser->status = status;
+	return 1;
+}
+
+// Путь события от уровня base совпадает с шаблоном целиком
+static int path_match(const JsonEvent *event, int base, const char *pattern)
+{
+	int level = base;
+	const char *p = pattern;
+
+	while (*p)
+	{
+		const char *dot = strchr(p, '.');
+		size_t length = dot ? (size_t)(dot - p) : strlen(p);
+		if (level >= event->depth)
+		{
+			return 0;
+		}
+
+		const JsonFrame *frame = &event->path[level];
+		if (length == 1 && *p == '#')
+		{
+			if (!frame->is_array)
+			{
+				return 0;
+			}
+		}
+		else if (frame->is_array || strncmp(frame->key, p, length) != 0 || frame->key[length] != '\0')
+		{
+			return 0;
+		}
+
+		level++;
+		p += length;
+		if (*p == '.')
+		{
+			p++;
+		}
+	}
+	return level == event->depth;
+}
+
+static const char *path_last_key(const JsonEvent *event)
+{
+	return json_event_key(event, event->depth - 1);
+}
+
+static int parser_text(TopologyParser *parser, const JsonEvent *event, char *out, size_t size)
+{
+	if (event->value_type != JSON_STRING)
+	{
+		return parser_fail(parser, EEPROM_ERROR_UNKNOWN, "%s: expected a string", path_last_key(event));
+	}
+	if (event->length >= size)
+	{
+		return parser_fail(parser, EEPROM_ERROR_UNKNOWN, "%s: \"%s\" is longer than %zu characters",
+						   path_last_key(event), event->string, size - 1);
+	}
+	memcpy(out, event->string, event->length + 1);
+	return 0;
+}
+
+static int parser_number(TopologyParser *parser, const JsonEvent *event, int address,
+						 int64_t min, int64_t max, int64_t *value)
+{
+	const char *key = path_last_key(event);
+	if (address && event->value_type == JSON_STRING)
+	{
+		char *end;
+		errno = 0;
+		unsigned long number = strtoul(event->string, &end, 0);
+		if (errno || end == event->string || *end != '\0')
+		{
+			return parser_fail(parser, EEPROM_ERROR_UNKNOWN, "%s: \"%s\" is not a number", key, event->string);
+		}
+		*value = (int64_t)number;
+	}
+	else if ((event->value_type == JSON_NUMBER && event->is_integer) || event->value_type == JSON_BOOL)
+	{
+		*value = event->integer;
+	}
+	else
+	{
+		return parser_fail(parser, EEPROM_ERROR_UNKNOWN, "%s: expected an integer", key ? key : "array element");
+	}
+
+	if (*value < min || *value > max)
+	{
+		return parser_fail(parser, EEPROM_ERROR_UNKNOWN, "%s: %lld is out of range %lld..%lld",
+						   key ? key : "array element", (long long)*value, (long long)min, (long long)max);
+	}
+	return 0;
+}
+
+static int parser_key(TopologyParser *parser, const JsonEvent *event, const TopologyKey *key)
+{
+	uint8_t *field = (uint8_t*)parser->board + key->offset;
+	if (key->kind == KEY_TEXT)
+	{
+		return parser_text(parser, event, (char*)field, key->size);
+	}
+
+	int64_t value;
+	int64_t max = key->size == 1 ? UINT8_MAX : key->size == 2 ? UINT16_MAX : UINT32_MAX;
+	if (parser_number(parser, event, key->kind == KEY_ADDRESS, 0, max, &value) != 0)
+	{
+		return 1;
+	}
+	switch (key->size)
+	{
+		case 1: *field = (uint8_t)value; break;
+		case 2: { uint16_t v = (uint16_t)value; memcpy(field, &v, sizeof(v)); break; }
+		default: { uint32_t v = (uint32_t)value; memcpy(field, &v, sizeof(v)); break; }
+	}
+	return 0;
+}
+
+static int parser_sensor_value(TopologyParser *parser, const JsonEvent *event)
+{
+	EEPROMTopologySensor *sensor = parser->sensor;
+	const char *key = path_last_key(event);
+	int64_t value;
+
+	if (!key)
+	{
+		return 0;
+	}
+	if (strcmp(key, "type") == 0)
+	{
+		return parser_text(parser, event, sensor->type, sizeof(sensor->type));
+	}
+	if (strcmp(key, "x") == 0)
+	{
+		return parser_text(parser, event, sensor->x, sizeof(sensor->x));
+	}
+	if (strcmp(key, "y") == 0)
+	{
+		return parser_text(parser, event, sensor->y, sizeof(sensor->y));
+	}
+	if (strcmp(key, "index") == 0)
+	{
+		if (parser_number(parser, event, 0, 0, UINT8_MAX, &value) != 0)
+		{
+			return 1;
+		}
+		sensor->index = (uint8_t)value;
+		return 0;
+	}
+	if (strcmp(key, "iic") == 0)
+	{
+		if (parser_number(parser, event, 0, 0, UINT8_MAX, &value) != 0)
+		{
+			return 1;
+		}
+		sensor->i2c_addr = (uint8_t)value;
+		return 0;
+	}
+	if (strcmp(key, "bind_asic") == 0 || strcmp(key, "asic") == 0)
+	{
+		if (parser_number(parser, event, 0, -1, INT16_MAX, &value) != 0)
+		{
+			return 1;
+		}
+		sensor->asic = (int16_t)value;
+	}
+	return 0;
+}
+
+// Числовые значения strategy и adjust_strategy
+static int parser_param(TopologyParser *parser, const JsonEvent *event)
+{
+	EEPROMTopologyBoard *board = parser->board;
+	if (event->value_type != JSON_BOOL && !(event->value_type == JSON_NUMBER && event->is_integer))
+	{
+		return 0;
+	}
+	if (board->param_count == EEPROM_TOPOLOGY_PARAMS)
+	{
+		return parser_fail(parser, EEPROM_ERROR_UNKNOWN, "more than %d strategy values", EEPROM_TOPOLOGY_PARAMS);
+	}
+
+	EEPROMTopologyParam *param = &board->params[board->param_count];
+	int length = snprintf(param->key, sizeof(param->key), "%s.%s",
+						  json_event_key(event, parser->base), path_last_key(event));
+	if (length < 0 || length >= (int)sizeof(param->key))
+	{
+		return parser_fail(parser, EEPROM_ERROR_UNKNOWN, "%s: name too long", path_last_key(event));
+	}
+	int64_t value;
+	if (parser_number(parser, event, 0, INT32_MIN, INT32_MAX, &value) != 0)
+	{
+		return 1;
+	}
+	param->value = (int32_t)value;
+	board->param_count++;
+	return 0;
+}
+
+static int parser_tpl_cell(TopologyParser *parser, int row, int column, int64_t value)
+{
+	if (row >= TOPOLOGY_TPL_MAX || column >= TOPOLOGY_TPL_MAX)
+	{
+		return parser_fail(parser, EEPROM_ERROR_UNKNOWN, "ASIC layout larger than %dx%d",
+						   TOPOLOGY_TPL_MAX, TOPOLOGY_TPL_MAX);
+	}
+	parser->tpl[row][column] = (uint8_t)value;
+	parser->tpl_rows = row + 1 > parser->tpl_rows ? row + 1 : parser->tpl_rows;
+	parser->tpl_columns = column + 1 > parser->tpl_columns ? column + 1 : parser->tpl_columns;
+	return 0;
+}
+
+static int parser_value(TopologyParser *parser, const JsonEvent *event)
+{
+	EEPROMTopologyBoard *board = parser->board;
+	int base = parser->base;
+	int64_t value;
+
+	if (parser->sensor && event->depth == parser->sensor_depth + 1)
+	{
+		return parser_sensor_value(parser, event);
+	}
+
+	for (size_t k = 0; k < sizeof(topology_keys) / sizeof(topology_keys[0]); k++)
+	{
+		if (path_match(event, base, topology_keys[k].path))
+		{
+			return parser_key(parser, event, &topology_keys[k]);
+		}
+	}
+
+	const char *group = json_event_key(event, base);
+	if (event->depth == base + 2 && group && json_event_key(event, base + 1) &&
+		(strcmp(group, "strategy") == 0 || strcmp(group, "adjust_strategy") == 0))
+	{
+		return parser_param(parser, event);
+	}
+
+	if (path_match(event, base, "mix_boardnames.#"))
+	{
+		char name[EEPROM_TOPOLOGY_NAME];
+		if (parser_text(parser, event, name, sizeof(name)) != 0)
+		{
+			return 1;
+		}
+		// Сама машина в списке не нужна, повторы тоже
+		if (strcmp(name, board->machine) == 0)
+		{
+			return 0;
+		}
+		for (int a = 0; a < board->alias_count; a++)
+		{
+			if (strcmp(name, board->aliases[a]) == 0)
+			{
+				return 0;
+			}
+		}
+		if (board->alias_count == EEPROM_TOPOLOGY_ALIASES)
+		{
+			return parser_fail(parser, EEPROM_ERROR_UNKNOWN, "more than %d mix_boardnames", EEPROM_TOPOLOGY_ALIASES);
+		}
+		memcpy(board->aliases[board->alias_count++], name, sizeof(name));
+		return 0;
+	}
+
+	if (path_match(event, base, "chain.tpl.#.#"))
+	{
+		if (parser_number(parser, event, 0, 0, UINT8_MAX, &value) != 0)
+		{
+			return 1;
+		}
+		return parser_tpl_cell(parser, (int)event->path[base + 2].index, (int)event->path[base + 3].index, value);
+	}
+
+	if (path_match(event, base, "chain.domain.#.asic.#.index"))
+	{
+		if (parser_number(parser, event, 0, 0, UINT8_MAX - 1, &value) != 0)
+		{
+			return 1;
+		}
+		parser->domain_asic = (int)value;
+	}
+	else if (path_match(event, base, "chain.domain.#.asic.#.coordinate.#"))
+	{
+		size_t k = event->path[base + 6].index;
+		if (k < 2)
+		{
+			if (parser_number(parser, event, 0, 1, TOPOLOGY_TPL_MAX, &value) != 0)
+			{
+				return 1;
+			}
+			parser->coordinate[k] = (int)value;
+		}
+	}
+	return 0;
+}
+
+static void parser_begin_board(TopologyParser *parser, int base, size_t entry)
+{
+	EEPROMTopologyBoard *board = &parser->boards[parser->count];
+	memset(board, 0, sizeof(*board));
+	snprintf(board->source, sizeof(board->source), "%s", parser->source);
+	board->source_entry = (uint16_t)entry;
+
+	parser->board = board;
+	parser->base = base;
+	parser->sensor = NULL;
+	memset(parser->tpl, 0, sizeof(parser->tpl));
+	parser->tpl_rows = 0;
+	parser->tpl_columns = 0;
+	parser->from_domains = 0;
+}
+
+static int parser_end_board(TopologyParser *parser)
+{
+	EEPROMTopologyBoard *board = parser->board;
+	parser->board = NULL;
+
+	if (board->machine[0] == '\0')
+	{
+		return parser_fail(parser, EEPROM_ERROR_UNKNOWN, "entry %u has no \"machine\"", board->source_entry);
+	}
+	if (parser->tpl_rows * parser->tpl_columns > EEPROM_TOPOLOGY_CELLS)
+	{
+		return parser_fail(parser, EEPROM_ERROR_UNKNOWN, "%s: ASIC layout %dx%d has more than %d cells",
+						   board->machine, parser->tpl_rows, parser->tpl_columns, EEPROM_TOPOLOGY_CELLS);
+	}
+
+	board->grid_rows = (uint8_t)parser->tpl_rows;
+	board->grid_columns = (uint8_t)parser->tpl_columns;
+	for (int row = 0; row < parser->tpl_rows; row++)
+	{
+		memcpy(board->grid + row * parser->tpl_columns, parser->tpl[row], parser->tpl_columns);
+	}
+
+	parser->count++;
+	return 0;
+}
+
+static int parser_event(const JsonEvent *event, void *user)
+{
+	TopologyParser *parser = (TopologyParser*)user;
+
+	switch (event->type)
+	{
+		case JSON_EVENT_OBJECT_BEGIN:
+			if (event->depth == 0)
+			{
+				// Одиночный конфиг, пока не встретился "config"
+				parser_begin_board(parser, 0, 0);
+				return 0;
+			}
+			if (parser->in_config && event->depth == 2 && path_match(event, 0, "config.#"))
+			{
+				if (parser->count == parser->capacity)
+				{
+					return parser_fail(parser, EEPROM_ERROR_SIZE, "more than %zu entries", parser->capacity);
+				}
+				parser_begin_board(parser, 2, event->path[1].index);
+				return 0;
+			}
+			if (!parser->board)
+			{
+				return 0;
+			}
+			for (size_t s = 0; s < sizeof(topology_sensor_arrays) / sizeof(topology_sensor_arrays[0]); s++)
+			{
+				if (path_match(event, parser->base, topology_sensor_arrays[s].path))
+				{
+					EEPROMTopologyBoard *board = parser->board;
+					if (board->sensor_count == EEPROM_TOPOLOGY_SENSORS)
+					{
+						return parser_fail(parser, EEPROM_ERROR_UNKNOWN, "more than %d sensors", EEPROM_TOPOLOGY_SENSORS);
+					}
+					parser->sensor = &board->sensors[board->sensor_count++];
+					parser->sensor->group = (uint8_t)topology_sensor_arrays[s].group;
+					parser->sensor->asic = -1;
+					parser->sensor_depth = event->depth;
+					return 0;
+				}
+			}
+			if (path_match(event, parser->base, "fan.#"))
+			{
+				parser->board->fan_count++;
+			}
+			else if (path_match(event, parser->base, "chain.domain.#.asic.#"))
+			{
+				parser->domain_asic = -1;
+				parser->coordinate[0] = 0;
+				parser->coordinate[1] = 0;
+			}
+			return 0;
+
+		case JSON_EVENT_OBJECT_END:
+			if (!parser->board)
+			{
+				return 0;
+			}
+			if (parser->sensor && event->depth == parser->sensor_depth)
+			{
+				parser->sensor = NULL;
+				return 0;
+			}
+			if (event->depth == parser->base)
+			{
+				return parser_end_board(parser);
+			}
+			// ASIC домена: номер по цепочке в клетку по координатам (строка, столбец от 1)
+			if (path_match(event, parser->base, "chain.domain.#.asic.#"))
+			{
+				if (parser->domain_asic < 0 || parser->coordinate[0] == 0 || parser->coordinate[1] == 0)
+				{
+					return parser_fail(parser, EEPROM_ERROR_UNKNOWN, "domain ASIC without index or coordinate");
+				}
+				if (parser->tpl_rows && !parser->from_domains)
+				{
+					return 0;      // есть tpl
+				}
+				parser->from_domains = 1;
+				return parser_tpl_cell(parser, parser->coordinate[0] - 1, parser->coordinate[1] - 1,
+									   parser->domain_asic + 1);
+			}
+			return 0;
+
+		case JSON_EVENT_ARRAY_BEGIN:
+			if (event->depth == 1 && path_match(event, 0, "config"))
+			{
+				parser->in_config = 1;
+				parser->board = NULL;
+			}
+			else if (parser->board && path_match(event, parser->base, "chain.tpl") && parser->from_domains)
+			{
+				// tpl важнее координат доменов, прочитанных раньше
+				memset(parser->tpl, 0, sizeof(parser->tpl));
+				parser->tpl_rows = 0;
+				parser->tpl_columns = 0;
+				parser->from_domains = 0;
+			}
+			return 0;
+
+		case JSON_EVENT_ARRAY_END:
+			return 0;
+
+		case JSON_EVENT_VALUE:
+			return parser->board ? parser_value(parser, event) : 0;
+	}
+	return 0;
+}
+
+int eeprom_topology_parse(const char *text, size_t size, const char *source,
+						  EEPROMTopologyBoard *boards, size_t capacity, size_t *count,
+						  char *message, size_t message_size)
+{
+	TopologyParser *parser = calloc(1, sizeof(TopologyParser));
+	if (!parser)
+	{
+		snprintf(message, message_size, "out of memory");
+		return EEPROM_ERROR_UNKNOWN;
+	}
+	parser->boards = boards;
+	parser->capacity = capacity;
+	parser->source = source;
+	parser->message = message;
+	parser->message_size = message_size;
+	parser->status = EEPROM_SUCCESS;
+
+	if (capacity == 0)
+	{
+		free(parser);
+		snprintf(message, message_size, "no room for entries");
+		return EEPROM_ERROR_SIZE;
+	}
+
+	JsonError error;
+	int ret = json_read(text, size, parser_event, parser, &error);
+	if (ret < 0)
+	{
+		snprintf(message, message_size, "line %d, column %d: %s", error.line, error.column, error.message);
+		parser->status = EEPROM_ERROR_UNKNOWN;
+	}
+	else if (ret == 0 && parser->count == 0)
+	{
+		snprintf(message, message_size, "no board entries");
+		parser->status = EEPROM_ERROR_UNKNOWN;
+	}
+
+	int status = parser->status;
+	*count = status == EEPROM_SUCCESS ? parser->count : 0;
+	free(parser);
+	return status;
+}
+
+const char *eeprom_topology_sensor_group(uint8_t group)
+{
+	static const char *const names[] = { "chain", "pic", "ctrlboard", "switch", "asic" };
+	return group < sizeof(names) / sizeof(names[0]) ? names[group] : "unknown";
+}
+
+// ═══════════════════════════════════════════════════════════════
+// Каталог конфигов
+// ═══════════════════════════════════════════════════════════════
+
+typedef struct
+{
+	char **names;                      // topol_*.conf по алфавиту
+	size_t count;
+	uint64_t fingerprint;
+} TopologyConfigs;
+
+static int compare_names(const void *a, const void *b)
+{
+	return strcmp(*(char *const*)a, *(char *const*)b);
+}
+
+static int topology_config_name(const char *name)
+{
+	size_t length = strlen(name);
+	size_t prefix = strlen(TOPOLOGY_PREFIX);
+	size_t suffix = strlen(TOPOLOGY_SUFFIX);
+	return length > prefix + suffix && strncmp(name, TOPOLOGY_PREFIX, prefix) == 0 &&
+		   strcmp(name + length - suffix, TOPOLOGY_SUFFIX) == 0;
+}
+
+static void configs_free(TopologyConfigs *configs)
+{
+	for (size_t i = 0; i < configs->count; i++)
+	{
+		free(configs->names[i]);
+	}
+	free(configs->names);
+	configs->names = NULL;
+	configs->count = 0;
+}
+
+// Список конфигов и отпечаток: имена, размеры, время изменения, inode
+static int configs_scan(TopologyConfigs *configs, const char *dir)
+{
+	memset(configs, 0, sizeof(*configs));
+
+	DIR *d = opendir(dir);
+	if (!d)
+	{
+		return -1;
+	}
+
+	size_t capacity = 0;
+	struct dirent *entry;
+	while ((entry = readdir(d)) != NULL)
+	{
+		if (!topology_config_name(entry->d_name))
+		{
+			continue;
+		}
+		if (configs->count == capacity)
+		{
+			size_t grown = capacity ? capacity * 2 : 64;
+			char **names = realloc(configs->names, grown * sizeof(char*));
+			if (!names)
+			{
+				closedir(d);
+				configs_free(configs);
+				errno = ENOMEM;
+				return -1;
+			}
+			configs->names = names;
+			capacity = grown;
+		}
+		if (!(configs->names[configs->count] = strdup(entry->d_name)))
+		{
+			closedir(d);
+			configs_free(configs);
+			errno = ENOMEM;
+			return -1;
+		}
+		configs->count++;
+	}
+	closedir(d);
+
+	qsort(configs->names, configs->count, sizeof(char*), compare_names);
+
+	uint64_t h = eeprom_hash64(EEPROM_TOPOLOGY_MAGIC, 8, sizeof(EEPROMTopologyBoard));
+	h = eeprom_hash64(dir, strlen(dir) + 1, h);
+	for (size_t i = 0; i < configs->count; i++)
+	{
+		char path[4096];
+		struct stat st;
+		uint64_t values[4] = { 0 };
+
+		snprintf(path, sizeof(path), "%s/%s", dir, configs->names[i]);
+		if (stat(path, &st) == 0)
+		{
+			values[0] = (uint64_t)st.st_size;
+			values[1] = (uint64_t)st.st_mtim.tv_sec;
+			values[2] = (uint64_t)st.st_mtim.tv_nsec;
+			values[3] = (uint64_t)st.st_ino;
+		}
+		h = eeprom_hash64(configs->names[i], strlen(configs->names[i]) + 1, h);
+		h = eeprom_hash64(values, sizeof(values), h);
+	}
+	configs->fingerprint = h;
+	return 0;
+}
+
+static char *read_config(const char *path, size_t *size)
+{
+	int fd = open(path, O_RDONLY);
+	if (fd < 0)
+	{
+		return NULL;
+	}
+
+	struct stat st;
+	char *text = NULL;
+	if (fstat(fd, &st) == 0)
+	{
+		if (st.st_size > TOPOLOGY_MAX_CONFIG)
+		{
+			errno = EFBIG;
+		}
+		else if ((text = malloc(st.st_size + 1)) != NULL)
+		{
+			ssize_t n = read(fd, text, st.st_size);
+			if (n != st.st_size)
+			{
+				free(text);
+				text = NULL;
+				errno = n < 0 ? errno : EIO;
+			}
+			else
+			{
+				*size = (size_t)n;
+			}
+		}
+	}
+	int saved = errno;
+	close(fd);
+	errno = saved;
+	return text;
+}
+
+// ═══════════════════════════════════════════════════════════════
+// Компиляция индекса
+// ═══════════════════════════════════════════════════════════════
+
+static void topology_diag(EEPROMDiagHandler diag, void *user, EEPROMDiagLevel level, const char *format, ...)
+{
+	if (!diag)
+	{
+		return;
+	}
+	char message[512];
+	va_list args;
+	va_start(args, format);
+	vsnprintf(message, sizeof(message), format, args);
+	va_end(args);
+	diag(level, message, user);
+}
+
+static int compare_topology_names(const void *a, const void *b)
+{
+	const EEPROMTopologyName *name_a = (const EEPROMTopologyName*)a;
+	const EEPROMTopologyName *name_b = (const EEPROMTopologyName*)b;
+	return strncmp(name_a->name, name_b->name, EEPROM_TOPOLOGY_NAME);
+}
+
+static int name_taken(const EEPROMTopologyName *names, size_t count, const char *name)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		if (strncmp(names[i].name, name, EEPROM_TOPOLOGY_NAME) == 0)
+		{
+			return 1;
+		}
+	}
+	return 0;
+}
+
+static size_t align8(size_t size)
+{
+	return (size + 7) & ~(size_t)7;
+}
+
+/*! \brief parses every config into one image of the cache file
+
+	Повторное определение машины отбрасывается целиком: остается первое по
+	имени файла, поэтому topol_HHB68601.conf важнее записи в topol_HHB68xxx.conf.
+ */
+static uint8_t *topology_compile(const char *dir, const TopologyConfigs *configs, size_t *image_size,
+								 EEPROMDiagHandler diag, void *user)
+{
+	EEPROMTopologyBoard *boards = NULL;
+	size_t board_count = 0;
+	size_t capacity = 0;
+	size_t skipped = 0;
+
+	for (size_t i = 0; i < configs->count; i++)
+	{
+		if (capacity - board_count < TOPOLOGY_PER_FILE)
+		{
+			size_t grown = capacity ? capacity * 2 : 4 * TOPOLOGY_PER_FILE;
+			EEPROMTopologyBoard *more = realloc(boards, grown * sizeof(EEPROMTopologyBoard));
+			if (!more)
+			{
+				free(boards);
+				errno = ENOMEM;
+				return NULL;
+			}
+			boards = more;
+			capacity = grown;
+		}
+
+		char path[4096];
+		size_t size = 0;
+		snprintf(path, sizeof(path), "%s/%s", dir, configs->names[i]);
+		char *text = read_config(path, &size);
+		if (!text)
+		{
+			topology_diag(diag, user, EEPROM_DIAG_WARNING, "%s: %s", path, strerror(errno));
+			skipped++;
+			continue;
+		}
+
+		char message[256];
+		size_t count = 0;
+		if (eeprom_topology_parse(text, size, configs->names[i], boards + board_count,
+								  TOPOLOGY_PER_FILE, &count, message, sizeof(message)) != EEPROM_SUCCESS)
+		{
+			topology_diag(diag, user, EEPROM_DIAG_WARNING, "%s: %s", path, message);
+			skipped++;
+		}
+		board_count += count;
+		free(text);
+	}
+
+	// Имена: сначала все машины, потом псевдонимы, не занятые машинами
+	EEPROMTopologyName *names = calloc(board_count * (1 + EEPROM_TOPOLOGY_ALIASES) + 1, sizeof(EEPROMTopologyName));
+	if (!names)
+	{
+		free(boards);
+		errno = ENOMEM;
+		return NULL;
+	}
+	size_t kept = 0;
+	size_t name_count = 0;
+	for (size_t b = 0; b < board_count; b++)
+	{
+		if (name_taken(names, name_count, boards[b].machine))
+		{
+			continue;
+		}
+		boards[kept] = boards[b];
+		memcpy(names[name_count].name, boards[kept].machine, EEPROM_TOPOLOGY_NAME);
+		names[name_count].board = (uint32_t)kept;
+		name_count++;
+		kept++;
+	}
+	for (size_t b = 0; b < kept; b++)
+	{
+		for (int a = 0; a < boards[b].alias_count; a++)
+		{
+			if (!name_taken(names, name_count, boards[b].aliases[a]))
+			{
+				memcpy(names[name_count].name, boards[b].aliases[a], EEPROM_TOPOLOGY_NAME);
+				names[name_count].board = (uint32_t)b;
+				names[name_count].alias = 1;
+				name_count++;
+			}
+		}
+	}
+	qsort(names, name_count, sizeof(EEPROMTopologyName), compare_topology_names);
+
+	size_t boards_offset = align8(sizeof(EEPROMTopologyHeader));
+	size_t names_offset = align8(boards_offset + kept * sizeof(EEPROMTopologyBoard));
+	size_t size = align8(names_offset + name_count * sizeof(EEPROMTopologyName));
+
+	uint8_t *image = calloc(1, size);
+	if (image)
+	{
+		EEPROMTopologyHeader *header = (EEPROMTopologyHeader*)image;
+		memcpy(header->magic, EEPROM_TOPOLOGY_MAGIC, sizeof(header->magic));
+		header->format_version = 1;
+		header->board_size = sizeof(EEPROMTopologyBoard);
+		header->fingerprint = configs->fingerprint;
+		header->board_count = kept;
+		header->name_count = name_count;
+		header->boards_offset = boards_offset;
+		header->names_offset = names_offset;
+		header->config_count = configs->count;
+		header->skipped_count = skipped;
+		memcpy(image + boards_offset, boards, kept * sizeof(EEPROMTopologyBoard));
+		memcpy(image + names_offset, names, name_count * sizeof(EEPROMTopologyName));
+		*image_size = size;
+	}
+	else
+	{
+		errno = ENOMEM;
+	}
+
+	free(names);
+	free(boards);
+	return image;
+}
+
+// ═══════════════════════════════════════════════════════════════
+// Файл индекса
+// ═══════════════════════════════════════════════════════════════
+
+static int topology_section_ok(uint64_t size, uint64_t offset, uint64_t count, uint64_t item)
+{
+	if (offset > size || (offset & 7) != 0)
+	{
+		return 0;
+	}
+	return count <= (size - offset) / item;
+}
+
+// Образ цел, собран этой сборкой из тех же конфигов
+// fingerprint NULL: образ принимается, из каких бы конфигов он ни был собран
+static int topology_attach(EEPROMTopology *topology, const uint8_t *base, size_t size,
+						   const uint64_t *fingerprint)
+{
+	const EEPROMTopologyHeader *header = (const EEPROMTopologyHeader*)base;
+	if (size < sizeof(EEPROMTopologyHeader) ||
+		memcmp(header->magic, EEPROM_TOPOLOGY_MAGIC, sizeof(header->magic)) != 0 ||
+		header->format_version != 1 ||
+		header->board_size != sizeof(EEPROMTopologyBoard) ||
+		(fingerprint && header->fingerprint != *fingerprint) ||
+		!topology_section_ok(size, header->boards_offset, header->board_count, sizeof(EEPROMTopologyBoard)) ||
+		!topology_section_ok(size, header->names_offset, header->name_count, sizeof(EEPROMTopologyName)))
+	{
+		return -1;
+	}
+
+	const EEPROMTopologyName *names = (const EEPROMTopologyName*)(base + header->names_offset);
+	for (uint64_t i = 0; i < header->name_count; i++)
+	{
+		if (names[i].board >= header->board_count)
+		{
+			return -1;
+		}
+	}
+
+	topology->base = base;
+	topology->size = size;
+	topology->header = header;
+	topology->boards = (const EEPROMTopologyBoard*)(base + header->boards_offset);
+	topology->names = names;
+	return 0;
+}
+
+static int topology_map(EEPROMTopology *topology, const char *path, const uint64_t *fingerprint)
+{
+	int fd = open(path, O_RDONLY);
+	if (fd < 0)
+	{
+		return -1;
+	}
+
+	struct stat st;
+	void *map = MAP_FAILED;
+	if (fstat(fd, &st) == 0)
+	{
+		if ((uint64_t)st.st_size >= sizeof(EEPROMTopologyHeader))
+		{
+			map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		}
+		else
+		{
+			errno = EINVAL;
+		}
+	}
+	close(fd);
+	if (map == MAP_FAILED)
+	{
+		return -1;
+	}
+
+	if (topology_attach(topology, map, st.st_size, fingerprint) != 0)
+	{
+		munmap(map, st.st_size);
+		errno = EINVAL;
+		return -1;
+	}
+	topology->mapped = 1;
+	return 0;
+}
+
+int eeprom_topology_open(EEPROMTopology *topology, const char *dir, const char *cache_path,
+						 EEPROMDiagHandler diag, void *user)
+{
+	memset(topology, 0, sizeof(*topology));
+
+	// Без каталога - только готовый индекс, ничего не собирается и не пишется
+	if (!dir)
+	{
+		if (!cache_path)
+		{
+			errno = ENOENT;
+			return EEPROM_ERROR_IO;
+		}
+		return topology_map(topology, cache_path, NULL) == 0 ? EEPROM_SUCCESS : EEPROM_ERROR_IO;
+	}
+
+	TopologyConfigs configs;
+	if (configs_scan(&configs, dir) != 0)
+	{
+		return EEPROM_ERROR_IO;
+	}
+
+	if (cache_path && topology_map(topology, cache_path, &configs.fingerprint) == 0)
+	{
+		configs_free(&configs);
+		return EEPROM_SUCCESS;
+	}
+
+	size_t size = 0;
+	uint8_t *image = topology_compile(dir, &configs, &size, diag, user);
+	configs_free(&configs);
+	if (!image)
+	{
+		return EEPROM_ERROR_IO;
+	}
+
+	if (cache_path && eeprom_write_file_atomic(cache_path, image, size) != EEPROM_SUCCESS)
+	{
+		topology_diag(diag, user, EEPROM_DIAG_WARNING, "Cannot write topology cache %s: %s",
+					  cache_path, strerror(errno));
+	}
+
+	// Только что собранный образ используется из памяти, без повторного чтения
+	topology_attach(topology, image, size, NULL);
+	topology->compiled = 1;
+	return EEPROM_SUCCESS;
+}
+
+void eeprom_topology_close(EEPROMTopology *topology)
+{
+	if (topology->base)
+	{
+		if (topology->mapped)
+		{
+			munmap((void*)topology->base, topology->size);
+		}
+		else
+		{
+			free((void*)topology->base);
+		}
+	}
+	memset(topology, 0, sizeof(*topology));
+}
+
+const EEPROMTopologyBoard *eeprom_topology_find(const EEPROMTopology *topology, const char *board_name)
+{
+	if (!topology->header)
+	{
+		return NULL;
+	}
+
+	char key[EEPROM_TOPOLOGY_NAME] = { 0 };
+	size_t length = strlen(board_name);
+	while (length > 0 && (board_name[length - 1] == ' ' || board_name[length - 1] == '\0'))
+	{
+		length--;
+	}
+	if (length == 0 || length >= sizeof(key))
+	{
+		return NULL;
+	}
+	memcpy(key, board_name, length);
+
+	size_t low = 0;
+	size_t high = topology->header->name_count;
+	while (low < high)
+	{
+		size_t middle = low + (high - low) / 2;
+		int cmp = strncmp(topology->names[middle].name, key, EEPROM_TOPOLOGY_NAME);
+		if (cmp == 0)
+		{
+			return &topology->boards[topology->names[middle].board];
+		}
+		if (cmp < 0)
+		{
+			low = middle + 1;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+	return NULL;
+}
@@ -0,0 +1,184 @@
+#ifndef EEPROM_TOPOLOGY_H
+#define EEPROM_TOPOLOGY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "eeprom_ops.h"
+
+// ═══════════════════════════════════════════════════════════════
+// Hashboard topology configs (topol_*.conf) and their compiled index (*.eet)
+// ═══════════════════════════════════════════════════════════════
+//
+// A config describes one board model, or several in a "config": [...]
+// array: ASIC type, chain geometry, ASIC order on the board, sensors and
+// strategy values. The configs of a directory are parsed once into fixed
+// size records and written to a cache file that later runs map read-only:
+//
+//   EEPROMTopologyHeader
+//   boards [board_count] EEPROMTopologyBoard
+//   names  [name_count]  EEPROMTopologyName    sorted, binary search
+//
+// Names are the "machine" of every record plus its "mix_boardnames". A
+// machine defined twice keeps the first definition in file name order;
+// an alias never hides a machine. Host byte order: the cache is a local
+// file. The header carries a fingerprint of the config file names, sizes
+// and modification times, so any change to the directory recompiles it.
+
+#define EEPROM_TOPOLOGY_MAGIC      "EEPRTOP1"
+#define EEPROM_TOPOLOGY_EXTENSION  ".eet"
+
+#define EEPROM_TOPOLOGY_NAME       16   // machine, chip and part names, NUL-padded
+#define EEPROM_TOPOLOGY_SOURCE     48   // config file name
+#define EEPROM_TOPOLOGY_ALIASES    4    // mix_boardnames other than machine
+#define EEPROM_TOPOLOGY_SENSORS    24
+#define EEPROM_TOPOLOGY_PARAMS     32
+#define EEPROM_TOPOLOGY_PARAM_KEY  56
+#define EEPROM_TOPOLOGY_CELLS      256  // grid_rows * grid_columns
+
+// Where a temperature sensor sits
+typedef enum
+{
+	EEPROM_TOPOLOGY_SENSOR_CHAIN,      // chain.sensor
+	EEPROM_TOPOLOGY_SENSOR_PIC,        // chain.pic.sensor
+	EEPROM_TOPOLOGY_SENSOR_CTRLBOARD,  // chain.ctrlboardsensor, chain.ctrlboard_sensor
+	EEPROM_TOPOLOGY_SENSOR_SWITCH,     // chain.switchsensor
+	EEPROM_TOPOLOGY_SENSOR_ASIC        // chain.asic_sensor
+} EEPROMTopologySensorGroup;
+
+typedef struct
+{
+	uint8_t group;                     // EEPROMTopologySensorGroup
+	uint8_t index;
+	uint8_t i2c_addr;                  // "iic", 0 if none
+	uint8_t reserved;
+	int16_t asic;                      // "bind_asic" / "asic", -1 if none
+	char type[24];
+	char x[12];
+	char y[12];
+} EEPROMTopologySensor;
+
+// Numeric strategy value, "strategy.inc_freq_step" or "adjust_strategy.vol_adjust_max"
+typedef struct
+{
+	char key[EEPROM_TOPOLOGY_PARAM_KEY];
+	int32_t value;                     // true/false as 1/0
+} EEPROMTopologyParam;
+
+typedef struct
+{
+	char machine[EEPROM_TOPOLOGY_NAME];
+	char hw_version[8];
+	char sw_version[8];
+	char processor[EEPROM_TOPOLOGY_NAME];
+	char power[EEPROM_TOPOLOGY_NAME];
+	char asic_id[EEPROM_TOPOLOGY_NAME];
+	char pic[EEPROM_TOPOLOGY_NAME];
+	char eeprom[EEPROM_TOPOLOGY_NAME];
+	char source[EEPROM_TOPOLOGY_SOURCE];
+	uint16_t source_entry;             // element of "config", 0 for single configs
+
+	uint16_t asic_addr;                // chip type, "0x1368"
+	uint16_t asic_addr_interval;
+	uint16_t asic_domain_num;
+	uint32_t asic_core_num;            // asic_core_num / asic_big_core_num
+	uint32_t asic_small_core_num;      // asic_small_core_num / asic_little_core_num
+
+	uint16_t chain_num;
+	uint16_t chain_row;
+	uint16_t chain_column;
+	uint16_t chain_domain_num;
+	uint16_t chain_asic_num;
+	uint16_t domain_asic_num;
+
+	uint8_t power_i2c_addr;
+	uint8_t pic_i2c_addr;
+	uint8_t eeprom_i2c_addr;
+	uint8_t fan_count;
+	uint8_t sensor_count;
+	uint8_t param_count;
+	uint8_t alias_count;
+
+	char aliases[EEPROM_TOPOLOGY_ALIASES][EEPROM_TOPOLOGY_NAME];
+	EEPROMTopologySensor sensors[EEPROM_TOPOLOGY_SENSORS];
+	EEPROMTopologyParam params[EEPROM_TOPOLOGY_PARAMS];
+
+	// ASIC number along the chain from 1, 0 where there is none, row-major
+	// grid_rows x grid_columns. From "tpl", or from the domain coordinates
+	// of configs that have none; 0 x 0 if neither. Usually chain_row x
+	// chain_column, but some configs give the layout transposed.
+	uint8_t grid_rows;
+	uint8_t grid_columns;
+	uint8_t grid[EEPROM_TOPOLOGY_CELLS];
+} EEPROMTopologyBoard;
+
+typedef struct
+{
+	char name[EEPROM_TOPOLOGY_NAME];
+	uint32_t board;
+	uint32_t alias;                    // 1 if from mix_boardnames
+} EEPROMTopologyName;
+
+typedef struct
+{
+	char magic[8];                     // EEPROM_TOPOLOGY_MAGIC
+	uint32_t format_version;           // 1
+	uint32_t board_size;               // sizeof(EEPROMTopologyBoard)
+	uint64_t fingerprint;              // config file names, sizes, mtimes
+	uint64_t board_count;
+	uint64_t name_count;
+	uint64_t boards_offset;
+	uint64_t names_offset;
+	uint64_t config_count;             // topol_*.conf files compiled
+	uint64_t skipped_count;            // of those, rejected as invalid
+} EEPROMTopologyHeader;
+
+typedef struct
+{
+	const uint8_t *base;
+	size_t size;
+	int mapped;                        // base is a mapping of the cache file, else malloc'd
+	int compiled;                      // configs were parsed by this open
+	const EEPROMTopologyHeader *header;
+	const EEPROMTopologyBoard *boards;
+	const EEPROMTopologyName *names;
+} EEPROMTopology;
+
+/**
+ * Maps the compiled index of the topol_*.conf files in dir
+ * Compiles it if cache_path is missing, damaged or was compiled from other
+ * config files; a config that cannot be parsed is reported through diag
+ * and left out. Without cache_path, or if the cache cannot be written
+ * (warning), the index is only kept in memory.
+ * With dir NULL, only maps an existing index at cache_path, whatever
+ * configs it was compiled from; nothing is compiled or written.
+ * @param diag - may be NULL
+ * @return EEPROM_SUCCESS or EEPROM_ERROR_IO (errno is set: ENOENT no
+ *         index, EINVAL damaged index)
+ */
+int eeprom_topology_open(EEPROMTopology *topology, const char *dir, const char *cache_path,
+						 EEPROMDiagHandler diag, void *user);
+void eeprom_topology_close(EEPROMTopology *topology);
+
+// Board record by EEPROM board_name; trailing spaces are ignored. NULL if unknown.
+const EEPROMTopologyBoard *eeprom_topology_find(const EEPROMTopology *topology, const char *board_name);
+
+static inline size_t eeprom_topology_count(const EEPROMTopology *topology)
+{
+	return topology->header->board_count;
+}
+
+/**
+ * Parses one config into boards
+ * @param source - file name stored in the records
+ * @param count - records written
+ * @return EEPROM_SUCCESS, EEPROM_ERROR_SIZE (more than capacity boards) or
+ *         EEPROM_ERROR_UNKNOWN; message describes the error
+ */
+int eeprom_topology_parse(const char *text, size_t size, const char *source,
+						  EEPROMTopologyBoard *boards, size_t capacity, size_t *count,
+						  char *message, size_t message_size);
+
+// Name of sensor groups: "chain", "pic", "ctrlboard", "switch", "asic"
+const char *eeprom_topology_sensor_group(uint8_t group);
+
+#endif // EEPROM_TOPOLOGY_H
@@ -0,0 +1,868 @@
+#include "export.h"
+#include "stats.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+
+// ═══════════════════════════════════════════════════════════════
+// Buffer
+// ═══════════════════════════════════════════════════════════════
+
+void export_buffer_init(ExportBuffer *buffer, size_t capacity)
+{
+	buffer->data = malloc(capacity);
+	buffer->length = 0;
+	buffer->capacity = buffer->data ? capacity : 0;
+	buffer->failed = buffer->data == NULL;
+}
+
+void export_buffer_free(ExportBuffer *buffer)
+{
+	free(buffer->data);
+	buffer->data = NULL;
+	buffer->length = 0;
+	buffer->capacity = 0;
+}
+
+static int export_reserve(ExportBuffer *buffer, size_t extra)
+{
+	if (buffer->length + extra <= buffer->capacity)
+	{
+		return 0;
+	}
+	if (buffer->failed)
+	{
+		return -1;
+	}
+
+	size_t capacity = buffer->capacity ? buffer->capacity : 4096;
+	while (capacity < buffer->length + extra)
+	{
+		capacity *= 2;
+	}
+
+	char *data = realloc(buffer->data, capacity);
+	if (!data)
+	{
+		buffer->failed = 1;
+		return -1;
+	}
+
+	buffer->data = data;
+	buffer->capacity = capacity;
+	return 0;
+}
+
+static void put(ExportBuffer *buffer, const char *text, size_t length)
+{
+	if (export_reserve(buffer, length) == 0)
+	{
+		memcpy(buffer->data + buffer->length, text, length);
+		buffer->length += length;
+	}
+}
+
+static void put_str(ExportBuffer *buffer, const char *text)
+{
+	put(buffer, text, strlen(text));
+}
+
+static void put_char(ExportBuffer *buffer, char c)
+{
+	if (export_reserve(buffer, 1) == 0)
+	{
+		buffer->data[buffer->length++] = c;
+	}
+}
+
+static void put_uint(ExportBuffer *buffer, uint32_t value)
+{
+	char digits[10];
+	size_t n = 0;
+
+	do
+	{
+		digits[n++] = '0' + value % 10;
+		value /= 10;
+	} while (value);
+
+	if (export_reserve(buffer, n) == 0)
+	{
+		while (n)
+		{
+			buffer->data[buffer->length++] = digits[--n];
+		}
+	}
+}
+
+static void put_int(ExportBuffer *buffer, int32_t value)
+{
+	if (value < 0)
+	{
+		put_char(buffer, '-');
+		put_uint(buffer, 0u - (uint32_t)value);
+	}
+	else
+	{
+		put_uint(buffer, (uint32_t)value);
+	}
+}
+
+// value / 100 с двумя знаками (напряжение, хешрейт)
+static void put_fixed2(ExportBuffer *buffer, uint32_t value)
+{
+	put_uint(buffer, value / 100);
+	put_char(buffer, '.');
+	put_char(buffer, '0' + (value / 10) % 10);
+	put_char(buffer, '0' + value % 10);
+}
+
+static void put_hex(ExportBuffer *buffer, uint32_t value, int digits)
+{
+	static const char hex[] = "0123456789ABCDEF";
+
+	if (export_reserve(buffer, 2 + digits) == 0)
+	{
+		buffer->data[buffer->length++] = '0';
+		buffer->data[buffer->length++] = 'x';
+		for (int i = digits - 1; i >= 0; i--)
+		{
+			buffer->data[buffer->length++] = hex[(value >> (i * 4)) & 0xF];
+		}
+	}
+}
+
+static void put_json_string(ExportBuffer *buffer, const char *text, size_t length)
+{
+	static const char hex[] = "0123456789abcdef";
+
+	// Худший случай: каждый байт как \u00XX
+	if (export_reserve(buffer, length * 6 + 2) != 0)
+	{
+		return;
+	}
+
+	char *out = buffer->data + buffer->length;
+	*out++ = '"';
+	for (size_t i = 0; i < length; i++)
+	{
+		uint8_t c = (uint8_t)text[i];
+		if (c == '"' || c == '\\')
+		{
+			*out++ = '\\';
+			*out++ = c;
+		}
+		else if (c >= 0x20 && c < 0x7F)
+		{
+			*out++ = c;
+		}
+		else
+		{
+			// Управляющие и не-ASCII байты полей EEPROM: как Latin-1
+			*out++ = '\\';
+			*out++ = 'u';
+			*out++ = '0';
+			*out++ = '0';
+			*out++ = hex[c >> 4];
+			*out++ = hex[c & 0xF];
+		}
+	}
+	*out++ = '"';
+	buffer->length = out - buffer->data;
+}
+
+static void put_csv_string(ExportBuffer *buffer, const char *text, size_t length)
+{
+	if (!memchr(text, ',', length) && !memchr(text, '"', length) &&
+		!memchr(text, '\n', length) && !memchr(text, '\r', length))
+	{
+		put(buffer, text, length);
+		return;
+	}
+
+	put_char(buffer, '"');
+	for (size_t i = 0; i < length; i++)
+	{
+		if (text[i] == '"')
+		{
+			put_char(buffer, '"');
+		}
+		put_char(buffer, text[i]);
+	}
+	put_char(buffer, '"');
+}
+
+int export_flush(ExportBuffer *buffer, int fd)
+{
+	size_t done = 0;
+
+	while (done < buffer->length)
+	{
+		ssize_t n = write(fd, buffer->data + done, buffer->length - done);
+		if (n < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			return -1;
+		}
+		done += n;
+	}
+
+	buffer->length = 0;
+	return 0;
+}
+
+int export_parse_format(const char *name, ExportFormat *format)
+{
+	if (strcmp(name, "text") == 0)
+	{
+		*format = EXPORT_FORMAT_TEXT;
+	}
+	else if (strcmp(name, "ndjson") == 0 || strcmp(name, "json") == 0)
+	{
+		*format = EXPORT_FORMAT_NDJSON;
+	}
+	else if (strcmp(name, "csv") == 0)
+	{
+		*format = EXPORT_FORMAT_CSV;
+	}
+	else
+	{
+		return -1;
+	}
+	return 0;
+}
+
+// ═══════════════════════════════════════════════════════════════
+// Columns: union of the field tables of all versions
+// ═══════════════════════════════════════════════════════════════
+
+#define EXPORT_VERSION_SLOTS 5
+#define EXPORT_MAX_COLUMNS   128
+#define EXPORT_MAX_FIELDS    64
+
+static const EEPROMVersion export_versions[EXPORT_VERSION_SLOTS] =
+{
+	EEPROM_VERSION_V1, EEPROM_VERSION_V4, EEPROM_VERSION_V5, EEPROM_VERSION_V6, EEPROM_VERSION_V17
+};
+
+typedef struct
+{
+	char key[40];                  // "Board Serial" -> "board_serial"
+	uint8_t is_sweep;              // per-ASIC frequencies, EEPROM_SWEEP_ASICS cells
+	const FieldMetadata *fields[EXPORT_VERSION_SLOTS];
+} ExportColumn;
+
+static ExportColumn export_columns[EXPORT_MAX_COLUMNS];
+static size_t export_column_count;
+
+// Индексы колонок в порядке полей каждой версии (для NDJSON)
+static uint8_t export_field_columns[EXPORT_VERSION_SLOTS][EXPORT_MAX_FIELDS];
+
+static pthread_once_t export_once = PTHREAD_ONCE_INIT;
+
+static int export_version_slot(EEPROMVersion version)
+{
+	for (int slot = 0; slot < EXPORT_VERSION_SLOTS; slot++)
+	{
+		if (export_versions[slot] == version)
+		{
+			return slot;
+		}
+	}
+	return -1;
+}
+
+// Колонка на FieldId, в порядке первого появления поля по версиям
+static void export_build_columns(void)
+{
+	uint8_t column_of_id[FIELD_ID_COUNT] = { 0 };  // номер колонки + 1
+
+	for (int slot = 0; slot < EXPORT_VERSION_SLOTS; slot++)
+	{
+		size_t count;
+		const FieldMetadata *fields = eeprom_get_fields(export_versions[slot], &count);
+
+		for (size_t i = 0; i < count && i < EXPORT_MAX_FIELDS; i++)
+		{
+			FieldId id = fields[i].id;
+			size_t c = column_of_id[id] ? column_of_id[id] - 1u : export_column_count;
+
+			if (c == export_column_count)
+			{
+				if (export_column_count == EXPORT_MAX_COLUMNS)
+				{
+					break;
+				}
+				snprintf(export_columns[c].key, sizeof(export_columns[c].key), "%s", eeprom_field_id_key(id));
+				export_columns[c].is_sweep = id == FIELD_ID_ASIC_FREQUENCIES;
+				column_of_id[id] = (uint8_t)(c + 1);
+				export_column_count++;
+			}
+
+			export_columns[c].fields[slot] = &fields[i];
+			export_field_columns[slot][i] = (uint8_t)c;
+		}
+	}
+}
+
+// ═══════════════════════════════════════════════════════════════
+// Field values
+// ═══════════════════════════════════════════════════════════════
+
+static void put_value(ExportBuffer *buffer, ExportFormat format, const EEPROMRecord *record,
+					  const FieldMetadata *field, int is_sweep)
+{
+	const uint8_t *ptr = (const uint8_t*)&record->v4 + field->offset;
+	int json = format == EXPORT_FORMAT_NDJSON;
+
+	switch (field->type)
+	{
+		case FIELD_TYPE_UINT8:
+			put_uint(buffer, *ptr);
+			break;
+
+		case FIELD_TYPE_UINT16:
+			put_uint(buffer, *(const uint16_t*)ptr);
+			break;
+
+		case FIELD_TYPE_INT8:
+			put_int(buffer, *(const int8_t*)ptr);
+			break;
+
+		case FIELD_TYPE_STRING:
+			if (json)
+			{
+				put_json_string(buffer, (const char*)ptr, strnlen((const char*)ptr, field->size));
+			}
+			else
+			{
+				put_csv_string(buffer, (const char*)ptr, strnlen((const char*)ptr, field->size));
+			}
+			break;
+
+		case FIELD_TYPE_HEX8:
+		case FIELD_TYPE_HEX16:
+		{
+			uint32_t value = field->type == FIELD_TYPE_HEX8 ? *ptr : *(const uint16_t*)ptr;
+			if (json)
+			{
+				put_char(buffer, '"');
+			}
+			put_hex(buffer, value, field->type == FIELD_TYPE_HEX8 ? 2 : 4);
+			if (json)
+			{
+				put_char(buffer, '"');
+			}
+			break;
+		}
+
+		case FIELD_TYPE_VOLTAGE:
+		case FIELD_TYPE_HASHRATE:
+			put_fixed2(buffer, *(const uint16_t*)ptr);
+			break;
+
+		case FIELD_TYPE_ARRAY_UINT8:
+		{
+			uint16_t freqs[EEPROM_SWEEP_ASICS];
+			size_t count = is_sweep ? eeprom_sweep_frequencies(record, freqs) : 0;
+			char sep = json ? ',' : ' ';
+
+			if (json)
+			{
+				put_char(buffer, '[');
+			}
+			if (is_sweep)
+			{
+				for (size_t i = 0; i < count; i++)
+				{
+					if (i)
+					{
+						put_char(buffer, sep);
+					}
+					put_uint(buffer, freqs[i]);
+				}
+			}
+			else
+			{
+				for (size_t i = 0; i < field->size; i++)
+				{
+					if (i)
+					{
+						put_char(buffer, sep);
+					}
+					put_uint(buffer, ptr[i]);
+				}
+			}
+			if (json)
+			{
+				put_char(buffer, ']');
+			}
+			break;
+		}
+
+		default:
+			if (json)
+			{
+				put_str(buffer, "null");
+			}
+			break;
+	}
+}
+
+// ═══════════════════════════════════════════════════════════════
+// Records
+// ═══════════════════════════════════════════════════════════════
+
+static const char *const export_status_columns[] =
+{
+	"source", "version", "error", "crc_ok", "test_ok", "crc_fail_mask", "test_fail_mask"
+};
+#define EXPORT_STATUS_COLUMNS (sizeof(export_status_columns) / sizeof(export_status_columns[0]))
+
+void export_header(ExportBuffer *buffer, ExportFormat format)
+{
+	if (format != EXPORT_FORMAT_CSV)
+	{
+		return;
+	}
+
+	pthread_once(&export_once, export_build_columns);
+
+	for (size_t i = 0; i < EXPORT_STATUS_COLUMNS; i++)
+	{
+		if (i)
+		{
+			put_char(buffer, ',');
+		}
+		put_str(buffer, export_status_columns[i]);
+	}
+
+	for (size_t c = 0; c < export_column_count; c++)
+	{
+		const ExportColumn *column = &export_columns[c];
+
+		if (column->is_sweep)
+		{
+			for (uint32_t i = 0; i < EEPROM_SWEEP_ASICS; i++)
+			{
+				put_char(buffer, ',');
+				put_str(buffer, column->key);
+				put_char(buffer, '_');
+				put_uint(buffer, i);
+			}
+		}
+		else
+		{
+			put_char(buffer, ',');
+			put_str(buffer, column->key);
+		}
+	}
+
+	put_char(buffer, '\n');
+}
+
+// Имена регионов из маски через запятую
+static void put_regions(ExportBuffer *buffer, EEPROMVersion version, uint32_t mask)
+{
+	const EEPROMLayout *layout = eeprom_get_layout(version);
+	int first = 1;
+
+	for (size_t i = 0; layout && i < layout->region_count; i++)
+	{
+		if (mask & (1u << i))
+		{
+			if (!first)
+			{
+				put_char(buffer, ',');
+			}
+			put_str(buffer, layout->regions[i].name);
+			first = 0;
+		}
+	}
+}
+
+static void export_text(ExportBuffer *buffer, const char *source,
+						const EEPROMDecodeResult *result, const EEPROMRecord *record)
+{
+	char serial[32];
+	eeprom_record_serial(record, serial, sizeof(serial));
+
+	put_str(buffer, source);
+	put_str(buffer, "\tv");
+	put_uint(buffer, result->version);
+	put_char(buffer, '\t');
+	put_str(buffer, serial);
+
+	put_str(buffer, "\tcrc=");
+	if (result->crc_fail_mask)
+	{
+		put_str(buffer, "fail:");
+		put_regions(buffer, result->version, result->crc_fail_mask);
+	}
+	else
+	{
+		put_str(buffer, "ok");
+	}
+
+	put_str(buffer, "\ttest=");
+	if (result->test_fail_mask)
+	{
+		put_str(buffer, "fail:");
+		put_regions(buffer, result->version, result->test_fail_mask);
+	}
+	else
+	{
+		put_str(buffer, "ok");
+	}
+
+	put_char(buffer, '\n');
+}
+
+static void export_ndjson(ExportBuffer *buffer, const char *source,
+						  const EEPROMDecodeResult *result, const EEPROMRecord *record)
+{
+	int slot = export_version_slot(record->version);
+
+	put_str(buffer, "{\"source\":");
+	put_json_string(buffer, source, strlen(source));
+	put_str(buffer, ",\"version\":");
+	put_uint(buffer, result->version);
+	put_str(buffer, result->crc_fail_mask ? ",\"crc_ok\":false" : ",\"crc_ok\":true");
+	put_str(buffer, result->test_fail_mask ? ",\"test_ok\":false" : ",\"test_ok\":true");
+	put_str(buffer, ",\"crc_fail_mask\":");
+	put_uint(buffer, result->crc_fail_mask);
+	put_str(buffer, ",\"test_fail_mask\":");
+	put_uint(buffer, result->test_fail_mask);
+
+	size_t count = 0;
+	const FieldMetadata *fields = eeprom_get_fields(record->version, &count);
+
+	for (size_t i = 0; slot >= 0 && i < count && i < EXPORT_MAX_FIELDS; i++)
+	{
+		const ExportColumn *column = &export_columns[export_field_columns[slot][i]];
+
+		put_str(buffer, ",\"");
+		put_str(buffer, column->key);
+		put_str(buffer, "\":");
+		put_value(buffer, EXPORT_FORMAT_NDJSON, record, &fields[i], column->is_sweep);
+	}
+
+	put_str(buffer, "}\n");
+}
+
+static void export_csv(ExportBuffer *buffer, const char *source,
+					   const EEPROMDecodeResult *result, const EEPROMRecord *record)
+{
+	int slot = export_version_slot(record->version);
+
+	put_csv_string(buffer, source, strlen(source));
+	put_char(buffer, ',');
+	put_uint(buffer, result->version);
+	put_str(buffer, ",,");
+	put_uint(buffer, result->crc_fail_mask == 0);
+	put_char(buffer, ',');
+	put_uint(buffer, result->test_fail_mask == 0);
+	put_char(buffer, ',');
+	put_uint(buffer, result->crc_fail_mask);
+	put_char(buffer, ',');
+	put_uint(buffer, result->test_fail_mask);
+
+	for (size_t c = 0; c < export_column_count; c++)
+	{
+		const ExportColumn *column = &export_columns[c];
+		const FieldMetadata *field = slot >= 0 ? column->fields[slot] : NULL;
+
+		if (column->is_sweep)
+		{
+			uint16_t freqs[EEPROM_SWEEP_ASICS];
+			size_t count = field ? eeprom_sweep_frequencies(record, freqs) : 0;
+
+			for (size_t i = 0; i < EEPROM_SWEEP_ASICS; i++)
+			{
+				put_char(buffer, ',');
+				if (i < count)
+				{
+					put_uint(buffer, freqs[i]);
+				}
+			}
+		}
+		else
+		{
+			put_char(buffer, ',');
+			if (field)
+			{
+				put_value(buffer, EXPORT_FORMAT_CSV, record, field, 0);
+			}
+		}
+	}
+
+	put_char(buffer, '\n');
+}
+
+void export_record(ExportBuffer *buffer, ExportFormat format, const char *source,
+				   const EEPROMDecodeResult *result, const EEPROMRecord *record)
+{
+	STATS_BEGIN(start);
+	pthread_once(&export_once, export_build_columns);
+
+	switch (format)
+	{
+		case EXPORT_FORMAT_NDJSON:
+			export_ndjson(buffer, source, result, record);
+			break;
+		case EXPORT_FORMAT_CSV:
+			export_csv(buffer, source, result, record);
+			break;
+		default:
+			export_text(buffer, source, result, record);
+			break;
+	}
+
+	STATS_END(STATS_EXPORT, start);
+}
+
+void export_error(ExportBuffer *buffer, ExportFormat format, const char *source,
+				  const char *message)
+{
+	STATS_BEGIN(start);
+	pthread_once(&export_once, export_build_columns);
+
+	switch (format)
+	{
+		case EXPORT_FORMAT_NDJSON:
+			put_str(buffer, "{\"source\":");
+			put_json_string(buffer, source, strlen(source));
+			put_str(buffer, ",\"error\":");
+			put_json_string(buffer, message, strlen(message));
+			put_str(buffer, "}\n");
+			break;
+
+		case EXPORT_FORMAT_CSV:
+		{
+			put_csv_string(buffer, source, strlen(source));
+			put_char(buffer, ',');
+			put_char(buffer, ',');
+			put_csv_string(buffer, message, strlen(message));
+
+			// Пустые ячейки до полной ширины строки
+			size_t cells = EXPORT_STATUS_COLUMNS - 3;
+			for (size_t c = 0; c < export_column_count; c++)
+			{
+				cells += export_columns[c].is_sweep ? EEPROM_SWEEP_ASICS : 1;
+			}
+			if (export_reserve(buffer, cells) == 0)
+			{
+				memset(buffer->data + buffer->length, ',', cells);
+				buffer->length += cells;
+			}
+			put_char(buffer, '\n');
+			break;
+		}
+
+		default:
+			put_str(buffer, source);
+			put_str(buffer, "\terror\t");
+			put_str(buffer, message);
+			put_char(buffer, '\n');
+			break;
+	}
+
+	STATS_END(STATS_EXPORT, start);
+}
+
+// ═══════════════════════════════════════════════════════════════
+// Differences
+// ═══════════════════════════════════════════════════════════════
+
+// Начало JSON-записи платы перед первым отличием
+static void diff_begin(ExportBuffer *buffer, ExportFormat format, const char *serial,
+					   const ExportDiffSide *old_side, const ExportDiffSide *new_side, size_t changes)
+{
+	if (format != EXPORT_FORMAT_NDJSON || changes)
+	{
+		return;
+	}
+	put_str(buffer, "{\"serial\":");
+	put_json_string(buffer, serial, strlen(serial));
+	put_str(buffer, ",\"status\":\"changed\",\"old\":");
+	put_json_string(buffer, old_side->source, strlen(old_side->source));
+	put_str(buffer, ",\"new\":");
+	put_json_string(buffer, new_side->source, strlen(new_side->source));
+	put_str(buffer, ",\"fields\":{");
+}
+
+// Одна строка текста или пара [old,new] в "fields"
+static void diff_value(ExportBuffer *buffer, ExportFormat format, const char *serial,
+					   const char *key, const char *old_value, size_t old_length,
+					   const char *new_value, size_t new_length, size_t fields)
+{
+	if (format == EXPORT_FORMAT_NDJSON)
+	{
+		if (fields)
+		{
+			put_char(buffer, ',');
+		}
+		put_char(buffer, '"');
+		put_str(buffer, key);
+		put_str(buffer, "\":[");
+		put(buffer, old_value, old_length);
+		put_char(buffer, ',');
+		put(buffer, new_value, new_length);
+		put_char(buffer, ']');
+	}
+	else
+	{
+		put_str(buffer, serial);
+		put_char(buffer, '\t');
+		put_str(buffer, key);
+		put_char(buffer, '\t');
+		put(buffer, old_value, old_length);
+		put_char(buffer, '\t');
+		put(buffer, new_value, new_length);
+		put_char(buffer, '\n');
+	}
+}
+
+// Значение колонки в scratch; пусто (null в JSON), если у версии нет поля
+static void diff_format(ExportBuffer *scratch, ExportFormat format, const ExportDiffSide *side,
+						const ExportColumn *column, uint32_t status, int is_status)
+{
+	if (is_status)
+	{
+		put_uint(scratch, status);
+		return;
+	}
+
+	int slot = export_version_slot(side->record->version);
+	const FieldMetadata *field = slot >= 0 ? column->fields[slot] : NULL;
+	if (field)
+	{
+		put_value(scratch, format, side->record, field, 0);
+	}
+	else if (format == EXPORT_FORMAT_NDJSON)
+	{
+		put_str(scratch, "null");
+	}
+}
+
+size_t export_diff(ExportBuffer *buffer, ExportFormat format, const char *serial,
+				   const ExportDiffSide *old_side, const ExportDiffSide *new_side)
+{
+	pthread_once(&export_once, export_build_columns);
+
+	size_t changes = 0;
+	size_t fields = 0;
+	ExportBuffer old_value, new_value;
+	export_buffer_init(&old_value, 256);
+	export_buffer_init(&new_value, 256);
+
+	// Сначала маски CRC/тестов, затем колонки; sweep - отдельным списком по ASIC
+	static const char *const status_keys[] = { "crc_fail_mask", "test_fail_mask" };
+	uint32_t old_status[] = { old_side->result->crc_fail_mask, old_side->result->test_fail_mask };
+	uint32_t new_status[] = { new_side->result->crc_fail_mask, new_side->result->test_fail_mask };
+
+	for (size_t c = 0; c < 2 + export_column_count; c++)
+	{
+		int is_status = c < 2;
+		const ExportColumn *column = is_status ? NULL : &export_columns[c - 2];
+		if (column && column->is_sweep)
+		{
+			continue;
+		}
+
+		export_buffer_reset(&old_value);
+		export_buffer_reset(&new_value);
+		diff_format(&old_value, format, old_side, column, is_status ? old_status[c] : 0, is_status);
+		diff_format(&new_value, format, new_side, column, is_status ? new_status[c] : 0, is_status);
+
+		if (old_value.length == new_value.length &&
+			memcmp(old_value.data, new_value.data, old_value.length) == 0)
+		{
+			continue;
+		}
+
+		diff_begin(buffer, format, serial, old_side, new_side, changes++);
+		diff_value(buffer, format, serial, is_status ? status_keys[c] : column->key,
+				   old_value.data, old_value.length, new_value.data, new_value.length, fields++);
+	}
+
+	export_buffer_free(&old_value);
+	export_buffer_free(&new_value);
+
+	uint16_t old_freqs[EEPROM_SWEEP_ASICS];
+	uint16_t new_freqs[EEPROM_SWEEP_ASICS];
+	size_t old_count = eeprom_sweep_frequencies(old_side->record, old_freqs);
+	size_t new_count = eeprom_sweep_frequencies(new_side->record, new_freqs);
+	size_t sweeps = 0;
+
+	// Плата без sweep с одной стороны: сравнивать по ASIC нечего
+	for (size_t i = 0; i < old_count && i < new_count; i++)
+	{
+		if (old_freqs[i] == new_freqs[i])
+		{
+			continue;
+		}
+
+		int delta = (int)new_freqs[i] - (int)old_freqs[i];
+		diff_begin(buffer, format, serial, old_side, new_side, changes++);
+
+		if (format == EXPORT_FORMAT_NDJSON)
+		{
+			put_str(buffer, sweeps++ ? ",[" : "},\"asic_frequencies\":[[");
+			put_uint(buffer, (uint32_t)i);
+			put_char(buffer, ',');
+			put_uint(buffer, old_freqs[i]);
+			put_char(buffer, ',');
+			put_uint(buffer, new_freqs[i]);
+			put_char(buffer, ',');
+			put_int(buffer, delta);
+			put_char(buffer, ']');
+		}
+		else
+		{
+			put_str(buffer, serial);
+			put_str(buffer, "\tasic_frequencies[");
+			put_uint(buffer, (uint32_t)i);
+			put_str(buffer, "]\t");
+			put_uint(buffer, old_freqs[i]);
+			put_char(buffer, '\t');
+			put_uint(buffer, new_freqs[i]);
+			put_char(buffer, '\t');
+			put_char(buffer, delta > 0 ? '+' : '-');
+			put_uint(buffer, (uint32_t)(delta > 0 ? delta : -delta));
+			put_char(buffer, '\n');
+		}
+	}
+
+	if (format == EXPORT_FORMAT_NDJSON && changes)
+	{
+		put_str(buffer, sweeps ? "]}\n" : "}}\n");
+	}
+
+	return changes;
+}
+
+void export_diff_missing(ExportBuffer *buffer, ExportFormat format, const char *serial,
+						 int added, const char *source)
+{
+	if (format == EXPORT_FORMAT_NDJSON)
+	{
+		put_str(buffer, "{\"serial\":");
+		put_json_string(buffer, serial, strlen(serial));
+		put_str(buffer, added ? ",\"status\":\"added\",\"new\":" : ",\"status\":\"removed\",\"old\":");
+		put_json_string(buffer, source, strlen(source));
+		put_str(buffer, "}\n");
+	}
+	else
+	{
+		put_str(buffer, serial);
+		put_str(buffer, added ? "\t+\t" : "\t-\t");
+		put_str(buffer, source);
+		put_char(buffer, '\n');
+	}
+}
@@ -0,0 +1,96 @@
+#ifndef EXPORT_H
+#define EXPORT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "eeprom_ops.h"
+
+// ═══════════════════════════════════════════════════════════════
+// Machine-readable output of decoded records
+// ═══════════════════════════════════════════════════════════════
+
+typedef enum
+{
+	EXPORT_FORMAT_TEXT,            // path, version, serial, crc/test status, tab-separated
+	EXPORT_FORMAT_NDJSON,          // one JSON object per line
+	EXPORT_FORMAT_CSV              // header + one row per record; columns shared by all versions
+} ExportFormat;
+
+/*! \brief Growable output buffer
+
+	Records are appended without intermediate printf/stdio; the owner
+	writes the whole buffer out at once (export_flush or its own sink).
+	After an allocation failure appends are dropped and failed is set.
+ */
+typedef struct
+{
+	char *data;
+	size_t length;
+	size_t capacity;
+	int failed;
+} ExportBuffer;
+
+void export_buffer_init(ExportBuffer *buffer, size_t capacity);
+void export_buffer_free(ExportBuffer *buffer);
+
+static inline void export_buffer_reset(ExportBuffer *buffer)
+{
+	buffer->length = 0;
+}
+
+// "text", "ndjson" (or "json"), "csv"; returns 0 or -1 if unknown
+int export_parse_format(const char *name, ExportFormat *format);
+
+/**
+ * CSV header row; nothing for the other formats
+ * Field columns are named after FieldMetadata.name in snake_case and are
+ * the union over all versions; per-ASIC sweep frequencies get one column
+ * each (asic_frequencies_0 ...).
+ */
+void export_header(ExportBuffer *buffer, ExportFormat format);
+
+/**
+ * One decoded record, terminated by a newline
+ * Every field of eeprom_get_fields(record->version) is written once;
+ * sweep levels are expanded to per-ASIC frequencies in MHz.
+ */
+void export_record(ExportBuffer *buffer, ExportFormat format, const char *source,
+				   const EEPROMDecodeResult *result, const EEPROMRecord *record);
+
+// A file that could not be read or decoded
+void export_error(ExportBuffer *buffer, ExportFormat format, const char *source,
+				  const char *message);
+
+// ═══════════════════════════════════════════════════════════════
+// Differences between two records of one board (text and NDJSON)
+// ═══════════════════════════════════════════════════════════════
+
+typedef struct
+{
+	const char *source;
+	const EEPROMDecodeResult *result;
+	const EEPROMRecord *record;
+} ExportDiffSide;
+
+/**
+ * Field-by-field comparison over the export columns, so fields of
+ * different versions with the same name are compared with each other
+ * text:   serial <TAB> column <TAB> old <TAB> new, one line per change;
+ *         sweep: serial <TAB> asic_frequencies[i] <TAB> old <TAB> new <TAB> +delta
+ * ndjson: {"serial","status":"changed","old","new","fields":{column:[old,new]},
+ *          "asic_frequencies":[[asic,old,new,delta],...]}
+ * CRC/test fail masks are compared as the crc_fail_mask and test_fail_mask
+ * columns. Nothing is written if the records are equal.
+ * @return number of differing values
+ */
+size_t export_diff(ExportBuffer *buffer, ExportFormat format, const char *serial,
+				   const ExportDiffSide *old_side, const ExportDiffSide *new_side);
+
+// Board present on one side only: text "serial <TAB> -|+ <TAB> source"
+void export_diff_missing(ExportBuffer *buffer, ExportFormat format, const char *serial,
+						 int added, const char *source);
+
+// write() the buffer to fd and reset it; returns 0 or -1 (errno is set)
+int export_flush(ExportBuffer *buffer, int fd);
+
+#endif // EXPORT_H
@@ -0,0 +1,305 @@
+// ═══════════════════════════════════════════════════════════════
+// gen_field_index: build-time generator of eeprom_field_index.h/.c
+//
+// Perfect hash (hash and displace) over (field table, field key)
+// for every FieldMetadata in eeprom_defs.h, plus the FieldId -> field
+// tables. Not minimal: INDEX_SLOTS is a power of two, about 60% full,
+// so a slot is a mask rather than a modulo. Run by CMake whenever eeprom_defs.h changes:
+//   gen_field_index <eeprom_field_index.h> <eeprom_field_index.c>
+// Fails the build if the tables break the FieldId rules: every field has
+// an ID, one ID per key, no key twice in a table.
+// ═══════════════════════════════════════════════════════════════
+
+#include "eeprom_defs.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define INDEX_BUCKETS 32           // ~2.5 ключа на корзину
+#define INDEX_SLOTS   128          // степень двойки, заполнение ~60%
+#define MAX_KEYS      INDEX_SLOTS
+#define KEY_SIZE      64
+
+static const EEPROMVersion table_versions[EEPROM_FIELD_TABLES] =
+{
+	EEPROM_VERSION_V1, EEPROM_VERSION_V4, EEPROM_VERSION_V17
+};
+
+typedef struct
+{
+	char key[KEY_SIZE];
+	int table;
+	int field;
+	FieldId id;
+	uint32_t bucket;
+} IndexKey;
+
+static IndexKey keys[MAX_KEYS];
+static size_t key_count;
+
+static int slot_of[INDEX_SLOTS];            // индекс ключа в слоте или -1
+static uint16_t displace[INDEX_BUCKETS];
+static const char *id_keys[FIELD_ID_COUNT];
+static int by_id[EEPROM_FIELD_TABLES][FIELD_ID_COUNT];
+
+static int collect_keys(void)
+{
+	for (int t = 0; t < EEPROM_FIELD_TABLES; t++)
+	{
+		size_t count;
+		const FieldMetadata *fields = eeprom_get_fields(table_versions[t], &count);
+
+		for (size_t f = 0; f < count; f++)
+		{
+			if (key_count == MAX_KEYS || f > 127)
+			{
+				fprintf(stderr, "gen_field_index: too many fields\n");
+				return -1;
+			}
+
+			IndexKey *key = &keys[key_count++];
+			eeprom_field_key(fields[f].name, key->key, sizeof(key->key));
+			key->table = t;
+			key->field = (int)f;
+			key->id = fields[f].id;
+
+			if (key->id <= FIELD_ID_NONE || key->id >= FIELD_ID_COUNT)
+			{
+				fprintf(stderr, "gen_field_index: field '%s' has no FieldId\n", fields[f].name);
+				return -1;
+			}
+			if (id_keys[key->id] && strcmp(id_keys[key->id], key->key) != 0)
+			{
+				fprintf(stderr, "gen_field_index: FieldId %d is used for both '%s' and '%s'\n",
+						key->id, id_keys[key->id], key->key);
+				return -1;
+			}
+			if (by_id[t][key->id] >= 0)
+			{
+				fprintf(stderr, "gen_field_index: '%s' appears twice in one field table\n", key->key);
+				return -1;
+			}
+			if (!id_keys[key->id])
+			{
+				id_keys[key->id] = key->key;
+			}
+			by_id[t][key->id] = (int)f;
+		}
+	}
+
+	// Один ключ - один ID: ключ с двумя разными ID ломает поиск по имени
+	for (size_t i = 0; i < key_count; i++)
+	{
+		for (size_t j = i + 1; j < key_count; j++)
+		{
+			if (strcmp(keys[i].key, keys[j].key) == 0 && keys[i].id != keys[j].id)
+			{
+				fprintf(stderr, "gen_field_index: key '%s' has two FieldIds\n", keys[i].key);
+				return -1;
+			}
+		}
+	}
+
+	for (int id = FIELD_ID_NONE + 1; id < FIELD_ID_COUNT; id++)
+	{
+		if (!id_keys[id])
+		{
+			fprintf(stderr, "gen_field_index: FieldId %d is not used by any field\n", id);
+			return -1;
+		}
+	}
+	return 0;
+}
+
+// Корзины по убыванию размера; для каждой подбирается смещение, при
+// котором все ее ключи попадают в свободные и разные слоты
+static int build_index(void)
+{
+	size_t bucket_size[INDEX_BUCKETS] = { 0 };
+	int order[INDEX_BUCKETS];
+
+	for (size_t i = 0; i < key_count; i++)
+	{
+		keys[i].bucket = eeprom_field_hash(0, keys[i].table, keys[i].key) & (INDEX_BUCKETS - 1);
+		bucket_size[keys[i].bucket]++;
+	}
+	for (int b = 0; b < INDEX_BUCKETS; b++)
+	{
+		order[b] = b;
+	}
+	for (int i = 1; i < INDEX_BUCKETS; i++)
+	{
+		for (int j = i; j > 0 && bucket_size[order[j]] > bucket_size[order[j - 1]]; j--)
+		{
+			int swap = order[j];
+			order[j] = order[j - 1];
+			order[j - 1] = swap;
+		}
+	}
+
+	memset(slot_of, -1, sizeof(slot_of));
+
+	for (int o = 0; o < INDEX_BUCKETS && bucket_size[order[o]]; o++)
+	{
+		int b = order[o];
+		uint32_t d;
+
+		for (d = 1; d <= UINT16_MAX; d++)
+		{
+			uint32_t taken[MAX_KEYS];
+			size_t n = 0;
+			int ok = 1;
+
+			for (size_t i = 0; i < key_count && ok; i++)
+			{
+				if (keys[i].bucket != (uint32_t)b)
+				{
+					continue;
+				}
+				uint32_t slot = eeprom_field_hash(d, keys[i].table, keys[i].key) & (INDEX_SLOTS - 1);
+				ok = slot_of[slot] < 0;
+				for (size_t k = 0; k < n && ok; k++)
+				{
+					ok = taken[k] != slot;
+				}
+				taken[n++] = slot;
+			}
+
+			if (ok)
+			{
+				n = 0;
+				for (size_t i = 0; i < key_count; i++)
+				{
+					if (keys[i].bucket == (uint32_t)b)
+					{
+						slot_of[taken[n++]] = (int)i;
+					}
+				}
+				displace[b] = (uint16_t)d;
+				break;
+			}
+		}
+
+		if (d > UINT16_MAX)
+		{
+			fprintf(stderr, "gen_field_index: no displacement for bucket %d\n", b);
+			return -1;
+		}
+	}
+	return 0;
+}
+
+static int write_header(const char *path)
+{
+	FILE *out = fopen(path, "w");
+	if (!out)
+	{
+		perror(path);
+		return -1;
+	}
+
+	fprintf(out,
+			"// Generated by gen_field_index from eeprom_defs.h - do not edit\n"
+			"#ifndef EEPROM_FIELD_INDEX_H\n"
+			"#define EEPROM_FIELD_INDEX_H\n"
+			"\n"
+			"#include <stdint.h>\n"
+			"#include \"eeprom_defs.h\"\n"
+			"\n"
+			"// bucket = eeprom_field_hash(0, table, key) & (BUCKETS - 1)\n"
+			"// slot = eeprom_field_hash(displace[bucket], table, key) & (SLOTS - 1)\n"
+			"#define EEPROM_FIELD_INDEX_BUCKETS %d\n"
+			"#define EEPROM_FIELD_INDEX_SLOTS   %d\n"
+			"\n"
+			"typedef struct\n"
+			"{\n"
+			"\tconst char *key;               // field key, NULL in empty slots\n"
+			"\tint8_t table;                  // eeprom_field_table()\n"
+			"\tuint8_t field;                 // index in eeprom_get_fields()\n"
+			"} EEPROMFieldSlot;\n"
+			"\n"
+			"extern const uint16_t eeprom_field_index_displace[EEPROM_FIELD_INDEX_BUCKETS];\n"
+			"extern const EEPROMFieldSlot eeprom_field_index_slots[EEPROM_FIELD_INDEX_SLOTS];\n"
+			"// Index in eeprom_get_fields() of each FieldId, -1 if the table has none\n"
+			"extern const int8_t eeprom_field_index_by_id[EEPROM_FIELD_TABLES][FIELD_ID_COUNT];\n"
+			"extern const char *const eeprom_field_index_keys[FIELD_ID_COUNT];\n"
+			"\n"
+			"#endif // EEPROM_FIELD_INDEX_H\n",
+			INDEX_BUCKETS, INDEX_SLOTS);
+
+	return fclose(out) == 0 ? 0 : -1;
+}
+
+static int write_source(const char *path)
+{
+	FILE *out = fopen(path, "w");
+	if (!out)
+	{
+		perror(path);
+		return -1;
+	}
+
+	fprintf(out, "// Generated by gen_field_index from eeprom_defs.h - do not edit\n");
+	fprintf(out, "#include \"eeprom_field_index.h\"\n\n");
+
+	fprintf(out, "const uint16_t eeprom_field_index_displace[EEPROM_FIELD_INDEX_BUCKETS] =\n{");
+	for (int b = 0; b < INDEX_BUCKETS; b++)
+	{
+		fprintf(out, "%s%u,", b % 8 ? " " : "\n\t", displace[b]);
+	}
+	fprintf(out, "\n};\n\n");
+
+	fprintf(out, "const EEPROMFieldSlot eeprom_field_index_slots[EEPROM_FIELD_INDEX_SLOTS] =\n{\n");
+	for (int s = 0; s < INDEX_SLOTS; s++)
+	{
+		if (slot_of[s] < 0)
+		{
+			fprintf(out, "\t{ NULL, -1, 0 },\n");
+		}
+		else
+		{
+			const IndexKey *key = &keys[slot_of[s]];
+			fprintf(out, "\t{ \"%s\", %d, %d },\n", key->key, key->table, key->field);
+		}
+	}
+	fprintf(out, "};\n\n");
+
+	fprintf(out, "const int8_t eeprom_field_index_by_id[EEPROM_FIELD_TABLES][FIELD_ID_COUNT] =\n{\n");
+	for (int t = 0; t < EEPROM_FIELD_TABLES; t++)
+	{
+		fprintf(out, "\t{");
+		for (int id = 0; id < FIELD_ID_COUNT; id++)
+		{
+			fprintf(out, "%s%d,", id % 16 ? " " : "\n\t\t", by_id[t][id]);
+		}
+		fprintf(out, "\n\t},\n");
+	}
+	fprintf(out, "};\n\n");
+
+	fprintf(out, "const char *const eeprom_field_index_keys[FIELD_ID_COUNT] =\n{\n\tNULL,\n");
+	for (int id = FIELD_ID_NONE + 1; id < FIELD_ID_COUNT; id++)
+	{
+		fprintf(out, "\t\"%s\",\n", id_keys[id]);
+	}
+	fprintf(out, "};\n");
+
+	return fclose(out) == 0 ? 0 : -1;
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc != 3)
+	{
+		fprintf(stderr, "Usage: %s <eeprom_field_index.h> <eeprom_field_index.c>\n", argv[0]);
+		return 1;
+	}
+
+	memset(by_id, -1, sizeof(by_id));
+
+	if (collect_keys() != 0 || build_index() != 0 ||
+		write_header(argv[1]) != 0 || write_source(argv[2]) != 0)
+	{
+		return 1;
+	}
+	return 0;
+}
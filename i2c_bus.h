@@ -0,0 +1,46 @@
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+#include <stdint.h>
+
+/*! \brief I2C bus backend (Linux i2c-dev semantics)
+
+    Каждая реализация ведет себя как открытый /dev/i2c-N: ioctl понимает
+    I2C_FUNCS, I2C_SLAVE, I2C_RDWR и I2C_SMBUS, read/write - обычные
+    транзакции с адресом из I2C_SLAVE. Ошибки: -1 и errno, как у системных
+    вызовов (ENXIO - NAK на адрес).
+
+    open  -- path без префикса backend'а, settings - строка port_settings из iic_open, может быть NULL
+    load  -- необязательно: образ целиком в обход транзакций (драйвер at24),
+             -1 и errno = ENOENT - нет такого пути, iic_eeprom_load переходит к транзакциям
+    close -- освобождает ctx
+ */
+typedef struct _IIC_Bus IIC_Bus;
+typedef struct _IIC_BusOps IIC_BusOps;
+
+struct _IIC_BusOps {
+    const char *name;
+    const char *prefix;            // "sim:" и т.п., NULL - любой путь
+    int  (*open)(IIC_Bus *bus, const char *path, const char *settings);
+    int  (*ioctl)(IIC_Bus *bus, unsigned long request, void *arg);
+    int  (*read)(IIC_Bus *bus, uint8_t *data, unsigned int len);
+    int  (*write)(IIC_Bus *bus, const uint8_t *data, unsigned int len);
+    int  (*load)(IIC_Bus *bus, uint8_t dev_addr, unsigned int offs, uint8_t *data, unsigned int len);
+    void (*close)(IIC_Bus *bus);
+};
+
+struct _IIC_Bus {
+    const IIC_BusOps *ops;
+    int fd;                        // i2c-dev: дескриптор, -1 - узла нет, только at24
+    int number;                    // i2c-dev: N из /dev/i2c-N, -1 - неизвестен
+    void *ctx;                     // прочие backend'ы: свое состояние
+};
+
+extern const IIC_BusOps IIC_bus_dev;   // i2c_eeprom.c: /dev/i2c-N
+extern const IIC_BusOps IIC_bus_sim;   // i2c_sim.c:    simulated 24C02 chips
+
+// i2c_nvmem.c: at24 driver through sysfs
+int iic_nvmem_load(int bus_number, uint8_t dev_addr, unsigned int offs, uint8_t *data, unsigned int len);
+int iic_nvmem_bus_present(int bus_number);
+
+#endif // I2C_BUS_H
@@ -4,63 +4,432 @@
 
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <fcntl.h>
 #include <sys/ioctl.h>
 #include <linux/i2c-dev.h>
 #include <linux/i2c.h>
 #include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include "i2c_eeprom.h"
+#include "i2c_bus.h"
+#include "stats.h"
 
 #define EEPROM_PAGE_SIZE 8
-static int _write_data(int fd, uint8_t dev_addr, uint8_t reg_addr,  const uint8_t *data, unsigned int len) 
+#define EEPROM_BYTES     256
+#define EEPROM_WRITE_TIMEOUT_MS 25   // tWR по datasheet 24C02: 5 мс, у клонов до 10 мс
+
+#define IIC_MAX_BUSES    64
+
+static int _read_method = IIC_READ_AUTO;
+
+// ═══ backend /dev/i2c-N ═══
+static int _dev_open(IIC_Bus *bus, const char *path, const char *settings)
+{
+    const char *name = strrchr(path, '/');
+    name = name ? name + 1 : path;
+    bus->number = -1;
+    if (strncmp(name, "i2c-", 4) == 0 && name[4] >= '0' && name[4] <= '9')
+        bus->number = (int)strtol(name + 4, NULL, 10);
+
+    bus->fd = open(path, O_RDWR | O_NONBLOCK);
+    // нет модуля i2c-dev, но есть микросхемы под драйвером at24 - читаем только через него
+    if (bus->fd < 0 && errno == ENOENT && bus->number >= 0 && iic_nvmem_bus_present(bus->number))
+        return 0;
+    return bus->fd < 0 ? -1 : 0;
+}
+static int _dev_load(IIC_Bus *bus, uint8_t dev_addr, unsigned int offs, uint8_t *data, unsigned int len)
+{
+    return iic_nvmem_load(bus->number, dev_addr, offs, data, len);
+}
+static int _dev_ioctl(IIC_Bus *bus, unsigned long request, void *arg)
+{
+    return ioctl(bus->fd, request, arg);
+}
+static int _dev_read(IIC_Bus *bus, uint8_t *data, unsigned int len)
+{
+    return read(bus->fd, data, len);
+}
+static int _dev_write(IIC_Bus *bus, const uint8_t *data, unsigned int len)
+{
+    return write(bus->fd, data, len);
+}
+static void _dev_close(IIC_Bus *bus)
+{
+    if (bus->fd >= 0) close(bus->fd);
+}
+const IIC_BusOps IIC_bus_dev = {
+    .name = "i2c-dev", .prefix = NULL,
+    .open = _dev_open, .ioctl = _dev_ioctl, .read = _dev_read, .write = _dev_write,
+    .load = _dev_load, .close = _dev_close,
+};
+
+// ═══ открытые шины: номер шины (handle) - индекс в таблице ═══
+static const IIC_BusOps *const _backends[] = { &IIC_bus_sim, &IIC_bus_dev };
+static IIC_Bus _buses[IIC_MAX_BUSES];
+static int _bus_used[IIC_MAX_BUSES];
+
+static IIC_Bus *_bus_get(int handle)
+{
+    if (handle < 0 || handle >= IIC_MAX_BUSES || !__atomic_load_n(&_bus_used[handle], __ATOMIC_ACQUIRE)) {
+        errno = EBADF;
+        return NULL;
+    }
+    return &_buses[handle];
+}
+static int _ioctl(IIC_Bus *bus, unsigned long request, void *arg)
+{
+    return bus->ops->ioctl(bus, request, arg);
+}
+/*! \brief page write: START, addr+W, reg_addr, len bytes, STOP; len <= EEPROM_PAGE_SIZE, within one page
+ */
+static int _write_data(IIC_Bus *bus, uint8_t dev_addr, uint8_t reg_addr,  const uint8_t *data, unsigned int len) 
 {
-	int res = ioctl(fd, I2C_SLAVE, dev_addr);
-    return write (fd, data, len);
+    uint8_t buf[1 + EEPROM_PAGE_SIZE];
+    if (len > EEPROM_PAGE_SIZE) return -1;
+    if (_ioctl(bus, I2C_SLAVE, (void *)(uintptr_t)dev_addr) < 0) return -1;
+    buf[0] = reg_addr;
+    for (unsigned int i = 0; i < len; i++) buf[1 + i] = data[i];
+    return bus->ops->write(bus, buf, len + 1) == (int)(len + 1) ? (int)len : -1;
 }
-static int _read_data(int fd, uint8_t dev_addr, uint8_t reg_addr,  uint8_t *data, unsigned int len) 
+static int _read_data(IIC_Bus *bus, uint8_t dev_addr, uint8_t reg_addr,  uint8_t *data, unsigned int len) 
 {
-	int res = ioctl(fd, I2C_SLAVE, dev_addr);
+	int res = _ioctl(bus, I2C_SLAVE, (void *)(uintptr_t)dev_addr);
 // такой вариант чтения годится для новых плат и не годится для 1397, возможно стоит читать по одному байту
-    return read (fd, data, len); 
+    return bus->ops->read(bus, data, len); 
 }
-static int _write_byte(int fd, uint8_t dev_addr, uint8_t cmd){
+static int _write_byte(IIC_Bus *bus, uint8_t dev_addr, uint8_t cmd){
     int res = 0;
-    res = ioctl(fd, I2C_SLAVE, dev_addr);
+    res = _ioctl(bus, I2C_SLAVE, (void *)(uintptr_t)dev_addr);
     struct i2c_smbus_ioctl_data args;
     args.read_write = I2C_SMBUS_WRITE;
     args.command = cmd;
     args.size = I2C_SMBUS_BYTE;
     args.data = NULL;
-    return ioctl(fd, I2C_SMBUS, &args);
+    return _ioctl(bus, I2C_SMBUS, &args);
+}
+/*! \brief combined write-address/read: one I2C_RDWR transaction (START, addr+W, offs, rSTART, addr+R, len bytes, STOP)
+ */
+static int _read_rdwr(IIC_Bus *bus, uint8_t dev_addr, uint8_t offs, uint8_t *data, unsigned int len)
+{
+    struct i2c_msg msgs[2] = {
+        { .addr = dev_addr, .flags = 0,        .len = 1,   .buf = &offs },
+        { .addr = dev_addr, .flags = I2C_M_RD, .len = len, .buf = data  },
+    };
+    struct i2c_rdwr_ioctl_data rdwr = { .msgs = msgs, .nmsgs = 2 };
+    return _ioctl(bus, I2C_RDWR, &rdwr) == 2 ? (int)len : -1;
+}
+static int _read_i2c_block(IIC_Bus *bus, uint8_t dev_addr, uint8_t offs, uint8_t *data, unsigned int len)
+{
+    if (_ioctl(bus, I2C_SLAVE, (void *)(uintptr_t)dev_addr) < 0) return -1;
+    unsigned int done = 0;
+    while (done < len) {
+        unsigned int n = len - done;
+        if (n > I2C_SMBUS_BLOCK_MAX) n = I2C_SMBUS_BLOCK_MAX;
+        union i2c_smbus_data block;
+        block.block[0] = n;
+        struct i2c_smbus_ioctl_data args;
+        args.read_write = I2C_SMBUS_READ;
+        args.command = offs + done;
+        args.size = I2C_SMBUS_I2C_BLOCK_DATA;
+        args.data = &block;
+        if (_ioctl(bus, I2C_SMBUS, &args) < 0 || block.block[0] == 0) return -1;
+        if (block.block[0] < n) n = block.block[0];
+        for (unsigned int i = 0; i < n; i++) data[done + i] = block.block[i + 1];
+        done += n;
+    }
+    return (int)done;
+}
+// по одному байту со своим адресом - самый медленный, но работает и на 1397
+static int _read_bytes(IIC_Bus *bus, uint8_t dev_addr, uint8_t offs, uint8_t *data, unsigned int len)
+{
+    if (_ioctl(bus, I2C_SLAVE, (void *)(uintptr_t)dev_addr) < 0) return -1;
+    for (unsigned int i = 0; i < len; i++) {
+        union i2c_smbus_data byte;
+        struct i2c_smbus_ioctl_data args;
+        args.read_write = I2C_SMBUS_READ;
+        args.command = offs + i;
+        args.size = I2C_SMBUS_BYTE_DATA;
+        args.data = &byte;
+        if (_ioctl(bus, I2C_SMBUS, &args) < 0) return -1;
+        data[i] = byte.byte;
+    }
+    return (int)len;
+}
+static int _read_legacy(IIC_Bus *bus, uint8_t dev_addr, uint8_t offs, uint8_t *data, unsigned int len)
+{
+    int res = _write_byte(bus, dev_addr, offs);
+    if (res < 0) return -1;
+    unsigned int done = 0;
+    while (done < len) {
+        unsigned int n = len - done < EEPROM_PAGE_SIZE ? len - done : EEPROM_PAGE_SIZE;
+        res = _read_data(bus, dev_addr, offs + done, data + done, n);
+        if (res < 0) return -1;
+        done += n;
+    }
+    return (int)len;
+}
+void iic_set_read_method(int method){
+    _read_method = method;
+}
+static int _eeprom_load(IIC_Bus *bus, uint8_t dev_addr, uint8_t page, uint8_t *data, unsigned int len)
+{
+    unsigned int offs = page * EEPROM_PAGE_SIZE;
+    if (offs >= EEPROM_BYTES) return -1;
+    if (len > EEPROM_BYTES - offs) len = EEPROM_BYTES - offs;
+
+    // драйвер at24 на адресе: читает сам, транзакции через i2c-dev ему мешают
+    if ((_read_method == IIC_READ_AUTO || _read_method == IIC_READ_NVMEM) && bus->ops->load) {
+        int res = bus->ops->load(bus, dev_addr, offs, data + offs, len);
+        if (res >= 0 || _read_method == IIC_READ_NVMEM) return res;
+        if (errno != ENOENT) return -1;
+    }
+    if (_read_method == IIC_READ_NVMEM) {
+        errno = ENOENT;
+        return -1;
+    }
+    if (_read_method == IIC_READ_LEGACY)
+        return _read_legacy(bus, dev_addr, offs, data + offs, len);
+
+    unsigned long funcs = 0;
+    if (_ioctl(bus, I2C_FUNCS, &funcs) < 0) funcs = 0;
+
+    int res = -1;
+    if ((_read_method == IIC_READ_AUTO || _read_method == IIC_READ_RDWR) && (funcs & I2C_FUNC_I2C)) {
+        res = _read_rdwr(bus, dev_addr, offs, data + offs, len);
+        if (res >= 0 || _read_method == IIC_READ_RDWR) return res;
+        // NAK на адрес - платы нет, остальные методы ответят так же
+        if (errno == ENXIO || errno == EREMOTEIO) return -1;
+        STATS_ADD(STATS_I2C_RETRIES, 1);
+    }
+    if ((_read_method == IIC_READ_AUTO || _read_method == IIC_READ_I2C_BLOCK) && (funcs & I2C_FUNC_SMBUS_READ_I2C_BLOCK)) {
+        res = _read_i2c_block(bus, dev_addr, offs, data + offs, len);
+        if (res >= 0 || _read_method == IIC_READ_I2C_BLOCK) return res;
+        STATS_ADD(STATS_I2C_RETRIES, 1);
+    }
+    if ((_read_method == IIC_READ_AUTO || _read_method == IIC_READ_BYTE) && (funcs & I2C_FUNC_SMBUS_READ_BYTE_DATA)) {
+        res = _read_bytes(bus, dev_addr, offs, data + offs, len);
+        if (res >= 0 || _read_method == IIC_READ_BYTE) return res;
+        STATS_ADD(STATS_I2C_RETRIES, 1);
+    }
+    // адаптер без I2C_FUNCS: прежний способ
+    if (_read_method == IIC_READ_AUTO && funcs == 0)
+        res = _read_legacy(bus, dev_addr, offs, data + offs, len);
+    return res;
 }
 /*! \brief load EEPROM 24C02 256 bytes
-    \param i2c_fd - file descriptor
+    \param i2c_fd - bus handle from iic_open
     \param dev_addr - i2c address (0x50+board_index) 
     \param page - 0, start address = page* EEPROM_PAGE_SIZE
-    \param data
+    \param data - EEPROM image, bytes are stored at their EEPROM address (data[page*8...])
     \param len <=256 bytes
-    \return >=0 - SUCCESS, -1 - FAIL
+    \return number of bytes read - SUCCESS, -1 - FAIL
+
+    Сначала драйвер at24 через sysfs, если он привязан к адресу (i2c_nvmem.c).
+    Иначе методы по убыванию скорости, выбор по I2C_FUNCS адаптера; при ошибке - следующий:
+    I2C_RDWR одной транзакцией, SMBus I2C block (по 32 байта), SMBus byte data.
+    Отсутствующая плата не отвечает на адрес ни одним методом.
  */
 int  iic_eeprom_load     (int i2c_fd, uint8_t dev_addr, uint8_t page, uint8_t *data, unsigned int len){
-    int res = 0;
-    int offs = page * EEPROM_PAGE_SIZE;
-    res = _write_byte(i2c_fd, dev_addr, offs);
-    if (res<0) {
+    IIC_Bus *bus = _bus_get(i2c_fd);
+    if (!bus) return -1;
+    STATS_BEGIN(start);
+    int res = _eeprom_load(bus, dev_addr, page, data, len);
+    STATS_END(STATS_I2C_READ, start);
+    if (res > 0) STATS_ADD(STATS_BYTES_READ, res);
+    return res;
+}
+static int _write_i2c_block(IIC_Bus *bus, uint8_t dev_addr, uint8_t offs, const uint8_t *data, unsigned int len)
+{
+    if (_ioctl(bus, I2C_SLAVE, (void *)(uintptr_t)dev_addr) < 0) return -1;
+    union i2c_smbus_data block;
+    block.block[0] = len;
+    for (unsigned int i = 0; i < len; i++) block.block[i + 1] = data[i];
+    struct i2c_smbus_ioctl_data args;
+    args.read_write = I2C_SMBUS_WRITE;
+    args.command = offs;
+    args.size = I2C_SMBUS_I2C_BLOCK_DATA;
+    args.data = &block;
+    return _ioctl(bus, I2C_SMBUS, &args) < 0 ? -1 : (int)len;
+}
+static int _write_byte_data(IIC_Bus *bus, uint8_t dev_addr, uint8_t offs, uint8_t value)
+{
+    if (_ioctl(bus, I2C_SLAVE, (void *)(uintptr_t)dev_addr) < 0) return -1;
+    union i2c_smbus_data byte;
+    byte.byte = value;
+    struct i2c_smbus_ioctl_data args;
+    args.read_write = I2C_SMBUS_WRITE;
+    args.command = offs;
+    args.size = I2C_SMBUS_BYTE_DATA;
+    args.data = &byte;
+    return _ioctl(bus, I2C_SMBUS, &args);
+}
+/*! \brief ACK polling: during the internal write cycle the chip NAKs its address.
+    Probe with an address-pointer write until it answers, instead of a fixed 10 ms sleep.
+ */
+static int _wait_write_cycle(IIC_Bus *bus, uint8_t dev_addr, uint8_t offs)
+{
+    struct timespec start, now;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    do {
+        if (_write_byte(bus, dev_addr, offs) >= 0) return 0;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+    } while ((now.tv_sec - start.tv_sec) * 1000L + (now.tv_nsec - start.tv_nsec) / 1000000L < EEPROM_WRITE_TIMEOUT_MS);
+    return -1;
+}
+/*! \brief program one page (or part of it) and wait for the write cycle
+    \param funcs - I2C_FUNCS of the adapter
+    \return number of bytes programmed (a byte-data adapter programs one byte per cycle), -1 - FAIL
+ */
+static int _store_page(IIC_Bus *bus, uint8_t dev_addr, unsigned long funcs, unsigned int addr, const uint8_t *data, unsigned int n)
+{
+    int res;
+    if (funcs == 0 || (funcs & I2C_FUNC_I2C)) {
+        res = _write_data(bus, dev_addr, addr, data, n);
+    } else if (funcs & I2C_FUNC_SMBUS_WRITE_I2C_BLOCK) {
+        res = _write_i2c_block(bus, dev_addr, addr, data, n);
     } else {
-        while (offs<256) {
-            res = _read_data(i2c_fd, dev_addr, offs, data+offs, EEPROM_PAGE_SIZE);
-            offs+=EEPROM_PAGE_SIZE;
-        }
+        res = _write_byte_data(bus, dev_addr, addr, data[0]) < 0 ? -1 : 1;
     }
+    if (res < 0 || _wait_write_cycle(bus, dev_addr, addr) < 0) return -1;
     return res;
 }
+static long _elapsed_us(const struct timespec *start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1000000L + (now.tv_nsec - start->tv_nsec) / 1000L;
+}
+/*! \brief store EEPROM 24C02, page writes with ACK polling and read-back verify
+    \param i2c_fd - bus handle from iic_open
+    \param dev_addr - i2c address (0x50+board_index)
+    \param page - 0, start address = page* EEPROM_PAGE_SIZE
+    \param data - EEPROM image, bytes are taken from their EEPROM address (data[page*8...])
+    \param len <=256 bytes
+    \return number of bytes written - SUCCESS, -1 - I/O FAIL, -2 - read-back differs
+
+    Запись страницами по 8 байт (граница страницы не пересекается, иначе адрес
+    заворачивается внутри страницы), после каждой - опрос ACK до конца цикла записи.
+    Без I2C_FUNC_I2C - SMBus I2C block, затем SMBus byte data (цикл записи на каждый байт).
+ */
+int  iic_eeprom_store    (int i2c_fd, uint8_t dev_addr, uint8_t page, const uint8_t *data, unsigned int len){
+    IIC_Bus *bus = _bus_get(i2c_fd);
+    if (!bus) return -1;
+    unsigned int offs = page * EEPROM_PAGE_SIZE;
+    if (offs >= EEPROM_BYTES) return -1;
+    if (len > EEPROM_BYTES - offs) len = EEPROM_BYTES - offs;
+
+    unsigned long funcs = 0;
+    if (_ioctl(bus, I2C_FUNCS, &funcs) < 0) funcs = 0;
+
+    unsigned int addr = offs;
+    while (addr < offs + len) {
+        unsigned int n = EEPROM_PAGE_SIZE - addr % EEPROM_PAGE_SIZE;
+        if (n > offs + len - addr) n = offs + len - addr;
+        int res = _store_page(bus, dev_addr, funcs, addr, data + addr, n);
+        if (res < 0) return -1;
+        addr += res;
+    }
+
+    uint8_t check[EEPROM_BYTES];
+    if (iic_eeprom_load(i2c_fd, dev_addr, page, check, len) != (int)len) return -1;
+    return memcmp(check + offs, data + offs, len) == 0 ? (int)len : -2;
+}
+/*! \brief differential store: read the chip, program only the 8-byte pages that differ, verify
+    \param i2c_fd - bus handle from iic_open
+    \param dev_addr - i2c address (0x50+board_index)
+    \param data - full EEPROM image, 256 bytes
+    \param stats - pages written/skipped and time of the read, write and verify phases, may be NULL
+    \return number of pages written - SUCCESS, -1 - I/O FAIL, -2 - read-back differs
+
+    Правка одного поля меняет только свой шифрованный регион - обычно несколько страниц
+    из 32: меньше времени на шине и циклов перезаписи ячеек.
+ */
+int  iic_eeprom_update   (int i2c_fd, uint8_t dev_addr, const uint8_t *data, IICWriteStats *stats){
+    IIC_Bus *bus = _bus_get(i2c_fd);
+    if (!bus) return -1;
+    IICWriteStats local;
+    if (!stats) stats = &local;
+    memset(stats, 0, sizeof(*stats));
+
+    unsigned long funcs = 0;
+    if (_ioctl(bus, I2C_FUNCS, &funcs) < 0) funcs = 0;
+
+    struct timespec start;
+    uint8_t current[EEPROM_BYTES];
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (iic_eeprom_load(i2c_fd, dev_addr, 0, current, EEPROM_BYTES) != EEPROM_BYTES) return -1;
+    stats->read_us = _elapsed_us(&start);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (unsigned int page = 0; page < EEPROM_BYTES / EEPROM_PAGE_SIZE; page++) {
+        unsigned int addr = page * EEPROM_PAGE_SIZE;
+        if (memcmp(current + addr, data + addr, EEPROM_PAGE_SIZE) == 0) {
+            stats->pages_skipped++;
+            continue;
+        }
+        for (unsigned int done = 0; done < EEPROM_PAGE_SIZE; ) {
+            int res = _store_page(bus, dev_addr, funcs, addr + done, data + addr + done, EEPROM_PAGE_SIZE - done);
+            if (res < 0) return -1;
+            done += res;
+        }
+        stats->pages_written++;
+    }
+    stats->write_us = _elapsed_us(&start);
+
+    if (stats->pages_written == 0) return 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (iic_eeprom_load(i2c_fd, dev_addr, 0, current, EEPROM_BYTES) != EEPROM_BYTES) return -1;
+    stats->verify_us = _elapsed_us(&start);
+    return memcmp(current, data, EEPROM_BYTES) == 0 ? (int)stats->pages_written : -2;
+}
+/*! \brief open I2C bus
+    \param path - "/dev/i2c-N" or "<prefix>..." of another backend ("sim:...", see i2c_sim.c)
+    \param port_settings - backend settings, NULL - defaults
+    \return bus handle - SUCCESS, -1 - FAIL
+ */
 int  iic_open(const char* path, const char* port_settings){
-    int fd = open(path, O_RDWR | O_NONBLOCK);
-    if (fd < 0) {
-        fprintf(stderr, "fail to open i2c port '%s'", path);
+    const IIC_BusOps *ops = &IIC_bus_dev;
+    for (unsigned int i = 0; i < sizeof(_backends) / sizeof(_backends[0]); i++) {
+        const char *prefix = _backends[i]->prefix;
+        if (prefix && strncmp(path, prefix, strlen(prefix)) == 0) {
+            ops = _backends[i];
+            path += strlen(prefix);
+            break;
+        }
+    }
+    // свободный слот занимается атомарно: шины открываются из рабочих потоков scan
+    int handle = -1;
+    for (int i = 0; i < IIC_MAX_BUSES && handle < 0; i++) {
+        int expected = 0;
+        if (__atomic_compare_exchange_n(&_bus_used[i], &expected, -1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+            handle = i;
+    }
+    if (handle < 0) {
+        fprintf(stderr, "fail to open i2c port '%s': too many open buses\n", path);
+        errno = EMFILE;
+        return -1;
+    }
+    IIC_Bus *bus = &_buses[handle];
+    memset(bus, 0, sizeof(*bus));
+    bus->ops = ops;
+    bus->fd = -1;
+    bus->number = -1;
+    if (ops->open(bus, path, port_settings) < 0) {
+        int err = errno;
+        fprintf(stderr, "fail to open i2c port '%s': %s\n", path, strerror(err));
+        __atomic_store_n(&_bus_used[handle], 0, __ATOMIC_RELEASE);
+        errno = err;
         return -1;
     }
-    return fd;
+    __atomic_store_n(&_bus_used[handle], 1, __ATOMIC_RELEASE);
+    return handle;
 }
 void iic_close(int i2c_fd){
-	close(i2c_fd);
+    IIC_Bus *bus = _bus_get(i2c_fd);
+    if (!bus) return;
+    bus->ops->close(bus);
+    __atomic_store_n(&_bus_used[i2c_fd], 0, __ATOMIC_RELEASE);
 }
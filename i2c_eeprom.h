@@ -7,27 +7,91 @@
 
 /**
  * Open I2C device
- * @param path - device path (e.g., "/dev/i2c-0")
- * @param port_settings - unused, for future compatibility
- * @return file descriptor on success, -1 on error
+ * @param path - device path (e.g., "/dev/i2c-0"), or "sim:" followed by the simulated bus spec (see i2c_sim.c)
+ * @param port_settings - backend settings (simulated bus: "key=value,..."), NULL for defaults
+ * @return bus handle on success, -1 on error
  */
 int iic_open(const char* path, const char* port_settings);
 
 /**
  * Close I2C device
- * @param i2c_fd - file descriptor from iic_open()
+ * @param i2c_fd - bus handle from iic_open()
  */
 void iic_close(int i2c_fd);
 
 /**
  * Load EEPROM 24C02 (256 bytes)
- * @param i2c_fd - file descriptor from iic_open()
+ * @param i2c_fd - bus handle from iic_open()
  * @param dev_addr - I2C device address (0x50 + board_index)
  * @param page - starting page (address = page * 8)
- * @param data - buffer for data (should be at least 256 bytes)
+ * @param data - buffer for data (should be at least 256 bytes), byte N of the EEPROM goes to data[N]
  * @param len - length to read (max 256 bytes)
- * @return >=0 on success, -1 on error
+ * @return number of bytes read on success, -1 on error
+ *
+ * Uses the fastest transfer the adapter supports (see iic_set_read_method)
  */
 int iic_eeprom_load(int i2c_fd, uint8_t dev_addr, uint8_t page, uint8_t *data, unsigned int len);
 
+/**
+ * Store EEPROM 24C02 (up to 256 bytes) and verify by reading it back
+ * @param i2c_fd - bus handle from iic_open()
+ * @param dev_addr - I2C device address (0x50 + board_index)
+ * @param page - starting page (address = page * 8)
+ * @param data - EEPROM image, byte N of the EEPROM is taken from data[N]
+ * @param len - length to write (max 256 bytes)
+ * @return number of bytes written on success, -1 on I/O error, -2 if the read-back differs
+ *
+ * Writes whole 8-byte pages and waits for each write cycle by ACK polling
+ */
+int iic_eeprom_store(int i2c_fd, uint8_t dev_addr, uint8_t page, const uint8_t *data, unsigned int len);
+
+/**
+ * Result of iic_eeprom_update
+ */
+typedef struct {
+    unsigned int pages_written;    // 8-byte pages programmed
+    unsigned int pages_skipped;    // pages already equal to the image
+    long read_us;                  // reading the current image
+    long write_us;                 // page writes including write cycles
+    long verify_us;                // read-back, 0 if nothing was written
+} IICWriteStats;
+
+/**
+ * Store EEPROM 24C02 differentially: program only the 8-byte pages that differ from the chip
+ * @param i2c_fd - bus handle from iic_open()
+ * @param dev_addr - I2C device address (0x50 + board_index)
+ * @param data - EEPROM image, 256 bytes
+ * @param stats - filled with page counts and timings, may be NULL
+ * @return number of pages written on success, -1 on I/O error, -2 if the read-back differs
+ */
+int iic_eeprom_update(int i2c_fd, uint8_t dev_addr, const uint8_t *data, IICWriteStats *stats);
+
+/**
+ * Read transfer used by iic_eeprom_load
+ * IIC_READ_AUTO      - at24 driver, else I2C_RDWR, else SMBus I2C block, else SMBus byte reads (default)
+ * IIC_READ_RDWR      - one combined write-address/read I2C_RDWR transaction
+ * IIC_READ_I2C_BLOCK - SMBus I2C block reads, 32 bytes each
+ * IIC_READ_BYTE      - SMBus byte data reads, one per address (1397 boards)
+ * IIC_READ_LEGACY    - address write, then read() in 8-byte chunks
+ * IIC_READ_NVMEM     - only through the at24 driver (sysfs nvmem), fails if it is not bound
+ *
+ * IIC_READ_AUTO tries the at24 driver first; the other methods bypass it.
+ */
+enum {
+    IIC_READ_AUTO,
+    IIC_READ_RDWR,
+    IIC_READ_I2C_BLOCK,
+    IIC_READ_BYTE,
+    IIC_READ_LEGACY,
+    IIC_READ_NVMEM
+};
+void iic_set_read_method(int method);
+
+/**
+ * Find buses with EEPROMs bound to the at24 driver (they may have no /dev/i2c-N node)
+ * @param after - previous bus number, -1 to start
+ * @return next bus number, -1 if there are no more
+ */
+int iic_nvmem_next_bus(int after);
+
 #endif // I2C_EEPROM_H
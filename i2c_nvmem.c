@@ -0,0 +1,108 @@
+/*! \brief EEPROM through the at24 kernel driver (sysfs nvmem)
+
+    Если на адрес привязан драйвер at24, I2C_SLAVE на /dev/i2c-N вернет EBUSY,
+    а обход драйвера через I2C_SLAVE_FORCE конфликтует с ним на шине.
+    Драйвер отдает содержимое микросхемы файлом:
+        /sys/bus/i2c/devices/N-00AA/eeprom           (at24, старый интерфейс)
+        /sys/bus/nvmem/devices/N-00AA<id>/nvmem      (nvmem, <id> - номер от ядра)
+    Образ читается одним pread, блочное чтение делает сам драйвер.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <ctype.h>
+#include "i2c_bus.h"
+
+#ifndef IIC_SYSFS_ROOT
+#define IIC_SYSFS_ROOT "/sys"
+#endif
+
+/*! \brief find the sysfs file of an at24 EEPROM
+    \return 0 - path is filled, -1 - no driver bound (errno = ENOENT)
+ */
+static int _nvmem_path(int bus_number, uint8_t dev_addr, char *path, size_t size)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%d-%04x", bus_number, dev_addr);
+
+    snprintf(path, size, IIC_SYSFS_ROOT "/bus/i2c/devices/%s/eeprom", name);
+    if (access(path, R_OK) == 0) return 0;
+
+    DIR *dir = opendir(IIC_SYSFS_ROOT "/bus/nvmem/devices");
+    if (dir) {
+        size_t len = strlen(name);
+        struct dirent *entry;
+        while ((entry = readdir(dir)) != NULL) {
+            // "N-00AA" и номер устройства nvmem из цифр: 0-00500
+            const char *id = entry->d_name + len;
+            if (strncmp(entry->d_name, name, len) != 0 || !isdigit((unsigned char)*id)) continue;
+            while (isdigit((unsigned char)*id)) id++;
+            if (*id) continue;
+            snprintf(path, size, IIC_SYSFS_ROOT "/bus/nvmem/devices/%s/nvmem", entry->d_name);
+            if (access(path, R_OK) == 0) {
+                closedir(dir);
+                return 0;
+            }
+        }
+        closedir(dir);
+    }
+    errno = ENOENT;
+    return -1;
+}
+/*! \brief read EEPROM bytes [offs, offs+len) through the at24 driver
+    \return number of bytes read - SUCCESS, -1 - FAIL (errno = ENOENT if no driver is bound)
+ */
+int  iic_nvmem_load(int bus_number, uint8_t dev_addr, unsigned int offs, uint8_t *data, unsigned int len)
+{
+    char path[512];
+    if (bus_number < 0 || _nvmem_path(bus_number, dev_addr, path, sizeof(path)) < 0) {
+        errno = ENOENT;
+        return -1;
+    }
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+    ssize_t res = pread(fd, data, len, offs);
+    int err = errno;
+    close(fd);
+    if (res != (ssize_t)len) {
+        // короче 256 байт - другая микросхема, не 24C02
+        errno = res < 0 ? err : EIO;
+        return -1;
+    }
+    return (int)res;
+}
+/*! \brief true if the at24 driver is bound to any address of the bus
+ */
+int  iic_nvmem_bus_present(int bus_number)
+{
+    char path[512];
+    for (int addr = 0x50; addr <= 0x57; addr++) {
+        if (_nvmem_path(bus_number, addr, path, sizeof(path)) == 0) return 1;
+    }
+    return 0;
+}
+/*! \brief smallest bus number greater than after with at24 EEPROMs at 0x50-0x57, -1 - none
+ */
+int  iic_nvmem_next_bus(int after)
+{
+    int next = -1;
+    DIR *dir = opendir(IIC_SYSFS_ROOT "/bus/i2c/devices");
+    if (!dir) return -1;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        int number;
+        unsigned int addr;
+        char tail;
+        if (sscanf(entry->d_name, "%d-%4x%c", &number, &addr, &tail) != 2) continue;
+        if (number <= after || (next >= 0 && number >= next) || addr < 0x50 || addr > 0x57) continue;
+        char path[512];
+        if (_nvmem_path(number, addr, path, sizeof(path)) == 0) next = number;
+    }
+    closedir(dir);
+    return next;
+}
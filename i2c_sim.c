@@ -0,0 +1,397 @@
+/*! \brief simulated I2C bus with 24C02 chips
+
+    Путь: sim:FILE[,FILE...][?SETTINGS]
+    FILE - дамп для платы 0x50, 0x51, ... ("blank" - чистая микросхема, пусто - платы нет)
+    SETTINGS (и port_settings из iic_open) - key=value через запятую:
+        adapter=i2c|smbus|byte|legacy  функциональность адаптера (legacy - без I2C_FUNCS)
+        khz=N           частота шины, время на байт 9 бит (0 - мгновенно, по умолчанию)
+        latency_us=N    задержка на каждую транзакцию
+        nak=P           вероятность NAK на транзакцию
+        ber=P           вероятность ошибки на бит читаемых данных
+        write_ms=N      цикл записи страницы (5)
+        slow_write=P    вероятность медленного цикла записи, slow_ms=N (20)
+        wp=1            защита от записи: ACK без записи
+        seed=N          начальное значение генератора (1)
+        persist=1       при закрытии записать образы обратно в файлы
+        stats=1         при закрытии вывести счетчики в stderr
+
+    Пример: eeprom_tool scan 'sim:examples/eeprom_BHB68701.bin,blank?khz=100,nak=0.01'
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <linux/i2c-dev.h>
+#include <linux/i2c.h>
+#include "i2c_bus.h"
+
+#define SIM_ADDR_FIRST  0x50
+#define SIM_CHIPS       8              // 0x50-0x57, A0-A2
+#define SIM_BYTES       256
+#define SIM_PAGE_SIZE   8
+
+typedef struct {
+    int present;
+    int dirty;
+    uint8_t ptr;                       // внутренний счетчик адреса
+    uint64_t busy_until;               // конец цикла записи, ns CLOCK_MONOTONIC
+    uint8_t mem[SIM_BYTES];
+    char path[256];
+} SimChip;
+
+typedef struct {
+    SimChip chips[SIM_CHIPS];
+    uint16_t slave;
+    unsigned long funcs;
+    int report_funcs;
+    uint64_t latency_ns, byte_ns, write_ns, slow_ns;
+    double nak, ber, slow;
+    int wp, persist, stats;
+    uint64_t rng;
+
+    unsigned long transactions, naks, busy_naks, flips, bytes_read, bytes_written, cycles;
+    uint64_t bus_ns;
+} SimBus;
+
+static uint64_t _now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+// xorshift64*: воспроизводимо при одинаковом seed
+static double _random(SimBus *sim)
+{
+    sim->rng ^= sim->rng >> 12;
+    sim->rng ^= sim->rng << 25;
+    sim->rng ^= sim->rng >> 27;
+    return ((sim->rng * 0x2545F4914F6CDD1Dull) >> 11) * (1.0 / 9007199254740992.0);
+}
+static int _chance(SimBus *sim, double p)
+{
+    return p > 0 && _random(sim) < p;
+}
+static void _delay(SimBus *sim, unsigned int bytes)
+{
+    uint64_t ns = sim->latency_ns + bytes * sim->byte_ns;
+    sim->bus_ns += ns;
+    if (ns) {
+        struct timespec ts = { .tv_sec = ns / 1000000000ull, .tv_nsec = ns % 1000000000ull };
+        nanosleep(&ts, NULL);
+    }
+}
+/*! \brief START + address: the chip ACKs unless absent, busy with a write cycle or a NAK is injected
+    \param bytes - bytes in the transaction after the address, for the bus time
+ */
+static SimChip *_address(SimBus *sim, uint16_t addr, unsigned int bytes)
+{
+    sim->transactions++;
+    _delay(sim, 1 + bytes);
+    if (addr < SIM_ADDR_FIRST || addr >= SIM_ADDR_FIRST + SIM_CHIPS || !sim->chips[addr - SIM_ADDR_FIRST].present) {
+        errno = ENXIO;
+        return NULL;
+    }
+    SimChip *chip = &sim->chips[addr - SIM_ADDR_FIRST];
+    if (_now_ns() < chip->busy_until) {
+        sim->busy_naks++;
+        errno = ENXIO;
+        return NULL;
+    }
+    if (_chance(sim, sim->nak)) {
+        sim->naks++;
+        errno = ENXIO;
+        return NULL;
+    }
+    return chip;
+}
+static void _read_bytes(SimBus *sim, SimChip *chip, uint8_t *data, unsigned int len)
+{
+    for (unsigned int i = 0; i < len; i++) {
+        uint8_t byte = chip->mem[chip->ptr++];
+        if (sim->ber > 0) {
+            for (int bit = 0; bit < 8; bit++) {
+                if (_chance(sim, sim->ber)) {
+                    byte ^= 1 << bit;
+                    sim->flips++;
+                }
+            }
+        }
+        data[i] = byte;
+    }
+    sim->bytes_read += len;
+}
+/*! \brief write message: address byte, then page write data (wraps inside the 8-byte page)
+ */
+static void _write_bytes(SimBus *sim, SimChip *chip, const uint8_t *data, unsigned int len)
+{
+    if (len == 0) return;
+    chip->ptr = data[0];
+    if (len == 1) return;
+    uint8_t page = chip->ptr & ~(SIM_PAGE_SIZE - 1);
+    uint8_t offs = chip->ptr;
+    for (unsigned int i = 1; i < len; i++) {
+        if (!sim->wp) chip->mem[page | (offs & (SIM_PAGE_SIZE - 1))] = data[i];
+        offs++;
+    }
+    chip->ptr = page | (offs & (SIM_PAGE_SIZE - 1));
+    sim->bytes_written += len - 1;
+    if (sim->wp) return;
+    chip->dirty = 1;
+    sim->cycles++;
+    chip->busy_until = _now_ns() + (_chance(sim, sim->slow) ? sim->slow_ns : sim->write_ns);
+}
+static int _load_chip(SimChip *chip, const char *path, unsigned int len)
+{
+    memset(chip->mem, 0xFF, SIM_BYTES);
+    chip->present = 1;
+    if (len == 5 && strncmp(path, "blank", 5) == 0) return 0;
+    if (len >= sizeof(chip->path)) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    memcpy(chip->path, path, len);
+    chip->path[len] = '\0';
+    FILE *file = fopen(chip->path, "rb");
+    if (!file) return -1;
+    size_t size = fread(chip->mem, 1, SIM_BYTES, file);
+    fclose(file);
+    if (size == 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    return 0;
+}
+static int _setting(SimBus *sim, const char *key, unsigned int key_len, const char *value, unsigned int value_len)
+{
+#define KEY(name)   (key_len == sizeof(name) - 1 && strncmp(key, name, key_len) == 0)
+#define VALUE(name) (value_len == sizeof(name) - 1 && strncmp(value, name, value_len) == 0)
+    char *end;
+    double number = strtod(value, &end);
+    if (KEY("adapter")) {
+        sim->report_funcs = 1;
+        if (VALUE("i2c")) {
+            sim->funcs = I2C_FUNC_I2C | I2C_FUNC_SMBUS_EMUL;
+        } else if (VALUE("smbus")) {
+            sim->funcs = I2C_FUNC_SMBUS_QUICK | I2C_FUNC_SMBUS_BYTE | I2C_FUNC_SMBUS_BYTE_DATA | I2C_FUNC_SMBUS_I2C_BLOCK;
+        } else if (VALUE("byte")) {
+            sim->funcs = I2C_FUNC_SMBUS_QUICK | I2C_FUNC_SMBUS_BYTE | I2C_FUNC_SMBUS_BYTE_DATA;
+        } else if (VALUE("legacy")) {
+            sim->funcs = I2C_FUNC_I2C | I2C_FUNC_SMBUS_BYTE;
+            sim->report_funcs = 0;
+        } else {
+            return -1;
+        }
+        return 0;
+    }
+    if (end != value + value_len) return -1;
+    if      (KEY("khz"))        sim->byte_ns = number > 0 ? (uint64_t)(9e6 / number) : 0;
+    else if (KEY("latency_us")) sim->latency_ns = (uint64_t)(number * 1e3);
+    else if (KEY("nak"))        sim->nak = number;
+    else if (KEY("ber"))        sim->ber = number;
+    else if (KEY("write_ms"))   sim->write_ns = (uint64_t)(number * 1e6);
+    else if (KEY("slow_write")) sim->slow = number;
+    else if (KEY("slow_ms"))    sim->slow_ns = (uint64_t)(number * 1e6);
+    else if (KEY("wp"))         sim->wp = number != 0;
+    else if (KEY("seed"))       sim->rng = (uint64_t)number ? (uint64_t)number : 1;
+    else if (KEY("persist"))    sim->persist = number != 0;
+    else if (KEY("stats"))      sim->stats = number != 0;
+    else return -1;
+    return 0;
+#undef KEY
+#undef VALUE
+}
+static int _settings(SimBus *sim, const char *settings)
+{
+    while (settings && *settings) {
+        const char *item_end = strchr(settings, ',');
+        if (!item_end) item_end = settings + strlen(settings);
+        const char *eq = memchr(settings, '=', item_end - settings);
+        if (!eq || _setting(sim, settings, eq - settings, eq + 1, item_end - eq - 1) < 0) {
+            fprintf(stderr, "sim: bad setting '%.*s'\n", (int)(item_end - settings), settings);
+            errno = EINVAL;
+            return -1;
+        }
+        settings = *item_end ? item_end + 1 : item_end;
+    }
+    return 0;
+}
+
+static int _sim_open(IIC_Bus *bus, const char *path, const char *settings)
+{
+    SimBus *sim = calloc(1, sizeof(SimBus));
+    if (!sim) return -1;
+    bus->ctx = sim;
+    sim->funcs = I2C_FUNC_I2C | I2C_FUNC_SMBUS_EMUL;
+    sim->report_funcs = 1;
+    sim->write_ns = 5000000;
+    sim->slow_ns = 20000000;
+    sim->rng = 1;
+
+    const char *query = strchr(path, '?');
+    const char *files_end = query ? query : path + strlen(path);
+    unsigned int index = 0;
+    for (const char *file = path; file < files_end && index < SIM_CHIPS; index++) {
+        const char *end = memchr(file, ',', files_end - file);
+        if (!end) end = files_end;
+        if (end > file && _load_chip(&sim->chips[index], file, end - file) < 0) {
+            int err = errno;
+            fprintf(stderr, "sim: cannot load '%.*s': %s\n", (int)(end - file), file, strerror(err));
+            free(sim);
+            errno = err;
+            return -1;
+        }
+        file = end < files_end ? end + 1 : end;
+    }
+
+    if (_settings(sim, query ? query + 1 : NULL) < 0 || _settings(sim, settings) < 0) {
+        free(sim);
+        return -1;
+    }
+    return 0;
+}
+
+static int _sim_ioctl(IIC_Bus *bus, unsigned long request, void *arg)
+{
+    SimBus *sim = bus->ctx;
+    switch (request) {
+    case I2C_FUNCS:
+        if (!sim->report_funcs) {
+            errno = ENOTTY;
+            return -1;
+        }
+        *(unsigned long *)arg = sim->funcs;
+        return 0;
+    case I2C_SLAVE:
+    case I2C_SLAVE_FORCE:
+        if ((unsigned long)arg > 0x7F) {
+            errno = EINVAL;
+            return -1;
+        }
+        sim->slave = (uint16_t)(unsigned long)arg;
+        return 0;
+    case I2C_RDWR: {
+        struct i2c_rdwr_ioctl_data *rdwr = arg;
+        if (!(sim->funcs & I2C_FUNC_I2C)) {
+            errno = EOPNOTSUPP;
+            return -1;
+        }
+        // повторный START между сообщениями: каждое адресуется заново
+        for (unsigned int i = 0; i < rdwr->nmsgs; i++) {
+            struct i2c_msg *msg = &rdwr->msgs[i];
+            SimChip *chip = _address(sim, msg->addr, msg->len);
+            if (!chip) return -1;
+            if (msg->flags & I2C_M_RD) _read_bytes(sim, chip, msg->buf, msg->len);
+            else _write_bytes(sim, chip, msg->buf, msg->len);
+        }
+        return rdwr->nmsgs;
+    }
+    case I2C_SMBUS: {
+        struct i2c_smbus_ioctl_data *args = arg;
+        unsigned long need;
+        unsigned int bytes;
+        switch (args->size) {
+        case I2C_SMBUS_QUICK:          need = I2C_FUNC_SMBUS_QUICK; bytes = 0; break;
+        case I2C_SMBUS_BYTE:           need = args->read_write == I2C_SMBUS_READ ? I2C_FUNC_SMBUS_READ_BYTE : I2C_FUNC_SMBUS_WRITE_BYTE; bytes = 1; break;
+        case I2C_SMBUS_BYTE_DATA:      need = args->read_write == I2C_SMBUS_READ ? I2C_FUNC_SMBUS_READ_BYTE_DATA : I2C_FUNC_SMBUS_WRITE_BYTE_DATA; bytes = 2; break;
+        case I2C_SMBUS_I2C_BLOCK_DATA:
+            need = args->read_write == I2C_SMBUS_READ ? I2C_FUNC_SMBUS_READ_I2C_BLOCK : I2C_FUNC_SMBUS_WRITE_I2C_BLOCK;
+            if (args->data->block[0] == 0 || args->data->block[0] > I2C_SMBUS_BLOCK_MAX) {
+                errno = EINVAL;
+                return -1;
+            }
+            bytes = 1 + args->data->block[0];
+            break;
+        default:
+            errno = EOPNOTSUPP;
+            return -1;
+        }
+        if (!(sim->funcs & need)) {
+            errno = EOPNOTSUPP;
+            return -1;
+        }
+        SimChip *chip = _address(sim, sim->slave, bytes);
+        if (!chip) return -1;
+        uint8_t msg[1 + I2C_SMBUS_BLOCK_MAX];
+        msg[0] = args->command;
+        if (args->size == I2C_SMBUS_BYTE) {
+            if (args->read_write == I2C_SMBUS_READ) _read_bytes(sim, chip, &args->data->byte, 1);
+            else _write_bytes(sim, chip, msg, 1);
+        } else if (args->size == I2C_SMBUS_BYTE_DATA) {
+            if (args->read_write == I2C_SMBUS_READ) {
+                _write_bytes(sim, chip, msg, 1);
+                _read_bytes(sim, chip, &args->data->byte, 1);
+            } else {
+                msg[1] = args->data->byte;
+                _write_bytes(sim, chip, msg, 2);
+            }
+        } else if (args->size == I2C_SMBUS_I2C_BLOCK_DATA) {
+            if (args->read_write == I2C_SMBUS_READ) {
+                _write_bytes(sim, chip, msg, 1);
+                _read_bytes(sim, chip, args->data->block + 1, args->data->block[0]);
+            } else {
+                memcpy(msg + 1, args->data->block + 1, args->data->block[0]);
+                _write_bytes(sim, chip, msg, 1 + args->data->block[0]);
+            }
+        }
+        return 0;
+    }
+    default:
+        errno = ENOTTY;
+        return -1;
+    }
+}
+
+static int _sim_read(IIC_Bus *bus, uint8_t *data, unsigned int len)
+{
+    SimBus *sim = bus->ctx;
+    if (!(sim->funcs & I2C_FUNC_I2C)) {
+        errno = EOPNOTSUPP;
+        return -1;
+    }
+    SimChip *chip = _address(sim, sim->slave, len);
+    if (!chip) return -1;
+    _read_bytes(sim, chip, data, len);
+    return (int)len;
+}
+
+static int _sim_write(IIC_Bus *bus, const uint8_t *data, unsigned int len)
+{
+    SimBus *sim = bus->ctx;
+    if (!(sim->funcs & I2C_FUNC_I2C)) {
+        errno = EOPNOTSUPP;
+        return -1;
+    }
+    SimChip *chip = _address(sim, sim->slave, len);
+    if (!chip) return -1;
+    _write_bytes(sim, chip, data, len);
+    return (int)len;
+}
+
+static void _sim_close(IIC_Bus *bus)
+{
+    SimBus *sim = bus->ctx;
+    for (int i = 0; sim->persist && i < SIM_CHIPS; i++) {
+        SimChip *chip = &sim->chips[i];
+        if (!chip->dirty || !chip->path[0]) continue;
+        FILE *file = fopen(chip->path, "wb");
+        if (!file || fwrite(chip->mem, 1, SIM_BYTES, file) != SIM_BYTES)
+            fprintf(stderr, "sim: cannot save '%s': %s\n", chip->path, strerror(errno));
+        if (file) fclose(file);
+    }
+    if (sim->stats) {
+        fprintf(stderr, "sim: %lu transactions, %lu NAK + %lu busy NAK, %lu bit errors, "
+                "%lu bytes read, %lu written, %lu write cycles, %.1f ms bus time\n",
+                sim->transactions, sim->naks, sim->busy_naks, sim->flips,
+                sim->bytes_read, sim->bytes_written, sim->cycles, sim->bus_ns / 1e6);
+    }
+    free(sim);
+    bus->ctx = NULL;
+}
+
+const IIC_BusOps IIC_bus_sim = {
+    .name = "sim", .prefix = "sim:",
+    .open = _sim_open, .ioctl = _sim_ioctl, .read = _sim_read, .write = _sim_write, .close = _sim_close,
+};
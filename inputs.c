@@ -0,0 +1,175 @@
+#include "inputs.h"
+#include "eeprom_ops.h"
+#include "eeprom_file.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+static int inputs_reserve(InputSet *inputs, size_t extra)
+{
+	if (inputs->count + extra <= inputs->capacity)
+	{
+		return 0;
+	}
+
+	size_t capacity = inputs->capacity ? inputs->capacity : 256;
+	while (capacity < inputs->count + extra)
+	{
+		capacity *= 2;
+	}
+
+	InputItem *items = realloc(inputs->items, capacity * sizeof(InputItem));
+	if (!items)
+	{
+		return -1;
+	}
+	inputs->items = items;
+	inputs->capacity = capacity;
+	return 0;
+}
+
+static int inputs_add_archive(InputSet *inputs, const char *path)
+{
+	EEPROMArchive archive;
+	int ret = eeprom_archive_open(&archive, path);
+	if (ret != EEPROM_SUCCESS)
+	{
+		if (ret != EEPROM_ERROR_IO)
+		{
+			errno = EINVAL;
+		}
+		return -1;
+	}
+
+	size_t n = inputs->archive_count;
+	EEPROMArchive *archives = realloc(inputs->archives, (n + 1) * sizeof(EEPROMArchive));
+	char **archive_paths = archives ? realloc(inputs->archive_paths, (n + 1) * sizeof(char*)) : NULL;
+	if (archives)
+	{
+		inputs->archives = archives;
+	}
+	if (archive_paths)
+	{
+		inputs->archive_paths = archive_paths;
+	}
+
+	size_t count = eeprom_archive_count(&archive);
+	if (!archives || !archive_paths || inputs_reserve(inputs, count) != 0 ||
+		!(inputs->archive_paths[n] = strdup(path)))
+	{
+		eeprom_archive_close(&archive);
+		errno = ENOMEM;
+		return -1;
+	}
+
+	inputs->archives[n] = archive;
+	inputs->archive_count++;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		inputs->items[inputs->count].archive = (uint32_t)n;
+		inputs->items[inputs->count].index = (uint32_t)i;
+		inputs->count++;
+	}
+
+	return 0;
+}
+
+int inputs_add(InputSet *inputs, const char *path)
+{
+	BatchPathList found = { 0 };
+
+	if (batch_collect_paths(&found, path) != 0)
+	{
+		batch_free_paths(&found);
+		return -1;
+	}
+
+	int result = 0;
+	for (size_t i = 0; i < found.count && result == 0; i++)
+	{
+		if (eeprom_archive_is_archive_path(found.paths[i]))
+		{
+			result = inputs_add_archive(inputs, found.paths[i]);
+			continue;
+		}
+
+		BatchPathList *paths = &inputs->paths;
+		if (paths->count == paths->capacity)
+		{
+			size_t capacity = paths->capacity ? paths->capacity * 2 : 256;
+			char **grown = realloc(paths->paths, capacity * sizeof(char*));
+			if (!grown)
+			{
+				result = -1;
+				break;
+			}
+			paths->paths = grown;
+			paths->capacity = capacity;
+		}
+		if (inputs_reserve(inputs, 1) != 0)
+		{
+			result = -1;
+			break;
+		}
+
+		// Путь переходит в inputs->paths без копирования
+		paths->paths[paths->count++] = found.paths[i];
+		found.paths[i] = NULL;
+
+		inputs->items[inputs->count].archive = INPUT_FILE;
+		inputs->items[inputs->count].index = (uint32_t)(inputs->paths.count - 1);
+		inputs->count++;
+	}
+
+	batch_free_paths(&found);
+	return result;
+}
+
+void inputs_free(InputSet *inputs)
+{
+	for (size_t i = 0; i < inputs->archive_count; i++)
+	{
+		eeprom_archive_close(&inputs->archives[i]);
+		free(inputs->archive_paths[i]);
+	}
+	free(inputs->archives);
+	free(inputs->archive_paths);
+	free(inputs->items);
+	batch_free_paths(&inputs->paths);
+	memset(inputs, 0, sizeof(*inputs));
+}
+
+int inputs_read(const InputSet *inputs, size_t item, uint8_t data[EEPROM_SIZE], size_t *length)
+{
+	const InputItem *it = &inputs->items[item];
+
+	if (it->archive == INPUT_FILE)
+	{
+		return eeprom_read_file(inputs->paths.paths[it->index], data, length);
+	}
+
+	const EEPROMArchive *archive = &inputs->archives[it->archive];
+	memcpy(data, eeprom_archive_record(archive, it->index), EEPROM_SIZE);
+	if (length)
+	{
+		*length = eeprom_archive_length(archive, it->index);
+	}
+	return EEPROM_SUCCESS;
+}
+
+void inputs_source(const InputSet *inputs, size_t item, char *buffer, size_t size)
+{
+	const InputItem *it = &inputs->items[item];
+
+	if (it->archive == INPUT_FILE)
+	{
+		snprintf(buffer, size, "%s", inputs->paths.paths[it->index]);
+	}
+	else
+	{
+		snprintf(buffer, size, "%s:%s", inputs->archive_paths[it->archive],
+				 eeprom_archive_name(&inputs->archives[it->archive], it->index));
+	}
+}
@@ -0,0 +1,43 @@
+#ifndef INPUTS_H
+#define INPUTS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "batch.h"
+#include "eeprom_archive.h"
+
+// ═══════════════════════════════════════════════════════════════
+// Command inputs: dump files, directories and *.eea archives
+// ═══════════════════════════════════════════════════════════════
+
+typedef struct
+{
+	uint32_t archive;              // INPUT_FILE или индекс в archives
+	uint32_t index;                // индекс в paths или номер записи архива
+} InputItem;
+
+#define INPUT_FILE UINT32_MAX
+
+typedef struct
+{
+	BatchPathList paths;
+	EEPROMArchive *archives;
+	char **archive_paths;
+	size_t archive_count;
+	InputItem *items;
+	size_t count;
+	size_t capacity;
+} InputSet;
+
+// Directories are walked; archives contribute all their records.
+// Returns 0 or -1 (errno is set, EINVAL for a damaged archive).
+int inputs_add(InputSet *inputs, const char *path);
+void inputs_free(InputSet *inputs);
+
+// Raw dump of item (files are read, archive records copied from the mapping)
+int inputs_read(const InputSet *inputs, size_t item, uint8_t data[EEPROM_SIZE], size_t *length);
+
+// "path" or "archive.eea:name"
+void inputs_source(const InputSet *inputs, size_t item, char *buffer, size_t size);
+
+#endif // INPUTS_H
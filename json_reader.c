@@ -0,0 +1,537 @@
+#include "json_reader.h"
+#include <stdlib.h>
+#include <string.h>
+
+// ═══════════════════════════════════════════════════════════════
+// Разбор: конечный автомат со стеком контейнеров вместо рекурсии
+// ═══════════════════════════════════════════════════════════════
+
+typedef struct
+{
+	const char *p;
+	const char *end;
+	const char *line_start;
+	int line;
+
+	JsonHandler handler;
+	void *user;
+	JsonError *error;
+
+	JsonFrame frames[JSON_MAX_DEPTH];
+	int started[JSON_MAX_DEPTH];   // в контейнере уже был элемент
+	int depth;
+	char string[JSON_MAX_STRING];
+} JsonReader;
+
+static int reader_fail(JsonReader *reader, const char *message)
+{
+	if (reader->error)
+	{
+		reader->error->line = reader->line;
+		reader->error->column = (int)(reader->p - reader->line_start) + 1;
+		reader->error->message = message;
+	}
+	return -1;
+}
+
+static void reader_skip_space(JsonReader *reader)
+{
+	while (reader->p < reader->end)
+	{
+		char c = *reader->p;
+		if (c == '\n')
+		{
+			reader->line++;
+			reader->line_start = reader->p + 1;
+		}
+		else if (c != ' ' && c != '\t' && c != '\r')
+		{
+			break;
+		}
+		reader->p++;
+	}
+}
+
+static int hex_digit(char c)
+{
+	if (c >= '0' && c <= '9') return c - '0';
+	if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+	if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+	return -1;
+}
+
+static int reader_hex4(JsonReader *reader, uint32_t *code)
+{
+	if (reader->end - reader->p < 4)
+	{
+		return reader_fail(reader, "truncated \\u escape");
+	}
+	*code = 0;
+	for (int i = 0; i < 4; i++)
+	{
+		int digit = hex_digit(reader->p[i]);
+		if (digit < 0)
+		{
+			return reader_fail(reader, "invalid \\u escape");
+		}
+		*code = (*code << 4) | (uint32_t)digit;
+	}
+	reader->p += 4;
+	return 0;
+}
+
+static size_t utf8_encode(uint32_t code, char *out)
+{
+	if (code < 0x80)
+	{
+		out[0] = (char)code;
+		return 1;
+	}
+	if (code < 0x800)
+	{
+		out[0] = (char)(0xC0 | (code >> 6));
+		out[1] = (char)(0x80 | (code & 0x3F));
+		return 2;
+	}
+	if (code < 0x10000)
+	{
+		out[0] = (char)(0xE0 | (code >> 12));
+		out[1] = (char)(0x80 | ((code >> 6) & 0x3F));
+		out[2] = (char)(0x80 | (code & 0x3F));
+		return 3;
+	}
+	out[0] = (char)(0xF0 | (code >> 18));
+	out[1] = (char)(0x80 | ((code >> 12) & 0x3F));
+	out[2] = (char)(0x80 | ((code >> 6) & 0x3F));
+	out[3] = (char)(0x80 | (code & 0x3F));
+	return 4;
+}
+
+// Строка с позиции после открывающей кавычки, без экранирования в out
+static int reader_string(JsonReader *reader, char *out, size_t size, size_t *length)
+{
+	size_t n = 0;
+
+	for (;;)
+	{
+		if (reader->p >= reader->end)
+		{
+			return reader_fail(reader, "unterminated string");
+		}
+
+		// Обычные символы копируются пачкой до кавычки или экранирования
+		const char *start = reader->p;
+		while (reader->p < reader->end && *reader->p != '"' && *reader->p != '\\' &&
+			   (unsigned char)*reader->p >= 0x20)
+		{
+			reader->p++;
+		}
+		size_t run = (size_t)(reader->p - start);
+		if (n + run >= size)
+		{
+			return reader_fail(reader, "string too long");
+		}
+		memcpy(out + n, start, run);
+		n += run;
+
+		if (reader->p >= reader->end)
+		{
+			return reader_fail(reader, "unterminated string");
+		}
+
+		char c = *reader->p++;
+		if (c == '"')
+		{
+			break;
+		}
+		if (c != '\\')
+		{
+			reader->p--;
+			return reader_fail(reader, "control character in string");
+		}
+		if (reader->p >= reader->end)
+		{
+			return reader_fail(reader, "unterminated string");
+		}
+
+		char utf8[4];
+		size_t utf8_length = 1;
+		c = *reader->p++;
+		switch (c)
+		{
+			case '"':  utf8[0] = '"';  break;
+			case '\\': utf8[0] = '\\'; break;
+			case '/':  utf8[0] = '/';  break;
+			case 'b':  utf8[0] = '\b'; break;
+			case 'f':  utf8[0] = '\f'; break;
+			case 'n':  utf8[0] = '\n'; break;
+			case 'r':  utf8[0] = '\r'; break;
+			case 't':  utf8[0] = '\t'; break;
+			case 'u':
+			{
+				uint32_t code;
+				if (reader_hex4(reader, &code) != 0)
+				{
+					return -1;
+				}
+				// Суррогатная пара: \uD8xx\uDCxx
+				if (code >= 0xD800 && code <= 0xDBFF)
+				{
+					uint32_t low;
+					if (reader->end - reader->p < 2 || reader->p[0] != '\\' || reader->p[1] != 'u')
+					{
+						return reader_fail(reader, "unpaired surrogate");
+					}
+					reader->p += 2;
+					if (reader_hex4(reader, &low) != 0)
+					{
+						return -1;
+					}
+					if (low < 0xDC00 || low > 0xDFFF)
+					{
+						return reader_fail(reader, "unpaired surrogate");
+					}
+					code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+				}
+				else if (code >= 0xDC00 && code <= 0xDFFF)
+				{
+					return reader_fail(reader, "unpaired surrogate");
+				}
+				if (code == 0)
+				{
+					return reader_fail(reader, "\\u0000 in string");
+				}
+				utf8_length = utf8_encode(code, utf8);
+				break;
+			}
+			default:
+				reader->p--;
+				return reader_fail(reader, "invalid escape");
+		}
+
+		if (n + utf8_length >= size)
+		{
+			return reader_fail(reader, "string too long");
+		}
+		memcpy(out + n, utf8, utf8_length);
+		n += utf8_length;
+	}
+
+	out[n] = '\0';
+	if (length)
+	{
+		*length = n;
+	}
+	return 0;
+}
+
+static int is_digit(char c)
+{
+	return c >= '0' && c <= '9';
+}
+
+static int reader_number(JsonReader *reader, JsonEvent *event)
+{
+	const char *start = reader->p;
+	const char *p = reader->p;
+	int integral = 1;
+
+	if (p < reader->end && *p == '-')
+	{
+		p++;
+	}
+	if (p >= reader->end || !is_digit(*p))
+	{
+		return reader_fail(reader, "invalid number");
+	}
+	if (*p == '0')
+	{
+		p++;
+	}
+	else
+	{
+		while (p < reader->end && is_digit(*p))
+		{
+			p++;
+		}
+	}
+	if (p < reader->end && *p == '.')
+	{
+		integral = 0;
+		p++;
+		if (p >= reader->end || !is_digit(*p))
+		{
+			reader->p = p;
+			return reader_fail(reader, "invalid number");
+		}
+		while (p < reader->end && is_digit(*p))
+		{
+			p++;
+		}
+	}
+	if (p < reader->end && (*p == 'e' || *p == 'E'))
+	{
+		integral = 0;
+		p++;
+		if (p < reader->end && (*p == '+' || *p == '-'))
+		{
+			p++;
+		}
+		if (p >= reader->end || !is_digit(*p))
+		{
+			reader->p = p;
+			return reader_fail(reader, "invalid number");
+		}
+		while (p < reader->end && is_digit(*p))
+		{
+			p++;
+		}
+	}
+
+	// Целые считаются сами, без strtod; переполнение - как дробное
+	event->is_integer = 0;
+	if (integral)
+	{
+		int negative = *start == '-';
+		uint64_t value = 0;
+		int overflow = 0;
+		for (const char *d = start + negative; d < p; d++)
+		{
+			if (value > (UINT64_MAX - 9) / 10)
+			{
+				overflow = 1;
+				break;
+			}
+			value = value * 10 + (uint64_t)(*d - '0');
+		}
+		if (!overflow && value <= (uint64_t)INT64_MAX)
+		{
+			event->is_integer = 1;
+			event->integer = negative ? -(int64_t)value : (int64_t)value;
+			event->number = (double)event->integer;
+		}
+	}
+	if (!event->is_integer)
+	{
+		char buffer[128];
+		size_t length = (size_t)(p - start);
+		if (length >= sizeof(buffer))
+		{
+			return reader_fail(reader, "number too long");
+		}
+		memcpy(buffer, start, length);
+		buffer[length] = '\0';
+		event->number = strtod(buffer, NULL);
+		event->integer = event->number > -9e18 && event->number < 9e18 ? (int64_t)event->number : 0;
+	}
+
+	reader->p = p;
+	return 0;
+}
+
+static int reader_literal(JsonReader *reader, const char *word)
+{
+	size_t length = strlen(word);
+	if ((size_t)(reader->end - reader->p) < length || memcmp(reader->p, word, length) != 0)
+	{
+		return reader_fail(reader, "invalid literal");
+	}
+	reader->p += length;
+	return 0;
+}
+
+static int reader_emit(JsonReader *reader, JsonEvent *event)
+{
+	event->depth = reader->depth;
+	event->path = reader->frames;
+	return reader->handler(event, reader->user);
+}
+
+// Значение в текущей позиции: скаляр целиком или начало контейнера
+static int reader_value(JsonReader *reader)
+{
+	JsonEvent event = { 0 };
+	int ret;
+
+	if (reader->p >= reader->end)
+	{
+		return reader_fail(reader, "unexpected end of input");
+	}
+
+	switch (*reader->p)
+	{
+		case '{':
+		case '[':
+		{
+			int is_array = *reader->p == '[';
+			if (reader->depth == JSON_MAX_DEPTH)
+			{
+				return reader_fail(reader, "nesting too deep");
+			}
+			reader->p++;
+			event.type = is_array ? JSON_EVENT_ARRAY_BEGIN : JSON_EVENT_OBJECT_BEGIN;
+			if ((ret = reader_emit(reader, &event)) != 0)
+			{
+				return ret;
+			}
+			reader->started[reader->depth] = 0;
+			JsonFrame *frame = &reader->frames[reader->depth++];
+			frame->is_array = is_array;
+			frame->index = 0;
+			frame->key[0] = '\0';
+			return 0;
+		}
+		case '"':
+			reader->p++;
+			if (reader_string(reader, reader->string, sizeof(reader->string), &event.length) != 0)
+			{
+				return -1;
+			}
+			event.value_type = JSON_STRING;
+			event.string = reader->string;
+			break;
+		case 't':
+		case 'f':
+			event.boolean = *reader->p == 't';
+			if (reader_literal(reader, event.boolean ? "true" : "false") != 0)
+			{
+				return -1;
+			}
+			event.value_type = JSON_BOOL;
+			event.integer = event.boolean;
+			event.number = event.boolean;
+			break;
+		case 'n':
+			if (reader_literal(reader, "null") != 0)
+			{
+				return -1;
+			}
+			event.value_type = JSON_NULL;
+			break;
+		default:
+			if (reader_number(reader, &event) != 0)
+			{
+				return -1;
+			}
+			event.value_type = JSON_NUMBER;
+			break;
+	}
+
+	event.type = JSON_EVENT_VALUE;
+	return reader_emit(reader, &event);
+}
+
+// Ключ члена объекта и двоеточие
+static int reader_key(JsonReader *reader)
+{
+	JsonFrame *frame = &reader->frames[reader->depth - 1];
+	if (reader->p >= reader->end || *reader->p != '"')
+	{
+		return reader_fail(reader, "expected member name");
+	}
+	reader->p++;
+	if (reader_string(reader, frame->key, sizeof(frame->key), NULL) != 0)
+	{
+		return -1;
+	}
+	reader_skip_space(reader);
+	if (reader->p >= reader->end || *reader->p != ':')
+	{
+		return reader_fail(reader, "expected ':'");
+	}
+	reader->p++;
+	reader_skip_space(reader);
+	return 0;
+}
+
+static int reader_close(JsonReader *reader)
+{
+	JsonEvent event = { 0 };
+	event.type = reader->frames[reader->depth - 1].is_array ? JSON_EVENT_ARRAY_END : JSON_EVENT_OBJECT_END;
+	reader->p++;
+	reader->depth--;
+	return reader_emit(reader, &event);
+}
+
+int json_read(const char *text, size_t size, JsonHandler handler, void *user, JsonError *error)
+{
+	JsonReader *reader = malloc(sizeof(JsonReader));
+	if (!reader)
+	{
+		if (error)
+		{
+			error->line = 0;
+			error->column = 0;
+			error->message = "out of memory";
+		}
+		return -1;
+	}
+	reader->p = text;
+	reader->end = text + size;
+	reader->line_start = text;
+	reader->line = 1;
+	reader->handler = handler;
+	reader->user = user;
+	reader->error = error;
+	reader->depth = 0;
+
+	// Пропуск UTF-8 BOM
+	if (size >= 3 && memcmp(text, "\xEF\xBB\xBF", 3) == 0)
+	{
+		reader->p += 3;
+		reader->line_start = reader->p;
+	}
+
+	reader_skip_space(reader);
+	int ret = reader_value(reader);
+
+	while (ret == 0 && reader->depth > 0)
+	{
+		JsonFrame *frame = &reader->frames[reader->depth - 1];
+		reader_skip_space(reader);
+		if (reader->p >= reader->end)
+		{
+			ret = reader_fail(reader, "unexpected end of input");
+			break;
+		}
+
+		char closer = frame->is_array ? ']' : '}';
+		if (*reader->p == closer)
+		{
+			ret = reader_close(reader);
+			continue;
+		}
+
+		// Перед каждым элементом, кроме первого, - запятая
+		if (reader->started[reader->depth - 1])
+		{
+			if (*reader->p != ',')
+			{
+				ret = reader_fail(reader, frame->is_array ? "expected ',' or ']'" : "expected ',' or '}'");
+				break;
+			}
+			reader->p++;
+			frame->index++;
+			reader_skip_space(reader);
+		}
+		reader->started[reader->depth - 1] = 1;
+
+		if (!frame->is_array && (ret = reader_key(reader)) != 0)
+		{
+			break;
+		}
+		ret = reader_value(reader);
+	}
+
+	if (ret == 0)
+	{
+		reader_skip_space(reader);
+		if (reader->p != reader->end)
+		{
+			ret = reader_fail(reader, "data after the JSON value");
+		}
+	}
+
+	free(reader);
+	return ret;
+}
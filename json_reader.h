@@ -0,0 +1,88 @@
+#ifndef JSON_READER_H
+#define JSON_READER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ═══════════════════════════════════════════════════════════════
+// Streaming JSON reader
+// ═══════════════════════════════════════════════════════════════
+//
+// One pass over the text, no tree: every value, and the start and end of
+// every object and array, is reported to a handler together with the path
+// that leads to it. Strings are unescaped into a buffer that is valid only
+// during the call.
+//
+//   {"chain": {"tpl": [[1, 2], [4, 3]]}}
+//   value 3: depth 4, path[0].key "chain", path[1].key "tpl",
+//            path[2].index 1, path[3].index 1
+
+#define JSON_MAX_DEPTH   32
+#define JSON_MAX_KEY     64        // with NUL; longer keys are an error
+#define JSON_MAX_STRING  256       // same for string values
+
+typedef enum
+{
+	JSON_EVENT_VALUE,
+	JSON_EVENT_OBJECT_BEGIN,
+	JSON_EVENT_OBJECT_END,
+	JSON_EVENT_ARRAY_BEGIN,
+	JSON_EVENT_ARRAY_END
+} JsonEventType;
+
+typedef enum
+{
+	JSON_NULL,
+	JSON_BOOL,
+	JSON_NUMBER,
+	JSON_STRING
+} JsonValueType;
+
+// Position inside one enclosing container
+typedef struct
+{
+	int is_array;
+	size_t index;                  // element (array) or member (object) number
+	char key[JSON_MAX_KEY];        // member name, "" in arrays
+} JsonFrame;
+
+typedef struct
+{
+	JsonEventType type;
+	int depth;                     // enclosing containers; begin/end events count the parent only
+	const JsonFrame *path;         // [depth]
+
+	// JSON_EVENT_VALUE
+	JsonValueType value_type;
+	int boolean;
+	double number;
+	int64_t integer;               // number without fraction or exponent
+	int is_integer;
+	const char *string;            // NUL-terminated, unescaped
+	size_t length;
+} JsonEvent;
+
+// Nonzero return stops the reader; json_read() returns it
+typedef int (*JsonHandler)(const JsonEvent *event, void *user);
+
+typedef struct
+{
+	int line;                      // from 1
+	int column;
+	const char *message;
+} JsonError;
+
+/**
+ * Reads one JSON value (RFC 8259) from text
+ * @return 0, -1 on a syntax error (error is filled) or the handler's return
+ */
+int json_read(const char *text, size_t size, JsonHandler handler, void *user, JsonError *error);
+
+// Key of path[level] if that container is an object, otherwise NULL
+static inline const char *json_event_key(const JsonEvent *event, int level)
+{
+	return level >= 0 && level < event->depth && !event->path[level].is_array
+		? event->path[level].key : NULL;
+}
+
+#endif // JSON_READER_H
@@ -2,10 +2,15 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <errno.h>
 
 #include "eeprom_defs.h"
 #include "eeprom_structure.h"
 #include "eeprom_ops.h"
+#include "eeprom_file.h"
+#include "commands.h"
+#include "crypto.h"
+#include "stats.h"
 #include "ui.h"
 
 #ifdef HAVE_I2C_SUPPORT
@@ -14,34 +19,29 @@
 
 #define MAX_FILENAME 256
 
+// --discover-keys: подбор алгоритма и ключа по CRC вместо заголовка
+static CommandOptions options = { 0 };
+
+// Индекс topol_*.conf для меню: открывается при первом декодировании.
+// Собирается только из --topology DIR, иначе берется готовый, если есть
+static EEPROMTopology topology;
+static int topology_state;     // 0 - не открыт, 1 - открыт, -1 - недоступен
+
 static int read_eeprom_file(const char *filename, uint8_t *buffer)
 {
-	FILE *file = fopen(filename, "rb");
-	if (!file)
-	{
-		printf("Error: Cannot open file %s\n", filename);
-		return -1;
-	}
+	size_t read_size;
+	int result = eeprom_read_file(filename, buffer, &read_size);
 
-	fseek(file, 0, SEEK_END);
-	long file_size = ftell(file);
-	fseek(file, 0, SEEK_SET);
-
-	if (file_size <= 0 || file_size > EEPROM_SIZE)
+	if (result == EEPROM_ERROR_SIZE)
 	{
-		printf("Error: Invalid file size: %ld bytes (expected 1-%d)\n",
-			   file_size, EEPROM_SIZE);
-		fclose(file);
+		printf("Error: Invalid file size: %zu bytes (expected 1-%d)\n",
+			   read_size, EEPROM_SIZE);
 		return -4;
 	}
-
-	size_t read_size = fread(buffer, 1, file_size, file);
-	fclose(file);
-
-	if (read_size != (size_t)file_size)
+	if (result != EEPROM_SUCCESS)
 	{
-		printf("Error: Failed to read file completely\n");
-		return -2;
+		printf("Error: Cannot read file %s: %s\n", filename, strerror(errno));
+		return -1;
 	}
 
 	printf("Read %zu bytes from %s\n", read_size, filename);
@@ -50,23 +50,12 @@ static int read_eeprom_file(const char *filename, uint8_t *buffer)
 
 static int write_eeprom_file(const char *filename, const uint8_t *buffer, size_t size)
 {
-	FILE *file = fopen(filename, "wb");
-	if (!file)
+	if (eeprom_write_file(filename, buffer, size) != EEPROM_SUCCESS)
 	{
-		printf("Error: Cannot open file %s for writing\n", filename);
+		printf("Error: Cannot write file %s: %s\n", filename, strerror(errno));
 		return -1;
 	}
 
-	size_t written_size = fwrite(buffer, 1, size, file);
-	fclose(file);
-
-	if (written_size != size)
-	{
-		printf("Error: Failed to write all data. Wrote %zu of %zu bytes\n",
-			   written_size, size);
-		return -3;
-	}
-
 	printf("Successfully wrote %zu bytes to %s\n", size, filename);
 	return 0;
 }
@@ -75,46 +64,95 @@ static int write_eeprom_file(const char *filename, const uint8_t *buffer, size_t
 // Функции для работы с EEPROM
 // ═══════════════════════════════════════════════════════════════
 
+// Сообщения библиотеки в прежнем формате консольного вывода
+static void print_diag(EEPROMDiagLevel level, const char *message, void *user)
+{
+	static const char *const prefix[] = { "", "Warning: ", "Error: " };
+	printf("%s%s\n", prefix[level], message);
+}
+
+static int decode_eeprom(uint8_t *data, EEPROMVersion version)
+{
+	if (!options.discover_keys)
+	{
+		return eeprom_decode(data, EEPROM_SIZE, version);
+	}
+
+	EEPROMKeyInfo key;
+	int result = eeprom_discover_key(data, EEPROM_SIZE, version, &key);
+	if (result == EEPROM_ERROR_VERSION)
+	{
+		return eeprom_decode(data, EEPROM_SIZE, version);
+	}
+
+	if (result == EEPROM_SUCCESS)
+	{
+		if (version == EEPROM_VERSION_V1)
+		{
+			ui_print_info("Key discovery: v1 key 0x%08X", key.v1_key);
+		}
+		else
+		{
+			ui_print_info("Key discovery: algorithm %d, key %d, %s table",
+						  key.algorithm, key.key_index,
+						  key.algorithm == CRYPTO_ALGORITHM_XOR ? "small"
+						  : key.key_table == EEPROM_VERSION_V17 ? "v17" : "large");
+		}
+	}
+	else
+	{
+		ui_print_warning("Key discovery: no key validates all region CRCs, using header key");
+	}
+
+	return eeprom_decode_with_key(data, EEPROM_SIZE, version, &key);
+}
+
 static void decode_and_print_eeprom(uint8_t *data)
 {
 	EEPROMVersion version = eeprom_detect_version(data);
 
 	// Decode data
-	if (eeprom_decode(data, EEPROM_SIZE, version) != EEPROM_SUCCESS)
+	if (decode_eeprom(data, version) != EEPROM_SUCCESS)
 	{
 		ui_print_error("Failed to decode EEPROM");
 		return;
 	}
 
 	// Parse and print structure
-	switch(version)
+	EEPROMRecord record;
+	if (eeprom_record_parse(&record, data, version) != EEPROM_SUCCESS)
 	{
-		case EEPROM_VERSION_V1:
-		{
-			EEPROMStructure_v1 eeprom_v1;
-			eeprom_v1_parse(&eeprom_v1, data);
-			ui_print_eeprom(&eeprom_v1, version);
-			break;
-		}
-		case EEPROM_VERSION_V4:
-		case EEPROM_VERSION_V5:
-		case EEPROM_VERSION_V6:
+		ui_print_error("Unsupported EEPROM version: %d", version);
+		return;
+	}
+
+	ui_print_eeprom(&record.v4, version);  // члены union начинаются с одного адреса
+
+	const FieldMetadata *field = eeprom_field_by_id(version, FIELD_ID_BOARD_NAME);
+	if (!field)
+	{
+		return;
+	}
+	if (topology_state == 0)
+	{
+		topology_state = command_topology_open(&options, &topology, 0) == EEPROM_SUCCESS ? 1 : -1;
+	}
+	if (topology_state > 0)
+	{
+		char name[EEPROM_TOPOLOGY_NAME + 1];
+		size_t length = strnlen((const char*)data + field->offset, field->size);
+		if (length >= sizeof(name))
 		{
-			EEPROMStructure eeprom;
-			eeprom_from_bytes(&eeprom, data);
-			ui_print_eeprom(&eeprom, version);
-			break;
+			length = sizeof(name) - 1;
 		}
-		case EEPROM_VERSION_V17:
+		memcpy(name, data + field->offset, length);
+		name[length] = '\0';
+
+		const EEPROMTopologyBoard *board = eeprom_topology_find(&topology, name);
+		if (board)
 		{
-			EEPROMStructure_v17 eeprom_v17;
-			eeprom_v17_parse(&eeprom_v17, data);
-			ui_print_eeprom(&eeprom_v17, version);
-			break;
+			ui_print_topology(board);
 		}
-		default:
-			ui_print_error("Unsupported EEPROM version: %d", version);
-			break;
 	}
 }
 
@@ -175,6 +213,83 @@ static void encode_and_save_eeprom_v17(const char *filename, EEPROMStructure_v17
 	}
 }
 
+// ═══════════════════════════════════════════════════════════════
+// Параметры командной строки
+// ═══════════════════════════════════════════════════════════════
+
+// --crypto-selftest: строка на каждый тест каждой реализации
+static void print_selftest(const char *backend, const char *test, CryptoSelftestResult result, void *user)
+{
+	(void)user;
+	if (result == CRYPTO_SELFTEST_SKIP)
+	{
+		printf("%-10s %-30s ..SKIP (not supported by CPU)\n", backend, "");
+		return;
+	}
+	printf("%-10s %-30s ..%s\n", backend, test, result == CRYPTO_SELFTEST_OK ? "OK" : "FAIL");
+}
+
+#ifndef EEPROM_NO_STATS
+// --stats: сводка по этапам при любом выходе - из команды или из меню
+static void print_stats(void)
+{
+	fflush(stdout);
+	fprintf(stderr, "\n");
+	stats_report(stderr);
+}
+#endif
+
+static void print_usage(const char *program)
+{
+	printf("Usage: %s [options] [command]\n", program);
+	printf("Without a command the interactive menu is started.\n");
+	printf("\nCommands:\n");
+	printf("  decode [--jobs N] [--unordered] [--format text|ndjson|csv] <files|dirs...>\n");
+	printf("                          Decode dumps in parallel, one result line per file\n");
+	printf("  verify [--jobs N] [--unordered] [--failed] <files|dirs...>\n");
+	printf("                          Check region CRCs and test results only, hex status bitmap per file\n");
+	printf("  diff [--jobs N] [--format text|ndjson] <old> <new>\n");
+	printf("                          Field differences of two dumps, or of two snapshots by serial number\n");
+	printf("  sweep [--jobs N] [--boards] [--weakest N] <files|dirs...>\n");
+	printf("                          Sweep frequency stats per board, or level histograms per ASIC position\n");
+	printf("  patch [--board NAME] [--serial SN] (--output DIR | --in-place | --dry-run) field=value... <files|dirs...>\n");
+	printf("                          Set fields on every matching dump, re-encode and write atomically\n");
+	printf("  topology [--rebuild] [--details] [board names|files|dirs...]\n");
+	printf("                          Hashboard topology (topol_*.conf) by board name or of the given dumps\n");
+	printf("  pack [--jobs N] <archive.eea> <files|dirs|archives...>\n");
+	printf("                          Pack dumps into one archive indexed by serial number\n");
+	printf("  unpack [--jobs N] <archive.eea> <directory>\n");
+	printf("                          Write the archived dumps back as files\n");
+	printf("  lookup [--format F] <archive.eea> <serial...>\n");
+	printf("                          Decode the records of the given boards\n");
+#ifdef HAVE_I2C_SUPPORT
+	printf("  scan [--format F] [--save DIR] [/dev/i2c-N...]\n");
+	printf("                          Read and decode boards 0x50-0x53 on all I2C buses\n");
+	printf("  flash [--addr 0x5N] [--full] [--force] <dump.bin> </dev/i2c-N>\n");
+	printf("                          Write changed pages of a dump to the board EEPROM, verify\n");
+#endif
+	printf("\nOptions:\n");
+	printf("  --crypto-backend NAME   AES implementation: auto");
+	const char *name;
+	for (size_t i = 0; (name = crypto_backend_get(i, NULL)) != NULL; i++)
+	{
+		printf(", %s", name);
+	}
+	printf("\n");
+	printf("  --crypto-selftest       Check all AES implementations and exit\n");
+	printf("  --discover-keys         Find algorithm and key by region CRCs\n");
+	printf("  --cache FILE            decode/verify: reuse results for dumps seen before (created if missing)\n");
+	printf("  --topology DIR          Directory with topol_*.conf configs to compile the topology index from\n");
+	printf("  --topology-cache FILE   Compiled topology index (default: $XDG_CACHE_HOME/eeprom_tool/topology.eet)\n");
+#ifndef EEPROM_NO_STATS
+	printf("  --stats                 Print time per stage (p50/p99) and counters on exit\n");
+#endif
+#ifdef HAVE_I2C_SUPPORT
+	printf("  --i2c-read METHOD       EEPROM read transfer: auto, rdwr, block, byte, legacy, nvmem\n");
+#endif
+	printf("  --help                  Show this help\n");
+}
+
 // ═══════════════════════════════════════════════════════════════
 // Главное меню
 // ═══════════════════════════════════════════════════════════════
@@ -183,6 +298,135 @@ int main(int argc, char *argv[])
 {
 	setlocale(LC_ALL, "en_US.UTF-8");
 
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--crypto-backend") == 0 && i + 1 < argc)
+		{
+			const char *name = argv[++i];
+			if (crypto_set_backend(name) != 0)
+			{
+				ui_print_error("Crypto backend '%s' is unknown or not supported by this CPU", name);
+				return 1;
+			}
+		}
+		else if (strcmp(argv[i], "--crypto-selftest") == 0)
+		{
+			int failures = crypto_selftest(print_selftest, NULL);
+			printf("Selected backend: %s\n", crypto_backend_name());
+			return failures ? 1 : 0;
+		}
+		else if (strcmp(argv[i], "--discover-keys") == 0)
+		{
+			options.discover_keys = 1;
+		}
+		else if (strcmp(argv[i], "--cache") == 0 && i + 1 < argc)
+		{
+			options.cache_path = argv[++i];
+		}
+		else if (strcmp(argv[i], "--topology") == 0 && i + 1 < argc)
+		{
+			options.topology_dir = argv[++i];
+		}
+		else if (strcmp(argv[i], "--topology-cache") == 0 && i + 1 < argc)
+		{
+			options.topology_cache = argv[++i];
+		}
+		else if (strcmp(argv[i], "--stats") == 0)
+		{
+#ifdef EEPROM_NO_STATS
+			ui_print_error("--stats is not available: statistics were compiled out (-DEEPROM_STATS=OFF)");
+			return 1;
+#else
+			if (!stats_enabled) // повторный --stats не регистрирует отчёт второй раз
+			{
+				stats_enable(1);
+				atexit(print_stats);
+			}
+#endif
+		}
+#ifdef HAVE_I2C_SUPPORT
+		else if (strcmp(argv[i], "--i2c-read") == 0 && i + 1 < argc)
+		{
+			static const char *const methods[] = { "auto", "rdwr", "block", "byte", "legacy", "nvmem" };
+			const char *name = argv[++i];
+			int method = -1;
+			for (int m = 0; m < (int)(sizeof(methods) / sizeof(methods[0])); m++)
+			{
+				if (strcmp(name, methods[m]) == 0)
+				{
+					method = m;
+				}
+			}
+			if (method < 0)
+			{
+				ui_print_error("Unknown I2C read method: %s", name);
+				return 1;
+			}
+			iic_set_read_method(method);
+		}
+#endif
+		else if (strcmp(argv[i], "decode") == 0)
+		{
+			return cmd_decode(argc - i - 1, argv + i + 1, &options);
+		}
+		else if (strcmp(argv[i], "verify") == 0)
+		{
+			return cmd_verify(argc - i - 1, argv + i + 1, &options);
+		}
+		else if (strcmp(argv[i], "diff") == 0)
+		{
+			return cmd_diff(argc - i - 1, argv + i + 1, &options);
+		}
+		else if (strcmp(argv[i], "sweep") == 0)
+		{
+			return cmd_sweep(argc - i - 1, argv + i + 1, &options);
+		}
+		else if (strcmp(argv[i], "patch") == 0)
+		{
+			return cmd_patch(argc - i - 1, argv + i + 1, &options);
+		}
+		else if (strcmp(argv[i], "topology") == 0)
+		{
+			return cmd_topology(argc - i - 1, argv + i + 1, &options);
+		}
+		else if (strcmp(argv[i], "pack") == 0)
+		{
+			return cmd_pack(argc - i - 1, argv + i + 1, &options);
+		}
+		else if (strcmp(argv[i], "unpack") == 0)
+		{
+			return cmd_unpack(argc - i - 1, argv + i + 1, &options);
+		}
+		else if (strcmp(argv[i], "lookup") == 0)
+		{
+			return cmd_lookup(argc - i - 1, argv + i + 1, &options);
+		}
+#ifdef HAVE_I2C_SUPPORT
+		else if (strcmp(argv[i], "scan") == 0)
+		{
+			return cmd_scan(argc - i - 1, argv + i + 1, &options);
+		}
+		else if (strcmp(argv[i], "flash") == 0)
+		{
+			return cmd_flash(argc - i - 1, argv + i + 1, &options);
+		}
+#endif
+		else if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0)
+		{
+			print_usage(argv[0]);
+			return 0;
+		}
+		else
+		{
+			ui_print_error("Unknown option: %s", argv[i]);
+			print_usage(argv[0]);
+			return 1;
+		}
+	}
+
+	// Команды работают по результатам декодирования, меню печатает сообщения библиотеки
+	eeprom_set_diag_handler(print_diag, NULL);
+
 	char input_filename[MAX_FILENAME];
 	char output_filename[MAX_FILENAME];
 	uint8_t data[EEPROM_SIZE];
@@ -223,7 +467,7 @@ int main(int argc, char *argv[])
 			{
 				EEPROMVersion version = eeprom_detect_version(data);
 
-				if (eeprom_decode(data, EEPROM_SIZE, version) != EEPROM_SUCCESS)
+				if (decode_eeprom(data, version) != EEPROM_SUCCESS)
 				{
 					ui_print_error("Failed to decode EEPROM");
 					break;
@@ -0,0 +1,204 @@
+#include "stats.h"
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+
+// ═══════════════════════════════════════════════════════════════
+// Гистограммы: 16 точных значений, затем по 8 подкорзин на каждую
+// степень двойки - погрешность перцентиля не больше 1/8
+// ═══════════════════════════════════════════════════════════════
+
+#define STATS_EXACT    16
+#define STATS_SUB_BITS 3
+#define STATS_BUCKETS  (STATS_EXACT + (64 - 4) * (1 << STATS_SUB_BITS))
+
+typedef struct StatsBlock StatsBlock;
+struct StatsBlock
+{
+	uint64_t count[STATS_STAGE_COUNT];
+	uint64_t total[STATS_STAGE_COUNT];
+	uint64_t max[STATS_STAGE_COUNT];
+	uint64_t buckets[STATS_STAGE_COUNT][STATS_BUCKETS];
+	uint64_t counters[STATS_COUNTER_COUNT];
+	StatsBlock *next;
+};
+
+int stats_enabled = 0;
+
+// Блок на поток; блоки завершившихся потоков остаются в списке до отчета
+static __thread StatsBlock *stats_local;
+static StatsBlock *stats_blocks;
+static pthread_mutex_t stats_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static const char *const stage_names[STATS_STAGE_COUNT] = {
+	"file_read", "i2c_read", "decrypt_aes", "decrypt_xxtea", "crc", "parse", "render", "export",
+};
+
+static const char *const counter_names[STATS_COUNTER_COUNT] = {
+	"boards", "bytes_read", "crc_failures", "test_failures", "i2c_retries", "cache_hits",
+};
+
+void stats_enable(int enabled)
+{
+	stats_enabled = enabled;
+}
+
+uint64_t stats_now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static StatsBlock *stats_block(void)
+{
+	if (!stats_local)
+	{
+		stats_local = calloc(1, sizeof(StatsBlock));
+		if (!stats_local)
+		{
+			return NULL;
+		}
+		pthread_mutex_lock(&stats_lock);
+		stats_local->next = stats_blocks;
+		stats_blocks = stats_local;
+		pthread_mutex_unlock(&stats_lock);
+	}
+	return stats_local;
+}
+
+static unsigned stats_bucket(uint64_t ns)
+{
+	if (ns < STATS_EXACT)
+	{
+		return (unsigned)ns;
+	}
+	unsigned exponent = 63 - __builtin_clzll(ns);
+	unsigned sub = (unsigned)(ns >> (exponent - STATS_SUB_BITS)) & ((1 << STATS_SUB_BITS) - 1);
+	return STATS_EXACT + (exponent - 4) * (1 << STATS_SUB_BITS) + sub;
+}
+
+// Середина корзины
+static double stats_bucket_value(unsigned bucket)
+{
+	if (bucket < STATS_EXACT)
+	{
+		return bucket;
+	}
+	unsigned exponent = (bucket - STATS_EXACT) / (1 << STATS_SUB_BITS) + 4;
+	unsigned sub = (bucket - STATS_EXACT) % (1 << STATS_SUB_BITS);
+	double width = (double)(1ull << (exponent - STATS_SUB_BITS));
+	return ((1 << STATS_SUB_BITS) + sub) * width + width / 2;
+}
+
+void stats_record(StatsStage stage, uint64_t start)
+{
+	uint64_t ns = stats_now() - start;
+	StatsBlock *block = stats_block();
+	if (!block)
+	{
+		return;
+	}
+	block->count[stage]++;
+	block->total[stage] += ns;
+	if (ns > block->max[stage])
+	{
+		block->max[stage] = ns;
+	}
+	block->buckets[stage][stats_bucket(ns)]++;
+}
+
+void stats_add(StatsCounter counter, uint64_t value)
+{
+	StatsBlock *block = stats_block();
+	if (block)
+	{
+		block->counters[counter] += value;
+	}
+}
+
+static double stats_percentile(const uint64_t *buckets, uint64_t count, double fraction)
+{
+	uint64_t rank = (uint64_t)(count * fraction);
+	uint64_t seen = 0;
+	for (unsigned b = 0; b < STATS_BUCKETS; b++)
+	{
+		seen += buckets[b];
+		if (seen > rank)
+		{
+			return stats_bucket_value(b);
+		}
+	}
+	return 0;
+}
+
+static void stats_print_ns(FILE *stream, double ns)
+{
+	if (ns < 1e4)
+	{
+		fprintf(stream, " %9.0fns", ns);
+	}
+	else if (ns < 1e7)
+	{
+		fprintf(stream, " %9.1fus", ns / 1e3);
+	}
+	else
+	{
+		fprintf(stream, " %9.1fms", ns / 1e6);
+	}
+}
+
+void stats_report(FILE *stream)
+{
+	// Сведение блоков всех потоков; вызывается, когда рабочие потоки завершены
+	StatsBlock *sum = calloc(1, sizeof(StatsBlock));
+	if (!sum)
+	{
+		return;
+	}
+	pthread_mutex_lock(&stats_lock);
+	for (StatsBlock *block = stats_blocks; block; block = block->next)
+	{
+		for (int s = 0; s < STATS_STAGE_COUNT; s++)
+		{
+			sum->count[s] += block->count[s];
+			sum->total[s] += block->total[s];
+			if (block->max[s] > sum->max[s])
+			{
+				sum->max[s] = block->max[s];
+			}
+			for (unsigned b = 0; b < STATS_BUCKETS; b++)
+			{
+				sum->buckets[s][b] += block->buckets[s][b];
+			}
+		}
+		for (int c = 0; c < STATS_COUNTER_COUNT; c++)
+		{
+			sum->counters[c] += block->counters[c];
+		}
+	}
+	pthread_mutex_unlock(&stats_lock);
+
+	fprintf(stream, "%-14s %10s %11s %11s %11s %11s\n", "stage", "count", "total", "p50", "p99", "max");
+	for (int s = 0; s < STATS_STAGE_COUNT; s++)
+	{
+		if (sum->count[s] == 0)
+		{
+			continue;
+		}
+		fprintf(stream, "%-14s %10llu", stage_names[s], (unsigned long long)sum->count[s]);
+		stats_print_ns(stream, (double)sum->total[s]);
+		// середина корзины может оказаться больше самого долгого замера
+		double p50 = stats_percentile(sum->buckets[s], sum->count[s], 0.50);
+		double p99 = stats_percentile(sum->buckets[s], sum->count[s], 0.99);
+		stats_print_ns(stream, p50 < sum->max[s] ? p50 : (double)sum->max[s]);
+		stats_print_ns(stream, p99 < sum->max[s] ? p99 : (double)sum->max[s]);
+		stats_print_ns(stream, (double)sum->max[s]);
+		fprintf(stream, "\n");
+	}
+	for (int c = 0; c < STATS_COUNTER_COUNT; c++)
+	{
+		fprintf(stream, "%-14s %10llu\n", counter_names[c], (unsigned long long)sum->counters[c]);
+	}
+	free(sum);
+}
@@ -0,0 +1,63 @@
+#ifndef STATS_H
+#define STATS_H
+
+// ═══════════════════════════════════════════════════════════════
+// Per-stage timers and counters (--stats)
+//
+// Disabled by default: every probe is one predictable branch on
+// stats_enabled and no clock read. Built with -DEEPROM_NO_STATS the
+// probes compile to nothing. Samples go to per-thread histograms, so
+// parallel decode does not contend on shared cache lines.
+// ═══════════════════════════════════════════════════════════════
+
+#include <stdint.h>
+#include <stdio.h>
+
+typedef enum
+{
+	STATS_FILE_READ,               // eeprom_read_file
+	STATS_I2C_READ,                // iic_eeprom_load
+	STATS_DECRYPT_AES,             // v1 AES-256-CBC, per region
+	STATS_DECRYPT_XXTEA,           // v4-v6/v17 XXTEA/XOR, per region
+	STATS_CRC,                     // region CRC, per region
+	STATS_PARSE,                   // eeprom_record_parse
+	STATS_RENDER,                  // ui_print_eeprom
+	STATS_EXPORT,                  // export_record / export_error
+	STATS_STAGE_COUNT
+} StatsStage;
+
+typedef enum
+{
+	STATS_BOARDS,                  // images decoded or copied from the cache
+	STATS_BYTES_READ,              // bytes read from files and I2C
+	STATS_CRC_FAILURES,            // regions with a CRC mismatch
+	STATS_TEST_FAILURES,           // regions with a failed test result
+	STATS_I2C_RETRIES,             // fallbacks to a slower I2C read method
+	STATS_CACHE_HITS,              // images found in the decode cache
+	STATS_COUNTER_COUNT
+} StatsCounter;
+
+extern int stats_enabled;
+
+void stats_enable(int enabled);
+uint64_t stats_now(void);
+void stats_record(StatsStage stage, uint64_t start);
+void stats_add(StatsCounter counter, uint64_t value);
+
+// Table of count, total, p50, p99 and max per stage, then the counters
+void stats_report(FILE *stream);
+
+#ifdef EEPROM_NO_STATS
+#define STATS_BEGIN(var)
+#define STATS_END(stage, var)
+#define STATS_ADD(counter, value)
+#else
+#define STATS_BEGIN(var) \
+	uint64_t var = __builtin_expect(stats_enabled, 0) ? stats_now() : 0
+#define STATS_END(stage, var) \
+	do { if (__builtin_expect(stats_enabled, 0)) stats_record(stage, var); } while (0)
+#define STATS_ADD(counter, value) \
+	do { if (__builtin_expect(stats_enabled, 0)) stats_add(counter, value); } while (0)
+#endif
+
+#endif // STATS_H
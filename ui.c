@@ -1,5 +1,7 @@
 #include "ui.h"
 #include "eeprom_structure.h"
+#include "eeprom_ops.h"
+#include "stats.h"
 #include <stdio.h>
 #include <stdarg.h>
 #include <string.h>
@@ -240,7 +242,7 @@ void ui_print_field(const void *base, const FieldMetadata *field)
 
 		case FIELD_TYPE_ARRAY_UINT8:
 		{
-			if (strcmp(field->name, "ASIC Frequencies") == 0)
+			if (field->id == FIELD_ID_ASIC_FREQUENCIES)
 			{
 				uint16_t freq_base;
 				uint8_t freq_step;
@@ -270,27 +272,27 @@ void ui_print_field(const void *base, const FieldMetadata *field)
 				}
 				printf("\n");
 
-				// Выводим частоты (каждый байт содержит 2 частоты по 4 бита)
-				for (size_t i = 0; i < array_size; i++)
+				// Частоты по 16 на строку и сводка по плате
+				uint16_t freqs[EEPROM_SWEEP_ASICS];
+				EEPROMSweepStats stats;
+				eeprom_sweep_unpack(array, freq_base, freq_step, freqs, &stats);
+
+				for (size_t i = 0; i < array_size && i < EEPROM_SWEEP_BYTES; i++)
 				{
 					if (i % 8 == 0)
 					{
 						printf("    ");
 					}
 
-					uint8_t v0 = array[i] >> 4;      // Старшие 4 бита
-					uint8_t v1 = array[i] & 0x0F;    // Младшие 4 бита
-
-					uint16_t freq0 = v0 * freq_step + freq_base;
-					uint16_t freq1 = v1 * freq_step + freq_base;
-
-					printf(" %4u %4u", freq0, freq1);
+					printf(" %4u %4u", freqs[2 * i], freqs[2 * i + 1]);
 
 					if ((i % 8) == 7)
 					{
 						printf("\n");
 					}
 				}
+				printf(TERM_DIM "    min %u  max %u  mean %.1f  stddev %.1f MHz" TERM_RESET "\n",
+					   stats.min, stats.max, stats.mean, stats.stddev);
 
 				return;
 			}
@@ -330,6 +332,7 @@ void ui_print_field(const void *base, const FieldMetadata *field)
 
 void ui_print_eeprom(const void *eeprom_struct, EEPROMVersion version)
 {
+	STATS_BEGIN(start);
 	size_t field_count;
 	const FieldMetadata *fields = eeprom_get_fields(version, &field_count);
 
@@ -370,4 +373,198 @@ void ui_print_eeprom(const void *eeprom_struct, EEPROMVersion version)
 	}
 
 	printf("\n");
+	STATS_END(STATS_RENDER, start);
+}
+
+void ui_print_topology(const EEPROMTopologyBoard *board)
+{
+	ui_print_category_header("Topology");
+
+	printf("  " TERM_BOLD "%-27s" TERM_RESET ": %s", "Config", board->source);
+	if (board->source_entry)
+	{
+		printf(" [%u]", board->source_entry);
+	}
+	printf("\n");
+	printf("  " TERM_BOLD "%-27s" TERM_RESET ": %s (hw %s, sw %s)\n", "Machine",
+		   board->machine, board->hw_version, board->sw_version);
+	printf("  " TERM_BOLD "%-27s" TERM_RESET ": %s (0x%04X), %u cores, %u domain(s)\n", "ASIC",
+		   board->asic_id, board->asic_addr, board->asic_core_num, board->asic_domain_num);
+	printf("  " TERM_BOLD "%-27s" TERM_RESET ": %u x %u ASICs, %u domains of %u\n", "Chains",
+		   board->chain_num, board->chain_asic_num, board->chain_domain_num, board->domain_asic_num);
+	printf("  " TERM_BOLD "%-27s" TERM_RESET ": %s, power %s, PIC %s, %u fans\n", "Hardware",
+		   board->processor, board->power, board->pic[0] ? board->pic : "-", board->fan_count);
+
+	printf("  " TERM_BOLD "%-27s" TERM_RESET ":", "Sensors");
+	for (int s = 0; s < board->sensor_count; s++)
+	{
+		const EEPROMTopologySensor *sensor = &board->sensors[s];
+		printf("%s %s %s", s ? "," : "", eeprom_topology_sensor_group(sensor->group), sensor->type);
+		if (sensor->i2c_addr)
+		{
+			printf("@0x%02X", sensor->i2c_addr);
+		}
+	}
+	printf("%s\n", board->sensor_count ? "" : " -");
+
+	// Номера ASIC по цепочке в расположении на плате
+	if (board->grid_rows && board->grid_columns)
+	{
+		printf("  " TERM_BOLD "%-27s" TERM_RESET ": %u x %u\n", "ASIC layout",
+			   board->grid_rows, board->grid_columns);
+		for (int row = 0; row < board->grid_rows; row++)
+		{
+			printf("    " TERM_DIM);
+			for (int column = 0; column < board->grid_columns; column++)
+			{
+				uint8_t asic = board->grid[row * board->grid_columns + column];
+				printf(asic ? " %3u" : "   .", asic);
+			}
+			printf(TERM_RESET "\n");
+		}
+	}
+	printf("\n");
+}
+
+// ═══════════════════════════════════════════════════════════════
+// Interactive Editing Functions
+// ═══════════════════════════════════════════════════════════════
+
+static int edit_field_interactive(void *base, const FieldMetadata *field)
+{
+	uint8_t *ptr = (uint8_t*)base + field->offset;
+
+	if (field->read_only)
+	{
+		ui_print_warning("Field '%s' is read-only", field->name);
+		return EEPROM_SUCCESS;
+	}
+
+	printf("\n");
+	ui_print_info("Editing: %s", field->name);
+	printf("Current value: ");
+	ui_print_field(base, field);
+
+	switch (field->type)
+	{
+		case FIELD_TYPE_UINT8:
+		case FIELD_TYPE_HEX8:
+		{
+			uint8_t value;
+			if (ui_input_uint8("New value", &value, field->min_value, field->max_value))
+			{
+				*(uint8_t*)ptr = value;
+				ui_print_success("Updated");
+			}
+			break;
+		}
+
+		case FIELD_TYPE_UINT16:
+		case FIELD_TYPE_HEX16:
+		case FIELD_TYPE_VOLTAGE:
+		case FIELD_TYPE_HASHRATE:
+		{
+			uint16_t value;
+			if (ui_input_uint16("New value", &value, field->min_value, field->max_value))
+			{
+				*(uint16_t*)ptr = value;
+				ui_print_success("Updated");
+			}
+			break;
+		}
+
+		case FIELD_TYPE_INT8:
+		{
+			int8_t value;
+			if (ui_input_int8("New value", &value, field->min_value, field->max_value))
+			{
+				*(int8_t*)ptr = value;
+				ui_print_success("Updated");
+			}
+			break;
+		}
+
+		case FIELD_TYPE_STRING:
+		{
+			char buffer[256];
+			if (ui_input_string("New value", buffer, sizeof(buffer)))
+			{
+				strncpy((char*)ptr, buffer, field->size);
+				((char*)ptr)[field->size - 1] = '\0';
+				ui_print_success("Updated");
+			}
+			break;
+		}
+
+		default:
+			ui_print_error("Editing not supported for this field type");
+			return EEPROM_ERROR_UNKNOWN;
+	}
+
+	return EEPROM_SUCCESS;
+}
+
+int eeprom_edit_interactive(void *eeprom_struct, EEPROMVersion version)
+{
+	size_t field_count;
+	const FieldMetadata *fields = eeprom_get_fields(version, &field_count);
+
+	if (!fields || field_count == 0)
+	{
+		ui_print_error("No field metadata for EEPROM version %d", version);
+		return EEPROM_ERROR_VERSION;
+	}
+
+	while (1)
+	{
+		ui_print_eeprom(eeprom_struct, version);
+
+		printf("\n" TERM_BOLD "Edit Menu:" TERM_RESET "\n");
+		printf("Select field to edit (1-%zu), or 0 to finish:\n", field_count);
+
+		const char *current_category = NULL;
+		for (size_t i = 0; i < field_count; i++)
+		{
+			if (current_category == NULL || strcmp(current_category, fields[i].category) != 0)
+			{
+				printf("\n" TERM_BOLD TERM_CYAN "  %s:" TERM_RESET "\n", fields[i].category);
+				current_category = fields[i].category;
+			}
+			printf("    [%2zu] %s", i + 1, fields[i].name);
+			if (fields[i].read_only)
+			{
+				printf(TERM_DIM " (read-only)" TERM_RESET);
+			}
+			printf("\n");
+		}
+
+		printf("\n    [ 0] " TERM_BOLD TERM_GREEN "Finish editing" TERM_RESET "\n");
+
+		printf("\nChoice: ");
+		int choice;
+		if (scanf("%d", &choice) != 1)
+		{
+			while (getchar() != '\n');
+			ui_print_error("Invalid input");
+			continue;
+		}
+		getchar();
+
+		if (choice == 0)
+		{
+			break;
+		}
+
+		if (choice < 1 || choice > (int)field_count)
+		{
+			ui_print_error("Invalid choice (1-%zu)", field_count);
+			continue;
+		}
+
+		const FieldMetadata *field = &fields[choice - 1];
+		edit_field_interactive(eeprom_struct, field);
+	}
+
+	ui_print_success("Editing complete");
+	return EEPROM_SUCCESS;
 }
@@ -6,6 +6,7 @@
 #include <stdbool.h>
 #include "eeprom_defs.h"
 #include "eeprom_structure.h"
+#include "eeprom_topology.h"
 
 // ═══════════════════════════════════════════════════════════════
 // ANSI Color Codes
@@ -66,4 +67,10 @@ void ui_print_field(const void *base, const FieldMetadata *field);
 // Print category header
 void ui_print_category_header(const char *category);
 
+// Print the hashboard topology resolved for the board name
+void ui_print_topology(const EEPROMTopologyBoard *board);
+
+// Field-by-field editing menu, returns EEPROM_SUCCESS when done
+int eeprom_edit_interactive(void *eeprom_struct, EEPROMVersion version);
+
 #endif // UI_H